@@ -276,16 +276,12 @@ bool SelfInstance::Start()
 		return false;
 	}
 
-	// spin until knowledge graph is loaded..
-	while( !m_bKnowledgeGraphReady )
-	{
-		ThreadPool::Instance()->ProcessMainThread();
-		boost::this_thread::yield();
-	}
-
-	// load our body from the models of self, this will block until the body is loaded..
-	LoadBody();
+	// the rest is started once the knowledge graph and our body are loaded, see StartComponents()
+	return true;
+}
 
+bool SelfInstance::StartComponents()
+{
 	if (! StartServices() )
 	{
 		Log::Error( "SelfInstance", "Failed to start services." );
@@ -431,7 +427,15 @@ bool SelfInstance::Stop()
 
 	if ( m_spKnowledgeGraph )
 	{
-		m_spKnowledgeGraph->Close();
+		// the main thread isn't running anymore, so process it here until the graph has written everything..
+		if ( m_spKnowledgeGraph->Close( DELEGATE( SelfInstance, OnKnowledgeGraphClosed, bool, this ) ) )
+		{
+			while( m_bKnowledgeGraphReady )
+			{
+				m_pThreadPool->ProcessMainThread();
+				boost::this_thread::sleep( boost::posix_time::milliseconds(5) );
+			}
+		}
 		m_spKnowledgeGraph.reset();
 	}
 
@@ -536,6 +540,16 @@ void SelfInstance::OnKnowledgeGraphLoaded( IGraph::SP a_spGraph )
 {
 	assert( a_spGraph == m_spKnowledgeGraph );
 	m_bKnowledgeGraphReady = true;
+
+	// load our body from the models of self, we continue starting once it's loaded..
+	LoadBody();
+}
+
+void SelfInstance::OnKnowledgeGraphClosed( bool a_bSuccess )
+{
+	if (! a_bSuccess )
+		Log::Error( "SelfInstance", "Failed to close knowledge graph." );
+	m_bKnowledgeGraphReady = false;
 }
 
 void SelfInstance::LoadBody()
@@ -552,12 +566,10 @@ void SelfInstance::LoadBody()
 		) );
 
 	if ( ! spLoadBody->Start( DELEGATE( SelfInstance, OnBodyLoaded, ITraverser::SP, this ) ) )
-		Log::Error( "SelfGraph", "Failed to discover model." );
-
-	while(! m_spMyBody )
 	{
-		boost::this_thread::yield();
-		ThreadPool::Instance()->ProcessMainThread();
+		// we can't start without a body..
+		Log::Error( "SelfGraph", "Failed to discover model." );
+		m_pThreadPool->StopMainThread();
 	}
 }
 
@@ -567,7 +579,12 @@ void SelfInstance::SaveBody()
 
 	IGraph::PropertyMap props;
 	props["bodyId"] = m_LocalConfig.m_BodyId;
-	props["data"] = ISerializable::SerializeObject( this ).toStyledString();
+	props["data"] = Json::FastWriter().write( ISerializable::SerializeObject( this ) );
+
+	// most calls change nothing, so don't rewrite the body when it's the same
+	Json::Value saved;
+	if ( m_spMyBody && m_spMyBody->GetPropertyStore().Find( "data", saved ) && saved == props["data"] )
+		return;
 
 	if (! m_spMyBody )
 	{
@@ -624,6 +641,12 @@ void SelfInstance::OnBodyLoaded(ITraverser::SP a_spTraverser)
 		ApplyLocalConfig();
 		SaveBody();
 	}
+
+	if ( m_bActive && !StartComponents() )
+	{
+		Log::Error( "SelfInstance", "Failed to start SelfInstance." );
+		m_pThreadPool->StopMainThread();
+	}
 }
 
 void SelfInstance::RegisterEventHandlers()
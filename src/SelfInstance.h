@@ -65,7 +65,7 @@ public:
 	{
 		RTTI_DECL();
 
-		LocalConfig() : m_RobotUrl( "tcp://127.0.0.1"), m_bUseDevVersion(false), m_nPort(-1)
+		LocalConfig() : m_RobotUrl( "tcp://127.0.0.1"), m_bUseDevVersion(false), m_nPort(-1), m_fReplaySpeed( 1.0f )
 		{}
 
 		bool m_bUseDevVersion;
@@ -81,6 +81,9 @@ public:
 		std::string m_BodyId;			// Id of our body in the models of self
 		std::string m_GatewayURL;		// URL for the gateway
 		int m_nPort;					// port to listen on
+		std::string m_RecordSession;	// if set, all sensor data is recorded into this file
+		std::string m_ReplaySession;	// if set, this recorded session is replayed in place of our sensors
+		float m_fReplaySpeed;			// speed of the replay, 0 replays as fast as possible
 
 		virtual void Serialize(Json::Value & json)
 		{
@@ -95,6 +98,9 @@ public:
 			json["m_BodyId"] = m_BodyId;
 			json["m_GatewayURL"] = m_GatewayURL;
 			json["m_nPort"] = m_nPort;
+			json["m_RecordSession"] = m_RecordSession;
+			json["m_ReplaySession"] = m_ReplaySession;
+			json["m_fReplaySpeed"] = m_fReplaySpeed;
 		}
 
 		virtual void Deserialize(const Json::Value & json)
@@ -121,6 +127,12 @@ public:
 				m_GatewayURL = json["m_GatewayURL"].asString();
 			if ( json["m_nPort"].isNumeric() )
 				m_nPort = json["m_nPort"].asInt();
+			if ( json["m_RecordSession"].isString() )
+				m_RecordSession = json["m_RecordSession"].asString();
+			if ( json["m_ReplaySession"].isString() )
+				m_ReplaySession = json["m_ReplaySession"].asString();
+			if ( json["m_fReplaySpeed"].isNumeric() )
+				m_fReplaySpeed = json["m_fReplaySpeed"].asFloat();
 		}
 	};
 
@@ -173,7 +185,8 @@ public:
 	const FileList &		GetSkillFiles() const;
 	const FileList &		GetPlanFiles() const;
 
-	//! Initialize this self instance.
+	//! Initialize this self instance. This returns once the knowledge graph starts loading, everything
+	//! else is started on the main thread after the graph and our body are loaded.
 	bool					Start();
 	//! Updates all systems of this self-instance, processes any pending events
 	//! and queued data. Returns false if instance is stopped.
@@ -276,7 +289,9 @@ private:
 	void ApplyLocalConfig();
 	void OnSaveConfig();
 
+	bool StartComponents();
 	void OnKnowledgeGraphLoaded( IGraph::SP a_spGraph );
+	void OnKnowledgeGraphClosed( bool a_bSuccess );
 
 	void LoadBody();
 	void SaveBody();
@@ -23,17 +23,22 @@
 REG_SERIALIZABLE(ModelAgent);
 RTTI_IMPL(ModelAgent, IAgent);
 
-ModelAgent::ModelAgent()
+ModelAgent::ModelAgent() : m_PageSize(100)
 {}
 
 void ModelAgent::Serialize(Json::Value & json)
 {
 	IAgent::Serialize(json);
+
+	json["m_PageSize"] = m_PageSize;
 }
 
 void ModelAgent::Deserialize(const Json::Value & json)
 {
 	IAgent::Deserialize(json);
+
+	if (json.isMember("m_PageSize"))
+		m_PageSize = json["m_PageSize"].asUInt();
 }
 
 bool ModelAgent::OnStart()
@@ -149,7 +154,7 @@ void ModelAgent::OnModelPayload(const ITopics::Payload & a_Payload)
 
 //-----------------------------------------------------------
 
-ModelAgent::ModelQuery::ModelQuery(ModelAgent * a_pAgent, const IThing::SP & a_spQuery) : m_pAgent(a_pAgent), m_spQuery(a_spQuery)
+ModelAgent::ModelQuery::ModelQuery(ModelAgent * a_pAgent, const IThing::SP & a_spQuery) : m_pAgent(a_pAgent), m_spQuery(a_spQuery), m_nPage(0)
 {
 	bool bError = true;
 	bool bCompleted = false;
@@ -171,7 +176,17 @@ ModelAgent::ModelQuery::ModelQuery(ModelAgent * a_pAgent, const IThing::SP & a_s
 		{
 			ITraverser::SP spTraverser = spGraph->LoadTraverser((*a_spQuery)["traverser"]);
 			if (spTraverser)
+			{
+				// results are sent a page at a time only if asked, otherwise they all go in one reply
+				if (data.isMember("limit"))
+					spTraverser->SetLimit(data["limit"].asUInt(), data["offset"].asUInt());
+				if (data.isMember("page_size"))
+					spTraverser->SetBatchSize(data["page_size"].asUInt());
+				else if (data.isMember("limit") && spTraverser->GetBatchSize() == 0)
+					spTraverser->SetBatchSize(m_pAgent->m_PageSize);
+
 				bError = !spTraverser->Start(DELEGATE(ModelQuery, OnTraverse, ITraverser::SP, this));
+			}
 		}
 		else if (evt == "gremlin")
 		{
@@ -287,12 +302,25 @@ ModelAgent::ModelQuery::ModelQuery(ModelAgent * a_pAgent, const IThing::SP & a_s
 
 void ModelAgent::ModelQuery::OnTraverse(ITraverser::SP a_spTraverser)
 {
-	// store results into the IThing object, then notify observers with a data and state change events..
+	// store this page of results into the IThing object replacing the last page, then notify observers with
+	// a data event for each page and a state change event once the last page is sent..
+	Json::Value & data = m_spQuery->GetData();
+	Json::Value & results = data["results"];
+	results = Json::Value(Json::arrayValue);
 	for (size_t i = 0; i < a_spTraverser->Size(); ++i)
-		a_spTraverser->GetResult(i)->Serialize(m_spQuery->GetData()["results"][i]);
+		a_spTraverser->GetResult(i)->Serialize(results[(Json::ArrayIndex)i]);
+	if (a_spTraverser->GetBatchSize() > 0)
+	{
+		data["page"] = m_nPage++;
+		data["more"] = !a_spTraverser->IsDone();
+	}
 	m_spQuery->OnDataChanged();
-	m_spQuery->SetState("COMPLETED");
-	delete this;
+
+	if (a_spTraverser->IsDone())
+	{
+		m_spQuery->SetState("COMPLETED");
+		delete this;
+	}
 }
 
 void ModelAgent::ModelQuery::OnVertexEvent(const IVertex::VertexEvent & a_Event)
@@ -58,6 +58,7 @@ private:
 
 		ModelAgent *	m_pAgent;
 		IThing::SP		m_spQuery;
+		unsigned int	m_nPage;
 	};
 	typedef std::vector<IThing::WP>						ObjectList;
 
@@ -73,6 +74,7 @@ private:
 
 	//! Data
 	SubscriberMap		m_SubscriberMap;
+	unsigned int		m_PageSize;				// page size of a traverse with a limit but no page_size
 
 	//! Callbacks
 	void OnModelSubscriber( const ITopics::SubInfo & a_Info );
@@ -31,6 +31,9 @@ void DepthImage::Serialize(Json::Value &json)
 #if ENABLE_CONTENT_SERIALIZATION
 	json["m_Content"] = StringUtil::EncodeBase64(m_Content);
 #endif
+	json["m_ContentType"] = m_ContentType;
+	json["m_Width"] = m_Width;
+	json["m_Height"] = m_Height;
 	json["m_Origin"] = m_Origin;
 }
 
@@ -42,6 +45,12 @@ void DepthImage::Deserialize(const Json::Value &json)
 	if (json.isMember("m_Content"))
 		m_Content = StringUtil::DecodeBase64(json["m_Content"].asString());
 #endif
+	if (json["m_ContentType"].isString())
+		m_ContentType = json["m_ContentType"].asString();
+	if (json["m_Width"].isNumeric())
+		m_Width = json["m_Width"].asInt();
+	if (json["m_Height"].isNumeric())
+		m_Height = json["m_Height"].asInt();
 	if (json["m_Origin"].isString())
 		m_Origin = json["m_Origin"].asString();
 }
@@ -32,7 +32,7 @@ public:
 	typedef boost::weak_ptr<DepthImage>				WP;
 
 	//! Construction
-	DepthImage() : IThing(TT_PERCEPTION, 30.0f)
+	DepthImage() : IThing(TT_PERCEPTION, 30.0f), m_ContentType( "image/png" ), m_Width( 0 ), m_Height( 0 )
 	{}
 
 	//! ISerializable interface
@@ -49,6 +49,29 @@ public:
 	{
 		m_Content = a_Content;
 	}
+	//! Returns the type of the content, "image/png" or the packed raw depth type of DepthVideoData.
+	const std::string & GetContentType() const
+	{
+		return m_ContentType;
+	}
+	void SetContentType(const std::string & a_ContentType)
+	{
+		m_ContentType = a_ContentType;
+	}
+	//! The size of the image, this is 0 if the size is unknown without decoding the content.
+	int GetWidth() const
+	{
+		return m_Width;
+	}
+	int GetHeight() const
+	{
+		return m_Height;
+	}
+	void SetSize(int a_Width, int a_Height)
+	{
+		m_Width = a_Width;
+		m_Height = a_Height;
+	}
 
 	//! Returns the GUID of the sensor.
 	const std::string & GetOrigin() const
@@ -64,6 +87,9 @@ public:
 private:
 	//! Data
 	std::string m_Content;
+	std::string	m_ContentType;
+	int			m_Width;
+	int			m_Height;
 	std::string	m_Origin;
 };
 
@@ -22,19 +22,34 @@
 #include "blackboard/Entity.h"
 #include "services/IFaceRecognition.h"
 
+#include "boost/filesystem.hpp"
+
 const int CLASSIFY_RETRY_ATTEMPTS = 0;
 
 REG_SERIALIZABLE(FaceClassifier);
 RTTI_IMPL( FaceClassifier, IClassifier );
 
-FaceClassifier::FaceClassifier() : m_MinFaceConfidence( 0.7f )
-{}
+FaceClassifier::FaceClassifier() : 
+	m_MinFaceConfidence( 0.7f ),
+	m_bLocalRecognition( true ),
+	m_LocalFacesFile( "cache/faces.dat" ),
+	m_fLocalMinConfidence( 0.85f ),
+	m_fSaveDelay( 10.0f )
+{
+	// an image may have several faces, let them all be classified together
+	m_MaxQueueDepth = 4;
+	m_MaxActivePerOrigin = 4;
+}
 
 void FaceClassifier::Serialize(Json::Value & json)
 {
 	IClassifier::Serialize( json );
 
 	json["m_MinFaceConfidence"] = m_MinFaceConfidence;
+	json["m_bLocalRecognition"] = m_bLocalRecognition;
+	json["m_LocalFacesFile"] = m_LocalFacesFile;
+	json["m_fLocalMinConfidence"] = m_fLocalMinConfidence;
+	json["m_fSaveDelay"] = m_fSaveDelay;
 }
 
 void FaceClassifier::Deserialize(const Json::Value & json)
@@ -43,6 +58,14 @@ void FaceClassifier::Deserialize(const Json::Value & json)
 
 	if ( json["m_MinFaceConfidence"].isDouble() )
 		m_MinFaceConfidence = json["m_MinFaceConfidence"].asFloat();
+	if ( json["m_bLocalRecognition"].isBool() )
+		m_bLocalRecognition = json["m_bLocalRecognition"].asBool();
+	if ( json["m_LocalFacesFile"].isString() )
+		m_LocalFacesFile = json["m_LocalFacesFile"].asString();
+	if ( json["m_fLocalMinConfidence"].isNumeric() )
+		m_fLocalMinConfidence = json["m_fLocalMinConfidence"].asFloat();
+	if ( json["m_fSaveDelay"].isNumeric() )
+		m_fSaveDelay = json["m_fSaveDelay"].asFloat();
 }
 
 const char * FaceClassifier::GetName() const
@@ -56,6 +79,13 @@ bool FaceClassifier::OnStart()
 	pBlackboard->SubscribeToType( "Person",
 		DELEGATE( FaceClassifier, OnPerson, const ThingEvent &, this ), TE_ADDED );
 
+	if ( m_bLocalRecognition )
+	{
+		m_LocalFaces.Clear();
+		if ( m_LocalFaces.Load( GetLocalFacesPath() ) )
+			Log::Status( "FaceClassifier", "Loaded %u known faces.", (unsigned int)m_LocalFaces.GetCount() );
+	}
+
 	Log::Status("FaceClassifier", "FaceClassifier started");
 	return true;
 }
@@ -64,7 +94,11 @@ bool FaceClassifier::OnStop()
 {
 	BlackBoard * pBlackboard = SelfInstance::GetInstance()->GetBlackBoard();
 	pBlackboard->UnsubscribeFromType( "Person", this );
-	m_ProcessingMap.clear();
+	ClearWork();
+
+	// don't lose faces learned since the last save
+	if ( m_spSaveTimer )
+		SaveLocalFaces();
 
 	Log::Status("FaceClassifier", "Person Classifier stopped");
 	return true;
@@ -100,9 +134,10 @@ bool FaceClassifier::LearnPerson( const Person::SP & a_spPerson, const std::stri
 		return false;
 	}
 
+	std::string personId( UniqueID( true ).Get() );
 	if (! pService->AddFace( xml, 
 		a_spPerson->GetFaceImage(), 
-		UniqueID( true ).Get(), 
+		personId, 
 		a_Name,
 		a_spPerson->GetGender(),
 		"",							// DOB
@@ -112,9 +147,50 @@ bool FaceClassifier::LearnPerson( const Person::SP & a_spPerson, const std::stri
 		return false;
 	}
 
+	std::vector<float> features;
+	if ( m_bLocalRecognition && FaceEmbeddingStore::ParseF256( xml, features )
+		&& m_LocalFaces.Add( personId, a_Name, a_spPerson->GetGender(), features ) )
+	{
+		QueueSaveLocalFaces();
+	}
+
 	return true;
 }
 
+std::string FaceClassifier::GetLocalFacesPath() const
+{
+	return Config::Instance()->GetInstanceDataPath() + m_LocalFacesFile;
+}
+
+void FaceClassifier::QueueSaveLocalFaces()
+{
+	if (! m_spSaveTimer )
+	{
+		m_spSaveTimer = TimerPool::Instance()->StartTimer(
+			VOID_DELEGATE( FaceClassifier, SaveLocalFaces, this ), m_fSaveDelay, true, false );
+	}
+}
+
+void FaceClassifier::SaveLocalFaces()
+{
+	m_spSaveTimer.reset();
+
+	std::string path( GetLocalFacesPath() );
+	try {
+		boost::filesystem::path parent( boost::filesystem::path( path ).parent_path() );
+		if (! parent.empty() )
+			boost::filesystem::create_directories( parent );
+	}
+	catch( const std::exception & ex )
+	{
+		Log::Error( "FaceClassifier", "Failed to create path for %s: %s", path.c_str(), ex.what() );
+		return;
+	}
+
+	if (! m_LocalFaces.Save( path ) )
+		Log::Error( "FaceClassifier", "Failed to save known faces to %s", path.c_str() );
+}
+
 void FaceClassifier::OnPerson(const ThingEvent & a_ThingEvent)
 {
 	Person::SP spPerson = DynamicCast<Person>(a_ThingEvent.GetIThing());
@@ -122,15 +198,7 @@ void FaceClassifier::OnPerson(const ThingEvent & a_ThingEvent)
 	{
 		Image::SP spImage = spPerson->FindParentType<Image>( true );
 		if ( spImage )
-		{
-			if ( m_ProcessingMap.find( spImage->GetOrigin() ) == m_ProcessingMap.end() )
-			{
-				SP spThis( boost::static_pointer_cast<FaceClassifier>( shared_from_this() ) );
-				m_ProcessingMap[ spImage->GetOrigin() ] = SensorGroup::SP( new SensorGroup( spThis ) );
-			}
-
-			m_ProcessingMap[ spImage->GetOrigin() ]->ProcessPerson( spImage, spPerson );
-		}
+			QueueWork( spImage->GetOrigin(), spPerson );
 		else
 		{
 			Log::Error( "FaceClassifier", "Failed to find image parent for person." );
@@ -143,24 +211,24 @@ void FaceClassifier::OnLearnPerson( const Json::Value & a_Response )
 	Log::Status( "FaceClassifier", "OnLearnPerson: %s", a_Response.toStyledString().c_str() );
 }
 
-//--------------------------------------
-
-bool FaceClassifier::SensorGroup::ProcessPerson( const Image::SP & a_spImage, const Person::SP & a_spPerson )
+bool FaceClassifier::OnWork( const std::string & a_Origin, const IThing::SP & a_spThing )
 {
-	if ( a_spImage != m_spImage && m_nActive > 0 )
-		return false;		// still processing persons from a previous image
-
-	m_spImage = a_spImage;
-	new ClassifyFace( shared_from_this(), a_spPerson );
+	Person::SP spPerson = DynamicCast<Person>( a_spThing );
+	if (! spPerson )
+		return false;
 
+	// the ClassifyFace object will delete itself when it's done, which calls WorkDone()
+	SP spThis( boost::static_pointer_cast<FaceClassifier>( shared_from_this() ) );
+	new ClassifyFace( spThis, a_Origin, spPerson );
 	return true;
 }
 
-FaceClassifier::ClassifyFace::ClassifyFace( const SensorGroup::SP & a_pGroup, const Person::SP & a_spPerson ) : 
-	m_pGroup( a_pGroup ), m_spPerson( a_spPerson ), m_spThis( this )
-{
-	m_pGroup->m_nActive += 1;
+//--------------------------------------
 
+FaceClassifier::ClassifyFace::ClassifyFace( const FaceClassifier::SP & a_pClassifier, const std::string & a_Origin, const Person::SP & a_spPerson ) : 
+	m_pClassifier( a_pClassifier ), m_Origin( a_Origin ), m_WorkGeneration( a_pClassifier->GetWorkGeneration() ), 
+	m_spPerson( a_spPerson ), m_spThis( this )
+{
 	IFaceRecognition * pService = Config::Instance()->FindService<IFaceRecognition>();
 	if ( pService != NULL && pService->IsConfigured() )
 	{
@@ -175,7 +243,7 @@ FaceClassifier::ClassifyFace::ClassifyFace( const SensorGroup::SP & a_pGroup, co
 
 FaceClassifier::ClassifyFace::~ClassifyFace()
 {
-	m_pGroup->m_nActive -= 1;
+	m_pClassifier->WorkDone( m_Origin, m_WorkGeneration );
 }
 
 void FaceClassifier::ClassifyFace::OnFaceClassified( const TiXmlDocument & a_F256 )
@@ -196,10 +264,32 @@ void FaceClassifier::ClassifyFace::OnFaceClassified( const TiXmlDocument & a_F25
 		// with these features..
 		m_spPerson->AddChild( IThing::SP( new IThing( TT_PERCEPTION, "Features", features ) ) );
 
+		// look through the faces we already know first, the service is only asked when we are not sure
+		FaceEmbeddingStore & store = m_pClassifier->m_LocalFaces;
+		FaceEmbeddingStore::MatchList matches;
+		if ( m_pClassifier->m_bLocalRecognition && FaceEmbeddingStore::ParseF256( a_F256, m_Features )
+			&& store.Search( m_Features, 1, matches ) 
+			&& matches[0].m_fConfidence >= m_pClassifier->m_fLocalMinConfidence )
+		{
+			const FaceEmbeddingStore::Face & face = store.GetFace( matches[0].m_Index );
+
+			Json::Value item;
+			item["personId"] = face.m_PersonId;
+			item["fullName"] = face.m_Name;
+			item["gender"] = face.m_Gender;
+			item["confidence"] = matches[0].m_fConfidence;
+			item["source"] = "local";
+
+			Json::Value found;
+			found["items"].append( item );
+			OnFaceFound( found );
+			return;
+		}
+
 		if ( pService != NULL && pService->IsConfigured() )
 		{
 			// for now search for the face in the remote DB..
-			if (pService->SearchForFace(a_F256, m_pGroup->m_pClassifier->m_MinFaceConfidence, 1,
+			if (pService->SearchForFace(a_F256, m_pClassifier->m_MinFaceConfidence, 1,
 				DELEGATE(ClassifyFace, OnFaceFound, const Json::Value &, this)))
 			{
 				bError = false;
@@ -225,6 +315,18 @@ void FaceClassifier::ClassifyFace::OnFaceFound( const Json::Value & a_Face )
 		{	// TODO capping RecognizedFace to 1 item for now
 			Json::Value item = items[i];
 			item["m_Origin"] = m_spPerson->GetOrigin();
+
+			// remember faces the service found that we don't know yet, so we can recognize them ourselves next time
+			if ( m_pClassifier->m_bLocalRecognition && m_Features.size() > 0 && !item.isMember( "source" )
+				&& item["personId"].isString() && !m_pClassifier->m_LocalFaces.Contains( item["personId"].asString() ) )
+			{
+				if ( m_pClassifier->m_LocalFaces.Add( item["personId"].asString(), item["fullName"].asString(),
+					item["gender"].isString() ? item["gender"].asString() : std::string(), m_Features ) )
+				{
+					m_pClassifier->QueueSaveLocalFaces();
+				}
+			}
+
 			m_spPerson->AddChild(IThing::SP(new IThing(TT_PERCEPTION, "RecognizedFace", item)));
 		}
 	}
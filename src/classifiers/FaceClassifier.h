@@ -23,6 +23,8 @@
 #include "blackboard/ThingEvent.h"
 #include "blackboard/Person.h"
 #include "blackboard/Image.h"
+#include "utils/FaceEmbeddingStore.h"
+#include "utils/TimerPool.h"
 #include "SelfLib.h"
 
 class SelfInstance;
@@ -56,26 +58,11 @@ public:
 
 private:
 	//! Types
-	struct SensorGroup : public boost::enable_shared_from_this<SensorGroup>
-	{
-		typedef boost::shared_ptr<SensorGroup>		SP;
-
-		SensorGroup( const FaceClassifier::SP & a_pClassifier ) : m_pClassifier( a_pClassifier ), m_nActive( 0 )
-		{}
-
-		bool ProcessPerson( const Image::SP & a_spImage, const Person::SP & a_spPerson );
-
-		FaceClassifier::SP	m_pClassifier;
-		Image::SP			m_spImage;
-		int					m_nActive;
-	};
-	typedef std::map<std::string,SensorGroup::SP>	ProcessingMap;
-
 	struct ClassifyFace : public boost::enable_shared_from_this<ClassifyFace>
 	{
 		typedef boost::shared_ptr<ClassifyFace>		SP;
 
-		ClassifyFace( const SensorGroup::SP & a_pGroup, const Person::SP & a_spPerson );
+		ClassifyFace( const FaceClassifier::SP & a_pClassifier, const std::string & a_Origin, const Person::SP & a_spPerson );
 		~ClassifyFace();
 
 		void OnFaceClassified( const TiXmlDocument & a_F256 );
@@ -83,13 +70,30 @@ private:
 
 		//! Data
 		SP					m_spThis;
-		SensorGroup::SP		m_pGroup;
+		FaceClassifier::SP	m_pClassifier;
+		std::string			m_Origin;
+		unsigned int		m_WorkGeneration;
 		Person::SP			m_spPerson;
+		std::vector<float>	m_Features;
 	};
 
 	//! Data
-	ProcessingMap	m_ProcessingMap;
 	float			m_MinFaceConfidence;
+	bool			m_bLocalRecognition;		// search our known faces before asking the service
+	std::string		m_LocalFacesFile;			// relative to the instance data path
+	float			m_fLocalMinConfidence;		// below this the service is asked instead
+	float			m_fSaveDelay;				// changes to the known faces are saved together after this long
+	FaceEmbeddingStore
+					m_LocalFaces;
+	TimerPool::ITimer::SP
+					m_spSaveTimer;
+
+	std::string		GetLocalFacesPath() const;
+	void			QueueSaveLocalFaces();
+	void			SaveLocalFaces();
+
+	//! IClassifier interface
+	virtual bool OnWork( const std::string & a_Origin, const IThing::SP & a_spThing );
 
 	//! Callbacks
 	void OnPerson(const ThingEvent & a_ThingEvent);
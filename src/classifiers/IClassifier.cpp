@@ -24,12 +24,35 @@ RTTI_IMPL(IClassifier, ISerializable);
 void IClassifier::Serialize(Json::Value & json)
 {
 	json["m_bEnabled"] = m_bEnabled;
+	json["m_MaxQueueDepth"] = m_MaxQueueDepth;
+	json["m_MaxActive"] = m_MaxActive;
+	json["m_MaxActivePerOrigin"] = m_MaxActivePerOrigin;
+	json["m_DropPolicy"] = DropPolicyText( m_eDropPolicy );
+	json["m_SampleRate"] = m_SampleRate;
 }
 
 void IClassifier::Deserialize(const Json::Value & json)
 {
 	if ( json["m_bEnabled"].isBool() )
 		m_bEnabled = json["m_bEnabled"].asBool();
+	if ( json["m_MaxQueueDepth"].isNumeric() )
+		m_MaxQueueDepth = json["m_MaxQueueDepth"].asInt();
+	if ( json["m_MaxActive"].isNumeric() )
+		m_MaxActive = json["m_MaxActive"].asInt();
+	if ( json["m_MaxActivePerOrigin"].isNumeric() )
+		m_MaxActivePerOrigin = json["m_MaxActivePerOrigin"].asInt();
+	if ( json["m_DropPolicy"].isString() )
+	{
+		const std::string & policy = json["m_DropPolicy"].asString();
+		if ( policy == DropPolicyText( DP_NEWEST ) )
+			m_eDropPolicy = DP_NEWEST;
+		else if ( policy == DropPolicyText( DP_SAMPLED ) )
+			m_eDropPolicy = DP_SAMPLED;
+		else
+			m_eDropPolicy = DP_OLDEST;
+	}
+	if ( json["m_SampleRate"].isNumeric() )
+		m_SampleRate = json["m_SampleRate"].asInt();
 }
 
 void IClassifier::AddOverride()
@@ -72,4 +95,151 @@ void IClassifier::SetClassifierManager(ClassifierManager * a_pManager, bool a_bO
 			m_Overriden.clear();
 		}
 	}
-}
\ No newline at end of file
+}
+
+bool IClassifier::QueueWork( const std::string & a_Origin, const IThing::SP & a_spThing )
+{
+	WorkQueue & queue = m_WorkQueues[ a_Origin ];
+	WorkMetrics & metrics = queue.m_Metrics;
+
+	bool bQueued = true;
+	int maxDepth = m_MaxQueueDepth > 0 ? m_MaxQueueDepth : 1;
+	if ( (int)queue.m_Queue.size() >= maxDepth )
+	{
+		queue.m_Arrivals += 1;
+
+		bool bReplace = m_eDropPolicy == DP_OLDEST
+			|| (m_eDropPolicy == DP_SAMPLED && (queue.m_Arrivals % (m_SampleRate > 0 ? m_SampleRate : 1)) == 0);
+		if ( bReplace )
+			queue.m_Queue.pop_front();
+		else
+			bQueued = false;
+		metrics.m_Dropped += 1;
+	}
+
+	if ( bQueued )
+	{
+		queue.m_Queue.push_back( a_spThing );
+		metrics.m_Queued += 1;
+	}
+
+	metrics.m_Depth = (int)queue.m_Queue.size();
+	if ( metrics.m_Depth > metrics.m_PeakDepth )
+		metrics.m_PeakDepth = metrics.m_Depth;
+
+	PumpWork();
+	return bQueued;
+}
+
+void IClassifier::WorkDone( const std::string & a_Origin, unsigned int a_Generation )
+{
+	// work started before ClearWork() is ignored, it must not be counted against any newer work
+	if ( a_Generation != m_WorkGeneration )
+		return;
+	WorkQueueMap::iterator iQueue = m_WorkQueues.find( a_Origin );
+	if ( iQueue == m_WorkQueues.end() || iQueue->second.m_Metrics.m_Active <= 0 )
+		return;
+
+	iQueue->second.m_Metrics.m_Active -= 1;
+	iQueue->second.m_Metrics.m_Completed += 1;
+	m_TotalActive -= 1;
+
+	PumpWork();
+}
+
+void IClassifier::ClearWork()
+{
+	m_WorkQueues.clear();
+	m_TotalActive = 0;
+	m_WorkGeneration += 1;
+	m_LastOrigin.clear();
+}
+
+IClassifier::WorkMetricsMap IClassifier::GetWorkMetrics() const
+{
+	WorkMetricsMap metrics;
+	for( WorkQueueMap::const_iterator iQueue = m_WorkQueues.begin(); iQueue != m_WorkQueues.end(); ++iQueue )
+		metrics[ iQueue->first ] = iQueue->second.m_Metrics;
+	return metrics;
+}
+
+void IClassifier::GetWorkMetrics( Json::Value & a_Metrics ) const
+{
+	for( WorkQueueMap::const_iterator iQueue = m_WorkQueues.begin(); iQueue != m_WorkQueues.end(); ++iQueue )
+	{
+		const WorkMetrics & metrics = iQueue->second.m_Metrics;
+
+		Json::Value & origin = a_Metrics["origins"][ iQueue->first ];
+		origin["depth"] = metrics.m_Depth;
+		origin["peak_depth"] = metrics.m_PeakDepth;
+		origin["active"] = metrics.m_Active;
+		origin["queued"] = metrics.m_Queued;
+		origin["dropped"] = metrics.m_Dropped;
+		origin["started"] = metrics.m_Started;
+		origin["rejected"] = metrics.m_Rejected;
+		origin["completed"] = metrics.m_Completed;
+	}
+	a_Metrics["active"] = m_TotalActive;
+}
+
+void IClassifier::PumpWork()
+{
+	// OnWork() may finish synchronously and call WorkDone(), the outer loop will pick up any new work
+	if ( m_bPumping )
+		return;
+	m_bPumping = true;
+
+	bool bStarted = true;
+	while( bStarted && (m_MaxActive <= 0 || m_TotalActive < m_MaxActive) )
+	{
+		// start one item from each origin that can take more work, so one busy origin doesn't starve the others. Each
+		// pass starts after the last origin that was given work, otherwise the first origin would take every free slot.
+		bStarted = false;
+		WorkQueueMap::iterator iQueue = m_WorkQueues.upper_bound( m_LastOrigin );
+		for( size_t i = 0; i < m_WorkQueues.size(); ++i, ++iQueue )
+		{
+			if ( m_MaxActive > 0 && m_TotalActive >= m_MaxActive )
+				break;
+			if ( iQueue == m_WorkQueues.end() )
+				iQueue = m_WorkQueues.begin();
+
+			WorkQueue & queue = iQueue->second;
+			WorkMetrics & metrics = queue.m_Metrics;
+			if ( queue.m_Queue.size() == 0 || metrics.m_Active >= (m_MaxActivePerOrigin > 0 ? m_MaxActivePerOrigin : 1) )
+				continue;
+
+			IThing::SP spThing = queue.m_Queue.front();
+			queue.m_Queue.pop_front();
+			metrics.m_Depth = (int)queue.m_Queue.size();
+
+			metrics.m_Active += 1;
+			metrics.m_Started += 1;
+			m_TotalActive += 1;
+			m_LastOrigin = iQueue->first;
+			bStarted = true;
+
+			if (! OnWork( iQueue->first, spThing ) )
+			{
+				metrics.m_Active -= 1;
+				metrics.m_Started -= 1;
+				metrics.m_Rejected += 1;
+				m_TotalActive -= 1;
+			}
+		}
+	}
+
+	m_bPumping = false;
+}
+
+const char * IClassifier::DropPolicyText( DropPolicy a_eDropPolicy )
+{
+	switch( a_eDropPolicy )
+	{
+	case DP_NEWEST:
+		return "newest";
+	case DP_SAMPLED:
+		return "sampled";
+	default:
+		return "oldest";
+	}
+}
@@ -19,9 +19,13 @@
 #ifndef ICLASSIFIER_H
 #define ICLASSIFIER_H
 
+#include <list>
+#include <map>
+
 #include "boost/enable_shared_from_this.hpp"
 #include "boost/shared_ptr.hpp"
 
+#include "blackboard/IThing.h"
 #include "utils/ISerializable.h"
 #include "utils/UniqueID.h"
 #include "SelfLib.h"				// include last
@@ -31,6 +35,12 @@ class BlackBoard;
 
 //! This class manages all active classifier instances. This classifiers subscribe to sensors 
 //! and add concepts to the BlackBoard object contained by the SelfInstance.
+//!
+//! Classifiers that send their work to a remote service should pass it through QueueWork(), which keeps
+//! a bounded queue for each origin and limits how many requests are active at once. When a queue is full
+//! the drop policy decides which item is lost, so a slow service can't build up a backlog. OnWork() is
+//! invoked when an item may start and WorkDone() must be called when it's finished. Origins take turns
+//! starting work, so a busy origin can't starve the others. All of these must be invoked on the main thread.
 class SELF_API IClassifier : public ISerializable,
 	public boost::enable_shared_from_this<IClassifier>
 {
@@ -47,12 +57,39 @@ public:
 		AS_SUSPENDED
 	};
 
+	//! What to drop when a work queue is full
+	enum DropPolicy {
+		DP_OLDEST,			// drop the oldest queued item to make room for the new one
+		DP_NEWEST,			// drop the new item
+		DP_SAMPLED			// keep 1 in m_SampleRate of the new items, replacing the oldest queued item
+	};
+
+	//! Work queue counters for one origin
+	struct WorkMetrics
+	{
+		WorkMetrics() : m_Depth( 0 ), m_PeakDepth( 0 ), m_Active( 0 ), m_Queued( 0 ),
+			m_Dropped( 0 ), m_Started( 0 ), m_Rejected( 0 ), m_Completed( 0 )
+		{}
+
+		int				m_Depth;			// items waiting right now
+		int				m_PeakDepth;
+		int				m_Active;			// items started but not done
+		unsigned int	m_Queued;
+		unsigned int	m_Dropped;
+		unsigned int	m_Started;
+		unsigned int	m_Rejected;			// items OnWork() refused to start
+		unsigned int	m_Completed;
+	};
+	typedef std::map< std::string, WorkMetrics >	WorkMetricsMap;
+
 	//! ISerializable interface
 	virtual void Serialize(Json::Value & json);
 	virtual void Deserialize(const Json::Value & json);
 
 	//! Construction
-	IClassifier() : m_bEnabled( true ), m_eState(AS_STOPPED), m_pManager(NULL), m_Overrides(0)
+	IClassifier() : m_bEnabled( true ), m_eState(AS_STOPPED), m_pManager(NULL), m_Overrides(0),
+		m_MaxQueueDepth( 1 ), m_MaxActive( 4 ), m_MaxActivePerOrigin( 1 ), m_eDropPolicy( DP_OLDEST ),
+		m_SampleRate( 4 ), m_TotalActive( 0 ), m_WorkGeneration( 0 ), m_bPumping( false )
 	{
 		NewGUID();
 	}
@@ -99,13 +136,62 @@ public:
 	void AddOverride();
 	void RemoveOverride();
 
+	//! Work queue
+	//! Queue a thing from the given origin for classification, returns false if it was dropped.
+	bool QueueWork( const std::string & a_Origin, const IThing::SP & a_spThing );
+	//! Invoke when the work started by OnWork() has finished, a_Generation is the value of GetWorkGeneration()
+	//! when the work was started. Work started before the last ClearWork() is ignored.
+	void WorkDone( const std::string & a_Origin, unsigned int a_Generation );
+	//! Drop all queued work and reset the counters.
+	void ClearWork();
+	//! Returns the current generation of work, this changes each time ClearWork() is invoked.
+	unsigned int GetWorkGeneration() const
+	{
+		return m_WorkGeneration;
+	}
+	//! Returns the counters for each origin.
+	WorkMetricsMap GetWorkMetrics() const;
+	void GetWorkMetrics( Json::Value & a_Metrics ) const;
+
 protected:
+	//! Types
+	struct WorkQueue
+	{
+		WorkQueue() : m_Arrivals( 0 )
+		{}
+
+		std::list< IThing::SP >	m_Queue;
+		unsigned int			m_Arrivals;			// arrivals while full, used for sampling
+		WorkMetrics				m_Metrics;
+	};
+	typedef std::map< std::string, WorkQueue >	WorkQueueMap;
+
+	//! Invoked to start classifying a queued thing, returns false if the work could not be started.
+	virtual bool OnWork( const std::string & a_Origin, const IThing::SP & a_spThing )
+	{
+		return false;
+	}
+
 	//! Data
 	bool				m_bEnabled;
 	State				m_eState;
 	ClassifierManager * m_pManager;
 	int					m_Overrides;
 	std::vector< SP >	m_Overriden;
+
+	int					m_MaxQueueDepth;		// items that may wait for each origin
+	int					m_MaxActive;			// active items for all origins, 0 for no limit
+	int					m_MaxActivePerOrigin;	// active items for each origin
+	DropPolicy			m_eDropPolicy;
+	int					m_SampleRate;
+	WorkQueueMap		m_WorkQueues;
+	int					m_TotalActive;
+	unsigned int		m_WorkGeneration;
+	std::string			m_LastOrigin;			// the last origin to start work, the next turn starts after it
+	bool				m_bPumping;
+
+	void				PumpWork();
+	static const char *	DropPolicyText( DropPolicy a_eDropPolicy );
 };
 
 #endif
@@ -18,6 +18,8 @@
 
 #define _CRT_SECURE_NO_WARNINGS
 
+#include <algorithm>
+
 #include "ImageClassifier.h"
 #include "SelfInstance.h"
 
@@ -25,9 +27,9 @@
 #include "blackboard/Entity.h"
 #include "blackboard/Health.h"
 #include "services/IVisualRecognition.h"
-#include "utils/ZipFile.h"
+#include "utils/ImageHash.h"
+#include "utils/ThreadPool.h"
 
-const std::string IMAGES_EXT(".zip");
 const std::string IMAGES_PATH("cache/image_classifier/");
 const float CHECK_RETRAINING_INVERVAL = 5.0f;			// how often to check the classifier when training
 
@@ -49,6 +51,10 @@ void ImageClassifier::Serialize(Json::Value & json)
 	json["m_ClassifierDate"] = m_ClassifierDate;
 	json["m_fRestartTime"] = m_fRestartTime;
 	json["m_bUseDefaultClassifier"] = m_bUseDefaultClassifier;
+	json["m_bReuseSimilarFrames"] = m_bReuseSimilarFrames;
+	json["m_MaxHashDistance"] = m_MaxHashDistance;
+	json["m_RecentFrameCount"] = m_RecentFrameCount;
+	json["m_fMaxReuseTime"] = m_fMaxReuseTime;
 
 	SerializeList("m_PendingExamples", m_PendingExamples, json);
 }
@@ -75,6 +81,14 @@ void ImageClassifier::Deserialize(const Json::Value & json)
 		m_fRestartTime = json["m_fRestartTime"].asFloat();
 	if (json.isMember("m_bUseDefaultClassifier"))
 		m_bUseDefaultClassifier = json["m_bUseDefaultClassifier"].asBool();
+	if (json.isMember("m_bReuseSimilarFrames"))
+		m_bReuseSimilarFrames = json["m_bReuseSimilarFrames"].asBool();
+	if (json.isMember("m_MaxHashDistance"))
+		m_MaxHashDistance = json["m_MaxHashDistance"].asInt();
+	if (json.isMember("m_RecentFrameCount"))
+		m_RecentFrameCount = json["m_RecentFrameCount"].asInt();
+	if (json.isMember("m_fMaxReuseTime"))
+		m_fMaxReuseTime = json["m_fMaxReuseTime"].asFloat();
 	if (m_ClassifierName == "default")
 		m_ClassifierName = "self";
 
@@ -95,9 +109,9 @@ bool ImageClassifier::OnStart()
 
 	// validate the images path..
 	const std::string & instanceData = Config::Instance()->GetInstanceDataPath();
-	if (!m_ImagesCache.Initialize(instanceData + IMAGES_PATH, m_MaxCacheSize, 0, IMAGES_EXT))
+	if (!m_Examples.Initialize(instanceData + IMAGES_PATH, m_MaxCacheSize))
 	{
-		Log::Error("ImageClassifier", "Failed to initialize image cache.");
+		Log::Error("ImageClassifier", "Failed to initialize training examples.");
 		return false;
 	}
 
@@ -116,7 +130,11 @@ bool ImageClassifier::OnStart()
 	pBlackboard->SubscribeToType("Health",
 		DELEGATE(ImageClassifier, OnHealth, const ThingEvent &, this), TE_ADDED);
 
-	m_ProcessingMap.clear();
+	m_RecentFrames.SetMaxFrames(m_RecentFrameCount);
+	m_RecentFrames.SetMaxDistance(m_MaxHashDistance);
+	m_RecentFrames.SetMaxAge(m_fMaxReuseTime);
+
+	ClearWork();
 	Log::Status("ImageClassifier", "ImageClassifier started");
 	return true;
 }
@@ -128,11 +146,12 @@ bool ImageClassifier::OnStop()
 	BlackBoard * pBlackboard = pInstance->GetBlackBoard();
 	assert(pBlackboard != NULL);
 
-	m_ImagesCache.Uninitialize();
+	m_Examples.Uninitialize();
 	pBlackboard->UnsubscribeFromType("Image", this);
 	pBlackboard->UnsubscribeFromType("Health", this);
 
-	m_ProcessingMap.clear();
+	ClearWork();
+	m_RecentFrames.Clear();
 
 	Log::Status("ImageClassifier", "Image Classifier stopped");
 	return true;
@@ -142,22 +161,32 @@ void ImageClassifier::OnImage(const ThingEvent & a_ThingEvent)
 {
 	Image::SP spImage = DynamicCast<Image>(a_ThingEvent.GetIThing());
 	if (spImage)
-	{
-		if (m_ProcessingMap.find(spImage->GetOrigin()) == m_ProcessingMap.end())
-		{
-			SP spThis(boost::static_pointer_cast<ImageClassifier>(shared_from_this()));
-			m_ProcessingMap[spImage->GetOrigin()] = ClassifyImage::SP(new ClassifyImage(spThis));
-		}
+		QueueWork(spImage->GetOrigin(), spImage);
+}
+
+bool ImageClassifier::OnWork(const std::string & a_Origin, const IThing::SP & a_spThing)
+{
+	Image::SP spImage = DynamicCast<Image>(a_spThing);
+	if (! spImage)
+		return false;
+
+	SP spThis(boost::static_pointer_cast<ImageClassifier>(shared_from_this()));
+	ClassifyImage::SP spClassify(new ClassifyImage(spThis, a_Origin));
 
-		m_ProcessingMap[spImage->GetOrigin()]->ProcessImage(spImage);
+	// a camera looking at the same scene sends nearly the same frame, the frame is hashed on a
+	// thread so the last result for it can be reused
+	if (m_bReuseSimilarFrames)
+	{
+		spClassify->m_spImage = spImage;
+		ThreadPool::Instance()->InvokeOnThread(VOID_DELEGATE(ClassifyImage, OnHashImage, spClassify));
+		return true;
 	}
+
+	return spClassify->ProcessImage(spImage);
 }
 
 bool ImageClassifier::ClassifyImage::ProcessImage(const Image::SP & a_spImage)
 {
-	if (m_spImage)
-		return false;	// still processing an image
-
 	IVisualRecognition * pVR = Config::Instance()->FindService<IVisualRecognition>(m_pClassifier->m_ServiceId);
 	if (pVR != NULL && pVR->IsConfigured())
 	{
@@ -172,14 +201,42 @@ bool ImageClassifier::ClassifyImage::ProcessImage(const Image::SP & a_spImage)
 			m_spImage = a_spImage;
 			pVR->ClassifyImage(m_spImage->GetContent(), classifiers,
 				DELEGATE(ClassifyImage, OnImageClassified, const Json::Value &, shared_from_this()));
+			return true;
 		}
-
-		return true;
 	}
 
 	return false;
 }
 
+void ImageClassifier::ClassifyImage::OnHashImage()
+{
+	m_bHashed = ImageHash::HashJpeg(m_spImage->GetContent(), m_Hash);
+	ThreadPool::Instance()->InvokeOnMain(VOID_DELEGATE(ClassifyImage, OnImageHashed, shared_from_this()));
+}
+
+void ImageClassifier::ClassifyImage::OnImageHashed()
+{
+	if (m_bHashed)
+	{
+		const Json::Value * pRecent = m_pClassifier->m_RecentFrames.Find(m_Origin, m_Hash, 
+			m_pClassifier->m_ClassifierId, Time().GetEpochTime());
+		if (pRecent != NULL)
+		{
+			Log::DebugLow("ImageClassifier", "Reusing classification of a similar frame from %s", m_Origin.c_str());
+			// not kept again, so the scene is classified again once the result is too old
+			m_bHashed = false;
+			OnImageClassified(Json::Value(*pRecent));
+			return;
+		}
+	}
+
+	if (!ProcessImage(m_spImage))
+	{
+		m_spImage.reset();
+		m_pClassifier->WorkDone(m_Origin, m_WorkGeneration);
+	}
+}
+
 void ImageClassifier::ClassifyImage::OnImageClassified(const Json::Value & json)
 {
 	//Log::Status("ImageClassifier", "OnImageClassified: %s", json.toStyledString().c_str() );
@@ -227,7 +284,11 @@ void ImageClassifier::ClassifyImage::OnImageClassified(const Json::Value & json)
 			json.toStyledString().c_str());
 	}
 
+	if (m_bHashed && !json.isNull() && json.isMember("images"))
+		m_pClassifier->m_RecentFrames.Add(m_Origin, m_Hash, m_pClassifier->m_ClassifierId, Time().GetEpochTime(), json);
+
 	m_spImage.reset();
+	m_pClassifier->WorkDone(m_Origin, m_WorkGeneration);
 }
 
 void ImageClassifier::OnGetClassifiers(const Json::Value & a_Response)
@@ -352,42 +413,27 @@ void ImageClassifier::OnDeleteClassifier(IService::Request * a_Response)
 
 void ImageClassifier::SubmitPositiveImages(const std::list< Image::SP> & a_Images, const std::string & a_Class)
 {
-	if (a_Images.size() < 10)
-		Log::Warning("ImageClassifier", "Submitting less than 10 images will not update trainer.");
-
-	ZipFile::ZipMap zipData;
-	for (std::list< Image::SP>::const_iterator i = a_Images.begin(); i != a_Images.end(); ++i)
-		zipData[StringUtil::Format("%p.jpg", (*i).get())] = (*i)->GetContent();
-
-	std::string zip;
-	if (ZipFile::Deflate(zipData, zip))
-	{
-		std::string id(a_Class + "_positive_examples");
-		m_ImagesCache.Save(id, zip, false);
-
-		UpdateClassifier(id);
-	}
-	else
-		Log::Error("ImageClassifer", "Failed to archive images.");
+	SubmitImages(a_Images, a_Class, ExampleCache::POSITIVE);
 }
 
 void ImageClassifier::SubmitNegativeImages(const std::list< Image::SP > & a_Images, const std::string & a_Class)
+{
+	SubmitImages(a_Images, a_Class, ExampleCache::NEGATIVE);
+}
+
+void ImageClassifier::SubmitImages(const std::list<Image::SP> & a_Images, const std::string & a_Class, ExampleCache::Polarity a_ePolarity)
 {
 	if (a_Images.size() < 10)
 		Log::Warning("ImageClassifier", "Submitting less than 10 images will not update trainer.");
 
-	ZipFile::ZipMap zipData;
+	// only the new images are written, they are appended to the examples we already have for this class
+	ExampleCache::ImageList images;
 	for (std::list< Image::SP>::const_iterator i = a_Images.begin(); i != a_Images.end(); ++i)
-		zipData[StringUtil::Format("%p.jpg", (*i).get())] = (*i)->GetContent();
+		images.push_back((*i)->GetContent());
 
-	std::string zip;
-	if (ZipFile::Deflate(zipData, zip))
-	{
-		std::string id(a_Class + "_negative_examples");
-		m_ImagesCache.Save(id, zip, false);
-
-		UpdateClassifier(id);
-	}
+	const ExampleCache::Archive * pArchive = m_Examples.Add(a_Class, a_ePolarity, images);
+	if (pArchive != NULL)
+		UpdateClassifier(pArchive->m_Id);
 	else
 		Log::Error("ImageClassifer", "Failed to archive images.");
 }
@@ -419,7 +465,9 @@ void ImageClassifier::UpdateClassifier(const std::string & a_ExampleId)
 {
 	if (m_ClassifierId.size() > 0)
 	{
-		m_PendingExamples.push_back(a_ExampleId);
+		// the new examples for a class are kept together until they are sent, so the id is only needed once
+		if (std::find(m_PendingExamples.begin(), m_PendingExamples.end(), a_ExampleId) == m_PendingExamples.end())
+			m_PendingExamples.push_back(a_ExampleId);
 		UpdateClassifier();
 	}
 	else
@@ -434,28 +482,28 @@ void ImageClassifier::InitializeClassifier()
 	IVisualRecognition * pVR = Config::Instance()->FindService<IVisualRecognition>(m_ServiceId);
 	if (pVR != NULL && pVR->IsConfigured())
 	{
-		const DataCache::CacheItemMap & cache = m_ImagesCache.GetCacheMap();
-		if (cache.size() >= 2)
+		const ExampleCache::ArchiveMap & positiveArchives = m_Examples.GetArchives(ExampleCache::POSITIVE);
+		const ExampleCache::ArchiveMap & negativeArchives = m_Examples.GetArchives(ExampleCache::NEGATIVE);
+		if ((positiveArchives.size() + negativeArchives.size()) >= 2)
 		{
 			Log::Status("ImageClassifier", "Creating new classifier %s", m_ClassifierId.c_str());
 
+			// the archives already hold every example we have, so they are sent as they are
 			std::vector<std::string> negatives;
 			std::vector<std::string> positives;
-			for (DataCache::CacheItemMap::const_iterator iItem = cache.begin();
-				iItem != cache.end(); ++iItem)
-			{
-				const DataCache::CacheItem & item = iItem->second;
-				if (StringUtil::EndsWith(item.m_Id, "_positive_examples"))
-					positives.push_back(item.m_Path);
-				else if (StringUtil::EndsWith(item.m_Id, "_negative_examples"))
-					negatives.push_back(item.m_Path);
-			}
+			for (ExampleCache::ArchiveMap::const_iterator iArchive = positiveArchives.begin();
+				iArchive != positiveArchives.end(); ++iArchive)
+				positives.push_back(iArchive->second.m_Path);
+			for (ExampleCache::ArchiveMap::const_iterator iArchive = negativeArchives.begin();
+				iArchive != negativeArchives.end(); ++iArchive)
+				negatives.push_back(iArchive->second.m_Path);
 
 			pVR->CreateClassifier(m_ClassifierName,
 				positives,
 				negatives.size() > 0 ? negatives[0] : EMPTY_STRING,
 				DELEGATE(ImageClassifier, OnCreateClassifier, const Json::Value &, this));
 			m_PendingExamples.clear();
+			m_Examples.ClearUnsent();
 			m_bForceRetrain = false;
 
 		}
@@ -489,30 +537,31 @@ void ImageClassifier::UpdateClassifier()
 
 		// if we are already training, then nothing to do ATM, once training completes it will recall
 		// this function..
-		if (m_PendingExamples.begin() != m_PendingExamples.end() && !m_spRetrainingTimer)
+		if (m_PendingExamples.begin() != m_PendingExamples.end() && !m_spRetrainingTimer && m_SentExamples.size() == 0)
 		{
-			std::string negative;
-			std::vector<std::string> positives;
+			// only the examples added since the last update are sent, the classifier already has the rest
+			const ExampleCache::Archive * pNegative = NULL;
+			std::vector<const ExampleCache::Archive *> positives;
 			for (FileList::iterator iItem = m_PendingExamples.begin();
 				iItem != m_PendingExamples.end(); )
 			{
 				const std::string & id = *iItem;
 
-				DataCache::CacheItem * pItem = m_ImagesCache.Find(id, false);
-				if (pItem == NULL)
+				const ExampleCache::Archive * pArchive = m_Examples.Find(id);
+				if (pArchive == NULL || pArchive->m_UnsentCount == 0)
 				{
 					m_PendingExamples.erase(iItem++);
 					continue;
 				}
 
-				if (StringUtil::EndsWith(id, "_positive_examples"))
+				if (pArchive->m_ePolarity == ExampleCache::POSITIVE)
 				{
-					positives.push_back(pItem->m_Path);
+					positives.push_back(pArchive);
 					m_PendingExamples.erase(iItem++);
 				}
-				else if (negative.size() == 0)
+				else if (pNegative == NULL)
 				{
-					negative = pItem->m_Path;
+					pNegative = pArchive;
 					m_PendingExamples.erase(iItem++);
 				}
 				else
@@ -521,60 +570,74 @@ void ImageClassifier::UpdateClassifier()
 
 			// if we only have a negative example to update with, then we need to go look in the cache
 			// and a positive example of the same class if possible, otherwise any other positive example
-			// will be used.
-			if (positives.size() == 0 && negative.size() > 0)
+			// will be used. The classifier already has these, but an update needs a positive example.
+			std::vector<std::string> positivePaths;
+			if (positives.size() == 0 && pNegative != NULL)
 			{
-				std::string positive_id(negative);
-				StringUtil::Replace(positive_id, "_negative_examples.zip", "_positive_examples");
-
-				const DataCache::CacheItem * pItem = m_ImagesCache.Find(positive_id, false);
-				if (pItem == NULL)
+				const ExampleCache::Archive * pArchive = m_Examples.Find(pNegative->m_Class, ExampleCache::POSITIVE);
+				if (pArchive == NULL)
 				{
 					// no positive example of our class was found, just use the first positive example in the cache then..
-					const DataCache::CacheItemMap & cache = m_ImagesCache.GetCacheMap();
-					for (DataCache::CacheItemMap::const_iterator iItem = cache.begin(); iItem != cache.end(); ++iItem)
-					{
-						if (StringUtil::EndsWith(iItem->second.m_Id, "_positive_examples"))
-						{
-							positives.push_back(iItem->second.m_Path);
-							break;
-						}
-					}
+					const ExampleCache::ArchiveMap & archives = m_Examples.GetArchives(ExampleCache::POSITIVE);
+					if (archives.begin() != archives.end())
+						positivePaths.push_back(archives.begin()->second.m_Path);
 				}
 				else
 				{
 					// YAY...  found positive example for our negative example.. use it.
-					positives.push_back(pItem->m_Path);
+					positivePaths.push_back(pArchive->m_Path);
 				}
 			}
 
-			if (positives.size() >= 1)
+			if (positives.size() >= 1 || positivePaths.size() >= 1)
 			{
+				std::string path;
+				for (size_t i = 0; i < positives.size(); ++i)
+				{
+					if (m_Examples.TakeUnsent(positives[i]->m_Id, path))
+					{
+						positivePaths.push_back(path);
+						m_SentExamples.push_back(path);
+					}
+				}
+
+				std::string negative;
+				if (pNegative != NULL && m_Examples.TakeUnsent(pNegative->m_Id, negative))
+					m_SentExamples.push_back(negative);
+
 				Log::Status("ImageClassifier", "Updating classifier %s with %u positive examples, and %s",
-					m_ClassifierId.c_str(), positives.size(),
+					m_ClassifierId.c_str(), positivePaths.size(),
 					negative.size() > 0 ? "a negative example" : "no negative examples");
 
 				pVR->UpdateClassifier(m_ClassifierId,
 					m_ClassifierName,
-					positives,
+					positivePaths,
 					negative,
 					DELEGATE(ImageClassifier, OnUpdateClassifier, const Json::Value &, this));
 			}
 			else
 			{
 				Log::Warning("ImageClassifier", "Cannot update classifier yet, not enough data.");
-				if (negative.size() > 0)
-					m_PendingExamples.push_back(negative);
+				if (pNegative != NULL)
+					m_PendingExamples.push_back(pNegative->m_Id);
 			}
 		}
 	}
 }
 
+void ImageClassifier::RemoveSentExamples()
+{
+	for (FileList::iterator iSent = m_SentExamples.begin(); iSent != m_SentExamples.end(); ++iSent)
+		m_Examples.RemoveSent(*iSent);
+	m_SentExamples.clear();
+}
+
 void ImageClassifier::OnUpdateClassifier(const Json::Value & a_Response)
 {
 	if (a_Response.isNull())
 	{
 		Log::Error("ImageClassifier", "Failed to update the classifier, training new classifier.");
+		RemoveSentExamples();
 		m_spRetrainingTimer.reset();
 		m_ClassifierId.clear();
 
@@ -583,6 +646,7 @@ void ImageClassifier::OnUpdateClassifier(const Json::Value & a_Response)
 	else
 	{
 		Log::Status("ImageClassifier", "Classifier is retraining");
+		RemoveSentExamples();
 		CheckTrainingClassifier();
 	}
 }
@@ -21,11 +21,14 @@
 
 #include <list>
 
+#include "boost/cstdint.hpp"
+
 #include "IClassifier.h"
 #include "blackboard/ThingEvent.h"
 #include "blackboard/Image.h"
 #include "utils/IService.h"
-#include "utils/DataCache.h"
+#include "utils/ExampleCache.h"
+#include "utils/SimilarFrameCache.h"
 #include "SelfLib.h"
 
 class SelfInstance;
@@ -51,6 +54,10 @@ public:
 		m_bForceRetrain(false),
 		m_fRestartTime( 300.0f ),
 		m_bUseDefaultClassifier( true ),
+		m_bReuseSimilarFrames( true ),
+		m_MaxHashDistance( 4 ),
+		m_RecentFrameCount( 4 ),
+		m_fMaxReuseTime( 60.0f ),
 		m_nPendingOps( 0 )
 	{}
 
@@ -75,20 +82,27 @@ private:
 	{
 		typedef boost::shared_ptr<ClassifyImage>		SP;
 
-		ClassifyImage( const ImageClassifier::SP & a_spClassifier ) : m_pClassifier( a_spClassifier )
+		ClassifyImage( const ImageClassifier::SP & a_spClassifier, const std::string & a_Origin ) :
+			m_pClassifier( a_spClassifier ), m_Origin( a_Origin ), m_WorkGeneration( a_spClassifier->GetWorkGeneration() ),
+			m_bHashed( false ), m_Hash( 0 )
 		{}
 
 		ImageClassifier::SP	m_pClassifier;
+		std::string			m_Origin;
+		unsigned int		m_WorkGeneration;
 		Image::SP			m_spImage;
+		bool				m_bHashed;
+		boost::uint64_t		m_Hash;
 
 		bool ProcessImage( const Image::SP & a_spImage );
+		void OnHashImage();
+		void OnImageHashed();
 		void OnImageClassified(const Json::Value & json);
 	};
-	typedef std::map< std::string, ClassifyImage::SP >		ProcessingMap;
 
 	//! Data
 	double					m_MinClassifyConfidence;	// confidence before an entity is put on the blackboard
-	unsigned int			m_MaxCacheSize;				// maximum size of our images cache in bytes
+	unsigned int			m_MaxCacheSize;				// maximum size of our training examples in bytes
 	std::string				m_ServiceId;
 	std::string				m_ClassifierName;
 	bool					m_bForceRetrain;
@@ -97,15 +111,23 @@ private:
 	std::string				m_ClassifierDate;
 	float					m_fRestartTime;
 	bool					m_bUseDefaultClassifier;
+	bool					m_bReuseSimilarFrames;	// reuse the result of a recent frame of the same scene
+	int						m_MaxHashDistance;		// most bits different for frames to be the same scene
+	int						m_RecentFrameCount;		// recent results kept for each origin
+	float					m_fMaxReuseTime;		// seconds a result may be reused before the scene is classified again
 	FileList				m_PendingExamples;		// new examples to update classifier with
+	FileList				m_SentExamples;			// files of new examples being sent with an update
+	SimilarFrameCache		m_RecentFrames;
 
-	DataCache				m_ImagesCache;
-	ProcessingMap			m_ProcessingMap;
+	ExampleCache			m_Examples;
 	TimerPool::ITimer::SP	m_spRestartTimer;
 
 	TimerPool::ITimer::SP	m_spRetrainingTimer;
 	int						m_nPendingOps;
 
+	//! IClassifier interface
+	virtual bool OnWork( const std::string & a_Origin, const IThing::SP & a_spThing );
+
 	//! Callback handler
 	void OnGetClassifiers(const Json::Value & a_Response );
 	void OnGetClassifier(const Json::Value & a_Response );
@@ -114,8 +136,10 @@ private:
 	void OnHealth(const ThingEvent & a_Event);
 
 	void RestartClassifier();
+	void SubmitImages( const std::list<Image::SP> & a_Images, const std::string & a_Class, ExampleCache::Polarity a_ePolarity );
 
 	void UpdateClassifier( const std::string & a_NewExample );
+	void RemoveSentExamples();
 	void InitializeClassifier();
 	void OnCreateClassifier( const Json::Value & a_Response );
 	void UpdateClassifier();
@@ -21,6 +21,9 @@
 
 #include "blackboard/BlackBoard.h"
 #include "services/IObjectRecognition.h"
+#include "sensors/DepthVideoData.h"
+
+#include <opencv2/opencv.hpp>
 
 REG_SERIALIZABLE(ObjectClassifier);
 RTTI_IMPL(ObjectClassifier, IClassifier);
@@ -28,11 +31,16 @@ RTTI_IMPL(ObjectClassifier, IClassifier);
 void ObjectClassifier::Serialize(Json::Value & json)
 {
 	IClassifier::Serialize(json);
+
+	json["m_fMinInterval"] = m_fMinInterval;
 }
 
 void ObjectClassifier::Deserialize(const Json::Value & json)
 {
 	IClassifier::Deserialize(json);
+
+	if (json["m_fMinInterval"].isNumeric())
+		m_fMinInterval = json["m_fMinInterval"].asFloat();
 }
 
 const char * ObjectClassifier::GetName() const
@@ -70,6 +78,8 @@ bool ObjectClassifier::OnStop()
 	assert(pBlackboard != NULL);
 
 	pBlackboard->UnsubscribeFromType("DepthImage", this);
+	m_ProcessingMap.clear();
+	ClearWork();
 
 	Log::Status("ObjectClassifier", "Object Classifier stopped");
 	return true;
@@ -80,24 +90,64 @@ void ObjectClassifier::OnDepthImage(const ThingEvent & a_ThingEvent)
 	DepthImage::SP spDepthImage = DynamicCast<DepthImage>(a_ThingEvent.GetIThing());
 	if (spDepthImage)
 	{
-		if (m_ProcessingMap.find(spDepthImage->GetOrigin()) == m_ProcessingMap.end())
-			m_ProcessingMap[spDepthImage->GetOrigin()] = ClassifyDepthImage::SP( new ClassifyDepthImage() );
+		ClassifyDepthImage::SP & spClassify = m_ProcessingMap[spDepthImage->GetOrigin()];
+		if (! spClassify )
+			spClassify = ClassifyDepthImage::SP( new ClassifyDepthImage( shared_from_this(), spDepthImage->GetOrigin() ) );
+
+		// drop images that arrive too soon after the last one we classified from this origin
+		double now = Time().GetEpochTime();
+		if ( (now - spClassify->m_LastClassify) < m_fMinInterval )
+			return;
 
-		m_ProcessingMap[spDepthImage->GetOrigin()]->ProcessDepthImage(spDepthImage);
+		QueueWork(spDepthImage->GetOrigin(), spDepthImage);
 	}
 }
 
+bool ObjectClassifier::OnWork(const std::string & a_Origin, const IThing::SP & a_spThing)
+{
+	DepthImage::SP spDepthImage = DynamicCast<DepthImage>(a_spThing);
+	ProcessingMap::iterator iClassify = m_ProcessingMap.find(a_Origin);
+	if (! spDepthImage || iClassify == m_ProcessingMap.end())
+		return false;
+
+	if (! iClassify->second->ProcessDepthImage(spDepthImage) )
+		return false;
+
+	iClassify->second->m_LastClassify = Time().GetEpochTime();
+	return true;
+}
+
 bool ObjectClassifier::ClassifyDepthImage::ProcessDepthImage(const DepthImage::SP & a_spDepthImage)
 {
 	if (m_spDepthImage)
-		return false;
+		return false;		// only one image from each origin at a time
 
 	IObjectRecognition * pObjectRecognition = Config::Instance()->FindService<IObjectRecognition>();
 	if ( pObjectRecognition != NULL && pObjectRecognition->IsConfigured() )
 	{
+		// the service takes png, raw frames are encoded here after they have been downsampled by the extractor
+		std::string encoded;
+		const std::string & content = a_spDepthImage->GetContent();
+		if ( a_spDepthImage->GetContentType() == DepthVideoData::RAW_DEPTH_TYPE )
+		{
+			if (! DepthVideoData::IsRawValid( content ) )
+				return false;
+
+			int width = DepthVideoData::GetRawWidth( content );
+			int height = DepthVideoData::GetRawHeight( content );
+			if ( width == 0 || height == 0 )
+				return false;
+
+			std::vector<unsigned char> png;
+			cv::Mat frame( height, width, CV_16UC1, (void *)DepthVideoData::GetRawSamples( content ) );
+			if (! cv::imencode( ".png", frame, png ) )
+				return false;
+			encoded.assign( png.begin(), png.end() );
+		}
+
 		m_spDepthImage = a_spDepthImage;
 
-		pObjectRecognition->ClassifyObjects(m_spDepthImage->GetContent(),
+		pObjectRecognition->ClassifyObjects(encoded.size() > 0 ? encoded : content,
 			DELEGATE(ClassifyDepthImage, OnDepthImageClassified, const Json::Value &, shared_from_this() ));
 
 		return true;
@@ -126,4 +176,5 @@ void ObjectClassifier::ClassifyDepthImage::OnDepthImageClassified(const Json::Va
 	}
 
 	m_spDepthImage.reset();
+	m_spClassifier->WorkDone(m_Origin, m_WorkGeneration);
 }
\ No newline at end of file
@@ -33,7 +33,7 @@ class SELF_API ObjectClassifier : public IClassifier
 public:
 	RTTI_DECL();
 
-	ObjectClassifier()
+	ObjectClassifier() : m_fMinInterval( 1.0f )
 	{}
 
 	//! ISerializable interface
@@ -51,20 +51,31 @@ private:
 	{
 		typedef boost::shared_ptr<ClassifyDepthImage>		SP;
 
-		ClassifyDepthImage()
+		ClassifyDepthImage( const IClassifier::SP & a_spClassifier, const std::string & a_Origin ) :
+			m_spClassifier( a_spClassifier ), m_Origin( a_Origin ), m_WorkGeneration( a_spClassifier->GetWorkGeneration() ),
+			m_LastClassify( 0.0 )
 		{}
 
+		IClassifier::SP			m_spClassifier;
+		std::string				m_Origin;
+		unsigned int			m_WorkGeneration;
 		DepthImage::SP			m_spDepthImage;
+		double					m_LastClassify;
 
 		bool ProcessDepthImage(const DepthImage::SP & a_spImage);
 		void OnDepthImageClassified(const Json::Value & json);
 	};
 	typedef std::map< std::string, ClassifyDepthImage::SP >		ProcessingMap;
+
+	//! IClassifier interface
+	virtual bool OnWork( const std::string & a_Origin, const IThing::SP & a_spThing );
+
 	//! Callback handler
 	void OnDepthImage(const ThingEvent & a_ThingEvent);
 
 	//! Data
 	ProcessingMap			m_ProcessingMap;
+	float					m_fMinInterval;			// minimum seconds between classifying images from the same origin
 }; 
 
 #endif // OBJECT_CLASSIFIER_H
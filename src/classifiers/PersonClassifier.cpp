@@ -27,6 +27,7 @@
 #include "blackboard/Person.h"
 #include "services/IVisualRecognition.h"
 #include "utils/JpegHelpers.h"
+#include "utils/StringUtil.h"
 
 #include <opencv2/opencv.hpp>
 
@@ -37,9 +38,17 @@ PersonClassifier::PersonClassifier() :
 	m_ServiceId("VisualRecognitionV1"),
 	m_PersonClass("person"),
 	m_nPeopleSubs( 0 ),
+	m_nAnnotationSubs( 0 ),
+	m_FrameId( 0 ),
 	m_FaceClassifierFile( "shared/opencv/lbpcascade_frontalface.xml" ),
 	m_DetectFacesInterval( 0.5 ),
-	m_Padding( 0.09375f )
+	m_Padding( 0.09375f ),
+	m_bTrackFaces( true ),
+	m_RedetectInterval( 2.0 ),
+	m_TrackScale( 4 ),
+	m_TrackSearchRadius( 8 ),
+	m_fMinTrackScore( 0.6f ),
+	m_bRenderAnnotations( false )
 {}
 
 void PersonClassifier::Serialize(Json::Value & json)
@@ -51,6 +60,12 @@ void PersonClassifier::Serialize(Json::Value & json)
 	json["m_FaceClassifierFile"] = m_FaceClassifierFile;
 	json["m_DetectFacesInterval"] = m_DetectFacesInterval;
 	json["m_Padding"] = m_Padding;
+	json["m_bTrackFaces"] = m_bTrackFaces;
+	json["m_RedetectInterval"] = m_RedetectInterval;
+	json["m_TrackScale"] = m_TrackScale;
+	json["m_TrackSearchRadius"] = m_TrackSearchRadius;
+	json["m_fMinTrackScore"] = m_fMinTrackScore;
+	json["m_bRenderAnnotations"] = m_bRenderAnnotations;
 }
 
 void PersonClassifier::Deserialize(const Json::Value & json)
@@ -67,6 +82,18 @@ void PersonClassifier::Deserialize(const Json::Value & json)
 		m_DetectFacesInterval = json["m_DetectFacesInterval"].asDouble();
 	if( json["m_Padding"].isNumeric() )
 		m_Padding = json["m_Padding"].asFloat();
+	if( json["m_bTrackFaces"].isBool() )
+		m_bTrackFaces = json["m_bTrackFaces"].asBool();
+	if( json["m_RedetectInterval"].isNumeric() )
+		m_RedetectInterval = json["m_RedetectInterval"].asDouble();
+	if( json["m_TrackScale"].isNumeric() )
+		m_TrackScale = json["m_TrackScale"].asInt();
+	if( json["m_TrackSearchRadius"].isNumeric() )
+		m_TrackSearchRadius = json["m_TrackSearchRadius"].asInt();
+	if( json["m_fMinTrackScore"].isNumeric() )
+		m_fMinTrackScore = json["m_fMinTrackScore"].asFloat();
+	if( json["m_bRenderAnnotations"].isBool() )
+		m_bRenderAnnotations = json["m_bRenderAnnotations"].asBool();
 }
 
 const char * PersonClassifier::GetName() const
@@ -83,8 +110,11 @@ bool PersonClassifier::OnStart()
 		DELEGATE( PersonClassifier, OnImage, const ThingEvent &, this ), TE_ADDED );
 	pInstance->GetTopicManager()->RegisterTopic( "person-classifier", "image/jpeg", 
 		DELEGATE( PersonClassifier, OnPeople, const TopicManager::SubInfo &, this) );
+	pInstance->GetTopicManager()->RegisterTopic( "person-classifier-annotations", "application/json", 
+		DELEGATE( PersonClassifier, OnAnnotations, const TopicManager::SubInfo &, this) );
 
 	m_ProcessingMap.clear();
+	ClearWork();
     Log::Status("PersonClassifier", "PersonClassifier started");
 	return true;
 }
@@ -96,6 +126,8 @@ bool PersonClassifier::OnStop()
 
 	pInstance->GetBlackBoard()->UnsubscribeFromType("Image", this );
 	pInstance->GetTopicManager()->UnregisterTopic( "person-classifier" );
+	pInstance->GetTopicManager()->UnregisterTopic( "person-classifier-annotations" );
+	ClearWork();
 
 	Log::Status("PersonClassifier", "Person Classifier stopped");
 	return true;
@@ -103,18 +135,23 @@ bool PersonClassifier::OnStop()
 
 void PersonClassifier::OnImage(const ThingEvent & a_ThingEvent)
 {
-	//Only trigger the finding of image type when the previous image has completed facial detection
 	Image::SP spImage = DynamicCast<Image>(a_ThingEvent.GetIThing());
 	if (spImage)
-	{
-		if ( m_ProcessingMap.find( spImage->GetOrigin() ) == m_ProcessingMap.end() )
-		{
-			ClassifyFaces::SP spClassifier( new ClassifyFaces( this ) );
-			m_ProcessingMap[ spImage->GetOrigin() ] = spClassifier;
-		}
+		QueueWork( spImage->GetOrigin(), spImage );
+}
 
-		m_ProcessingMap[ spImage->GetOrigin() ]->ProcessImage( spImage );
-	}
+bool PersonClassifier::OnWork( const std::string & a_Origin, const IThing::SP & a_spThing )
+{
+	Image::SP spImage = DynamicCast<Image>( a_spThing );
+	if (! spImage )
+		return false;
+
+	// each origin keeps its own face detector, which only works on one image at a time
+	ClassifyFaces::SP & spClassifier = m_ProcessingMap[ a_Origin ];
+	if (! spClassifier )
+		spClassifier = ClassifyFaces::SP( new ClassifyFaces( this, a_Origin ) );
+
+	return spClassifier->ProcessImage( spImage );
 }
 
 void PersonClassifier::OnPeople(const TopicManager::SubInfo & a_Sub )
@@ -126,10 +163,21 @@ void PersonClassifier::OnPeople(const TopicManager::SubInfo & a_Sub )
 	assert( m_nPeopleSubs >= 0 );
 }
 
+void PersonClassifier::OnAnnotations(const TopicManager::SubInfo & a_Sub )
+{
+	if ( a_Sub.m_Subscribed )
+		m_nAnnotationSubs += 1;
+	else
+		m_nAnnotationSubs -= 1;
+	assert( m_nAnnotationSubs >= 0 );
+}
+
 //--------------------------------------------------------
 
-PersonClassifier::ClassifyFaces::ClassifyFaces( PersonClassifier * a_pClassifier ) : 
-	m_pClassifier( a_pClassifier ), m_pFaceClassifier( NULL ), m_LastClassify( 0.0 )
+PersonClassifier::ClassifyFaces::ClassifyFaces( PersonClassifier * a_pClassifier, const std::string & a_Origin ) : 
+	m_pClassifier( a_pClassifier ), m_Origin( a_Origin ), m_WorkGeneration( a_pClassifier->GetWorkGeneration() ), 
+	m_pFaceClassifier( NULL ), m_LastClassify( 0.0 ),
+	m_Tracker( a_pClassifier->m_TrackSearchRadius, a_pClassifier->m_fMinTrackScore ), m_bTracking( false )
 {
 #if ENABLE_LOCAL_DETECTION
 	SelfInstance * pInstance = SelfInstance::GetInstance();
@@ -149,36 +197,99 @@ bool PersonClassifier::ClassifyFaces::ProcessImage(const Image::SP & a_spImage )
 {
 	if ( m_spImage )
 		return false;		// already processing an image
-#if ENABLE_LOCAL_THROTTLE
+
+	// between full detections, just follow the faces we already found
 	double now = Time().GetEpochTime();
 	double elapsed = now - m_LastClassify;
-	if ( elapsed < m_pClassifier->m_DetectFacesInterval )
-		return false;		// not time to classify again
-	m_LastClassify = now;
+	m_bTracking = m_pClassifier->m_bTrackFaces && m_Tracker.HasFaces()
+		&& elapsed < m_pClassifier->m_RedetectInterval;
+	if (! m_bTracking )
+	{
+#if ENABLE_LOCAL_THROTTLE
+		if ( elapsed < m_pClassifier->m_DetectFacesInterval )
+			return false;		// not time to classify again
 #endif
+		m_LastClassify = now;
+	}
 
 	m_spImage = a_spImage;
+	if ( m_bTracking )
+	{
+		ThreadPool::Instance()->InvokeOnThread( VOID_DELEGATE( ClassifyFaces, OnTrackFaces, this ) );
+		return true;
+	}
+	if (! StartDetection() )
+	{
+		m_spImage.reset();
+		return false;
+	}
+
+	return true;
+}
+
+bool PersonClassifier::ClassifyFaces::StartDetection()
+{
 #if ENABLE_LOCAL_DETECTION
 	if ( m_pFaceClassifier != NULL )
 	{
 		// do classification in a background thread so we don't block the main thread..
 		ThreadPool::Instance()->InvokeOnThread( VOID_DELEGATE( ClassifyFaces, OnClassifyFaces, this ) );
+		return true;
 	}
-	else
 #endif
+	IVisualRecognition * pVisualRecognition = Config::Instance()->FindService<IVisualRecognition>( 
+		m_pClassifier->m_ServiceId );
+	if (pVisualRecognition != NULL)
 	{
-		IVisualRecognition * pVisualRecognition = Config::Instance()->FindService<IVisualRecognition>( 
-			m_pClassifier->m_ServiceId );
-		if (pVisualRecognition != NULL)
-		{
-			pVisualRecognition->DetectFaces(m_spImage->GetContent(),
-				DELEGATE(ClassifyFaces, OnFacesDetected, const Json::Value &, this));
-		}
-		else
-			m_spImage.reset();
+		pVisualRecognition->DetectFaces(m_spImage->GetContent(),
+			DELEGATE(ClassifyFaces, OnFacesDetected, const Json::Value &, this));
+		return true;
 	}
 
-	return true;
+	return false;
+}
+
+void PersonClassifier::ClassifyFaces::OnTrackFaces()
+{
+	FaceTracker::Frame frame;
+	if (! frame.FromJpeg( m_spImage->GetContent(), m_pClassifier->m_TrackScale ) || !m_Tracker.Track( frame ) )
+	{
+		// lost a face, go back to the main thread for a full detection
+		m_Tracker.Clear();
+		ThreadPool::Instance()->InvokeOnMain( VOID_DELEGATE( ClassifyFaces, OnTrackLost, this ) );
+		return;
+	}
+
+	// report the tracked faces just like a detection, keeping what the detection told us about each face
+	Json::Value result;
+	Json::Value & image0 = result["images"][0];
+	const FaceTracker::FaceList & faces = m_Tracker.GetFaces();
+	for(size_t i=0;i<faces.size();++i)
+	{
+		Json::Value & face = image0["faces"][(Json::ArrayIndex)i];
+		face = faces[i].m_Data;
+		face["track_score"] = faces[i].m_fScore;
+
+		Json::Value & face_rec = face["face_location"];
+		face_rec["left"] = faces[i].m_Left;
+		face_rec["top"] = faces[i].m_Top;
+		face_rec["width"] = faces[i].m_Width;
+		face_rec["height"] = faces[i].m_Height;
+	}
+
+	ThreadPool::Instance()->InvokeOnMain<Json::Value>( DELEGATE( ClassifyFaces, OnClassifyDone, Json::Value, this), result );
+}
+
+void PersonClassifier::ClassifyFaces::OnTrackLost()
+{
+	m_bTracking = false;
+	m_LastClassify = Time().GetEpochTime();
+
+	if (! StartDetection() )
+	{
+		m_spImage.reset();
+		m_pClassifier->WorkDone( m_Origin, m_WorkGeneration );
+	}
 }
 
 void PersonClassifier::ClassifyFaces::OnClassifyFaces()
@@ -209,6 +320,71 @@ void PersonClassifier::ClassifyFaces::OnClassifyFaces()
 	ThreadPool::Instance()->InvokeOnMain<Json::Value>( DELEGATE( ClassifyFaces, OnClassifyDone, Json::Value, this), result );
 }
 
+//! Copy a jpeg into a_Tagged with a "frame:<id>" comment segment right after the start of image marker,
+//! the image data is not touched so this doesn't need a decode.
+static void AddFrameId( const std::string & a_Jpeg, unsigned int a_FrameId, std::string & a_Tagged )
+{
+	if ( a_Jpeg.size() < 2 || (unsigned char)a_Jpeg[0] != 0xff || (unsigned char)a_Jpeg[1] != 0xd8 )
+	{
+		a_Tagged = a_Jpeg;
+		return;
+	}
+
+	std::string comment = StringUtil::Format( "frame:%u", a_FrameId );
+	size_t length = comment.size() + 2;		// the length includes itself
+
+	a_Tagged.reserve( a_Jpeg.size() + comment.size() + 4 );
+	a_Tagged.assign( a_Jpeg, 0, 2 );
+	a_Tagged += (char)0xff;
+	a_Tagged += (char)0xfe;
+	a_Tagged += (char)((length >> 8) & 0xff);
+	a_Tagged += (char)(length & 0xff);
+	a_Tagged += comment;
+	a_Tagged.append( a_Jpeg, 2, std::string::npos );
+}
+
+//! Read the size of a jpeg from its start of frame segment, without decoding it.
+static bool GetJpegSize( const std::string & a_Jpeg, int & a_Width, int & a_Height )
+{
+	const unsigned char * pData = (const unsigned char *)a_Jpeg.data();
+	size_t size = a_Jpeg.size();
+	if ( size < 4 || pData[0] != 0xff || pData[1] != 0xd8 )
+		return false;
+
+	size_t offset = 2;
+	while( offset + 4 <= size )
+	{
+		if ( pData[offset] != 0xff )
+			return false;
+		unsigned char marker = pData[offset + 1];
+		if ( marker == 0xff )
+		{
+			offset += 1;		// fill byte
+			continue;
+		}
+		if ( marker == 0x01 || (marker >= 0xd0 && marker <= 0xd7) )
+		{
+			offset += 2;		// no length
+			continue;
+		}
+		if ( marker == 0xd9 || marker == 0xda )
+			return false;		// end of image or start of scan, no frame header found
+
+		size_t length = (pData[offset + 2] << 8) | pData[offset + 3];
+		if ( marker >= 0xc0 && marker <= 0xcf && marker != 0xc4 && marker != 0xc8 && marker != 0xcc )
+		{
+			if ( length < 7 || offset + 9 > size )
+				return false;
+			a_Height = (pData[offset + 5] << 8) | pData[offset + 6];
+			a_Width = (pData[offset + 7] << 8) | pData[offset + 8];
+			return a_Width > 0 && a_Height > 0;
+		}
+		offset += 2 + length;
+	}
+
+	return false;
+}
+
 struct PeopleImage
 {
 	bool m_ImageLoaded;
@@ -258,15 +434,16 @@ struct PeopleImage
 	{
 		assert( m_ImageLoaded );
 
-		for(int x=0;x<a_width;++x)
+		// only the edges are touched, so this costs the perimeter not the area
+		for(int x=0;x<=a_width;++x)
 		{
-			for(int y=0;y<a_height;++y)
-			{
-				SetColor( a_left + x, a_top, a_Color );				//!< draw top
-				SetColor( a_left, a_top + y, a_Color );				//!< draw left
-				SetColor( a_left + a_width, a_top + y, a_Color );	//!< draw right
-				SetColor( a_left + x, a_top + a_height, a_Color );	//!< draw bottom
-			}
+			SetColor( a_left + x, a_top, a_Color );				//!< draw top
+			SetColor( a_left + x, a_top + a_height, a_Color );	//!< draw bottom
+		}
+		for(int y=0;y<=a_height;++y)
+		{
+			SetColor( a_left, a_top + y, a_Color );				//!< draw left
+			SetColor( a_left + a_width, a_top + y, a_Color );	//!< draw right
 		}
 	}
 };
@@ -281,10 +458,19 @@ void PersonClassifier::ClassifyFaces::OnFacesDetected(const Json::Value & json)
 	//Log::Status( "PersonClassifier", "OnPersonClassified: %s", json.toStyledString().c_str() );
 	if (!json.isNull() && json.isMember("images"))
 	{
+		bool bPublish = m_pClassifier->m_nPeopleSubs > 0 || m_pClassifier->m_nAnnotationSubs > 0;
+		Json::Value boxes( Json::arrayValue );
+
+		// the image goes out as it came in unless we've been asked to draw the boxes ourselves
 		PeopleImage publish;
-		if ( m_pClassifier->m_nPeopleSubs > 0 )
+		if ( m_pClassifier->m_nPeopleSubs > 0 && m_pClassifier->m_bRenderAnnotations )
 			publish.DecodeFromJpeg( m_spImage->GetContent() );
 
+		// face locations and padding are based on the size of the frame the faces were found in
+		int imageWidth = 0, imageHeight = 0;
+		if (! GetJpegSize( m_spImage->GetContent(), imageWidth, imageHeight ) )
+			Log::Warning( "PersonClassifier", "Failed to read the image size, faces will have no location or padding." );
+
 		const Json::Value & imageArray = json["images"];
 		for (size_t i = 0; i < imageArray.size(); ++i)
 		{
@@ -298,21 +484,50 @@ void PersonClassifier::ClassifyFaces::OnFacesDetected(const Json::Value & json)
 					std::string ageMin = face["age"]["min"].asString();
 					std::string ageRange = ageMin + "-" + ageMax;
 					std::string gender = face["gender"]["gender"].asString();
+					const Json::Value & location = face["face_location"];
 
-					// extract the face from the image data..
-					int padding = static_cast<int>( publish.m_Width * m_pClassifier->m_Padding );
-					int left = face["face_location"]["left"].asInt() - padding;
-					int top = face["face_location"]["top"].asInt() - padding;
-					int width = face["face_location"]["width"].asInt() + (padding * 2);
-					int height = face["face_location"]["height"].asInt() + (padding * 2);
+					// extract the face from the image data, padded by a part of the width of the frame..
+					int padding = static_cast<int>( imageWidth * m_pClassifier->m_Padding );
+					int left = location["left"].asInt() - padding;
+					int top = location["top"].asInt() - padding;
+					int width = location["width"].asInt() + (padding * 2);
+					int height = location["height"].asInt() + (padding * 2);
 
-					if ( m_pClassifier->m_nPeopleSubs > 0 )
-						publish.DrawRectangle( top, left, width, height, 0xff00ff );
+					if ( bPublish )
+					{
+						Json::Value & box = boxes.append( Json::Value() );
+						box["left"] = left;
+						box["top"] = top;
+						box["width"] = width;
+						box["height"] = height;
+						box["label"] = gender.size() > 0 ? gender + " " + ageRange : m_pClassifier->m_PersonClass;
+						box["confidence"] = m_bTracking ? face["track_score"].asDouble() : 
+							(face["gender"]["score"].isNumeric() ? face["gender"]["score"].asDouble() : 1.0);
+						box["tracked"] = m_bTracking;
+
+						if ( publish.m_ImageLoaded )
+							publish.DrawRectangle( top, left, width, height, 0xff00ff );
+					}
 
 					std::vector<float> face_location;
-					std::string face_image;
+					FaceTracker::GetLocation( location["left"].asInt(), location["top"].asInt(), 
+						location["width"].asInt(), location["height"].asInt(), imageWidth, imageHeight, face_location );
+
+					if ( m_bTracking )
+					{
+						// tracked faces were already sent for recognition, so only the location of the face 
+						// in this frame is needed and the image isn't decoded again
+						Person::SP spPerson(new Person());
+						spPerson->SetGender(gender);
+						spPerson->SetAgeRange(ageRange);
+						spPerson->SetFaceLocation(face_location);
+						spPerson->SetOrigin(m_spImage->GetOrigin());
+						m_spImage->AddChild(spPerson);
+						continue;
+					}
 
-					if (JpegHelpers::ExtractImage(m_spImage->GetContent(), left, top, width, height, face_image, &face_location))
+					std::string face_image;
+					if (JpegHelpers::ExtractImage(m_spImage->GetContent(), left, top, width, height, face_image, NULL))
 					{
 						Person::SP spPerson(new Person());
 						spPerson->SetGender(gender);
@@ -324,19 +539,32 @@ void PersonClassifier::ClassifyFaces::OnFacesDetected(const Json::Value & json)
 
 						Log::DebugHigh("PersonClassifier", "Adding person Gender: %s, AgeRange: %s", gender.c_str(), ageRange.c_str());
 					}
+
+					// the detection is kept with the face, so tracking can report it in the following frames
+					if ( i == 0 && m_pClassifier->m_bTrackFaces )
+					{
+						m_TrackFaces.push_back( FaceTracker::Face( location["left"].asInt(), location["top"].asInt(),
+							location["width"].asInt(), location["height"].asInt(), face ) );
+					}
 				}
 			}
 		}
 
-		if ( m_pClassifier->m_nPeopleSubs > 0 )
+		if ( bPublish )
 		{
 			std::string encoded;
-			if ( publish.EncodeToJpeg( encoded ) )
-			{
-				SelfInstance * pInstance = SelfInstance::GetInstance();
-				if ( pInstance != NULL )
-					pInstance->GetTopicManager()->Publish( "person-classifier", encoded, false, true );
-			}
+			if ( publish.m_ImageLoaded && publish.EncodeToJpeg( encoded ) )
+				PublishAnnotations( boxes, encoded );
+			else
+				PublishAnnotations( boxes, m_spImage->GetContent() );
+		}
+
+		// start tracking the faces we just detected, the image is decoded on a thread and we
+		// stay busy until it's done so the tracker isn't used meanwhile
+		if (! m_bTracking && m_pClassifier->m_bTrackFaces )
+		{
+			ThreadPool::Instance()->InvokeOnThread( VOID_DELEGATE( ClassifyFaces, OnStartTracking, this ) );
+			return;
 		}
 	}
 	else
@@ -346,4 +574,57 @@ void PersonClassifier::ClassifyFaces::OnFacesDetected(const Json::Value & json)
 
     //set the processing flag to false here to allow for additional detection of face
 	m_spImage.reset();
+	m_pClassifier->WorkDone( m_Origin, m_WorkGeneration );
+}
+
+void PersonClassifier::ClassifyFaces::PublishAnnotations(const Json::Value & a_Boxes, const std::string & a_Image)
+{
+	SelfInstance * pInstance = SelfInstance::GetInstance();
+	if ( pInstance == NULL )
+		return;
+	TopicManager * pTopics = pInstance->GetTopicManager();
+
+	unsigned int frameId = ++m_pClassifier->m_FrameId;
+	if ( m_pClassifier->m_nPeopleSubs > 0 )
+	{
+		// the frame id goes into the image too, so it can be matched to its annotations on its own
+		std::string image;
+		AddFrameId( a_Image, frameId, image );
+		pTopics->Publish( "person-classifier", image, false, true );
+	}
+
+	if ( m_pClassifier->m_nAnnotationSubs > 0 )
+	{
+		Json::Value annotations;
+		annotations["frame"] = frameId;
+		annotations["origin"] = m_spImage->GetOrigin();
+		annotations["time"] = Time().GetEpochTime();
+		annotations["boxes"] = a_Boxes;
+		pTopics->Publish( "person-classifier-annotations", Json::FastWriter().write( annotations ) );
+	}
+}
+
+void PersonClassifier::ClassifyFaces::OnStartTracking()
+{
+	FaceTracker::Frame frame;
+	if ( m_TrackFaces.size() > 0 && frame.FromJpeg( m_spImage->GetContent(), m_pClassifier->m_TrackScale ) )
+	{
+		// every face must be tracked, otherwise a face would be missing from the following frames
+		if ( m_Tracker.SetFaces( frame, m_TrackFaces ) < m_TrackFaces.size() )
+		{
+			Log::DebugLow( "PersonClassifier", "Can't track all %u faces, detecting again.", (unsigned int)m_TrackFaces.size() );
+			m_Tracker.Clear();
+		}
+	}
+	else
+		m_Tracker.Clear();
+	m_TrackFaces.clear();
+
+	ThreadPool::Instance()->InvokeOnMain( VOID_DELEGATE( ClassifyFaces, OnTrackingStarted, this ) );
+}
+
+void PersonClassifier::ClassifyFaces::OnTrackingStarted()
+{
+	m_spImage.reset();
+	m_pClassifier->WorkDone( m_Origin, m_WorkGeneration );
 }
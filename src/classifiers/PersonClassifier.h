@@ -24,6 +24,7 @@
 #include "blackboard/Entity.h"
 #include "blackboard/Image.h"
 #include "topics/TopicManager.h"
+#include "utils/FaceTracker.h"
 #include "SelfLib.h"
 
 class SelfInstance;
@@ -60,17 +61,28 @@ private:
 		typedef boost::shared_ptr<ClassifyFaces>		SP;
 
 		//! Construction
-		ClassifyFaces(PersonClassifier * a_pClassifier);
+		ClassifyFaces(PersonClassifier * a_pClassifier, const std::string & a_Origin);
 
 		bool ProcessImage( const Image::SP & a_spImage );		//!< Will return false if busy already
+		bool StartDetection();
 		void OnClassifyFaces();
+		void OnTrackFaces();
+		void OnTrackLost();
 		void OnClassifyDone( Json::Value a_Result );
 		void OnFacesDetected(const Json::Value & json);
+		void OnStartTracking();
+		void OnTrackingStarted();
+		void PublishAnnotations(const Json::Value & a_Boxes, const std::string & a_Image);
 
 		PersonClassifier *		m_pClassifier;
+		std::string				m_Origin;
+		unsigned int			m_WorkGeneration;		//!< the work generation this detector was created in
 		cv::CascadeClassifier *	m_pFaceClassifier;
 		Image::SP				m_spImage;
-		double					m_LastClassify;
+		double					m_LastClassify;			//!< time of the last full detection
+		FaceTracker				m_Tracker;
+		FaceTracker::FaceList	m_TrackFaces;			//!< faces from the last detection, handed to the tracker on a thread
+		bool					m_bTracking;			//!< true if m_spImage is being tracked, not detected
 	};
 
 	typedef std::map<std::string,ClassifyFaces::SP>		ProcessingMap;
@@ -81,13 +93,25 @@ private:
 	std::string		m_FaceClassifierFile;
 	double			m_DetectFacesInterval;		//!< How often to detect faces in the image in seconds per sensor
 	float			m_Padding;					//!< Percentage of padding around the detected face to add
+	bool			m_bTrackFaces;				//!< Track detected faces between detections
+	double			m_RedetectInterval;			//!< How often to run a full detection while faces are tracked
+	int				m_TrackScale;				//!< Images are reduced by this much for tracking
+	int				m_TrackSearchRadius;		//!< How far a face may move between frames, in reduced pixels
+	float			m_fMinTrackScore;			//!< Minimum correlation before a face is lost
+	bool			m_bRenderAnnotations;		//!< Draw the face boxes into the published image instead of sending the image as is
 
 	ProcessingMap	m_ProcessingMap;
 	int				m_nPeopleSubs;
+	int				m_nAnnotationSubs;
+	unsigned int	m_FrameId;					//!< links each published image to its annotations
+
+	//! IClassifier interface
+	virtual bool OnWork( const std::string & a_Origin, const IThing::SP & a_spThing );
 
 	//! Callbacks
 	void OnImage(const ThingEvent & a_ThingEvent);
 	void OnPeople(const TopicManager::SubInfo & a_Sub );
+	void OnAnnotations(const TopicManager::SubInfo & a_Sub );
 };
 
 #endif //SELF_PERSONCLASSIFIER_H
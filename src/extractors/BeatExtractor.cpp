@@ -42,7 +42,6 @@ BeatExtractor::BeatExtractor() :
 	m_fBeatHistoryTime( 7.0f ),
 	m_nMinBeatCount( 10 ),
 	m_fIntervalThreshold( 0.05f ),			// beat intervals need to be within 50 ms of each other
-	m_pAudioSensor( NULL ),
 	m_bMusicDetected( false ),
 	m_fMusicBPM( 0 )
 {}
@@ -99,29 +98,30 @@ bool BeatExtractor::OnStop()
 
 void BeatExtractor::OnAddAudio(ISensor * a_pSensor)
 {
-	if ( m_pAudioSensor == NULL )
+	if (! m_spAudioBus )
 	{
-		m_pAudioSensor= a_pSensor;
-		m_pAudioSensor->Subscribe( DELEGATE( BeatExtractor, OnAudioData, IData *, this) );
+		m_spAudioBus = AudioBus::Attach( a_pSensor );
+		m_spAudioBus->Subscribe( DELEGATE( BeatExtractor, OnAudioFrame, AudioBus *, this ) );
+		m_Cursor = m_spAudioBus->OpenCursor( AudioBus::BT_FLOAT );
 	}
 	else
-		Log::Warning( "TextExtractor", "multiple audio streams currently not supported by TextExtractor." );
+		Log::Warning( "BeatExtractor", "multiple audio streams currently not supported by BeatExtractor." );
 }
 
 void BeatExtractor::OnRemoveAudio(ISensor * a_pSensor)
 {
-	if ( a_pSensor == m_pAudioSensor )
+	if ( m_spAudioBus && m_spAudioBus->GetSensor() == a_pSensor )
 	{
-		m_pAudioSensor->Unsubscribe( this );
-		m_pAudioSensor = NULL;
+		m_spAudioBus->Unsubscribe( this );
+		m_spAudioBus.reset();
 	}
 }
-void BeatExtractor::OnAudioData( IData * a_pData )
+
+void BeatExtractor::OnAudioFrame( AudioBus * a_pBus )
 {
-	AudioData * pAudio = DynamicCast<AudioData>( a_pData );
-	if ( pAudio != NULL && pAudio->GetBPS() == 16 )
+	if ( a_pBus->GetRate() > 0 && a_pBus->Available( m_Cursor ) > 0 )
 	{
-		if ( m_pBT == NULL || m_pBT->GetSampleRate() != pAudio->GetFrequency() )
+		if ( m_pBT == NULL || m_pBT->GetSampleRate() != a_pBus->GetRate() )
 		{
 			if ( m_pBT == NULL )
 			{
@@ -135,38 +135,22 @@ void BeatExtractor::OnAudioData( IData * a_pData )
 				m_pBT->SetSensitivity( 100.0f / 1000.0f );		// 100 ms between beats
 			}
 
-			m_pBT->Initialize( TIME_SLICE, (float)pAudio->GetFrequency() );
+			m_pBT->Initialize( TIME_SLICE, (float)a_pBus->GetRate() );
 		}
 
-		size_t nOffset = m_Samples.size();
-		std::vector<float> samples( m_Samples );
-
-		short * pSamples = (short *)pAudio->GetWaveData().data();
-		size_t nSampleCount = pAudio->GetWaveData().size() / sizeof(short);
-
-		samples.resize( samples.size() + nSampleCount );
-		for(size_t i=0;i<nSampleCount;++i)
-			samples[i + nOffset] = ((float)pSamples[i]) / 32768.0f;
-
-		// how much time does this audio data represent, subtract this from the current time to know
-		double audioDuration = ((double)samples.size() / pAudio->GetChannels()) / (double)pAudio->GetFrequency();
-		double audioStartTime = Time().GetEpochTime() - audioDuration;			// get the actual start time for this audio block..
+		// the bus has already converted the samples, any unprocessed samples just stay in the bus until next frame
+		double audioStartTime = a_pBus->GetSampleTime( AudioBus::BT_FLOAT, m_Cursor.m_Position );
 
-		size_t nProcessed = 0;
-		while( (nProcessed + TIME_SLICE) <= samples.size() )
+		m_Slice.resize( TIME_SLICE );
+		while( a_pBus->Available( m_Cursor ) >= TIME_SLICE )
 		{
-			if ( m_pBT->Detect( samples, nProcessed ) )
-			{
-				double beatTime = audioStartTime + (((double)nProcessed / (double)pAudio->GetChannels()) / (double)pAudio->GetFrequency());
-				m_BeatTimes.push_back( beatTime );
-			}
+			double sliceTime = a_pBus->GetSampleTime( AudioBus::BT_FLOAT, m_Cursor.m_Position );
+			a_pBus->Read( m_Cursor, &m_Slice[0], TIME_SLICE );
 
-			nProcessed += TIME_SLICE;
+			if ( m_pBT->Detect( m_Slice, 0 ) )
+				m_BeatTimes.push_back( sliceTime );
 		}
 
-		// save any unprocessed samples into a buffer to do later..
-		m_Samples.assign( samples.begin() + nProcessed, samples.end() );
-
 		bool musicDetected = false;
 		float BPM = 0.0f;
 		if ( m_BeatTimes.begin() != m_BeatTimes.end() )
@@ -22,6 +22,7 @@
 #include <math.h>
 
 #include "extractors/TextExtractor.h"
+#include "sensors/AudioBus.h"
 #include "SelfLib.h"
 
 class IBeatDetect;
@@ -54,9 +55,12 @@ private:
 	IBeatDetect *
 				m_pBT;						// beat detection that uses an FFT to detect the beat
 	std::vector<float>
-				m_Samples;					// buffer for samples yet to be processed.
+				m_Slice;					// buffer for the slice of samples being processed
 
-	ISensor *	m_pAudioSensor;
+	AudioBus::SP
+				m_spAudioBus;				// shared bus for our audio sensor
+	AudioBus::Cursor
+				m_Cursor;					// our read position in the float buffer of the bus
 	bool		m_bMusicDetected;
 	std::list<double>
 				m_BeatTimes;				// history of beat times
@@ -66,7 +70,7 @@ private:
 
 	void		OnAddAudio(ISensor * a_pSensor);
 	void		OnRemoveAudio(ISensor * a_pSensor);
-	void		OnAudioData( IData * a_pData );
+	void		OnAudioFrame( AudioBus * a_pBus );
 	void		OnBeat();
 };
 
@@ -16,6 +16,8 @@
 */
 
 
+#include <algorithm>
+
 #include "DepthExtractor.h"
 
 #include "SelfInstance.h"
@@ -29,9 +31,41 @@
 
 #include "jsoncpp/json/json.h"
 
+#include <opencv2/opencv.hpp>
+
 REG_SERIALIZABLE(DepthExtractor);
 RTTI_IMPL(DepthExtractor, IExtractor);
 
+void DepthExtractor::Serialize(Json::Value & json)
+{
+	IExtractor::Serialize(json);
+
+	json["m_Decimation"] = m_Decimation;
+	json["m_RoiX"] = m_RoiX;
+	json["m_RoiY"] = m_RoiY;
+	json["m_RoiWidth"] = m_RoiWidth;
+	json["m_RoiHeight"] = m_RoiHeight;
+	json["m_bEncodePng"] = m_bEncodePng;
+}
+
+void DepthExtractor::Deserialize(const Json::Value & json)
+{
+	IExtractor::Deserialize(json);
+
+	if (json["m_Decimation"].isNumeric())
+		m_Decimation = json["m_Decimation"].asInt();
+	if (json["m_RoiX"].isNumeric())
+		m_RoiX = json["m_RoiX"].asInt();
+	if (json["m_RoiY"].isNumeric())
+		m_RoiY = json["m_RoiY"].asInt();
+	if (json["m_RoiWidth"].isNumeric())
+		m_RoiWidth = json["m_RoiWidth"].asInt();
+	if (json["m_RoiHeight"].isNumeric())
+		m_RoiHeight = json["m_RoiHeight"].asInt();
+	if (json["m_bEncodePng"].isBool())
+		m_bEncodePng = json["m_bEncodePng"].asBool();
+}
+
 const char * DepthExtractor::GetName() const
 {
 	return "ObjectExtractor";
@@ -87,10 +121,122 @@ void DepthExtractor::OnDepthVideoData(IData * a_pData)
 	DepthVideoData * pVideo = DynamicCast<DepthVideoData>(a_pData);
 	if (pVideo != NULL)
 	{
-		DepthImage::SP spDepthImage(new DepthImage());
-		spDepthImage->SetContent(pVideo->GetBinaryData());
-		spDepthImage->SetOrigin(pVideo->GetOrigin()->GetSensorId());
+		DepthImage::SP spDepthImage = CreateDepthImage(pVideo);
+		if (spDepthImage)
+		{
+			spDepthImage->SetOrigin(pVideo->GetOrigin()->GetSensorId());
+			SelfInstance::GetInstance()->GetBlackBoard()->AddThing(spDepthImage);
+		}
+	}
+}
+
+DepthImage::SP DepthExtractor::CreateDepthImage(const DepthVideoData * a_pVideo) const
+{
+	DepthImage::SP spDepthImage(new DepthImage());
 
-		SelfInstance::GetInstance()->GetBlackBoard()->AddThing(spDepthImage);
+	bool bFullFrame = m_Decimation <= 1 && m_RoiX <= 0 && m_RoiY <= 0 && m_RoiWidth <= 0 && m_RoiHeight <= 0;
+	if (bFullFrame)
+	{
+		// nothing to do, pass the frame through in the format the sensor sent it
+		spDepthImage->SetContent(a_pVideo->GetBinaryData());
+		if (a_pVideo->IsRaw())
+		{
+			spDepthImage->SetSize(a_pVideo->GetWidth(), a_pVideo->GetHeight());
+			spDepthImage->SetContentType(DepthVideoData::RAW_DEPTH_TYPE);
+		}
+		return spDepthImage;
+	}
+
+	int width = 0, height = 0;
+	const Sample * pSamples = NULL;
+
+	cv::Mat decoded;
+	if (a_pVideo->IsRaw())
+	{
+		width = a_pVideo->GetWidth();
+		height = a_pVideo->GetHeight();
+		pSamples = a_pVideo->GetSamples();
+	}
+	else
+	{
+		const std::string & png = a_pVideo->GetBinaryData();
+		std::vector<unsigned char> encoded(png.begin(), png.end());
+		decoded = cv::imdecode(encoded, CV_LOAD_IMAGE_ANYDEPTH);
+		if (decoded.empty())
+		{
+			Log::Error("ObjectExtractor", "Failed to decode depth image.");
+			return DepthImage::SP();
+		}
+		if (decoded.type() != CV_16UC1)
+			decoded.convertTo(decoded, CV_16UC1);
+		if (! decoded.isContinuous())
+			decoded = decoded.clone();
+
+		width = decoded.cols;
+		height = decoded.rows;
+		pSamples = (const Sample *)decoded.data;
+	}
+
+	int outWidth = 0, outHeight = 0;
+	std::vector<Sample> output;
+	Downsample(width, height, pSamples, m_RoiX, m_RoiY, m_RoiWidth, m_RoiHeight, m_Decimation,
+		outWidth, outHeight, output);
+	spDepthImage->SetSize(outWidth, outHeight);
+
+	if (m_bEncodePng)
+	{
+		std::vector<unsigned char> encoded;
+		if (outWidth > 0 && outHeight > 0)
+			cv::imencode(".png", cv::Mat(outHeight, outWidth, CV_16UC1, &output[0]), encoded);
+		spDepthImage->SetContent(std::string(encoded.begin(), encoded.end()));
+	}
+	else
+	{
+		std::string content;
+		DepthVideoData::PackRaw(outWidth, outHeight, output.size() > 0 ? &output[0] : NULL, content);
+		spDepthImage->SetContent(content);
+		spDepthImage->SetContentType(DepthVideoData::RAW_DEPTH_TYPE);
+	}
+
+	return spDepthImage;
+}
+
+void DepthExtractor::Downsample(int a_Width, int a_Height, const Sample * a_pSamples,
+	int a_RoiX, int a_RoiY, int a_RoiWidth, int a_RoiHeight, int a_Decimation,
+	int & a_OutWidth, int & a_OutHeight, std::vector<Sample> & a_Output)
+{
+	// clamp the region to the frame
+	int x0 = std::min(std::max(a_RoiX, 0), a_Width);
+	int y0 = std::min(std::max(a_RoiY, 0), a_Height);
+	int x1 = a_RoiWidth > 0 ? std::min(x0 + a_RoiWidth, a_Width) : a_Width;
+	int y1 = a_RoiHeight > 0 ? std::min(y0 + a_RoiHeight, a_Height) : a_Height;
+	int step = std::max(a_Decimation, 1);
+
+	a_OutWidth = (x1 - x0 + step - 1) / step;
+	a_OutHeight = (y1 - y0 + step - 1) / step;
+	a_Output.resize((size_t)a_OutWidth * a_OutHeight);
+
+	Sample * pOutput = a_Output.size() > 0 ? &a_Output[0] : NULL;
+	for (int y = y0; y < y1; y += step)
+	{
+		int by1 = std::min(y + step, y1);
+		for (int x = x0; x < x1; x += step)
+		{
+			int bx1 = std::min(x + step, x1);
+
+			// 0 is no depth, so keep the nearest valid depth in the block
+			Sample nearest = 0;
+			for (int by = y; by < by1; ++by)
+			{
+				const Sample * pRow = a_pSamples + ((size_t)by * a_Width);
+				for (int bx = x; bx < bx1; ++bx)
+				{
+					Sample depth = pRow[bx];
+					if (depth != 0 && (nearest == 0 || depth < nearest))
+						nearest = depth;
+				}
+			}
+			*pOutput++ = nearest;
+		}
 	}
 }
\ No newline at end of file
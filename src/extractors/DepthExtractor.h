@@ -20,31 +20,66 @@
 #define SELF_OBJECTEXTRACTOR_H
 
 #include <list>
+#include <vector>
 
 #include "IExtractor.h"
 #include "sensors/SensorManager.h"
+#include "sensors/DepthVideoData.h"
+#include "blackboard/DepthImage.h"
 #include "utils/Factory.h"
 #include "SelfLib.h"
 
-
+//! This extractor turns depth frames into DepthImage objects on the blackboard. Frames can be cropped to a
+//! region and decimated before they are added, by default frames are passed through untouched so nothing
+//! is decoded or encoded.
 class SELF_API DepthExtractor : public IExtractor
 {
 public:
 	RTTI_DECL();
 
-	DepthExtractor() {}
+	//! Types
+	typedef DepthVideoData::Sample		Sample;
+
+	DepthExtractor() :
+		m_Decimation( 1 ),
+		m_RoiX( 0 ),
+		m_RoiY( 0 ),
+		m_RoiWidth( 0 ),
+		m_RoiHeight( 0 ),
+		m_bEncodePng( false )
+	{}
+
+	//! ISerializable interface
+	virtual void Serialize(Json::Value & json);
+	virtual void Deserialize(const Json::Value & json);
 
 	//! IFeatureExtractor interface
 	virtual const char * GetName() const;
 	virtual bool OnStart();
 	virtual bool OnStop();
 
+	//! Crop and decimate the given frame into a new DepthImage, returns a NULL pointer if the frame can't be decoded.
+	DepthImage::SP CreateDepthImage( const DepthVideoData * a_pVideo ) const;
+
+	//! Crop a_pSamples to the given region and decimate it, each output sample is the nearest non-zero
+	//! depth in its a_Decimation x a_Decimation block so small near objects aren't lost. A region
+	//! width or height of 0 extends to the edge of the frame.
+	static void Downsample( int a_Width, int a_Height, const Sample * a_pSamples,
+		int a_RoiX, int a_RoiY, int a_RoiWidth, int a_RoiHeight, int a_Decimation,
+		int & a_OutWidth, int & a_OutHeight, std::vector<Sample> & a_Output );
+
 private:
 	//! Types
 	typedef SensorManager::SensorList	SensorList;
 
 	//! Data
 	SensorList		        m_DepthVideoSensors;
+	int						m_Decimation;			// keep 1 in N samples in each direction
+	int						m_RoiX;					// region of the frame to keep, in source pixels
+	int						m_RoiY;
+	int						m_RoiWidth;
+	int						m_RoiHeight;
+	bool					m_bEncodePng;			// if true, cropped or decimated images are png encoded, otherwise raw 16-bit depth
 
 	//! Callback handler
 	void OnAddSensor(ISensor * a_pSensor);
@@ -16,17 +16,28 @@
 */
 
 
+#include <algorithm>
+
 #include "utils/Log.h"
+#include "utils/Time.h"
+#include "utils/ThreadPool.h"
+#include "utils/TimerPool.h"
 #include "FeatureManager.h"
 #include "ProxyExtractor.h"
 #include "SelfInstance.h"
 
 
-FeatureManager::FeatureManager() : m_bActive( false )
+FeatureManager::FeatureManager() : m_bActive( false ), m_pTopicManager( NULL ), 
+	m_fStartTimeout( 30.0f )
 {}
 
 FeatureManager::~FeatureManager()
-{}
+{
+	// any ops still running on a thread must not call back into this object
+	for (size_t i = 0; i < m_PendingOps.size(); ++i)
+		m_PendingOps[i]->m_pManager = NULL;
+	m_spStartBatch.reset();
+}
 
 bool FeatureManager::Start()
 {
@@ -35,7 +46,12 @@ bool FeatureManager::Start()
 		return false;
 	if (m_bActive)
         return false;
-    m_bActive = true;
+
+	m_pTopicManager = SelfInstance::GetInstance()->GetTopicManager();
+	m_pTopicManager->RegisterTopic("feature-manager", "application/json",
+		DELEGATE(FeatureManager, OnSubscriber, const ITopics::SubInfo &, this));
+	m_pTopicManager->Subscribe("feature-manager",
+		DELEGATE(FeatureManager, OnFeatureExtractorEvent, const ITopics::Payload &, this));
 
 	const FeatureExtractorList & extractors = pInstance->GetExtractorList();
 	for (FeatureExtractorList::const_iterator iExtractor = extractors.begin();
@@ -44,13 +60,27 @@ bool FeatureManager::Start()
 		AddFeatureExtractor(*iExtractor);
 	}
 
-	m_pTopicManager = SelfInstance::GetInstance()->GetTopicManager();
-	m_pTopicManager->RegisterTopic("feature-manager", "application/json",
-		DELEGATE(FeatureManager, OnSubscriber, const ITopics::SubInfo &, this));
-	m_pTopicManager->Subscribe("feature-manager",
-		DELEGATE(FeatureManager, OnFeatureExtractorEvent, const ITopics::Payload &, this));
+	// start all the extractors together, any extractor that can start on a thread will be started
+	// in parallel, the rest are queued for the main thread. We don't wait for any of them, so the
+	// start timeout covers every extractor and OnExtractorOp() is invoked as each one is done.
+	m_bActive = true;
+
+	StartBatch::SP spBatch( new StartBatch() );
+	spBatch->m_fStartTime = Time().GetEpochTime();
+	for (FeatureExtractorList::iterator iExtractor = m_FeatureExtractors.begin();
+		iExtractor != m_FeatureExtractors.end(); ++iExtractor)
+	{
+		if ((*iExtractor)->IsEnabled())
+			spBatch->m_Ops.push_back(StartExtractor(*iExtractor, true));
+	}
+
+	m_spStartBatch = spBatch;
+	if (! CheckStartBatch() )
+	{
+		m_spStartBatch->m_spTimeout = TimerPool::Instance()->StartTimer(
+			VOID_DELEGATE(FeatureManager, OnStartTimeout, this), m_fStartTimeout, true, false);
+	}
 
-    Log::Status( "FeatureManager", "FeatureManager started, %d feature extractors", m_FeatureExtractors.size() );
     return true;
 }
 
@@ -60,16 +90,52 @@ bool FeatureManager::Stop()
         return false;
 
     Log::Status( "FeatureManager", "Stopping FeatureManager." );
+
+	// cancel any extractor still queued to start on the main thread, then wait for any extractor starting
+	// on a thread so it's not left running. The main thread has stopped by the time we are stopped, so 
+	// extractors are always stopped inline.
+	double startTime = Time().GetEpochTime();
+	m_spStartBatch.reset();
+
+	std::vector< IExtractor::SP > cancelled;
+	for (size_t i = 0; i < m_PendingOps.size(); ++i)
+	{
+		const ExtractorOp::SP & spOp = m_PendingOps[i];
+		if (spOp->m_bStart && !spOp->m_bThreaded)
+		{
+			spOp->m_bCancelled = true;
+			cancelled.push_back(spOp->m_spExtractor);
+		}
+	}
+	if (! WaitForPendingOps() )
+		Log::Warning("FeatureManager", "Timed out waiting for %u extractors to start.", (unsigned int)m_PendingOps.size());
+
+    m_bActive = false;
+
+	int count = 0;
     for (FeatureExtractorList ::iterator iExtractor = m_FeatureExtractors.begin();
          iExtractor != m_FeatureExtractors.end(); ++iExtractor)
     {
-        IExtractor::SP spFeatureExtractor = *iExtractor;
-        if (! spFeatureExtractor->OnStop() )
-			Log::Error( "FeatureManager", "Failed to stop feature extractor %s", spFeatureExtractor->GetName() );
+		if (std::find(cancelled.begin(), cancelled.end(), *iExtractor) != cancelled.end())
+			continue;
+		if ( FindPendingOp(*iExtractor) )
+		{
+			// it's op will stop it if it ever finishes starting
+			Log::Warning("FeatureManager", "Extractor %s is still starting, not stopping it.", (*iExtractor)->GetName());
+			continue;
+		}
+
+		StartExtractor(*iExtractor, false);
+		count += 1;
     }
     m_FeatureExtractors.clear();
 
-    m_bActive = false;
+	Json::Value ev;
+	ev["event"] = "extractors_stopped";
+	ev["count"] = count;
+	ev["duration"] = Time().GetEpochTime() - startTime;
+	PublishEvent(ev);
+
     return true;
 }
 
@@ -82,10 +148,7 @@ bool FeatureManager::AddFeatureExtractor(const IExtractor::SP & a_spExtractor, b
 	m_FeatureExtractors.push_back(a_spExtractor);
 
 	if (m_bActive && a_spExtractor->IsEnabled() )
-	{
-		if (a_spExtractor->OnStart())
-			a_spExtractor->SetState(IExtractor::AS_RUNNING);
-	}
+		StartExtractor(a_spExtractor, true);
 
 	Log::Status("FeatureExtractor", "Added extractor %s", a_spExtractor->GetRTTI().GetName().c_str());
 
@@ -99,6 +162,7 @@ bool FeatureManager::RemoveFeatureExtractor(const IExtractor::SP & a_spFeatureEx
 	{
 		if ((*iFeatureExtractor) == a_spFeatureExtractor)
 		{
+			// an extractor that is still starting is stopped by OnExtractorOp() once it's done
 			if (a_spFeatureExtractor->IsActive())
 				a_spFeatureExtractor->OnStop();
 
@@ -226,4 +290,206 @@ void FeatureManager::OnFeatureExtractorEvent(const ITopics::Payload & a_Payload)
 	}
 }
 
+FeatureManager::ExtractorOp::SP FeatureManager::StartExtractor(const IExtractor::SP & a_spExtractor, bool a_bStart)
+{
+	ExtractorOp::SP spOp(new ExtractorOp(this, a_spExtractor, a_bStart));
+	spOp->m_fStartTime = Time().GetEpochTime();
+	spOp->m_bThreaded = a_bStart && a_spExtractor->IsStartOnThread() && ThreadPool::Instance() != NULL;
+	m_PendingOps.push_back(spOp);
+
+	if (spOp->m_bThreaded)
+		ThreadPool::Instance()->InvokeOnThread(VOID_DELEGATE(ExtractorOp, Execute, spOp));
+	else if (a_bStart && ThreadPool::Instance() != NULL)
+		ThreadPool::Instance()->InvokeOnMain(VOID_DELEGATE(ExtractorOp, Execute, spOp));
+	else
+		spOp->Execute();
+
+	return spOp;
+}
+
+bool FeatureManager::FindPendingOp(const IExtractor::SP & a_spExtractor) const
+{
+	for (size_t i = 0; i < m_PendingOps.size(); ++i)
+		if (m_PendingOps[i]->m_spExtractor == a_spExtractor)
+			return true;
+	return false;
+}
+
+bool FeatureManager::WaitForPendingOps()
+{
+	ThreadPool * pPool = ThreadPool::Instance();
+	if (pPool == NULL)
+		return m_PendingOps.size() == 0;
+
+	double end = Time().GetEpochTime() + m_fStartTimeout;
+	while (m_PendingOps.size() > 0)
+	{
+		if (Time().GetEpochTime() > end)
+			return false;
+
+		pPool->ProcessMainThread();
+		boost::this_thread::sleep(boost::posix_time::milliseconds(5));
+	}
+
+	return true;
+}
+
+bool FeatureManager::CheckStartBatch()
+{
+	if (! m_spStartBatch )
+		return false;
+
+	const OpList & ops = m_spStartBatch->m_Ops;
+	for (size_t i = 0; i < ops.size(); ++i)
+		if (!ops[i]->m_bCompleted)
+			return false;
+
+	OnStartDone();
+	return true;
+}
+
+void FeatureManager::OnStartTimeout()
+{
+	if (! m_spStartBatch )
+		return;
+
+	// leave the extractor running on it's thread, it's state will be updated if it ever finishes.
+	const OpList & ops = m_spStartBatch->m_Ops;
+	for (size_t i = 0; i < ops.size(); ++i)
+	{
+		const ExtractorOp::SP & spOp = ops[i];
+		if (spOp->m_bCompleted)
+			continue;
+
+		spOp->m_bTimedOut = true;
+		Log::Error("FeatureManager", "Extractor %s timed out after %.1f seconds in OnStart().",
+			spOp->m_spExtractor->GetName(), m_fStartTimeout);
+
+		Json::Value ev;
+		ev["event"] = "extractor_start_timeout";
+		ev["name"] = spOp->m_spExtractor->GetName();
+		ev["extractorId"] = spOp->m_spExtractor->GetGUID();
+		ev["timeout"] = m_fStartTimeout;
+		PublishEvent(ev);
+	}
+
+	OnStartDone();
+}
+
+void FeatureManager::OnStartDone()
+{
+	StartBatch::SP spBatch = m_spStartBatch;
+	m_spStartBatch.reset();
+
+	const OpList & ops = spBatch->m_Ops;
+	int failed = 0;
+	for (size_t i = 0; i < ops.size(); ++i)
+		if (!ops[i]->m_bCompleted || !ops[i]->m_bResult)
+			failed += 1;
+
+	double duration = Time().GetEpochTime() - spBatch->m_fStartTime;
+
+	Json::Value ev;
+	ev["event"] = "extractors_started";
+	ev["count"] = (int)ops.size();
+	ev["failed"] = failed;
+	ev["duration"] = duration;
+	PublishEvent(ev);
+
+    Log::Status( "FeatureManager", "FeatureManager started, %d feature extractors, %d failed, %.2f seconds", 
+		ops.size(), failed, duration );
+}
+
+void FeatureManager::OnExtractorOp(ExtractorOp * a_pOp)
+{
+	for (OpList::iterator iOp = m_PendingOps.begin(); iOp != m_PendingOps.end(); ++iOp)
+	{
+		if ((*iOp).get() == a_pOp)
+		{
+			m_PendingOps.erase(iOp);
+			break;
+		}
+	}
+
+	const IExtractor::SP & spExtractor = a_pOp->m_spExtractor;
+	if (a_pOp->m_bCancelled)
+	{
+		Log::Status("FeatureManager", "Cancelled start of feature extractor %s", spExtractor->GetName());
+		return;
+	}
+	if (a_pOp->m_bStart)
+	{
+		bool bRemoved = std::find(m_FeatureExtractors.begin(), m_FeatureExtractors.end(), spExtractor) == m_FeatureExtractors.end();
+		if (a_pOp->m_bResult && m_bActive && !bRemoved)
+			spExtractor->SetState(IExtractor::AS_RUNNING);
+		else if (a_pOp->m_bResult)
+			spExtractor->OnStop();			// we were stopped or it was removed before it finished starting
+		else
+			Log::Error("FeatureManager", "Failed to start feature extractor %s %s", spExtractor->GetName(), a_pOp->m_Error.c_str());
+	}
+	else
+	{
+		if (a_pOp->m_bResult)
+			spExtractor->SetState(IExtractor::AS_STOPPED);
+		else
+			Log::Error("FeatureManager", "Failed to stop feature extractor %s %s", spExtractor->GetName(), a_pOp->m_Error.c_str());
+	}
+
+	Json::Value ev;
+	ev["event"] = a_pOp->m_bStart ? "extractor_started" : "extractor_stopped";
+	ev["name"] = spExtractor->GetName();
+	ev["extractorId"] = spExtractor->GetGUID();
+	ev["success"] = a_pOp->m_bResult;
+	ev["duration"] = a_pOp->m_fDuration;
+	ev["threaded"] = a_pOp->m_bThreaded;
+	if (a_pOp->m_bTimedOut)
+		ev["late"] = true;
+	if (a_pOp->m_Error.size() > 0)
+		ev["error"] = a_pOp->m_Error;
+	PublishEvent(ev);
+
+	if (a_pOp->m_bStart)
+		CheckStartBatch();
+}
+
+void FeatureManager::PublishEvent(const Json::Value & a_Event)
+{
+	if (m_pTopicManager != NULL)
+		m_pTopicManager->Publish("feature-manager", a_Event.toStyledString());
+}
+
+//----------------------------------------------
 
+void FeatureManager::ExtractorOp::Execute()
+{
+	// we were stopped before this queued start was run
+	if (m_bCancelled)
+	{
+		OnExecuted();
+		return;
+	}
+
+	// a failure in one extractor must not stop the other extractors from starting
+	try
+	{
+		m_bResult = m_bStart ? m_spExtractor->OnStart() : m_spExtractor->OnStop();
+	}
+	catch (const std::exception & ex)
+	{
+		m_bResult = false;
+		m_Error = ex.what();
+	}
+	m_fDuration = Time().GetEpochTime() - m_fStartTime;
+
+	if (m_bThreaded)
+		ThreadPool::Instance()->InvokeOnMain(VOID_DELEGATE(ExtractorOp, OnExecuted, shared_from_this()));
+	else
+		OnExecuted();
+}
+
+void FeatureManager::ExtractorOp::OnExecuted()
+{
+	m_bCompleted = true;
+	if (m_pManager != NULL)
+		m_pManager->OnExtractorOp(this);
+}
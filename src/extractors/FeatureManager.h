@@ -20,8 +20,13 @@
 #define FEATURE_MANAGER_H
 
 #include <list>
+#include <vector>
+
+#include "boost/shared_ptr.hpp"
+#include "boost/enable_shared_from_this.hpp"
 
 #include "utils/Factory.h"
+#include "utils/TimerPool.h"
 #include "IExtractor.h"
 #include "topics/TopicManager.h"
 #include "SelfLib.h"			// include last
@@ -42,9 +47,15 @@ public:
 	//! Accessors
 	const FeatureExtractorList & GetFeatureExtractorList() const;
 
-	//! Start this manager, initializes all available extractor objects.
+	//! Mutators
+	//! Set how long to wait for extractors that start on a thread before reporting them as timed out.
+	void SetStartTimeout( float a_fStartTimeout );
+
+	//! Start this manager, initializes all available extractor objects. The extractors are still
+	//! starting when this returns, each one is started on a thread or queued for the main thread.
 	bool Start();
-	//! Stop this manager.
+	//! Stop this manager, any extractor still waiting to start is cancelled and any extractor
+	//! starting on a thread is waited on before all the extractors are stopped.
 	bool Stop();
 	//! Add the extractor to this manager, it takes ownership of the object if accepted.
 	bool AddFeatureExtractor(const IExtractor::SP & a_spExtractor, bool a_bOverride = false);
@@ -90,10 +101,67 @@ public:
 	}
 
 private:
+	//! Types
+	//! This object starts or stops a single extractor, it's started on a thread for any
+	//! extractor that allows it, otherwise it's queued to run on the main thread so Start()
+	//! never blocks on an extractor. Stops are always run inline.
+	struct ExtractorOp : public boost::enable_shared_from_this<ExtractorOp>
+	{
+		typedef boost::shared_ptr<ExtractorOp>		SP;
+
+		ExtractorOp( FeatureManager * a_pManager, const IExtractor::SP & a_spExtractor, bool a_bStart ) :
+			m_pManager( a_pManager ), m_spExtractor( a_spExtractor ), m_bStart( a_bStart ),
+			m_bThreaded( false ), m_bResult( false ), m_bCompleted( false ), m_bTimedOut( false ), 
+			m_bCancelled( false ), m_fStartTime( 0.0 ), m_fDuration( 0.0 )
+		{}
+
+		FeatureManager *	m_pManager;
+		IExtractor::SP		m_spExtractor;
+		bool				m_bStart;
+		bool				m_bThreaded;
+		bool				m_bResult;
+		bool				m_bCompleted;		// set on the main thread once the op is done
+		bool				m_bTimedOut;
+		bool				m_bCancelled;		// set if stopped before a queued start was executed
+		double				m_fStartTime;
+		double				m_fDuration;
+		std::string			m_Error;
+
+		void Execute();
+		void OnExecuted();
+	};
+	typedef std::vector< ExtractorOp::SP >	OpList;
+
+	//! The extractors started by Start(), the summary is published once they are all done or
+	//! the start timeout expires.
+	struct StartBatch
+	{
+		typedef boost::shared_ptr<StartBatch>		SP;
+
+		StartBatch() : m_fStartTime( 0.0 )
+		{}
+
+		OpList					m_Ops;
+		double					m_fStartTime;
+		TimerPool::ITimer::SP	m_spTimeout;
+	};
+
 	//!Data
 	bool						m_bActive;
 	FeatureExtractorList		m_FeatureExtractors;
 	TopicManager *				m_pTopicManager;
+	float						m_fStartTimeout;
+	OpList						m_PendingOps;
+	StartBatch::SP				m_spStartBatch;
+
+	ExtractorOp::SP			StartExtractor(const IExtractor::SP & a_spExtractor, bool a_bStart);
+	bool					FindPendingOp(const IExtractor::SP & a_spExtractor) const;
+	bool					WaitForPendingOps();
+	bool					CheckStartBatch();
+	void					OnStartTimeout();
+	void					OnStartDone();
+	void					OnExtractorOp(ExtractorOp * a_pOp);
+	void					PublishEvent(const Json::Value & a_Event);
 
 	//! Callbacks
 	void					OnSubscriber(const ITopics::SubInfo & a_Info);
@@ -105,4 +173,9 @@ inline const FeatureManager::FeatureExtractorList & FeatureManager::GetFeatureEx
 	return m_FeatureExtractors;
 }
 
+inline void FeatureManager::SetStartTimeout( float a_fStartTimeout )
+{
+	m_fStartTimeout = a_fStartTimeout;
+}
+
 #endif
\ No newline at end of file
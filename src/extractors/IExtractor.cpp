@@ -28,12 +28,15 @@ RTTI_IMPL(IExtractor, ISerializable);
 void IExtractor::Serialize(Json::Value & json)
 {
 	json["m_bEnabled"] = m_bEnabled;
+	json["m_bStartOnThread"] = m_bStartOnThread;
 }
 
 void IExtractor::Deserialize(const Json::Value & json)
 {
 	if ( json["m_bEnabled"].isBool() )
 		m_bEnabled = json["m_bEnabled"].asBool();
+	if ( json["m_bStartOnThread"].isBool() )
+		m_bStartOnThread = json["m_bStartOnThread"].asBool();
 }
 
 void IExtractor::AddOverride()
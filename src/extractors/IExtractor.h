@@ -49,7 +49,7 @@ public:
 
 
 	//! Construction
-	IExtractor() : m_bEnabled( true ), m_eState(AS_STOPPED), m_pFeatureManager(NULL), m_Overrides(0)
+	IExtractor() : m_bEnabled( true ), m_bStartOnThread( false ), m_eState(AS_STOPPED), m_pFeatureManager(NULL), m_Overrides(0)
 	{
 		NewGUID();
 	}
@@ -78,6 +78,14 @@ public:
 	{
 		return m_bEnabled;
 	}
+	//! If true, the FeatureManager may invoke OnStart() on a background thread along with
+	//! other extractors, otherwise OnStart() is queued to run on the main thread. Only extractors
+	//! that don't touch any main thread objects in OnStart() should enable this, OnStop() is 
+	//! always invoked on the calling thread.
+	bool IsStartOnThread() const
+	{
+		return m_bStartOnThread;
+	}
 	State GetState() const
 	{
 		return m_eState;
@@ -102,6 +110,7 @@ public:
 protected:
 	//! Data
 	bool				m_bEnabled;
+	bool				m_bStartOnThread;
 	State				m_eState;
 	FeatureManager *	m_pFeatureManager;
 	int					m_Overrides;
@@ -49,6 +49,10 @@ void ProximityExtractor::Deserialize(const Json::Value & json )
         m_MaxSonarValue = json["m_MaxSonarValue"].asFloat();
     if ( json.isMember("m_SamplesToAverage") )
         m_SamplesToAverage = json["m_SamplesToAverage"].asInt();
+    if ( json["m_MinLaserValue"].isNumeric() )
+        m_MinLaserValue = json["m_MinLaserValue"].asFloat();
+    if ( json["m_MaxLaserValue"].isNumeric() )
+        m_MaxLaserValue = json["m_MaxLaserValue"].asFloat();
 }
 
 void ProximityExtractor::Serialize( Json::Value & json )
@@ -58,6 +62,8 @@ void ProximityExtractor::Serialize( Json::Value & json )
     json["m_MinSonarValue"] = m_MinSonarValue;
     json["m_MaxSonarValue"] = m_MaxSonarValue;
     json["m_SamplesToAverage"] = m_SamplesToAverage;
+    json["m_MinLaserValue"] = m_MinLaserValue;
+    json["m_MaxLaserValue"] = m_MaxLaserValue;
 }
 
 bool ProximityExtractor::OnStart()
@@ -85,6 +91,9 @@ bool ProximityExtractor::OnStop()
     for (SensorManager::SensorList::iterator iSensor = m_SonarSensors.begin(); iSensor != m_SonarSensors.end(); ++iSensor)
         (*iSensor)->Unsubscribe(this);
     m_SonarSensors.clear();
+    for (SensorManager::SensorList::iterator iSensor = m_LaserSensors.begin(); iSensor != m_LaserSensors.end(); ++iSensor)
+        (*iSensor)->Unsubscribe(this);
+    m_LaserSensors.clear();
 
     Log::Status("ProximityExtractor", "ProximityExtractor stopped");
 	return true;
@@ -111,8 +120,17 @@ void ProximityExtractor::OnLaserData(IData * data)
     LaserData* pLaserData = DynamicCast<LaserData>(data);
     if(pLaserData != NULL)
     {
-        Log::Debug("ProximityExtractor", "Adding proximity data");
-        Proximity::SP spProximity( new Proximity("Laser", true, pLaserData->GetDistance() ) );
-        SelfInstance::GetInstance()->GetBlackBoard()->AddThing( spProximity );
+        // one proximity for the whole scan, using the nearest point
+        int nearest = pLaserData->FindNearest( m_MinLaserValue );
+        if ( nearest >= 0 )
+        {
+            float distance = pLaserData->GetPoints()[nearest].m_fDistance;
+            if ( distance < m_MaxLaserValue )
+            {
+                Log::Debug("ProximityExtractor", "Adding proximity data, %.2f from %u points", distance, (unsigned int)pLaserData->GetPointCount() );
+                Proximity::SP spProximity( new Proximity("Laser", true, distance ) );
+                SelfInstance::GetInstance()->GetBlackBoard()->AddThing( spProximity );
+            }
+        }
     }
 }
\ No newline at end of file
@@ -35,7 +35,9 @@ public:
         m_MinSonarValue(0.0),
         m_MaxSonarValue(4.0),
         m_SamplesToAverage(5),
-        m_CurrentAverage(0.0) 
+        m_CurrentAverage(0.0),
+        m_MinLaserValue(0.05f),
+        m_MaxLaserValue(4.0f)
     {}
 
     virtual void Deserialize(const Json::Value & json);
@@ -57,6 +59,8 @@ private:
     float                   m_MaxSonarValue;
     float                   m_CurrentAverage;
     int                     m_SamplesToAverage;
+    float                   m_MinLaserValue;        // laser returns closer than this are ignored
+    float                   m_MaxLaserValue;        // only report laser scans with a point closer than this
 
     //! Callback handler
     void OnSonarData(IData * data);
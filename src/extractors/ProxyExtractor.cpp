@@ -20,6 +20,7 @@
 #include "SelfInstance.h"
 #include "FeatureManager.h"
 #include "utils/UniqueID.h"
+#include "utils/ThreadPool.h"
 #include "topics/ITopics.h"
 
 RTTI_IMPL(ProxyExtractor, IExtractor);
@@ -31,11 +32,14 @@ ProxyExtractor::ProxyExtractor(const std::string & a_ExtractorName, const std::s
 	m_bOverride(a_bOverride)
 {
 	SetGUID( a_InstanceId );
+	m_bStartOnThread = true;
 }
 
 ProxyExtractor::ProxyExtractor() :
 	m_bOverride(false)
-{}
+{
+	m_bStartOnThread = true;
+}
 
 ProxyExtractor::~ProxyExtractor()
 {}
@@ -58,7 +62,15 @@ void ProxyExtractor::Deserialize(const Json::Value & json)
 
 bool ProxyExtractor::OnStart()
 {
-	SendEvent("start_extractor");
+	// we may be started on a thread, the topics can only be used from the main thread..
+	ThreadPool * pPool = ThreadPool::Instance();
+	if ( pPool != NULL )
+	{
+		pPool->InvokeOnMain<std::string *>( DELEGATE( ProxyExtractor, OnSendEvent, std::string *, 
+			boost::static_pointer_cast<ProxyExtractor>( shared_from_this() ) ), new std::string( "start_extractor" ) );
+	}
+	else
+		SendEvent("start_extractor");
 	return true;
 }
 
@@ -73,6 +85,12 @@ const char * ProxyExtractor::GetName() const
 	return m_ExtractorName.c_str();
 }
 
+void ProxyExtractor::OnSendEvent(std::string * a_pEventName)
+{
+	SendEvent(*a_pEventName);
+	delete a_pEventName;
+}
+
 void ProxyExtractor::SendEvent(const std::string & a_EventName)
 {
 	SelfInstance * pInstance = SelfInstance::GetInstance();
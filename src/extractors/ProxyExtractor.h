@@ -45,6 +45,7 @@ public:
 	virtual void Deserialize(const Json::Value & json);
 
 	//! IFeatureExtractor interface	
+	//! OnStart() is safe to invoke on a thread, the start event is sent from the main thread.
 	virtual bool OnStart();
 	virtual bool OnStop();
 	virtual const char * GetName() const;
@@ -61,6 +62,8 @@ protected:
 	std::string			m_Origin;
 	std::string			m_ExtractorName;
 	bool				m_bOverride;
+
+	void OnSendEvent(std::string * a_pEventName);
 };
 
 #endif // SELF_PROXY_EXTRACTOR_H
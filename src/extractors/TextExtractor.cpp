@@ -70,7 +70,6 @@ TextExtractor::TextExtractor() :
 	m_BurnInCycles(0),
 	m_Listening( true ),
 	m_bStoreAudio(false),
-	m_pAudioSensor( NULL ),
 	m_nSpectrumSubs( 0 ),
 	m_FFTHeight( 100 ),
 	m_FFTWidth( 500 ),
@@ -218,10 +217,10 @@ bool TextExtractor::OnStop()
 	if ( pSTT != NULL && pSTT->IsListening() )
 		pSTT->StopListening();
 
-	if ( m_pAudioSensor != NULL )
+	if ( m_spAudioBus )
 	{
-		m_pAudioSensor->Unsubscribe( this );
-		m_pAudioSensor = NULL;
+		m_spAudioBus->Unsubscribe( this );
+		m_spAudioBus.reset();
 	}
 
 	SensorManager * pSensorMgr = pInstance->GetSensorManager();
@@ -385,10 +384,11 @@ void TextExtractor::OnConversation( const ITopics::Payload & a_Payload )
 
 void TextExtractor::OnAddAudio(ISensor * a_pSensor)
 {
-	if ( m_pAudioSensor == NULL )
+	if (! m_spAudioBus )
 	{
-		m_pAudioSensor= a_pSensor;
-		m_pAudioSensor->Subscribe( DELEGATE( TextExtractor, OnAudioData, IData *, this) );
+		m_spAudioBus = AudioBus::Attach( a_pSensor );
+		m_spAudioBus->Subscribe( DELEGATE( TextExtractor, OnAudioFrame, AudioBus *, this ) );
+		m_SpectrumCursor = m_spAudioBus->OpenCursor( AudioBus::BT_FLOAT );
 	}
 	else
 		Log::Warning( "TextExtractor", "multiple audio streams currently not supported by TextExtractor." );
@@ -396,10 +396,10 @@ void TextExtractor::OnAddAudio(ISensor * a_pSensor)
 
 void TextExtractor::OnRemoveAudio(ISensor * a_pSensor)
 {
-	if ( a_pSensor == m_pAudioSensor )
+	if ( m_spAudioBus && m_spAudioBus->GetSensor() == a_pSensor )
 	{
-		m_pAudioSensor->Unsubscribe( this );
-		m_pAudioSensor = NULL;
+		m_spAudioBus->Unsubscribe( this );
+		m_spAudioBus.reset();
 	}
 }
 
@@ -413,7 +413,7 @@ void TextExtractor::OnRemoveText(ISensor * a_pSensor)
 	a_pSensor->Unsubscribe( this );
 }
 
-void TextExtractor::OnAudioData(IData * data)
+void TextExtractor::OnAudioFrame(AudioBus * a_pBus)
 {
 	ISpeechToText * pSTT = SelfInstance::GetInstance()->FindService<ISpeechToText>();
 	if ( pSTT != NULL )
@@ -429,7 +429,7 @@ void TextExtractor::OnAudioData(IData * data)
 		float energyAverageSum = 0;
 		float energyStandardDeviation = 0;
 
-		AudioData * pAudio = DynamicCast<AudioData>(data);
+		const AudioData * pAudio = a_pBus->GetFrame();
 		if ( pAudio != NULL )
 		{
 			SpeechAudioData speech;
@@ -452,10 +452,10 @@ void TextExtractor::OnAudioData(IData * data)
 
 				if ( m_nSpectrumSubs > 0 )
 				{
-					std::vector<float> fsamples;
-					fsamples.resize( samples );
-					for(size_t i=0;i<samples;++i)
-						fsamples[i] = ((float)pSamples[i]) / 32768.0f;
+					// take the samples already converted by the bus
+					m_SpectrumSamples.resize( a_pBus->Available( m_SpectrumCursor ) );
+					if ( m_SpectrumSamples.size() > 0 )
+						a_pBus->Read( m_SpectrumCursor, &m_SpectrumSamples[0], m_SpectrumSamples.size() );
 
 					if ( m_FFT.GetAverageSize() == 0 )
 					{
@@ -463,9 +463,14 @@ void TextExtractor::OnAudioData(IData * data)
 						m_FFT.LogAverages(60, 3);
 					}
 
-					m_FFT.Forward(fsamples);
-					PublishSpectrum();
+					if ( m_SpectrumSamples.size() > 0 )
+					{
+						m_FFT.Forward(m_SpectrumSamples);
+						PublishSpectrum();
+					}
 				}
+				else
+					m_SpectrumCursor = a_pBus->OpenCursor( AudioBus::BT_FLOAT );
 
 				speech.m_Level = movingAverage / (samples * 32768.0f);
 
@@ -26,6 +26,7 @@
 #include "blackboard/ThingEvent.h"
 #include "blackboard/Person.h"
 #include "sensors/SensorManager.h"
+#include "sensors/AudioBus.h"
 #include "services/ISpeechToText.h"
 #include "services/ILanguageTranslation.h"
 #include "utils/Factory.h"
@@ -151,13 +152,15 @@ private:
 
 	double				m_LastFailureResponse;
     SensorList     		m_TextSensors;
-	ISensor *			m_pAudioSensor;
+	AudioBus::SP		m_spAudioBus;
 	bool 				m_Listening;
 
 	Filters				m_Filters;
 
 	int					m_nSpectrumSubs;
 	FFT					m_FFT;
+	AudioBus::Cursor	m_SpectrumCursor;
+	std::vector<float>	m_SpectrumSamples;
 
 	int					m_FFTHeight;
 	int					m_FFTWidth;
@@ -168,7 +171,7 @@ private:
 	void OnRemoveAudio(ISensor * a_pSensor);
 	void OnAddText(ISensor * a_pSensor);
 	void OnRemoveText(ISensor * a_pSensor);
-	void OnAudioData(IData * data);
+	void OnAudioFrame(AudioBus * a_pBus);
     void OnTextData(IData * data);
 	void OnPerson( const ThingEvent & a_Event );
 	void OnHealth( const ThingEvent & a_Event );
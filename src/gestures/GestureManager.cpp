@@ -57,20 +57,82 @@ void GestureManager::Deserialize(const Json::Value & json)
 
 		spGesture->SetGestureId( key.asString() );		// make sure the correct ID is in the object
 		m_GestureMap.insert(std::pair<std::string, IGesture::SP>(key.asString(), spGesture));
+		IndexGesture( spGesture );
 	}
 }
 
-bool GestureManager::FindGestures( const std::string & a_GestureId, GestureList & a_Gestures ) const
+bool GestureManager::FindGestures( const std::string & a_GestureId, GestureList & a_Gestures )
 {
-	a_Gestures.clear();
-	for( GestureMap::const_iterator iFind = m_GestureMap.find( a_GestureId ); 
-		iFind != m_GestureMap.end() && iFind->first == a_GestureId; ++iFind )
+	a_Gestures = GetGestures( FindGestureHandle( a_GestureId ) );
+	return a_Gestures.size() > 0;
+}
+
+GestureManager::GestureHandle GestureManager::FindGestureHandle( const std::string & a_GestureId ) const
+{
+	HandleMap::const_iterator iHandle = m_HandleMap.find( a_GestureId );
+	if ( iHandle != m_HandleMap.end() )
+		return iHandle->second;
+	return INVALID_HANDLE;
+}
+
+GestureManager::GestureHandle GestureManager::GetGestureHandle( const std::string & a_GestureId )
+{
+	HandleMap::iterator iHandle = m_HandleMap.find( a_GestureId );
+	if ( iHandle != m_HandleMap.end() )
+		return iHandle->second;
+
+	GestureHandle handle = (GestureHandle)m_GestureTypes.size();
+	m_GestureTypes.push_back( GestureType( a_GestureId ) );
+	m_HandleMap[ a_GestureId ] = handle;
+
+	return handle;
+}
+
+const GestureManager::GestureList & GestureManager::GetGestures( GestureHandle a_Handle )
+{
+	static GestureList EMPTY;
+	if ( a_Handle < 0 || a_Handle >= (GestureHandle)m_GestureTypes.size() )
+		return EMPTY;
+
+	GestureType & type = m_GestureTypes[ a_Handle ];
+	if ( type.m_bDirty || type.m_StateVersion != IGesture::GetStateVersion() )
 	{
-		if ( iFind->second->IsEnabled() && !iFind->second->IsOverridden() )
-			a_Gestures.push_back( iFind->second );
+		type.m_Candidates.clear();
+		for( GestureList::iterator iGesture = type.m_Gestures.begin(); iGesture != type.m_Gestures.end(); ++iGesture )
+		{
+			if ( (*iGesture)->IsEnabled() && !(*iGesture)->IsOverridden() )
+				type.m_Candidates.push_back( *iGesture );
+		}
+		type.m_StateVersion = IGesture::GetStateVersion();
+		type.m_bDirty = false;
 	}
 
-	return a_Gestures.size() > 0;
+	return type.m_Candidates;
+}
+
+void GestureManager::IndexGesture( const IGestureSP & a_spGesture )
+{
+	GestureType & type = m_GestureTypes[ GetGestureHandle( a_spGesture->GetGestureId() ) ];
+	type.m_Gestures.push_back( a_spGesture );
+	type.m_bDirty = true;
+}
+
+void GestureManager::UnindexGesture( const IGestureSP & a_spGesture )
+{
+	GestureHandle handle = FindGestureHandle( a_spGesture->GetGestureId() );
+	if ( handle == INVALID_HANDLE )
+		return;
+
+	GestureType & type = m_GestureTypes[ handle ];
+	for( GestureList::iterator iGesture = type.m_Gestures.begin(); iGesture != type.m_Gestures.end(); ++iGesture )
+	{
+		if ( *iGesture == a_spGesture )
+		{
+			type.m_Gestures.erase( iGesture );
+			break;
+		}
+	}
+	type.m_bDirty = true;
 }
 
 bool GestureManager::Start()
@@ -103,7 +165,10 @@ bool GestureManager::Start()
 	{
 		IGesture * pGesture = iGesture->second.get();
 		if (! pGesture->Start() )
+		{
+			UnindexGesture( iGesture->second );
 			m_GestureMap.erase( iGesture-- );
+		}
 	}
 
 	Log::Status( "GestureManager", "GestureManager started." );
@@ -140,6 +205,7 @@ bool GestureManager::AddGesture( const IGestureSP & a_spGesture )
 		return false;
 
 	m_GestureMap.insert( GestureMap::value_type( a_spGesture->GetGestureId(), a_spGesture ) );
+	IndexGesture( a_spGesture );
 	return true;
 }
 
@@ -154,6 +220,7 @@ bool GestureManager::RemoveGesture( const IGestureSP & a_spGesture )
 				return false;
 
 			m_GestureMap.erase( iFind );
+			UnindexGesture( a_spGesture );
 			return true;
 		}
 	}
@@ -47,6 +47,9 @@ public:
 	typedef std::map< std::string, ProxyGestureSP >		ProxyMap;
 	typedef Factory< IGesture >		GestureFactory;
 	typedef Delegate<IGesture *>	GestureDelegate;
+	typedef int						GestureHandle;
+
+	static const GestureHandle		INVALID_HANDLE = -1;
 
 	//! Construction
 	GestureManager();
@@ -64,7 +67,13 @@ public:
 
 	//! This finds all gestures who have the given ID, returns false if none are found.
 	bool FindGestures( const std::string & a_GestureId, 
-		GestureList & a_Gestures ) const;
+		GestureList & a_Gestures );
+	//! Returns the handle for the given gesture ID, or INVALID_HANDLE if no gesture with that ID has ever
+	//! been added. Once returned, a handle is valid for the life of this manager.
+	GestureHandle FindGestureHandle( const std::string & a_GestureId ) const;
+	//! Returns the enabled, non-overridden gestures for the given handle. The returned list is cached
+	//! and remains valid until a gesture is added or removed.
+	const GestureList & GetGestures( GestureHandle a_Handle );
 
 	//! Initialize and start this sensor manager.
 	bool Start();
@@ -75,10 +84,33 @@ public:
 	bool RemoveGesture( const IGestureSP & a_spGesture );
 
 private:
+	//! Types
+	struct GestureType
+	{
+		GestureType( const std::string & a_GestureId ) : m_GestureId( a_GestureId ), m_StateVersion( 0 ), m_bDirty( true )
+		{}
+
+		std::string		m_GestureId;
+		GestureList		m_Gestures;			// all gestures with this ID
+		GestureList		m_Candidates;		// cached list of usable gestures
+		unsigned int	m_StateVersion;		// IGesture state version the candidates were built at
+		bool			m_bDirty;
+	};
+	typedef std::vector< GestureType >				GestureTypeList;
+	typedef std::map< std::string, GestureHandle >	HandleMap;
+
 	//! Data
 	bool					m_bActive;
 	GestureMap				m_GestureMap;	
 	ProxyMap				m_ProxyMap;
+	GestureTypeList			m_GestureTypes;		// indexed by GestureHandle
+	HandleMap				m_HandleMap;
+
+	//! Returns the handle for the given ID, adding it if needed. Only used when indexing a gesture, so
+	//! looking up unknown IDs never adds a handle.
+	GestureHandle GetGestureHandle( const std::string & a_GestureId );
+	void IndexGesture( const IGestureSP & a_spGesture );
+	void UnindexGesture( const IGestureSP & a_spGesture );
 
 	void OnSubscriber( const ITopics::SubInfo & a_Info );
 	void OnGestureEvent( const ITopics::Payload & a_Payload );
@@ -16,14 +16,30 @@
 */
 
 
+#include <algorithm>
+
 #include "IGesture.h"
+#include "utils/Time.h"
+#include "utils/StringUtil.h"
 
 RTTI_IMPL( IGesture, ISerializable );
 
+//! Maximum number of free Request objects we keep around for reuse
+const size_t MAX_POOLED_REQUESTS = 256;
+
+IGesture::RequestPool IGesture::sm_RequestPool;
+boost::mutex IGesture::sm_RequestPoolLock;
+unsigned int IGesture::sm_StateVersion = 0;
+
+const char * IGesture::PRIORITY_PARAM = "gesture_priority";
+const char * IGesture::TIMEOUT_PARAM = "gesture_timeout";
+
 void IGesture::Serialize(Json::Value & json)
 {
 	json["m_bEnabled"] = m_bEnabled;
 	json["m_GestureId"] = m_GestureId;
+	json["m_fRequestTimeout"] = m_fRequestTimeout;
+	json["m_bMergeRequests"] = m_bMergeRequests;
 }
 
 void IGesture::Deserialize(const Json::Value & json)
@@ -32,6 +48,10 @@ void IGesture::Deserialize(const Json::Value & json)
 		m_bEnabled = json["m_bEnabled"].asBool();
 	if ( json["m_GestureId"].isString() )
 		m_GestureId = json["m_GestureId"].asString();
+	if ( json["m_fRequestTimeout"].isNumeric() )
+		m_fRequestTimeout = json["m_fRequestTimeout"].asFloat();
+	if ( json["m_bMergeRequests"].isBool() )
+		m_bMergeRequests = json["m_bMergeRequests"].asBool();
 }
 
 bool IGesture::Start()
@@ -57,3 +77,193 @@ bool IGesture::Abort()
 	return false;
 }
 
+bool IGesture::PushRequest( GestureDelegate a_Callback, const ParamsMap & a_Params )
+{
+	RequestList expired;
+	ExpireRequests( false, expired );
+	CompleteRequests( expired, true );
+
+	RequestPriority ePriority = GetRequestPriority( a_Params );
+	float fTimeout = m_fRequestTimeout;
+	if ( a_Params.GetData().isMember( TIMEOUT_PARAM ) )
+		fTimeout = a_Params[ TIMEOUT_PARAM ].asFloat();
+	double fDeadline = fTimeout > 0.0f ? Time().GetEpochTime() + fTimeout : 0.0;
+
+	if ( m_Requests.begin() == m_Requests.end() )
+	{
+		Request * pRequest = AllocRequest( a_Callback, a_Params );
+		pRequest->m_ePriority = ePriority;
+		pRequest->m_fDeadline = fDeadline;
+		m_Requests.push_back( pRequest );
+		return true;
+	}
+
+	RequestList::iterator iInsert = m_Requests.begin();
+	for( ++iInsert; iInsert != m_Requests.end(); ++iInsert )
+	{
+		Request * pQueued = *iInsert;
+		if ( m_bMergeRequests && pQueued->m_ePriority == ePriority 
+			&& pQueued->m_Params.GetData() == a_Params.GetData() )
+		{
+			// an identical request is already waiting, just complete both when it's done
+			pQueued->m_Merged.push_back( a_Callback );
+			if ( pQueued->m_fDeadline != 0.0 )
+				pQueued->m_fDeadline = fDeadline != 0.0 ? std::max( pQueued->m_fDeadline, fDeadline ) : 0.0;
+			return false;
+		}
+		if ( pQueued->m_ePriority < ePriority )
+			break;
+	}
+
+	Request * pRequest = AllocRequest( a_Callback, a_Params );
+	pRequest->m_ePriority = ePriority;
+	pRequest->m_fDeadline = fDeadline;
+	m_Requests.insert( iInsert, pRequest );
+
+	if ( ePriority == PRIORITY_URGENT && m_Requests.front()->m_ePriority < PRIORITY_URGENT && OnPreempt() )
+	{
+		Log::Debug( "IGesture", "Gesture %s active request preempted.", m_GestureId.c_str() );
+		return PopRequest( true );
+	}
+
+	return false;
+}
+
+bool IGesture::PopRequest( bool a_bError )
+{
+	bool bMore = false;
+	if ( m_Requests.begin() != m_Requests.end() )
+	{
+		RequestList done;
+		done.push_back( m_Requests.front() );
+		m_Requests.pop_front();
+
+		RequestList expired;
+		ExpireRequests( true, expired );
+
+		bMore = m_Requests.begin() != m_Requests.end();
+		CompleteRequests( done, a_bError );
+		CompleteRequests( expired, true );
+	}
+
+	return bMore;
+}
+
+void IGesture::RemoveActiveRequest()
+{
+	if ( m_Requests.begin() != m_Requests.end() )
+	{
+		FreeRequest( m_Requests.front() );
+		m_Requests.pop_front();
+	}
+}
+
+void IGesture::PopAllRequests()
+{
+	for( RequestList::iterator iReq = m_Requests.begin(); iReq != m_Requests.end(); ++iReq )
+		FreeRequest( *iReq );
+	m_Requests.clear();
+}
+
+bool IGesture::OnPreempt()
+{
+	return false;
+}
+
+IGesture::RequestPriority IGesture::GetRequestPriority( const ParamsMap & a_Params )
+{
+	const Json::Value & priority = a_Params[ PRIORITY_PARAM ];
+	if ( priority.isNumeric() )
+		return (RequestPriority)std::max<int>( PRIORITY_LOW, std::min<int>( PRIORITY_URGENT, priority.asInt() ) );
+	if ( priority.isString() )
+	{
+		const std::string & value = priority.asString();
+		if ( StringUtil::Compare( value, "low", true ) == 0 )
+			return PRIORITY_LOW;
+		if ( StringUtil::Compare( value, "high", true ) == 0 )
+			return PRIORITY_HIGH;
+		if ( StringUtil::Compare( value, "urgent", true ) == 0 )
+			return PRIORITY_URGENT;
+	}
+
+	return PRIORITY_NORMAL;
+}
+
+void IGesture::ExpireRequests( bool a_bIncludeActive, RequestList & a_Expired )
+{
+	if ( m_Requests.begin() == m_Requests.end() )
+		return;
+
+	double now = Time().GetEpochTime();
+	RequestList::iterator iReq = m_Requests.begin();
+	if (! a_bIncludeActive )
+		++iReq;
+
+	while( iReq != m_Requests.end() )
+	{
+		Request * pRequest = *iReq;
+		if ( pRequest->m_fDeadline != 0.0 && pRequest->m_fDeadline < now )
+		{
+			Log::Debug( "IGesture", "Gesture %s request expired after waiting in the queue.", m_GestureId.c_str() );
+			a_Expired.push_back( pRequest );
+			m_Requests.erase( iReq++ );
+		}
+		else
+			++iReq;
+	}
+}
+
+void IGesture::CompleteRequests( RequestList & a_Requests, bool a_bError )
+{
+	for( RequestList::iterator iReq = a_Requests.begin(); iReq != a_Requests.end(); ++iReq )
+	{
+		Request * pRequest = *iReq;
+		pRequest->m_bError |= a_bError;
+
+		Result result( this, pRequest->m_bError );
+		if ( pRequest->m_Callback.IsValid() )
+			pRequest->m_Callback( result );
+		for( size_t i=0;i<pRequest->m_Merged.size();++i)
+			if ( pRequest->m_Merged[i].IsValid() )
+				pRequest->m_Merged[i]( result );
+
+		FreeRequest( pRequest );
+	}
+	a_Requests.clear();
+}
+
+IGesture::Request * IGesture::AllocRequest( GestureDelegate a_Callback, const ParamsMap & a_Params )
+{
+	Request * pRequest = NULL;
+	{
+		boost::unique_lock<boost::mutex> lock( sm_RequestPoolLock );
+		if ( sm_RequestPool.size() > 0 )
+		{
+			pRequest = sm_RequestPool.back();
+			sm_RequestPool.pop_back();
+		}
+	}
+
+	if ( pRequest == NULL )
+		pRequest = new Request();
+
+	pRequest->m_Callback = a_Callback;
+	pRequest->m_Params = a_Params;
+	return pRequest;
+}
+
+void IGesture::FreeRequest( Request * a_pRequest )
+{
+	a_pRequest->m_Callback = GestureDelegate();
+	a_pRequest->m_Params = ParamsMap();
+	a_pRequest->m_bError = false;
+	a_pRequest->m_ePriority = PRIORITY_NORMAL;
+	a_pRequest->m_fDeadline = 0.0;
+	a_pRequest->m_Merged.clear();
+
+	boost::unique_lock<boost::mutex> lock( sm_RequestPoolLock );
+	if ( sm_RequestPool.size() < MAX_POOLED_REQUESTS )
+		sm_RequestPool.push_back( a_pRequest );
+	else
+		delete a_pRequest;
+}
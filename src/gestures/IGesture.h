@@ -21,6 +21,9 @@
 
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <list>
+#include <vector>
 
 #include "utils/UniqueID.h"
 #include "utils/ISerializable.h"
@@ -55,13 +58,28 @@ public:
 	};
 	typedef Delegate<const Result &>		GestureDelegate;
 
+	//! Request priority classes, higher priority requests are executed first.
+	enum RequestPriority
+	{
+		PRIORITY_LOW,
+		PRIORITY_NORMAL,
+		PRIORITY_HIGH,
+		PRIORITY_URGENT			// preempts the active request, e.g. a safety stop
+	};
+
+	//! Constants
+	static const char * PRIORITY_PARAM;		//!< name of the request parameter that holds the priority
+	static const char * TIMEOUT_PARAM;		//!< name of the request parameter that holds the seconds a request may wait
+
 
 	//! Construction
-	IGesture() : m_bEnabled( true ), m_GestureId( UniqueID().Get() ), m_Overrides( 0 )
+	IGesture() : m_bEnabled( true ), m_GestureId( UniqueID().Get() ), m_Overrides( 0 ), 
+		m_fRequestTimeout( 0.0f ), m_bMergeRequests( false )
 	{
 		NewGUID();
 	}
-	IGesture( const std::string & a_GestureId ) : m_bEnabled( true ), m_GestureId( a_GestureId ), m_Overrides( 0 )
+	IGesture( const std::string & a_GestureId ) : m_bEnabled( true ), m_GestureId( a_GestureId ), m_Overrides( 0 ),
+		m_fRequestTimeout( 0.0f ), m_bMergeRequests( false )
 	{
 		NewGUID();
 	}
@@ -94,11 +112,18 @@ public:
 	{
 		assert( m_Overrides >= 0 );
 		m_Overrides += 1;
+		sm_StateVersion += 1;
 	}
 	void RemoveOverride( )
 	{
 		assert( m_Overrides > 0 );
 		m_Overrides -= 1;
+		sm_StateVersion += 1;
+	}
+	//! Returns a counter that changes whenever any gesture is overridden or restored
+	static unsigned int GetStateVersion()
+	{
+		return sm_StateVersion;
 	}
 
 	//! Initialize this gesture, if this returns false then GestureManager will not register this gesture.
@@ -116,13 +141,19 @@ protected:
 	//! Types
 	struct Request
 	{
+		Request() : m_bError( false ), m_ePriority( PRIORITY_NORMAL ), m_fDeadline( 0.0 )
+		{}
 		Request( GestureDelegate a_Callback, const ParamsMap & a_Params )
-			: m_Callback( a_Callback ), m_Params( a_Params ), m_bError( false )
+			: m_Callback( a_Callback ), m_Params( a_Params ), m_bError( false ), 
+			m_ePriority( PRIORITY_NORMAL ), m_fDeadline( 0.0 )
 		{}
 
 		GestureDelegate m_Callback;
 		ParamsMap m_Params;
 		bool m_bError;
+		RequestPriority m_ePriority;
+		double m_fDeadline;							// epoch time this request expires if not started, 0 if never
+		std::vector<GestureDelegate> m_Merged;		// callbacks of redundant requests merged into this one
 	};
 	typedef std::list<Request *> RequestList;
 	typedef std::vector< WP >	OverrideList;
@@ -132,6 +163,8 @@ protected:
 	std::string		m_GestureId;
 	int				m_Overrides;
 	RequestList		m_Requests;
+	float			m_fRequestTimeout;		// default number of seconds a request may wait in the queue, 0 for no limit
+	bool			m_bMergeRequests;		// if true, queued requests with identical parameters are merged
 	
 	bool HaveRequests() const
 	{
@@ -145,40 +178,39 @@ protected:
 		return NULL;
 	}
 
-	//! Push a request into the queue, returns true if this is the first active request.
-	bool PushRequest( GestureDelegate a_Callback, const ParamsMap & a_Params )
-	{
-		bool bFirstRequest = m_Requests.begin() == m_Requests.end();
-		m_Requests.push_back( new Request( a_Callback, a_Params ) );
-		return bFirstRequest;
-	}
-
+	//! Push a request into the queue ordered by its priority, returns true if the caller should start 
+	//! the active request. The priority is read from the PRIORITY_PARAM parameter and the number of seconds
+	//! the request may wait from the TIMEOUT_PARAM parameter. An urgent request will preempt the active
+	//! request if OnPreempt() returns true.
+	bool PushRequest( GestureDelegate a_Callback, const ParamsMap & a_Params );
 	//! pops the current active request from the queue, returns true if there are more requests
-	bool PopRequest( bool a_bError = false )
-	{
-		bool bMore = false;
-		if ( m_Requests.begin() != m_Requests.end() )
-		{
-			Request * pRequest = m_Requests.front();
-			m_Requests.pop_front();
-
-			bMore = m_Requests.begin() != m_Requests.end();
-			pRequest->m_bError |= a_bError;
+	bool PopRequest( bool a_bError = false );
+	//! Remove the active request from the queue without invoking its callback.
+	void RemoveActiveRequest();
+	//! Remove all requests without invoking any callbacks.
+	void PopAllRequests();
+	//! This is invoked when an urgent request is pushed, return true if the active request was stopped 
+	//! and should be completed with an error.
+	virtual bool OnPreempt();
+
+	static RequestPriority GetRequestPriority( const ParamsMap & a_Params );
+
+private:
+	//! Types
+	typedef std::vector<Request *>	RequestPool;
 
-			if ( pRequest->m_Callback.IsValid() )
-				pRequest->m_Callback( Result( this, pRequest->m_bError ) );
-			delete pRequest;
-		}
+	//! Data
+	static RequestPool		sm_RequestPool;
+	static boost::mutex		sm_RequestPoolLock;
+	static unsigned int		sm_StateVersion;
 
-		return bMore;
-	}
+	//! Remove any requests that have waited past their deadline, they are appended to the provided list
+	void ExpireRequests( bool a_bIncludeActive, RequestList & a_Expired );
+	//! Invoke the callbacks for the given requests and return them to the pool
+	void CompleteRequests( RequestList & a_Requests, bool a_bError );
 
-	void PopAllRequests()
-	{
-		for( RequestList::iterator iReq = m_Requests.begin(); iReq != m_Requests.end(); ++iReq )
-			delete *iReq;
-		m_Requests.clear();
-	}
+	static Request * AllocRequest( GestureDelegate a_Callback, const ParamsMap & a_Params );
+	static void FreeRequest( Request * a_pRequest );
 };
 
 
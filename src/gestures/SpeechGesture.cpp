@@ -24,11 +24,22 @@ RTTI_IMPL( SpeechGesture, IGesture );
 void SpeechGesture::Serialize(Json::Value & json)
 {
 	IGesture::Serialize( json );
+
+	json["m_bStreaming"] = m_bStreaming;
+	json["m_fJitterBuffer"] = m_fJitterBuffer;
+	json["m_fMaxBuffer"] = m_fMaxBuffer;
 }
 
 void SpeechGesture::Deserialize(const Json::Value & json)
 {
 	IGesture::Deserialize( json );
+
+	if ( json.isMember( "m_bStreaming" ) )
+		m_bStreaming = json["m_bStreaming"].asBool();
+	if ( json.isMember( "m_fJitterBuffer" ) )
+		m_fJitterBuffer = json["m_fJitterBuffer"].asFloat();
+	if ( json.isMember( "m_fMaxBuffer" ) )
+		m_fMaxBuffer = json["m_fMaxBuffer"].asFloat();
 }
 
 bool SpeechGesture::Execute( GestureDelegate a_Callback, const ParamsMap & a_Params )
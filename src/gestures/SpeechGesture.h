@@ -29,10 +29,17 @@ public:
 	RTTI_DECL();
 
 	//! Construction
-	SpeechGesture() 
+	SpeechGesture() : 
+		m_bStreaming( true ),
+		m_fJitterBuffer( 0.25f ),
+		m_fMaxBuffer( 1.0f )
 	{}
 
-	SpeechGesture(const std::string & a_gestureId) : IGesture(a_gestureId)
+	SpeechGesture(const std::string & a_gestureId) : 
+		IGesture(a_gestureId),
+		m_bStreaming( true ),
+		m_fJitterBuffer( 0.25f ),
+		m_fMaxBuffer( 1.0f )
 	{}
 
 	//! ISerializable interface
@@ -42,6 +49,12 @@ public:
 	//! IGesture interface
 	virtual bool Execute( GestureDelegate a_Callback, const ParamsMap & a_Params );
 	virtual bool Abort();
+
+protected:
+	//! Data
+	bool			m_bStreaming;			// if true, play audio as it's received from the TTS service
+	float			m_fJitterBuffer;		// seconds of streamed audio to buffer before playback starts
+	float			m_fMaxBuffer;			// maximum seconds of streamed audio sent ahead of playback
 };
 
 
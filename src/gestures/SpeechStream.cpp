@@ -0,0 +1,312 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include <algorithm>
+#include <vector>
+#include <math.h>
+
+#include "SpeechStream.h"
+#include "utils/Time.h"
+#include "utils/Log.h"
+
+static unsigned int ReadLE( const std::string & a_Data, size_t a_Offset, size_t a_Bytes )
+{
+	unsigned int value = 0;
+	for(size_t i=0;i<a_Bytes;++i)
+		value |= ((unsigned int)(unsigned char)a_Data[a_Offset + i]) << (i * 8);
+	return value;
+}
+
+SpeechStream::SpeechStream( int a_OutputRate,
+	float a_fJitterBuffer,
+	float a_fMaxBuffer,
+	AudioCallback a_AudioCallback,
+	DoneCallback a_DoneCallback ) :
+	m_OutputRate( a_OutputRate ),
+	m_fJitterBuffer( a_fJitterBuffer ),
+	m_fMaxBuffer( a_fMaxBuffer ),
+	m_fPumpInterval( 0.05f ),
+	m_AudioCallback( a_AudioCallback ),
+	m_DoneCallback( a_DoneCallback ),
+	m_bHeaderParsed( false ),
+	m_SourceRate( 22050 ),
+	m_SourceChannels( 1 ),
+	m_SourceBits( 16 ),
+	m_fResamplePos( 0.0 ),
+	m_LastSample( 0 ),
+	m_BufferOffset( 0 ),
+	m_bPlaying( false ),
+	m_bClosed( false ),
+	m_bCancelled( false ),
+	m_bFailed( false ),
+	m_bDone( false ),
+	m_fStartTime( Time().GetEpochTime() ),
+	m_fPlayStart( 0.0 ),
+	m_fFirstAudio( -1.0 ),
+	m_BytesReleased( 0 )
+{
+	if ( m_fMaxBuffer < m_fJitterBuffer )
+		m_fMaxBuffer = m_fJitterBuffer;
+}
+
+SpeechStream::~SpeechStream()
+{
+	m_spPumpTimer.reset();
+}
+
+void SpeechStream::SetSourceFormat( int a_Rate, int a_Channels )
+{
+	m_SourceRate = a_Rate;
+	m_SourceChannels = a_Channels;
+}
+
+void SpeechStream::Start()
+{
+	m_fStartTime = Time().GetEpochTime();
+	if ( TimerPool::Instance() != NULL )
+	{
+		m_spPumpTimer = TimerPool::Instance()->StartTimer(
+			VOID_DELEGATE( SpeechStream, Pump, shared_from_this() ), m_fPumpInterval, true, true );
+	}
+}
+
+void SpeechStream::Cancel()
+{
+	if (! m_bCancelled && !m_bDone )
+	{
+		Log::Debug( "SpeechStream", "Speech cancelled, dropping %.2f seconds of audio.", GetBufferedTime() );
+
+		m_bCancelled = true;
+		m_Buffer.clear();
+		m_BufferOffset = 0;
+		m_spPumpTimer.reset();
+	}
+}
+
+void SpeechStream::OnStreamData( std::string * a_pData )
+{
+	if ( a_pData != NULL )
+		Write( *a_pData );
+	else
+		Close();
+}
+
+void SpeechStream::Write( const std::string & a_Data )
+{
+	if ( m_bCancelled || m_bClosed )
+		return;
+
+	if (! m_bHeaderParsed )
+	{
+		std::string remaining;
+		if (! ParseHeader( a_Data, remaining ) )
+			return;
+		Convert( remaining );
+	}
+	else
+		Convert( a_Data );
+
+	Pump();
+}
+
+void SpeechStream::Close()
+{
+	if ( m_bClosed )
+		return;
+
+	m_bClosed = true;
+	Pump();
+}
+
+void SpeechStream::Pump()
+{
+	if ( m_bCancelled || m_bDone )
+		return;
+
+	// hold a reference, our done callback may release the last one held by our owner..
+	SP spThis( shared_from_this() );
+
+	double now = Time().GetEpochTime();
+	if (! m_bPlaying )
+	{
+		if ( GetBufferedTime() < m_fJitterBuffer && !m_bClosed )
+			return;
+
+		m_bPlaying = true;
+		m_fPlayStart = now;
+	}
+
+	// release only what is due for playback plus our maximum lead, the rest stays in the buffer
+	// so it can be dropped if we are cancelled.
+	size_t allowed = ((size_t)((now - m_fPlayStart + m_fMaxBuffer) * m_OutputRate)) * sizeof(short);
+	size_t available = m_Buffer.size() - m_BufferOffset;
+	if ( allowed > m_BytesReleased && available > 0 )
+		Release( std::min( allowed - m_BytesReleased, available ) );
+
+	if ( m_bClosed && m_BufferOffset >= m_Buffer.size() )
+	{
+		m_bDone = true;
+		m_spPumpTimer.reset();
+
+		if ( m_DoneCallback.IsValid() )
+			m_DoneCallback( this );
+	}
+}
+
+bool SpeechStream::ParseHeader( const std::string & a_Data, std::string & a_Remaining )
+{
+	m_Header += a_Data;
+	if ( m_Header.size() < 12 )
+		return false;
+
+	// no header, this is raw PCM in the format provided by SetSourceFormat()
+	if ( m_Header.compare( 0, 4, "RIFF" ) != 0 )
+	{
+		m_bHeaderParsed = true;
+		a_Remaining.swap( m_Header );
+		return true;
+	}
+
+	size_t offset = 12;
+	while( offset + 8 <= m_Header.size() )
+	{
+		std::string id( m_Header.substr( offset, 4 ) );
+		size_t size = ReadLE( m_Header, offset + 4, 4 );
+
+		if ( id == "fmt " )
+		{
+			if ( offset + 8 + 16 > m_Header.size() )
+				return false;
+
+			m_SourceChannels = ReadLE( m_Header, offset + 10, 2 );
+			m_SourceRate = ReadLE( m_Header, offset + 12, 4 );
+			m_SourceBits = ReadLE( m_Header, offset + 22, 2 );
+		}
+		else if ( id == "data" )
+		{
+			// streamed WAV files have an unknown data size, so just take everything after the header
+			m_bHeaderParsed = true;
+			a_Remaining = m_Header.substr( offset + 8 );
+			m_Header.clear();
+
+			if ( m_SourceBits != 16 || m_SourceChannels < 1 || m_SourceRate <= 0 )
+			{
+				Log::Error( "SpeechStream", "Unsupported audio format, rate: %d, channels: %d, bits: %d",
+					m_SourceRate, m_SourceChannels, m_SourceBits );
+				Fail();
+				return false;
+			}
+			return true;
+		}
+
+		offset += 8 + size + (size & 1);
+	}
+
+	return false;
+}
+
+void SpeechStream::Fail()
+{
+	// close the stream with nothing to play, so our owner still gets the done callback and can move on
+	m_bFailed = true;
+	m_bClosed = true;
+	m_Buffer.clear();
+	m_BufferOffset = 0;
+	m_Partial.clear();
+
+	Pump();
+}
+
+void SpeechStream::Convert( const std::string & a_Data )
+{
+	std::string data;
+	if ( m_Partial.size() > 0 )
+	{
+		data = m_Partial + a_Data;
+		m_Partial.clear();
+	}
+	const std::string & input = data.size() > 0 ? data : a_Data;
+
+	size_t frameSize = m_SourceChannels * sizeof(short);
+	size_t frames = input.size() / frameSize;
+	if ( frames * frameSize < input.size() )
+		m_Partial = input.substr( frames * frameSize );
+	if ( frames == 0 )
+		return;
+
+	// mix down to mono..
+	std::vector<short> samples( frames );
+	for(size_t i=0;i<frames;++i)
+	{
+		int sum = 0;
+		for(int c=0;c<m_SourceChannels;++c)
+			sum += (short)ReadLE( input, (i * m_SourceChannels + c) * sizeof(short), 2 );
+		samples[i] = (short)(sum / m_SourceChannels);
+	}
+
+	// linear resample into the output rate, carrying our position over to the next chunk so the
+	// chunk boundaries don't click.
+	double step = (double)m_SourceRate / m_OutputRate;
+	m_Buffer.reserve( m_Buffer.size() + (size_t)((frames / step) + 1) * sizeof(short) );
+	while( m_fResamplePos <= (double)(frames - 1) )
+	{
+		int i0 = (int)floor( m_fResamplePos );
+		double frac = m_fResamplePos - i0;
+		short a = i0 < 0 ? m_LastSample : samples[i0];
+		short b = (size_t)(i0 + 1) < frames ? samples[i0 + 1] : a;
+		short s = (short)(a + (b - a) * frac);
+
+		m_Buffer += (char)(s & 0xff);
+		m_Buffer += (char)((s >> 8) & 0xff);
+		m_fResamplePos += step;
+	}
+	m_fResamplePos -= frames;
+	m_LastSample = samples[frames - 1];
+}
+
+void SpeechStream::Release( size_t a_Bytes )
+{
+	a_Bytes &= ~((size_t)1);
+	if ( a_Bytes == 0 )
+		return;
+
+	if ( m_fFirstAudio < 0.0 )
+	{
+		m_fFirstAudio = Time().GetEpochTime() - m_fStartTime;
+		Log::Debug( "SpeechStream", "First audio after %.3f seconds.", m_fFirstAudio );
+	}
+
+	std::string audio( m_Buffer.substr( m_BufferOffset, a_Bytes ) );
+	m_BufferOffset += a_Bytes;
+	m_BytesReleased += a_Bytes;
+
+	// compact the buffer once we have played through a good amount of it
+	if ( m_BufferOffset >= m_Buffer.size() )
+	{
+		m_Buffer.clear();
+		m_BufferOffset = 0;
+	}
+	else if ( m_BufferOffset > (size_t)(m_OutputRate * sizeof(short)) )
+	{
+		m_Buffer.erase( 0, m_BufferOffset );
+		m_BufferOffset = 0;
+	}
+
+	if ( m_AudioCallback.IsValid() )
+		m_AudioCallback( audio );
+}
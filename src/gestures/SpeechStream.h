@@ -0,0 +1,136 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#ifndef SELF_SPEECH_STREAM_H
+#define SELF_SPEECH_STREAM_H
+
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "utils/Delegate.h"
+#include "utils/TimerPool.h"
+#include "SelfLib.h"
+
+//! This object receives the chunks of a streaming ITextToSpeech::ToSound() request and plays them
+//! out as they arrive. Each chunk is converted to 16-bit mono PCM at the output rate, then held in a
+//! small jitter buffer that is released at the playback rate, so only a bounded amount of audio is
+//! ever ahead of the listener and Cancel() can stop the speech immediately. This object must be
+//! owned by a SP, all calls are expected on the main thread.
+class SELF_API SpeechStream : public boost::enable_shared_from_this<SpeechStream>
+{
+public:
+	//! Types
+	typedef boost::shared_ptr<SpeechStream>		SP;
+	typedef boost::weak_ptr<SpeechStream>		WP;
+	typedef Delegate<const std::string &>		AudioCallback;
+	typedef Delegate<SpeechStream *>			DoneCallback;
+
+	//! Construction
+	SpeechStream( int a_OutputRate,
+		float a_fJitterBuffer,
+		float a_fMaxBuffer,
+		AudioCallback a_AudioCallback,
+		DoneCallback a_DoneCallback );
+	~SpeechStream();
+
+	//! Accessors
+	int GetOutputRate() const
+	{
+		return m_OutputRate;
+	}
+	bool IsClosed() const
+	{
+		return m_bClosed;
+	}
+	bool IsCancelled() const
+	{
+		return m_bCancelled;
+	}
+	//! Returns true if the stream was closed because the audio could not be played
+	bool IsFailed() const
+	{
+		return m_bFailed;
+	}
+	//! Returns the number of seconds from Start() until the first audio was released, -1 if none yet
+	double GetFirstAudioLatency() const
+	{
+		return m_fFirstAudio;
+	}
+	//! Returns the number of seconds of audio held in the jitter buffer
+	double GetBufferedTime() const
+	{
+		return (double)(m_Buffer.size() - m_BufferOffset) / (m_OutputRate * sizeof(short));
+	}
+
+	//! Set the format to assume when the stream has no WAV header
+	void SetSourceFormat( int a_Rate, int a_Channels );
+	//! Start playback, pass this object's OnStreamData() to ITextToSpeech::ToSound()
+	void Start();
+	//! Stop playback, any buffered audio is dropped and the done callback is NOT invoked.
+	void Cancel();
+
+	//! ITextToSpeech::StreamCallback, a NULL data pointer closes the stream.
+	void OnStreamData( std::string * a_pData );
+	//! Append audio data to this stream, this can be called directly instead of OnStreamData().
+	void Write( const std::string & a_Data );
+	//! Mark the end of the stream, the done callback is invoked once all audio has been released. The done
+	//! callback is also invoked if the audio is in a format we can't play, IsFailed() returns true in that case.
+	void Close();
+	//! Release any audio that is due for playback, this is invoked by our timer.
+	void Pump();
+
+private:
+	//! Data
+	int					m_OutputRate;
+	float				m_fJitterBuffer;		// seconds of audio buffered before playback starts
+	float				m_fMaxBuffer;			// maximum seconds of audio released ahead of playback
+	float				m_fPumpInterval;
+	AudioCallback		m_AudioCallback;
+	DoneCallback		m_DoneCallback;
+
+	bool				m_bHeaderParsed;
+	std::string			m_Header;
+	int					m_SourceRate;
+	int					m_SourceChannels;
+	int					m_SourceBits;
+	std::string			m_Partial;				// partial sample frame left over from the last chunk
+
+	double				m_fResamplePos;			// position of the next output sample in source samples
+	short				m_LastSample;			// last source sample of the previous chunk
+
+	std::string			m_Buffer;				// converted PCM waiting for playback
+	size_t				m_BufferOffset;
+	bool				m_bPlaying;
+	bool				m_bClosed;
+	bool				m_bCancelled;
+	bool				m_bFailed;
+	bool				m_bDone;
+	double				m_fStartTime;
+	double				m_fPlayStart;
+	double				m_fFirstAudio;
+	size_t				m_BytesReleased;
+	TimerPool::ITimer::SP
+						m_spPumpTimer;
+
+	bool ParseHeader( const std::string & a_Data, std::string & a_Remaining );
+	void Convert( const std::string & a_Data );
+	void Release( size_t a_Bytes );
+	void Fail();
+};
+
+#endif //SELF_SPEECH_STREAM_H
@@ -92,12 +92,12 @@ bool TelephonySpeechGesture::Stop()
 
 void TelephonySpeechGesture::Serialize(Json::Value & json)
 {
-	IGesture::Serialize( json );
+	SpeechGesture::Serialize( json );
 }
 
 void TelephonySpeechGesture::Deserialize(const Json::Value & json)
 {
-	IGesture::Deserialize( json );
+	SpeechGesture::Deserialize( json );
 }
 
 bool TelephonySpeechGesture::Execute( GestureDelegate a_Callback, const ParamsMap & a_Params )
@@ -112,7 +112,30 @@ bool TelephonySpeechGesture::Execute( GestureDelegate a_Callback, const ParamsMa
 bool TelephonySpeechGesture::Abort()
 {
 	Log::Debug("TelephonySpeechGesture", "Attempting to abort speech!");
-	return false;
+	if (! m_spStream )
+		return false;
+
+	// barge-in, drop any audio not yet sent and the active request without invoking its callback
+	m_spStream->Cancel();
+	m_spStream.reset();
+
+	RemoveActiveRequest();
+	SelfInstance::GetInstance()->GetSensorManager()->ResumeSensorType(AudioData::GetStaticRTTI().GetName());
+	if ( HaveRequests() )
+		StartSpeech();
+
+	return true;
+}
+
+bool TelephonySpeechGesture::OnPreempt()
+{
+	// only streamed speech can be stopped part way through
+	if (! m_spStream )
+		return false;
+
+	m_spStream->Cancel();
+	m_spStream.reset();
+	return true;
 }
 
 void TelephonySpeechGesture::OnVoices( Voices * a_pVoices )
@@ -152,7 +175,17 @@ void TelephonySpeechGesture::StartSpeech()
 		{
 			// call the service to get the audio data for playing ..
 			pTTS->SetVoice(voice);
-			pTTS->ToSound( text, DELEGATE( TelephonySpeechGesture, OnSpeechData, Sound *, this ) );
+			if ( m_bStreaming )
+			{
+				m_spStream = SpeechStream::SP( new SpeechStream( m_SampleRate, m_fJitterBuffer, m_fMaxBuffer,
+					DELEGATE( TelephonySpeechGesture, OnStreamAudio, const std::string &, this ),
+					DELEGATE( TelephonySpeechGesture, OnStreamDone, SpeechStream *, this ) ) );
+				m_spStream->Start();
+
+				pTTS->ToSound( text, DELEGATE( SpeechStream, OnStreamData, std::string *, m_spStream ) );
+			}
+			else
+				pTTS->ToSound( text, DELEGATE( TelephonySpeechGesture, OnSpeechData, Sound *, this ) );
 			bSuccess = true;
 		}
 		else
@@ -179,6 +212,24 @@ void TelephonySpeechGesture::OnSpeechData( Sound * a_pSound )
 	OnSpeechDone();
 }
 
+void TelephonySpeechGesture::OnStreamAudio( const std::string & a_Audio )
+{
+	m_pTelephony->SendAudioIn( a_Audio );
+}
+
+void TelephonySpeechGesture::OnStreamDone( SpeechStream * a_pStream )
+{
+	if ( m_spStream.get() != a_pStream )
+		return;
+
+	if ( a_pStream->IsFailed() )
+		Log::Error( "TelephonySpeechGesture", "Failed to play streamed speech." );
+	else
+		Log::Debug("TelephonySpeechGesture", "Stream done, first audio after %.3f seconds.", a_pStream->GetFirstAudioLatency() );
+	m_spStream.reset();
+	OnSpeechDone();
+}
+
 void TelephonySpeechGesture::OnSpeechDone()
 {
 	SelfInstance::GetInstance()->GetSensorManager()->ResumeSensorType(AudioData::GetStaticRTTI().GetName());
@@ -20,6 +20,7 @@
 #define TELE_SPEECH_GESTURE_H
 
 #include "gestures/SpeechGesture.h"
+#include "gestures/SpeechStream.h"
 
 
 class Sound;
@@ -53,11 +54,16 @@ public:
 	virtual bool Execute(GestureDelegate a_Callback, const ParamsMap & a_Params);
 	virtual bool Abort();
 
+protected:
+	//! IGesture interface
+	virtual bool OnPreempt();
 
 private:
 	void StartSpeech();
 	void OnVoices(Voices * a_pVoices);
 	void OnSpeechData(Sound * a_pSound);
+	void OnStreamAudio(const std::string & a_Audio);
+	void OnStreamDone(SpeechStream * a_pStream);
 	void WaitOnBuffer();
 	void OnSpeechDone();
 	void ParseAudioData(const std::string & a_Data);
@@ -68,6 +74,7 @@ private:
 	bool				m_bOverride;
 	int 				m_SampleRate;
 	OverrideList		m_Overrides;
+	SpeechStream::SP	m_spStream;
 };
 
 
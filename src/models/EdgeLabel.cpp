@@ -0,0 +1,40 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include "EdgeLabel.h"
+
+StringTable & EdgeLabel::GetTable()
+{
+	static StringTable table;
+	return table;
+}
+
+EdgeLabel::Id EdgeLabel::Intern( const std::string & a_Label )
+{
+	return GetTable().Intern( a_Label );
+}
+
+bool EdgeLabel::Find( const std::string & a_Label, Id & a_Id )
+{
+	return GetTable().Find( a_Label, a_Id );
+}
+
+const std::string & EdgeLabel::GetText( Id a_Id )
+{
+	return GetTable().GetText( a_Id );
+}
@@ -0,0 +1,47 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#ifndef SELF_EDGE_LABEL_H
+#define SELF_EDGE_LABEL_H
+
+#include <string>
+
+#include "utils/StringTable.h"
+#include "SelfLib.h"
+
+//! Edge labels are interned, each distinct label is stored once and edges refer to it by a small integer
+//! id. Vertices bucket their edges by this id so a traversal can go straight to the edges with a given
+//! label. Ids are never released and the empty label is always id 0.
+class SELF_API EdgeLabel
+{
+public:
+	//! Types
+	typedef StringTable::Id		Id;
+
+	//! Get the id for a label, adding the label if it's new.
+	static Id					Intern( const std::string & a_Label );
+	//! Find the id of a label without adding it, returns false if no edge has ever used the label.
+	static bool					Find( const std::string & a_Label, Id & a_Id );
+	//! Get the label for an id.
+	static const std::string &	GetText( Id a_Id );
+
+private:
+	static StringTable &		GetTable();
+};
+
+#endif // SELF_EDGE_LABEL_H
@@ -19,3 +19,26 @@
 #include "IEdge.h"
 
 RTTI_IMPL( IEdge, ISerializable );
+
+void IEdge::SetLabel(const std::string & a_Label)
+{
+	EdgeLabel::Id label = EdgeLabel::Intern( a_Label );
+	m_Properties.Get()["_label"] = a_Label;
+	if ( label == m_LabelId )
+		return;
+
+	// our vertexes keep their edges by label, so move this edge into the bucket for the new label
+	IVertex::SP spSource = m_Source.lock();
+	IVertex::SP spDest = m_Destination.lock();
+	if ( spSource )
+		spSource->RemoveOutEdge( shared_from_this() );
+	if ( spDest )
+		spDest->RemoveInEdge( shared_from_this() );
+
+	m_LabelId = label;
+
+	if ( spSource )
+		spSource->AddOutEdge( shared_from_this() );
+	if ( spDest )
+		spDest->AddInEdge( shared_from_this() );
+}
@@ -52,7 +52,7 @@ public:
 	};
 	typedef DelegateList<const EdgeEvent &>	NotificationList;
 
-	IEdge() : m_pGraph( NULL ), m_Id( LOCAL_ID_CHAR + UniqueID().Get() ), m_fTime( 0.0 )
+	IEdge() : m_pGraph( NULL ), m_Id( LOCAL_ID_CHAR + UniqueID().Get() ), m_LabelId( 0 ), m_fTime( 0.0 )
 	{}
 	virtual ~IEdge()
 	{}
@@ -65,9 +65,12 @@ public:
 	IGraph *			GetGraph() const;
 	const EdgeId &		GetId() const;
 	const std::string & GetLabel() const;
+	EdgeLabel::Id		GetLabelId() const;
 	const Json::Value & GetProperty(const std::string & a_Property) const;
 	const Json::Value & operator[](const std::string & a_Property) const;
 	const PropertyMap & GetProperties() const;
+	const PropertyStore &
+						GetPropertyStore() const;
 	double				GetTime() const;
 	VertexId			GetSourceId() const;
 	IVertex::SP			GetSource() const;
@@ -79,6 +82,9 @@ public:
 	Json::Value &		operator[](const std::string & a_Property);
 	PropertyMap &		GetProperties();
 	void				SetProperties(const PropertyMap & a_Properties );
+	//! Pack the properties back into their compact form. Once asked for, the properties stay expanded until
+	//! this is called, references returned by GetProperties() or GetProperty() are invalid after that.
+	void				CompactProperties();
 
 	NotificationList &	GetNotificationList();					//!< Get the notification list for this vertex, this is invoked when this object modified
 
@@ -86,8 +92,8 @@ protected:
 	//! Data
 	IGraph *			m_pGraph;
 	EdgeId				m_Id;
-	std::string			m_Label;
-	PropertyMap			m_Properties;
+	EdgeLabel::Id		m_LabelId;			// interned label
+	PropertyStore		m_Properties;
 	double				m_fTime;
 	VertexId			m_SourceId;
 	VertexId			m_DestinationId;
@@ -119,20 +125,30 @@ inline const IEdge::EdgeId & IEdge::GetId() const
 
 inline const std::string & IEdge::GetLabel() const
 {
-	return m_Label;
+	return EdgeLabel::GetText( m_LabelId );
+}
+
+inline EdgeLabel::Id IEdge::GetLabelId() const
+{
+	return m_LabelId;
 }
 
 inline const Json::Value & IEdge::GetProperty(const std::string & a_Property) const
 {
-	return m_Properties[ a_Property ];
+	return m_Properties.Get()[ a_Property ];
 }
 
 inline const Json::Value & IEdge::operator[]( const std::string & a_Property ) const
 {
-	return m_Properties[ a_Property ];
+	return m_Properties.Get()[ a_Property ];
 }
 
 inline const IEdge::PropertyMap & IEdge::GetProperties() const
+{
+	return m_Properties.Get();
+}
+
+inline const PropertyStore & IEdge::GetPropertyStore() const
 {
 	return m_Properties;
 }
@@ -175,35 +191,34 @@ inline void IEdge::SetId(const EdgeId & a_Id)
 
 inline Json::Value & IEdge::GetProperty(const std::string & a_Property) 
 {
-	return m_Properties[ a_Property ];
+	return m_Properties.Get()[ a_Property ];
 }
 
 inline Json::Value & IEdge::operator[]( const std::string & a_Property ) 
 {
-	return m_Properties[ a_Property ];
+	return m_Properties.Get()[ a_Property ];
 }
 
 inline IEdge::PropertyMap & IEdge::GetProperties()
 {
-	return m_Properties;
+	return m_Properties.Get();
 }
 
 inline void IEdge::SetProperties( const PropertyMap & a_Properties )
 {
-	m_Properties = a_Properties;
-	m_Properties["_label"] = m_Label;		// restore the label property
+	m_Properties.Set( a_Properties );
+	m_Properties.Get()["_label"] = GetLabel();		// restore the label property
 	m_NotificationList.Invoke( EdgeEvent( E_MODIFIED, shared_from_this() ) );
 }
 
-inline IEdge::NotificationList & IEdge::GetNotificationList()
+inline void IEdge::CompactProperties()
 {
-	return m_NotificationList;
+	m_Properties.Compact();
 }
 
-inline void IEdge::SetLabel(const std::string & a_Label)
+inline IEdge::NotificationList & IEdge::GetNotificationList()
 {
-	m_Label = a_Label;
-	m_Properties["_label"] = a_Label;
+	return m_NotificationList;
 }
 
 inline void IEdge::SetTime( double a_fTime )
@@ -53,6 +53,7 @@ public:
 
 	typedef Delegate<IGraph::SP>						OnGraphConnected;
 	typedef Delegate<IGraph::SP>						OnGraphLoaded;
+	typedef Delegate<bool>								OnGraphClosed;
 	typedef Delegate<const IVertex::VertexEvent &>		VertexEvent;
 	typedef Delegate<const IEdge::EdgeEvent &>			EdgeEvent;
 
@@ -74,11 +75,15 @@ public:
 
 	const std::string & GetGraphId() const { return m_GraphId; }
 	void SetGraphId( const std::string & a_GraphId ) { m_GraphId = a_GraphId; }
+	//! Subscribers to this list are notified when any vertex is saved into this graph, including
+	//! vertexes merged in from a remote graph.
+	IVertex::NotificationList & GetVertexNotifications() { return m_VertexNotifications; }
 
 	//! Load the local storage for this graph, it is ready to be queried but all queries 
 	//! will be against the local graph only until Connect() is invoked.
 	virtual bool		Load( OnGraphLoaded a_Callback ) = 0;
-	//! Connect this graph to remote storage via the provided service.
+	//! Connect this graph to remote storage via the provided service. The callback is invoked once
+	//! connected, or with a NULL graph if the remote graph could not be created.
 	virtual bool		Connect( OnGraphConnected a_Callback,
 							const std::string & a_ServiceId = "GraphV1" ) = 0;
 	//! Import a graph from the provided JSON
@@ -87,10 +92,11 @@ public:
 	virtual bool		Export( Json::Value & a_Export ) = 0;
 	//! Wipe all data from this graph.
 	virtual void		Clear() = 0;
-	//! Disconnect this graph from remote & local storage.
-	virtual bool		Close() = 0;
-	//! Close and destroy this graph from storage.
-	virtual bool		Drop() = 0;
+	//! Disconnect this graph from remote & local storage. This returns right away, the callback is
+	//! invoked once all pending operations are done and the storage is closed.
+	virtual bool		Close( OnGraphClosed a_Callback = OnGraphClosed() ) = 0;
+	//! Close and destroy this graph from storage, the callback is invoked once it's done.
+	virtual bool		Drop( OnGraphClosed a_Callback = OnGraphClosed() ) = 0;
 
 	//! Set the current model, any created vertex will be associated with this model within the graph.
 	virtual void		SetModel( const std::string & a_Model ) = 0;
@@ -118,6 +124,8 @@ public:
 
 protected:
 	std::string			m_GraphId;
+	IVertex::NotificationList
+						m_VertexNotifications;
 
 	friend class ITraverser;
 };
@@ -29,6 +29,12 @@ void ITraverser::Serialize(Json::Value & json)
 		json["m_spCondition"] = ISerializable::SerializeObject(m_spCondition.get());
 	if (m_spNext)
 		json["m_spNext"] = ISerializable::SerializeObject(m_spNext.get());
+	if (m_Limit > 0)
+		json["m_Limit"] = (Json::UInt)m_Limit;
+	if (m_Offset > 0)
+		json["m_Offset"] = (Json::UInt)m_Offset;
+	if (m_BatchSize > 0)
+		json["m_BatchSize"] = (Json::UInt)m_BatchSize;
 }
 
 void ITraverser::Deserialize(const Json::Value & json)
@@ -37,5 +43,11 @@ void ITraverser::Deserialize(const Json::Value & json)
 		m_spCondition = IConditional::SP(ISerializable::DeserializeObject<IConditional>(json["m_spCondition"]));
 	if (json.isMember("m_spNext"))
 		m_spNext = ITraverser::SP(ISerializable::DeserializeObject<ITraverser>(json["m_spNext"]));
+	if (json.isMember("m_Limit"))
+		m_Limit = json["m_Limit"].asUInt();
+	if (json.isMember("m_Offset"))
+		m_Offset = json["m_Offset"].asUInt();
+	if (json.isMember("m_BatchSize"))
+		m_BatchSize = json["m_BatchSize"].asUInt();
 }
 
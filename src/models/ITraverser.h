@@ -54,10 +54,18 @@ public:
 
 	//! Construction
 	ITraverser() : 
-		m_pGraph( NULL )
+		m_pGraph( NULL ),
+		m_Limit( 0 ),
+		m_Offset( 0 ),
+		m_BatchSize( 0 ),
+		m_bDone( false )
 	{}
 	ITraverser(const Condition & a_Condition, const SP & a_spNext) :
 		m_pGraph( a_spNext ? a_spNext->m_pGraph : NULL),
+		m_Limit( 0 ),
+		m_Offset( 0 ),
+		m_BatchSize( 0 ),
+		m_bDone( false ),
 		m_spNext(a_spNext),
 		m_spCondition(a_Condition.Clone())
 	{}
@@ -76,6 +84,14 @@ public:
 	size_t				Size() const;							//!< Returns the size of the results
 	IVertex::SP			GetResult( size_t i ) const;			//!< Get a result by index
 	IVertex::SP 		operator[](size_t n) const;				//!< Help function to access the results
+	size_t				GetLimit() const;						//!< Maximum number of results, 0 if there is no limit
+	size_t				GetOffset() const;						//!< Number of results skipped before the first result
+	size_t				GetBatchSize() const;					//!< Number of results given to each callback, 0 for all of them
+	bool				IsDone() const;							//!< True once the last results have been given to the callback
+
+	//! Mutators
+	void				SetLimit( size_t a_Limit, size_t a_Offset = 0 );
+	void				SetBatchSize( size_t a_BatchSize );
 
 	//! Interface
 	virtual bool		Export( Json::Value & a_Export ) = 0;	//!< Export this traverser into JSON
@@ -84,13 +100,18 @@ public:
 	virtual SP			In(const Condition & a_spCond = NULL_CONDITION) = 0;		//!< Get all vertexes with an in edge that meets the provided conditions
 
 	//! Traverse the graph and invoke the provided callback once the search is completed. Since traverse
-	//! make take some time to complete, this call is asynchronous.
+	//! make take some time to complete, this call is asynchronous. If a batch size is set, the callback is
+	//! invoked for each batch of results instead, GetResults() holds just that batch and IsDone() is true for the last one.
 	virtual bool	Start(TraverseCallback a_Callback ) = 0;
 
 protected:
 	//! Data
 	IGraph *		m_pGraph;						// pointer to the owning graph object
 	VertextList		m_Results;						// vector of the results
+	size_t			m_Limit;
+	size_t			m_Offset;
+	size_t			m_BatchSize;
+	bool			m_bDone;
 
 	SP				m_spNext;
 	Condition::SP	m_spCondition;
@@ -132,6 +153,37 @@ inline IVertex::SP ITraverser::operator [](size_t i ) const
 	return GetResult( i );
 }
 
+inline size_t ITraverser::GetLimit() const
+{
+	return m_Limit;
+}
+
+inline size_t ITraverser::GetOffset() const
+{
+	return m_Offset;
+}
+
+inline size_t ITraverser::GetBatchSize() const
+{
+	return m_BatchSize;
+}
+
+inline bool ITraverser::IsDone() const
+{
+	return m_bDone;
+}
+
+inline void ITraverser::SetLimit( size_t a_Limit, size_t a_Offset /*= 0*/ )
+{
+	m_Limit = a_Limit;
+	m_Offset = a_Offset;
+}
+
+inline void ITraverser::SetBatchSize( size_t a_BatchSize )
+{
+	m_BatchSize = a_BatchSize;
+}
+
 inline void ITraverser::SetGraph( IGraph * a_pGraph)
 {
 	m_pGraph = a_pGraph;
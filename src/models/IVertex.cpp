@@ -29,13 +29,10 @@ bool IVertex::SortEdges( const EdgeSP & a1, const EdgeSP & a2 )
 bool IVertex::FindOutEdges( const std::string & a_EdgeLabel, 
 	EdgeList & a_Edges )
 {
-	for( size_t i=0;i<m_OutEdges.size(); ++i)
-	{
-		const IEdge::SP & spEdge = m_OutEdges[i];
-		if ( spEdge->GetLabel().compare( a_EdgeLabel ) != 0 )
-			continue;
-		a_Edges.push_back( spEdge );
-	}
+	EdgeLabel::Id label = 0;
+	const EdgeList * pEdges = EdgeLabel::Find( a_EdgeLabel, label ) ? GetOutEdges( label ) : NULL;
+	if ( pEdges != NULL )
+		a_Edges.insert( a_Edges.end(), pEdges->begin(), pEdges->end() );
 
 	std::sort( a_Edges.begin(), a_Edges.end(), SortEdges );
 	return a_Edges.size() > 0;
@@ -44,14 +41,93 @@ bool IVertex::FindOutEdges( const std::string & a_EdgeLabel,
 bool IVertex::FindInEdges( const std::string & a_EdgeLabel,
 	EdgeList & a_Edges )
 {
-	for( size_t i=0;i<m_InEdges.size(); ++i)
+	EdgeLabel::Id label = 0;
+	const EdgeList * pEdges = EdgeLabel::Find( a_EdgeLabel, label ) ? GetInEdges( label ) : NULL;
+	if ( pEdges != NULL )
+		a_Edges.insert( a_Edges.end(), pEdges->begin(), pEdges->end() );
+
+	std::sort( a_Edges.begin(), a_Edges.end(), SortEdges );
+	return a_Edges.size() > 0;
+}
+
+void IVertex::GetInEdges( EdgeList & a_Edges ) const
+{
+	for(size_t i=0;i<m_InEdges.size();++i)
+		a_Edges.insert( a_Edges.end(), m_InEdges[i].m_Edges.begin(), m_InEdges[i].m_Edges.end() );
+}
+
+void IVertex::GetOutEdges( EdgeList & a_Edges ) const
+{
+	for(size_t i=0;i<m_OutEdges.size();++i)
+		a_Edges.insert( a_Edges.end(), m_OutEdges[i].m_Edges.begin(), m_OutEdges[i].m_Edges.end() );
+}
+
+const IVertex::EdgeList * IVertex::FindBucket( const EdgeBucketList & a_Buckets, EdgeLabel::Id a_Label )
+{
+	// vertices have edges with only a few different labels, so a linear search is fastest
+	for(size_t i=0;i<a_Buckets.size();++i)
+		if ( a_Buckets[i].m_Label == a_Label )
+			return &a_Buckets[i].m_Edges;
+	return NULL;
+}
+
+void IVertex::AddToBucket( EdgeBucketList & a_Buckets, const EdgeSP & a_spEdge )
+{
+	EdgeLabel::Id label = a_spEdge->GetLabelId();
+	for(size_t i=0;i<a_Buckets.size();++i)
 	{
-		const IEdge::SP & spEdge = m_InEdges[i];
-		if ( spEdge->GetLabel().compare( a_EdgeLabel ) != 0 )
+		if ( a_Buckets[i].m_Label == label )
+		{
+			a_Buckets[i].m_Edges.push_back( a_spEdge );
+			return;
+		}
+	}
+
+	a_Buckets.push_back( EdgeBucket( label ) );
+	a_Buckets.back().m_Edges.push_back( a_spEdge );
+}
+
+bool IVertex::RemoveFromBucket( EdgeBucketList & a_Buckets, const EdgeSP & a_spEdge )
+{
+	EdgeLabel::Id label = a_spEdge->GetLabelId();
+	for(size_t i=0;i<a_Buckets.size();++i)
+	{
+		if ( a_Buckets[i].m_Label != label )
 			continue;
-		a_Edges.push_back( spEdge );
+
+		EdgeList & edges = a_Buckets[i].m_Edges;
+		for(size_t k=0;k<edges.size();++k)
+		{
+			if ( edges[k] == a_spEdge )
+			{
+				edges.erase( edges.begin() + k );
+				if ( edges.size() == 0 )
+					a_Buckets.erase( a_Buckets.begin() + i );
+				return true;
+			}
+		}
+		break;
 	}
 
-	std::sort( a_Edges.begin(), a_Edges.end(), SortEdges );
-	return a_Edges.size() > 0;
+	return false;
+}
+
+void IVertex::AddInEdge( const EdgeSP & a_spEdge )
+{
+	AddToBucket( m_InEdges, a_spEdge );
+}
+
+bool IVertex::RemoveInEdge( const EdgeSP & a_spEdge )
+{
+	return RemoveFromBucket( m_InEdges, a_spEdge );
+}
+
+void IVertex::AddOutEdge( const EdgeSP & a_spEdge )
+{
+	AddToBucket( m_OutEdges, a_spEdge );
+}
+
+bool IVertex::RemoveOutEdge( const EdgeSP & a_spEdge )
+{
+	return RemoveFromBucket( m_OutEdges, a_spEdge );
 }
@@ -25,6 +25,8 @@
 #include "utils/UniqueID.h"
 #include "utils/Delegate.h"
 
+#include "EdgeLabel.h"
+#include "PropertyStore.h"
 #include "SelfLib.h"
 
 class IEdge;			// forward declare
@@ -47,6 +49,17 @@ public:
 	typedef boost::weak_ptr<IVertex>			WP;
 	typedef boost::shared_ptr<IEdge>			EdgeSP;
 	typedef std::vector< EdgeSP >				EdgeList;
+
+	//! edges of a vertex are kept in a bucket for each label
+	struct EdgeBucket
+	{
+		EdgeBucket( EdgeLabel::Id a_Label = 0 ) : m_Label( a_Label )
+		{}
+
+		EdgeLabel::Id		m_Label;
+		EdgeList			m_Edges;
+	};
+	typedef std::vector< EdgeBucket >			EdgeBucketList;
 	typedef std::string							VertexId;
 	typedef Json::Value							PropertyMap;
 
@@ -84,15 +97,29 @@ public:
 	const Json::Value & GetProperty(const std::string & a_Property) const;
 	const Json::Value & operator[](const std::string & a_Property) const;
 	const PropertyMap & GetProperties() const;
+	const PropertyStore &
+						GetPropertyStore() const;
 	double				GetTime() const;
-	const EdgeList &	GetInEdges() const;
-	const EdgeList &	GetOutEdges() const;
+	const EdgeBucketList &
+						GetInBuckets() const;
+	const EdgeBucketList &
+						GetOutBuckets() const;
+	//! Get the in/out edges with the given label, returns NULL if this vertex has none
+	const EdgeList *	GetInEdges( EdgeLabel::Id a_Label ) const;
+	const EdgeList *	GetOutEdges( EdgeLabel::Id a_Label ) const;
+	//! Get all in/out edges of this vertex
+	void				GetInEdges( EdgeList & a_Edges ) const;
+	void				GetOutEdges( EdgeList & a_Edges ) const;
+	bool				HasEdges() const;
 
 	//! Mutators
 	Json::Value &		GetProperty(const std::string & a_Property);
 	Json::Value &		operator[](const std::string & a_Property);
 	PropertyMap &		GetProperties();
 	void				SetProperties(const PropertyMap & a_Properties );
+	//! Pack the properties back into their compact form. Once asked for, the properties stay expanded until
+	//! this is called, references returned by GetProperties() or GetProperty() are invalid after that.
+	void				CompactProperties();
 
 	NotificationList &	GetNotificationList();									//!< Get the notification list for this vertex, this is invoked when this object modified
 
@@ -121,11 +148,11 @@ protected:
 	//! Data
 	VertexId			m_Id;				// Id of this vertex in the graph
 	std::string			m_Label;			// vertex label
-	PropertyMap			m_Properties;		// properties of this vertex
+	PropertyStore		m_Properties;		// properties of this vertex, packed until someone asks for them
 	double				m_fTime;			// last time this vertex was touched
 
-	EdgeList			m_InEdges;
-	EdgeList			m_OutEdges;
+	EdgeBucketList		m_InEdges;			// by edge label
+	EdgeBucketList		m_OutEdges;
 	IGraph *			m_pGraph;			// the graph this vertex belongs
 	NotificationList	m_NotificationList;
 
@@ -134,6 +161,11 @@ protected:
 	void				SetLabel(const std::string & a_label );
 	void				SetTime(double a_fTime);
 
+	static const EdgeList *
+						FindBucket( const EdgeBucketList & a_Buckets, EdgeLabel::Id a_Label );
+	static void			AddToBucket( EdgeBucketList & a_Buckets, const EdgeSP & a_spEdge );
+	static bool			RemoveFromBucket( EdgeBucketList & a_Buckets, const EdgeSP & a_spEdge );
+
 	void				AddInEdge(const EdgeSP & a_spEdge);
 	bool				RemoveInEdge(const EdgeSP & a_spEdge);
 	void				AddOutEdge(const EdgeSP & a_spEdge);
@@ -160,15 +192,20 @@ inline const std::string & IVertex::GetLabel() const
 
 inline const Json::Value & IVertex::GetProperty(const std::string & a_Property) const
 {
-	return m_Properties[ a_Property ];
+	return m_Properties.Get()[ a_Property ];
 }
 
 inline const Json::Value & IVertex::operator[]( const std::string & a_Property ) const
 {
-	return m_Properties[ a_Property ];
+	return m_Properties.Get()[ a_Property ];
 }
 
 inline const IVertex::PropertyMap & IVertex::GetProperties() const
+{
+	return m_Properties.Get();
+}
+
+inline const PropertyStore & IVertex::GetPropertyStore() const
 {
 	return m_Properties;
 }
@@ -178,16 +215,31 @@ inline double IVertex::GetTime() const
 	return m_fTime;
 }
 
-inline const IVertex::EdgeList & IVertex::GetInEdges() const
+inline const IVertex::EdgeBucketList & IVertex::GetInBuckets() const
 {
 	return m_InEdges;
 }
 
-inline const IVertex::EdgeList & IVertex::GetOutEdges() const
+inline const IVertex::EdgeBucketList & IVertex::GetOutBuckets() const
 {
 	return m_OutEdges;
 }
 
+inline const IVertex::EdgeList * IVertex::GetInEdges( EdgeLabel::Id a_Label ) const
+{
+	return FindBucket( m_InEdges, a_Label );
+}
+
+inline const IVertex::EdgeList * IVertex::GetOutEdges( EdgeLabel::Id a_Label ) const
+{
+	return FindBucket( m_OutEdges, a_Label );
+}
+
+inline bool IVertex::HasEdges() const
+{
+	return m_InEdges.size() > 0 || m_OutEdges.size() > 0;
+}
+
 inline void IVertex::SetGraph(IGraph * a_pGraph)
 {
 	m_pGraph = a_pGraph;
@@ -202,31 +254,36 @@ inline void IVertex::SetId( const VertexId & a_Id )
 inline void IVertex::SetLabel(const std::string & a_label )
 {
 	m_Label = a_label;
-	m_Properties["_label"] = a_label;		// keep stored in properties as well
+	m_Properties.Get()["_label"] = a_label;		// keep stored in properties as well
 }
 
 inline Json::Value & IVertex::GetProperty(const std::string & a_Property) 
 {
-	return m_Properties[ a_Property ];
+	return m_Properties.Get()[ a_Property ];
 }
 
 inline Json::Value & IVertex::operator[]( const std::string & a_Property )
 {
-	return m_Properties[ a_Property ];
+	return m_Properties.Get()[ a_Property ];
 }
 
 inline IVertex::PropertyMap & IVertex::GetProperties()
 {
-	return m_Properties;
+	return m_Properties.Get();
 }
 
 inline void IVertex::SetProperties( const PropertyMap & a_Properties )
 {
-	m_Properties = a_Properties;
-	m_Properties["_label"] = m_Label;
+	m_Properties.Set( a_Properties );
+	m_Properties.Get()["_label"] = m_Label;
 	m_NotificationList.Invoke( VertexEvent(E_MODIFIED,shared_from_this()) );
 }
 
+inline void IVertex::CompactProperties()
+{
+	m_Properties.Compact();
+}
+
 inline IVertex::NotificationList & IVertex::GetNotificationList() 
 {
 	return m_NotificationList;
@@ -237,42 +294,4 @@ inline void IVertex::SetTime(double a_fTime)
 	m_fTime = a_fTime;
 }
 
-inline void IVertex::AddInEdge( const EdgeSP & a_spEdge )
-{
-	m_InEdges.push_back( a_spEdge );
-}
-
-inline bool IVertex::RemoveInEdge( const EdgeSP & a_spEdge )
-{
-	for(size_t i=0;i<m_InEdges.size();++i)
-	{
-		if ( m_InEdges[i] == a_spEdge )
-		{
-			m_InEdges.erase( m_InEdges.begin() + i );
-			return true;
-		}
-	}
-
-	return false;
-}
-
-inline void IVertex::AddOutEdge( const EdgeSP & a_spEdge )
-{
-	m_OutEdges.push_back( a_spEdge );
-}
-
-inline bool IVertex::RemoveOutEdge( const EdgeSP & a_spEdge )
-{
-	for(size_t i=0;i<m_OutEdges.size();++i)
-	{
-		if ( m_OutEdges[i] == a_spEdge )
-		{
-			m_OutEdges.erase( m_OutEdges.begin() + i );
-			return true;
-		}
-	}
-
-	return false;
-}
-
 #endif
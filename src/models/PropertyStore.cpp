@@ -0,0 +1,291 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include <string.h>
+
+#include "PropertyStore.h"
+#include "utils/Log.h"
+
+PropertyStore::PropertyStore() : m_pExpanded( NULL )
+{}
+
+PropertyStore::PropertyStore( const PropertyStore & a_Copy ) : 
+	m_Packed( a_Copy.m_Packed ),
+	m_pExpanded( a_Copy.m_pExpanded != NULL ? new Json::Value( *a_Copy.m_pExpanded ) : NULL )
+{}
+
+PropertyStore::~PropertyStore()
+{
+	delete m_pExpanded;
+}
+
+PropertyStore & PropertyStore::operator=( const PropertyStore & a_Copy )
+{
+	if ( this != &a_Copy )
+	{
+		m_Packed = a_Copy.m_Packed;
+		delete m_pExpanded;
+		m_pExpanded = a_Copy.m_pExpanded != NULL ? new Json::Value( *a_Copy.m_pExpanded ) : NULL;
+	}
+	return *this;
+}
+
+bool PropertyStore::Find( const std::string & a_Key, Json::Value & a_Value ) const
+{
+	if ( m_pExpanded != NULL )
+	{
+		if (! m_pExpanded->isObject() || !m_pExpanded->isMember( a_Key ) )
+			return false;
+		a_Value = (*m_pExpanded)[ a_Key ];
+		return true;
+	}
+
+	KeyId find = 0;
+	if (! GetKeys().Find( a_Key, find ) )
+		return false;			// no property has ever used this key
+
+	size_t offset = 0;
+	KeyId key = 0;
+	while( offset < m_Packed.size() )
+	{
+		// peek at the key, so we only decode the value we are looking for
+		if ( offset + sizeof(KeyId) > m_Packed.size() )
+			break;
+		memcpy( &key, m_Packed.data() + offset, sizeof(key) );
+		if (! ReadEntry( m_Packed, offset, key, key == find ? &a_Value : NULL ) )
+			break;
+		if ( key == find )
+			return true;
+	}
+
+	return false;
+}
+
+void PropertyStore::GetJson( Json::Value & a_Properties ) const
+{
+	if ( m_pExpanded != NULL )
+		a_Properties = *m_pExpanded;
+	else
+		Unpack( m_Packed, a_Properties );
+}
+
+Json::Value PropertyStore::GetJson() const
+{
+	Json::Value properties;
+	GetJson( properties );
+	return properties;
+}
+
+void PropertyStore::Set( const Json::Value & a_Properties )
+{
+	if ( m_pExpanded != NULL )
+		*m_pExpanded = a_Properties;
+	else
+		m_pExpanded = new Json::Value( a_Properties );
+	m_Packed.clear();
+}
+
+bool PropertyStore::Compact()
+{
+	if ( m_pExpanded == NULL )
+		return true;
+	if (! m_pExpanded->isObject() && !m_pExpanded->isNull() )
+		return false;
+
+	std::string packed;
+	Pack( *m_pExpanded, packed );
+	m_Packed.swap( packed );
+
+	delete m_pExpanded;
+	m_pExpanded = NULL;
+	return true;
+}
+
+PropertyStore::KeyId PropertyStore::InternKey( const std::string & a_Key )
+{
+	return GetKeys().Intern( a_Key );
+}
+
+void PropertyStore::Expand() const
+{
+	m_pExpanded = new Json::Value();
+	Unpack( m_Packed, *m_pExpanded );
+}
+
+StringTable & PropertyStore::GetKeys()
+{
+	static StringTable keys;
+	return keys;
+}
+
+void PropertyStore::Pack( const Json::Value & a_Properties, std::string & a_Packed )
+{
+	if (! a_Properties.isObject() )
+		return;
+
+	for( Json::ValueConstIterator iProp = a_Properties.begin(); iProp != a_Properties.end(); ++iProp )
+	{
+		const Json::Value & value = *iProp;
+
+		KeyId key = InternKey( iProp.name() );
+		a_Packed.append( (const char *)&key, sizeof(key) );
+
+		if ( value.isBool() )
+			a_Packed += (char)(value.asBool() ? VT_TRUE : VT_FALSE);
+		else if ( value.type() == Json::intValue && value.isInt() )
+		{
+			int n = value.asInt();
+			a_Packed += (char)VT_INT;
+			a_Packed.append( (const char *)&n, sizeof(n) );
+		}
+		else if ( value.type() == Json::uintValue && value.isUInt() )
+		{
+			unsigned int n = value.asUInt();
+			a_Packed += (char)VT_UINT;
+			a_Packed.append( (const char *)&n, sizeof(n) );
+		}
+		else if ( value.isNumeric() )
+		{
+			// reals, and any integers too large for 32 bits
+			double d = value.asDouble();
+			a_Packed += (char)VT_REAL;
+			a_Packed.append( (const char *)&d, sizeof(d) );
+		}
+		else if ( value.isString() || value.isArray() || value.isObject() )
+		{
+			std::string text;
+			if ( value.isString() )
+			{
+				text = value.asString();
+				a_Packed += (char)VT_STRING;
+			}
+			else
+			{
+				text = Json::FastWriter().write( value );
+				if ( text.size() > 0 && text[ text.size() - 1 ] == '\n' )
+					text.resize( text.size() - 1 );
+				a_Packed += (char)VT_JSON;
+			}
+
+			unsigned int length = (unsigned int)text.size();
+			a_Packed.append( (const char *)&length, sizeof(length) );
+			a_Packed.append( text );
+		}
+		else
+			a_Packed += (char)VT_NULL;
+	}
+}
+
+void PropertyStore::Unpack( const std::string & a_Packed, Json::Value & a_Properties )
+{
+	a_Properties = a_Packed.empty() ? Json::Value() : Json::Value( Json::objectValue );
+
+	size_t offset = 0;
+	KeyId key = 0;
+	Json::Value value;
+	while( offset < a_Packed.size() )
+	{
+		if (! ReadEntry( a_Packed, offset, key, &value ) )
+		{
+			Log::Error( "PropertyStore", "Packed properties are corrupted at offset %u", (unsigned int)offset );
+			break;
+		}
+		a_Properties[ GetKeys().GetText( key ) ] = value;
+	}
+}
+
+bool PropertyStore::ReadEntry( const std::string & a_Packed, size_t & a_Offset, 
+	KeyId & a_Key, Json::Value * a_pValue )
+{
+	const char * pData = a_Packed.data();
+	size_t size = a_Packed.size();
+	if ( a_Offset + sizeof(KeyId) + 1 > size )
+		return false;
+
+	memcpy( &a_Key, pData + a_Offset, sizeof(KeyId) );
+	unsigned char type = (unsigned char)pData[ a_Offset + sizeof(KeyId) ];
+	size_t offset = a_Offset + sizeof(KeyId) + 1;
+
+	switch( type )
+	{
+	case VT_NULL:
+		if ( a_pValue != NULL )
+			*a_pValue = Json::Value();
+		break;
+	case VT_TRUE:
+	case VT_FALSE:
+		if ( a_pValue != NULL )
+			*a_pValue = type == VT_TRUE;
+		break;
+	case VT_INT:
+	case VT_UINT:
+		{
+			if ( offset + sizeof(int) > size )
+				return false;
+			if ( a_pValue != NULL )
+			{
+				int n = 0;
+				unsigned int u = 0;
+				memcpy( &n, pData + offset, sizeof(n) );
+				memcpy( &u, pData + offset, sizeof(u) );
+				*a_pValue = type == VT_INT ? Json::Value( n ) : Json::Value( u );
+			}
+			offset += sizeof(int);
+		}
+		break;
+	case VT_REAL:
+		{
+			if ( offset + sizeof(double) > size )
+				return false;
+			if ( a_pValue != NULL )
+			{
+				double d = 0.0;
+				memcpy( &d, pData + offset, sizeof(d) );
+				*a_pValue = d;
+			}
+			offset += sizeof(double);
+		}
+		break;
+	case VT_STRING:
+	case VT_JSON:
+		{
+			unsigned int length = 0;
+			if ( offset + sizeof(length) > size )
+				return false;
+			memcpy( &length, pData + offset, sizeof(length) );
+			offset += sizeof(length);
+			if ( length > size - offset )
+				return false;
+
+			if ( a_pValue != NULL )
+			{
+				if ( type == VT_STRING )
+					*a_pValue = std::string( pData + offset, length );
+				else if (! Json::Reader( Json::Features::strictMode() ).parse( pData + offset, pData + offset + length, *a_pValue ) )
+					return false;
+			}
+			offset += length;
+		}
+		break;
+	default:
+		return false;
+	}
+
+	a_Offset = offset;
+	return true;
+}
@@ -0,0 +1,126 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#ifndef SELF_PROPERTY_STORE_H
+#define SELF_PROPERTY_STORE_H
+
+#include <string>
+
+#include "utils/StringTable.h"
+#include "utils/ISerializable.h"
+#include "SelfLib.h"
+
+//! Compact storage for the properties of a vertex or edge. The properties are packed into a single buffer of
+//! interned keys and typed values, a Json::Value is only built when a caller asks for the properties and it's
+//! kept until it's released by Compact(), so references into it stay valid until then. A Json::Value object costs a map node and a key allocation per property, which
+//! adds up quickly on a graph with many vertices.
+class SELF_API PropertyStore
+{
+public:
+	//! Types
+	typedef StringTable::Id		KeyId;
+
+	//! Construction
+	PropertyStore();
+	PropertyStore( const PropertyStore & a_Copy );
+	~PropertyStore();
+
+	PropertyStore &		operator=( const PropertyStore & a_Copy );
+
+	//! Accessors
+	bool				IsNull() const;
+	bool				IsExpanded() const;
+	size_t				GetPackedSize() const;
+	//! Read a single property without expanding, returns false if there is no property with the given key.
+	bool				Find( const std::string & a_Key, Json::Value & a_Value ) const;
+	//! Get the properties as json, they are built from the packed data if needed.
+	const Json::Value &	Get() const;
+	//! Copy the properties into the given json, this doesn't keep the properties expanded.
+	void				GetJson( Json::Value & a_Properties ) const;
+	Json::Value			GetJson() const;
+
+	//! Mutators
+	Json::Value &		Get();
+	void				Set( const Json::Value & a_Properties );
+	//! Pack the json back into the buffer and release it, any references returned by Get() are invalid after
+	//! this call. Returns false if the properties are not a json object, they are kept as json in that case.
+	bool				Compact();
+
+	//! Get the interned id of a property key.
+	static KeyId		InternKey( const std::string & a_Key );
+
+private:
+	//! Types
+	enum ValueType
+	{
+		VT_NULL,
+		VT_TRUE,
+		VT_FALSE,
+		VT_INT,
+		VT_UINT,
+		VT_REAL,
+		VT_STRING,
+		VT_JSON				// arrays and objects are kept as json text
+	};
+
+	//! Data
+	std::string			m_Packed;			// key id, value type and value for each property
+	mutable Json::Value *
+						m_pExpanded;
+
+	void				Expand() const;
+
+	static StringTable &GetKeys();
+	static void			Pack( const Json::Value & a_Properties, std::string & a_Packed );
+	static void			Unpack( const std::string & a_Packed, Json::Value & a_Properties );
+	static bool			ReadEntry( const std::string & a_Packed, size_t & a_Offset, 
+							KeyId & a_Key, Json::Value * a_pValue );
+};
+
+//----------------------------------
+
+inline bool PropertyStore::IsNull() const
+{
+	return m_pExpanded != NULL ? m_pExpanded->isNull() : m_Packed.empty();
+}
+
+inline bool PropertyStore::IsExpanded() const
+{
+	return m_pExpanded != NULL;
+}
+
+inline size_t PropertyStore::GetPackedSize() const
+{
+	return m_Packed.size();
+}
+
+inline const Json::Value & PropertyStore::Get() const
+{
+	if ( m_pExpanded == NULL )
+		Expand();
+	return *m_pExpanded;
+}
+
+inline Json::Value & PropertyStore::Get()
+{
+	if ( m_pExpanded == NULL )
+		Expand();
+	return *m_pExpanded;
+}
+
+#endif // SELF_PROPERTY_STORE_H
@@ -0,0 +1,253 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <string.h>
+
+#include "GraphJournal.h"
+#include "utils/Log.h"
+
+#include "boost/filesystem.hpp"
+#include "boost/cstdint.hpp"
+
+const char * GraphJournal::JOURNAL_MAGIC = "SELFGJ01";
+
+GraphJournal::GraphJournal() : m_pFile( NULL )
+{}
+
+GraphJournal::~GraphJournal()
+{
+	Close();
+}
+
+bool GraphJournal::Open( const std::string & a_File )
+{
+	Close();
+
+	try {
+		boost::filesystem::path parent( boost::filesystem::path( a_File ).parent_path() );
+		if (! parent.empty() && !boost::filesystem::exists( parent ) )
+			boost::filesystem::create_directories( parent );
+	}
+	catch( const std::exception & ex )
+	{
+		Log::Error( "GraphJournal", "Failed to create directory for %s: %s", a_File.c_str(), ex.what() );
+		return false;
+	}
+
+	m_pFile = fopen( a_File.c_str(), "ab" );
+	if ( m_pFile == NULL )
+	{
+		Log::Error( "GraphJournal", "Failed to open journal %s", a_File.c_str() );
+		return false;
+	}
+
+	m_File = a_File;
+	fseek( m_pFile, 0, SEEK_END );
+	if ( ftell( m_pFile ) == 0 )
+	{
+		fwrite( JOURNAL_MAGIC, 1, JOURNAL_MAGIC_SIZE, m_pFile );
+		fflush( m_pFile );
+	}
+
+	return true;
+}
+
+void GraphJournal::Close()
+{
+	if ( m_pFile != NULL )
+	{
+		fclose( m_pFile );
+		m_pFile = NULL;
+	}
+}
+
+bool GraphJournal::Save( const std::string & a_Key, const Json::Value & a_Data )
+{
+	return WriteRecord( OP_SAVE, a_Key, Json::FastWriter().write( a_Data ) );
+}
+
+bool GraphJournal::Delete( const std::string & a_Key )
+{
+	return WriteRecord( OP_DELETE, a_Key, std::string() );
+}
+
+bool GraphJournal::Rotate()
+{
+	if ( m_pFile == NULL )
+		return false;
+
+	// a rotated journal still here is from a flush that never finished, so keep it's changes too
+	std::string rotated( GetRotatedFile() );
+	if ( boost::filesystem::exists( rotated ) )
+	{
+		RecordList records;
+		ReadFile( m_File, records );
+
+		Close();
+		FILE * pRotated = fopen( rotated.c_str(), "ab" );
+		if ( pRotated == NULL )
+		{
+			Log::Error( "GraphJournal", "Failed to open journal %s", rotated.c_str() );
+			return Open( m_File );
+		}
+		m_pFile = pRotated;
+		bool bWritten = true;
+		for(size_t i=0;i<records.size() && bWritten;++i)
+		{
+			bWritten = WriteRecord( records[i].m_Op, records[i].m_Key, 
+				records[i].m_Op == OP_SAVE ? Json::FastWriter().write( records[i].m_Data ) : std::string() );
+		}
+		Close();
+
+		// the current journal is only removed once all of it's records are in the rotated one
+		if ( bWritten )
+			boost::filesystem::remove( m_File );
+		return Open( m_File );
+	}
+
+	Close();
+	try {
+		boost::filesystem::rename( m_File, rotated );
+	}
+	catch( const std::exception & ex )
+	{
+		Log::Error( "GraphJournal", "Failed to rotate journal %s: %s", m_File.c_str(), ex.what() );
+	}
+
+	return Open( m_File );
+}
+
+void GraphJournal::Retire()
+{
+	boost::system::error_code ec;
+	boost::filesystem::remove( GetRotatedFile(), ec );
+}
+
+bool GraphJournal::Read( RecordList & a_Records ) const
+{
+	bool bRotated = ReadFile( GetRotatedFile(), a_Records );
+	bool bCurrent = ReadFile( m_File, a_Records );
+	return bRotated || bCurrent;
+}
+
+void GraphJournal::Remove()
+{
+	Close();
+
+	boost::system::error_code ec;
+	boost::filesystem::remove( GetRotatedFile(), ec );
+	boost::filesystem::remove( m_File, ec );
+}
+
+std::string GraphJournal::GetRotatedFile() const
+{
+	return m_File + ".flush";
+}
+
+bool GraphJournal::WriteRecord( Operation a_Op, const std::string & a_Key, const std::string & a_Data )
+{
+	if ( m_pFile == NULL )
+		return false;
+
+	unsigned char op = (unsigned char)a_Op;
+	boost::uint32_t keySize = (boost::uint32_t)a_Key.size();
+	boost::uint32_t dataSize = (boost::uint32_t)a_Data.size();
+
+	std::string record;
+	record.reserve( sizeof(op) + sizeof(keySize) + keySize + sizeof(dataSize) + dataSize );
+	record.append( (const char *)&op, sizeof(op) );
+	record.append( (const char *)&keySize, sizeof(keySize) );
+	record += a_Key;
+	record.append( (const char *)&dataSize, sizeof(dataSize) );
+	record += a_Data;
+
+	// written in one call and flushed, so a crash can only lose or tear the last record
+	if ( fwrite( record.data(), 1, record.size(), m_pFile ) != record.size() || fflush( m_pFile ) != 0 )
+	{
+		Log::Error( "GraphJournal", "Failed to write to %s, journal closed.", m_File.c_str() );
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+bool GraphJournal::ReadFile( const std::string & a_File, RecordList & a_Records )
+{
+	FILE * pFile = fopen( a_File.c_str(), "rb" );
+	if ( pFile == NULL )
+		return false;
+
+	std::string data;
+	char buffer[ 16 * 1024 ];
+	size_t read = 0;
+	while( (read = fread( buffer, 1, sizeof(buffer), pFile )) > 0 )
+		data.append( buffer, read );
+	fclose( pFile );
+
+	if ( data.size() < JOURNAL_MAGIC_SIZE || memcmp( data.data(), JOURNAL_MAGIC, JOURNAL_MAGIC_SIZE ) != 0 )
+	{
+		Log::Warning( "GraphJournal", "%s is not a graph journal.", a_File.c_str() );
+		return false;
+	}
+
+	size_t start = JOURNAL_MAGIC_SIZE;
+	while( start < data.size() )
+	{
+		size_t offset = start;
+		unsigned char op = 0;
+		boost::uint32_t keySize = 0;
+		boost::uint32_t dataSize = 0;
+
+		if ( offset + sizeof(op) + sizeof(keySize) > data.size() )
+			break;
+		op = (unsigned char)data[ offset ];
+		memcpy( &keySize, data.data() + offset + sizeof(op), sizeof(keySize) );
+		offset += sizeof(op) + sizeof(keySize);
+		if ( keySize > data.size() - offset || sizeof(dataSize) > data.size() - offset - keySize )
+			break;
+
+		Record record;
+		record.m_Op = (Operation)op;
+		record.m_Key.assign( data.data() + offset, keySize );
+		offset += keySize;
+		memcpy( &dataSize, data.data() + offset, sizeof(dataSize) );
+		offset += sizeof(dataSize);
+		if ( dataSize > data.size() - offset )
+			break;
+
+		if ( op == OP_SAVE )
+		{
+			if (! Json::Reader( Json::Features::strictMode() ).parse( data.data() + offset, data.data() + offset + dataSize, record.m_Data ) )
+				break;
+		}
+		else if ( op != OP_DELETE )
+			break;
+		offset += dataSize;
+
+		a_Records.push_back( record );
+		start = offset;
+	}
+
+	if ( start < data.size() )
+		Log::Warning( "GraphJournal", "Ignoring %u bytes at the end of %s", (unsigned int)(data.size() - start), a_File.c_str() );
+
+	return true;
+}
@@ -0,0 +1,100 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#ifndef SELF_GRAPH_JOURNAL_H
+#define SELF_GRAPH_JOURNAL_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "utils/ISerializable.h"
+#include "SelfLib.h"
+
+//! This journal records each change to the local graph between the batched writes to the data store, so changes
+//! can be recovered if we stop without flushing. The file starts with JOURNAL_MAGIC followed by records, each
+//! record is an operation byte, a 32-bit key length, the key, a 32-bit data length, then the data as JSON text.
+//! While a flush is being written, the journal is rotated aside so new changes go into a fresh journal.
+class SELF_API GraphJournal
+{
+public:
+	//! Types
+	enum Operation {
+		OP_SAVE = 1,
+		OP_DELETE = 2
+	};
+	struct Record
+	{
+		Operation		m_Op;
+		std::string		m_Key;
+		Json::Value		m_Data;
+	};
+	typedef std::vector<Record>		RecordList;
+
+	static const char *		JOURNAL_MAGIC;
+	static const size_t		JOURNAL_MAGIC_SIZE = 8;
+
+	//! Construction
+	GraphJournal();
+	~GraphJournal();
+
+	//! Accessors
+	const std::string &	GetFile() const;
+	bool				IsOpen() const;
+
+	//! Open the journal for appending, this creates the file if needed.
+	bool				Open( const std::string & a_File );
+	void				Close();
+	//! Record a change, the record is handed to the OS before this returns.
+	bool				Save( const std::string & a_Key, const Json::Value & a_Data );
+	bool				Delete( const std::string & a_Key );
+	//! Move the current journal aside and start a new one, call this before a flush is written. If a rotated
+	//! journal is still here from a failed flush, the current records are added to the end of it instead.
+	bool				Rotate();
+	//! Every record in the rotated journal has been written, so remove it. Don't call this after a failed
+	//! flush, the next flush has to write those records as well.
+	void				Retire();
+	//! Read the changes in the rotated journal then the current one, in the order they were made. A
+	//! record cut short at the end of a file is ignored.
+	bool				Read( RecordList & a_Records ) const;
+	//! Close and remove both journal files.
+	void				Remove();
+
+private:
+	//! Data
+	std::string			m_File;
+	FILE *				m_pFile;
+
+	std::string			GetRotatedFile() const;
+	bool				WriteRecord( Operation a_Op, const std::string & a_Key, const std::string & a_Data );
+	static bool			ReadFile( const std::string & a_File, RecordList & a_Records );
+};
+
+//----------------------------------
+
+inline const std::string & GraphJournal::GetFile() const
+{
+	return m_File;
+}
+
+inline bool GraphJournal::IsOpen() const
+{
+	return m_pFile != NULL;
+}
+
+#endif // SELF_GRAPH_JOURNAL_H
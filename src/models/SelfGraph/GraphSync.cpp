@@ -0,0 +1,385 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include <algorithm>
+
+#include "GraphSync.h"
+#include "SelfGraph.h"
+#include "utils/StringUtil.h"
+
+const size_t GraphSync::MIN_BATCH_BYTES = 1024;
+const size_t GraphSync::MAX_BATCH_BYTES = 64 * 1024;
+const size_t GraphSync::MIN_PULL_SIZE = 10;
+const size_t GraphSync::MAX_PULL_SIZE = 1000;
+const size_t GraphSync::PULL_TARGET_OBJECTS = 1000;
+
+GraphSync::GraphSync( SelfGraph * a_pGraph ) : 
+	m_pGraph( a_pGraph ),
+	m_BatchBytes( 16 * 1024 ),
+	m_PullSize( 100 )
+{}
+
+GraphSync::~GraphSync()
+{}
+
+void GraphSync::Queue( const SelfVertex::SP & a_spVertex )
+{
+	Update update;
+	update.m_spVertex = a_spVertex;
+	if ( m_Queued.insert( GetKey( update ) ).second )
+		m_Queue.push_back( update );
+}
+
+void GraphSync::Queue( const SelfEdge::SP & a_spEdge )
+{
+	Update update;
+	update.m_spEdge = a_spEdge;
+	if ( m_Queued.insert( GetKey( update ) ).second )
+		m_Queue.push_back( update );
+}
+
+void GraphSync::Send()
+{
+	if ( m_Sending.size() > 0 )
+		return;
+
+	std::string script;
+	Json::Value bindings;
+	size_t bytes = 0;
+
+	UpdateList each;
+	while( m_Queue.size() > 0 && (m_Sending.empty() || bytes < m_BatchBytes) )
+	{
+		Update update( m_Queue.front() );
+		m_Queue.pop_front();
+		m_Queued.erase( GetKey( update ) );
+
+		// dropped objects are deleted instead, objects still being created are saved again once they are created
+		bool bDropped = update.m_spVertex ? update.m_spVertex->m_bDropped : update.m_spEdge->m_bDropped;
+		const std::string & id = update.m_spVertex ? update.m_spVertex->GetId() : update.m_spEdge->GetId();
+		if ( bDropped || id[0] == LOCAL_ID_CHAR )
+			continue;
+
+		if ( AddUpdate( update, script, bindings, bytes ) )
+			m_Sending.push_back( update );
+		else
+			each.push_back( update );
+	}
+	SendEach( each );
+
+	if ( m_Sending.size() > 0 )
+	{
+		if ( Query( script, bindings, DELEGATE( GraphSync, OnSent, const Json::Value &, shared_from_this() ) ) )
+			m_pGraph->OnOpStarted();
+		else
+		{
+			UpdateList sending;
+			sending.swap( m_Sending );
+			SendEach( sending );
+		}
+	}
+}
+
+size_t GraphSync::Merge( const Json::Value & a_Result, IdSet & a_Found )
+{
+	size_t objects = 0;
+
+	const Json::Value & data = a_Result["result"]["data"];
+	for(size_t i=0;i<data.size();++i)
+	{
+		const Json::Value & item = data[(Json::ArrayIndex)i];
+		if (! item.isMember( "objects" ) )
+		{
+			// without a path, each result is just the vertex
+			objects += 1;
+			if ( item["type"].asString() == "vertex" )
+			{
+				SelfVertex::SP spVertex = MergeVertex( item );
+				if ( spVertex )
+					a_Found.insert( spVertex->GetId() );
+			}
+			continue;
+		}
+
+		// do vertexes first
+		const Json::Value & path = item["objects"];
+		objects += path.size();
+		for(size_t k=0;k<path.size();++k)
+		{
+			const Json::Value & object = path[(Json::ArrayIndex)k];
+			if ( object["type"].asString() == "vertex" )
+			{
+				SelfVertex::SP spVertex = MergeVertex( object );
+				if ( spVertex )
+					a_Found.insert( spVertex->GetId() );
+			}
+		}
+
+		// now do the edges, we do this after all the vertexes so we can actually find them in the map..
+		for(size_t k=0;k<path.size();++k)
+		{
+			const Json::Value & object = path[(Json::ArrayIndex)k];
+			if ( object["type"].asString() == "edge" )
+				MergeEdge( object );
+		}
+	}
+
+	return objects;
+}
+
+void GraphSync::OnPulled( size_t a_Results, size_t a_Objects )
+{
+	if ( a_Results == 0 )
+		return;
+
+	// long paths make for large results, so pull fewer of them at a time
+	size_t perResult = std::max<size_t>( 1, (a_Objects + a_Results - 1) / a_Results );
+	m_PullSize = std::min( std::max( PULL_TARGET_OBJECTS / perResult, MIN_PULL_SIZE ), MAX_PULL_SIZE );
+}
+
+bool GraphSync::Query( const std::string & a_Query, const Json::Value & a_Bindings, QueryCallback a_Callback )
+{
+	if ( m_pGraph->m_pGraph == NULL )
+		return false;
+
+	return m_pGraph->m_pGraph->Query( m_pGraph->m_GraphId, a_Query, a_Bindings, a_Callback );
+}
+
+//--------------------------
+
+std::string GraphSync::GetKey( const Update & a_Update )
+{
+	if ( a_Update.m_spVertex )
+		return "vertex_" + a_Update.m_spVertex->GetId();
+	return "edge_" + a_Update.m_spEdge->GetId();
+}
+
+bool GraphSync::AddUpdate( Update & a_Update, std::string & a_Script, Json::Value & a_Bindings, size_t & a_Bytes )
+{
+	Json::Value properties;
+	if ( a_Update.m_spVertex )
+		a_Update.m_spVertex->GetPropertyStore().GetJson( properties );
+	else
+		a_Update.m_spEdge->GetPropertyStore().GetJson( properties );
+
+	// gremlin can't set an object or array as a property, those updates are sent on their own
+	Json::Value::Members keys( properties.getMemberNames() );
+	for(size_t i=0;i<keys.size();++i)
+	{
+		const Json::Value & value = properties[ keys[i] ];
+		if ( value.isObject() || value.isArray() )
+			return false;
+	}
+
+	std::string idBinding( StringUtil::Format( "bind%u", a_Bindings.size() ) );
+	if ( a_Update.m_spVertex )
+	{
+		a_Bindings[ idBinding ] = a_Update.m_spVertex->GetId();
+		a_Update.m_Version = a_Update.m_spVertex->m_Version;
+	}
+	else
+	{
+		a_Bindings[ idBinding ] = a_Update.m_spEdge->GetId();
+		a_Update.m_Version = a_Update.m_spEdge->m_Version;
+	}
+
+	// replace all the properties, the same as updating the vertex or edge on it's own
+	std::string element( StringUtil::Format( "graph.traversal().%s(%s)", 
+		a_Update.m_spVertex ? "V" : "E", idBinding.c_str() ) );
+	std::string statement( element + ".properties().drop().iterate();" + element );
+	for(size_t i=0;i<keys.size();++i)
+	{
+		if ( keys[i] == "_label" )
+			continue;
+
+		std::string keyBinding( StringUtil::Format( "bind%u", a_Bindings.size() ) );
+		a_Bindings[ keyBinding ] = keys[i];
+		std::string valueBinding( StringUtil::Format( "bind%u", a_Bindings.size() ) );
+		a_Bindings[ valueBinding ] = properties[ keys[i] ];
+
+		statement += ".property(" + keyBinding + "," + valueBinding + ")";
+	}
+	statement += ".iterate();";
+
+	a_Script += statement;
+	a_Bytes += statement.size() + Json::FastWriter().write( properties ).size();
+	return true;
+}
+
+void GraphSync::OnSent( const Json::Value & a_Result )
+{
+	UpdateList sent;
+	sent.swap( m_Sending );
+
+	if (! a_Result.isNull() )
+	{
+		// the remote graph is up to date with the versions we sent, the next flush saves that so they aren't sent again
+		for( UpdateList::iterator iUpdate = sent.begin(); iUpdate != sent.end(); ++iUpdate )
+		{
+			if ( iUpdate->m_spVertex )
+			{
+				SelfVertex::SP spVertex = iUpdate->m_spVertex;
+				spVertex->m_SyncedVersion = std::max( spVertex->m_SyncedVersion, iUpdate->m_Version );
+				if (! spVertex->m_bDropped )
+					m_pGraph->MarkSynced( spVertex );
+			}
+			else
+			{
+				SelfEdge::SP spEdge = iUpdate->m_spEdge;
+				spEdge->m_SyncedVersion = std::max( spEdge->m_SyncedVersion, iUpdate->m_Version );
+				if (! spEdge->m_bDropped )
+					m_pGraph->MarkSynced( spEdge );
+			}
+		}
+
+		m_BatchBytes = std::min( m_BatchBytes * 2, MAX_BATCH_BYTES );
+	}
+	else if ( sent.size() > 1 && m_BatchBytes > MIN_BATCH_BYTES )
+	{
+		// try again in smaller batches, anything queued again while we were sending is already in the queue
+		m_BatchBytes = std::max( m_BatchBytes / 2, MIN_BATCH_BYTES );
+		Log::Warning( "GraphSync", "Failed to send %u updates, trying again in batches of %u bytes.",
+			(unsigned int)sent.size(), (unsigned int)m_BatchBytes );
+
+		for( UpdateList::reverse_iterator iUpdate = sent.rbegin(); iUpdate != sent.rend(); ++iUpdate )
+		{
+			if ( m_Queued.insert( GetKey( *iUpdate ) ).second )
+				m_Queue.push_front( *iUpdate );
+		}
+	}
+	else
+	{
+		// send them one at a time, these retry on their own..
+		m_BatchBytes = std::max( m_BatchBytes / 2, MIN_BATCH_BYTES );
+		Log::Warning( "GraphSync", "Failed to send %u updates, sending them one at a time.", (unsigned int)sent.size() );
+		SendEach( sent );
+	}
+
+	Send();
+	m_pGraph->OnOpDone();
+}
+
+void GraphSync::SendEach( UpdateList & a_Updates )
+{
+	for( UpdateList::iterator iUpdate = a_Updates.begin(); iUpdate != a_Updates.end(); ++iUpdate )
+	{
+		bool bSent = iUpdate->m_spVertex ? iUpdate->m_spVertex->SendUpdate() : iUpdate->m_spEdge->SendUpdate();
+		if (! bSent )
+			Log::Error( "GraphSync", "Failed to send update for %s", GetKey( *iUpdate ).c_str() );
+	}
+	a_Updates.clear();
+}
+
+SelfVertex::SP GraphSync::MergeVertex( const Json::Value & a_Object )
+{
+	std::string id( a_Object["id"].asString() );
+	std::string label( a_Object["label"].asString() );
+
+	Json::Value properties;
+	const Json::Value & props = a_Object["properties"];
+	for( Json::ValueConstIterator iProp = props.begin(); iProp != props.end(); ++iProp )
+		properties[ iProp.name() ] = (*iProp)[0]["value"];
+	properties["_label"] = label;
+
+	SelfVertex::SP spVertex = m_pGraph->m_Vertices.Find( id );
+	if ( spVertex )
+	{
+		// changes not sent yet win, they are on their way to the remote graph
+		if ( spVertex->m_Version > spVertex->m_SyncedVersion )
+			return spVertex;
+
+		// nothing to do if nothing has changed
+		Json::Value local;
+		spVertex->GetPropertyStore().GetJson( local );
+		if ( local == properties )
+			return spVertex;
+	}
+	else
+	{
+		spVertex = SelfVertex::SP( new SelfVertex() );
+		spVertex->SetGraph( m_pGraph );
+		spVertex->SetId( id );
+		spVertex->SetLabel( label );
+	}
+
+	// someone may be holding the expanded properties, leave those alone
+	bool bExpanded = spVertex->GetPropertyStore().IsExpanded();
+	spVertex->SetProperties( properties );
+	spVertex->m_SyncedVersion = spVertex->m_Version;
+	spVertex->SaveLocal();
+	if (! bExpanded )
+		spVertex->CompactProperties();
+
+	return spVertex;
+}
+
+void GraphSync::MergeEdge( const Json::Value & a_Object )
+{
+	std::string id( a_Object["id"].asString() );
+	std::string label( a_Object["label"].asString() );
+	std::string inV( a_Object["inV"].asString() );
+	std::string outV( a_Object["outV"].asString() );
+
+	SelfVertex::SP spSource = m_pGraph->m_Vertices.Find( outV );
+	if (! spSource )
+	{
+		Log::Warning( "GraphSync", "Failed to find outV %s", outV.c_str() );
+		return;
+	}
+	SelfVertex::SP spDest = m_pGraph->m_Vertices.Find( inV );
+	if (! spDest )
+	{
+		Log::Warning( "GraphSync", "Failed to find inV %s", inV.c_str() );
+		return;
+	}
+
+	Json::Value properties;
+	const Json::Value & props = a_Object["properties"];
+	for( Json::ValueConstIterator iProp = props.begin(); iProp != props.end(); ++iProp )
+		properties[ iProp.name() ] = (*iProp);
+	properties["_label"] = label;
+
+	SelfEdge::SP spEdge = m_pGraph->m_Edges.Find( id );
+	if ( spEdge )
+	{
+		if ( spEdge->m_Version > spEdge->m_SyncedVersion )
+			return;
+
+		Json::Value local;
+		spEdge->GetPropertyStore().GetJson( local );
+		if ( local == properties )
+			return;
+	}
+	else
+	{
+		spEdge = SelfEdge::SP( new SelfEdge() );
+		spEdge->SetGraph( m_pGraph );
+		spEdge->SetId( id );
+		spEdge->SetLabel( label );
+		spEdge->SetSource( spSource );
+		spEdge->SetDestination( spDest );
+	}
+
+	// someone may be holding the expanded properties, leave those alone
+	bool bExpanded = spEdge->GetPropertyStore().IsExpanded();
+	spEdge->SetProperties( properties );
+	spEdge->m_SyncedVersion = spEdge->m_Version;
+	spEdge->SaveLocal();
+	if (! bExpanded )
+		spEdge->CompactProperties();
+}
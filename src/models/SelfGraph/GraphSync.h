@@ -0,0 +1,136 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#ifndef SELF_GRAPH_SYNC_H
+#define SELF_GRAPH_SYNC_H
+
+#include <list>
+#include <set>
+
+#include "boost/shared_ptr.hpp"
+#include "boost/enable_shared_from_this.hpp"
+#include "boost/unordered_set.hpp"
+
+#include "SelfVertex.h"
+#include "SelfEdge.h"
+#include "utils/Delegate.h"
+#include "SelfLib.h"
+
+class SelfGraph;
+
+//! This object keeps the local SelfGraph in sync with the remote graph service. Updates to vertexes and edges
+//! are queued and sent as gremlin scripts in batches bounded by size, only one batch is sent at a time so sync
+//! traffic doesn't crowd out everything else on the link. The batch size grows while batches succeed and shrinks
+//! when they fail. Remote query results are pulled in chunks sized by how many objects each result expands into,
+//! and only objects that actually changed are merged into the local graph.
+class SELF_API GraphSync : public boost::enable_shared_from_this<GraphSync>
+{
+public:
+	//! Types
+	typedef boost::shared_ptr<GraphSync>		SP;
+	typedef boost::weak_ptr<GraphSync>			WP;
+	typedef Delegate<const Json::Value &>		QueryCallback;
+	typedef std::set<std::string>				IdSet;
+
+	//! Constants
+	static const size_t MIN_BATCH_BYTES;
+	static const size_t MAX_BATCH_BYTES;
+	static const size_t MIN_PULL_SIZE;
+	static const size_t MAX_PULL_SIZE;
+	static const size_t PULL_TARGET_OBJECTS;
+
+	//! Construction
+	GraphSync( SelfGraph * a_pGraph );
+	virtual ~GraphSync();
+
+	//! Accessors
+	size_t				GetBatchBytes() const;				//!< current size limit of a batch of updates
+	size_t				GetPullSize() const;				//!< number of results to pull in each chunk
+	size_t				GetQueued() const;					//!< number of updates waiting to be sent
+	bool				IsSending() const;					//!< true while a batch is being sent
+
+	//! Queue an update for a vertex or edge, updates queued more than once are only sent once.
+	void				Queue( const SelfVertex::SP & a_spVertex );
+	void				Queue( const SelfEdge::SP & a_spEdge );
+	//! Send the next batch of updates, does nothing while a batch is being sent.
+	void				Send();
+
+	//! Merge the results of a remote query into the local graph, the results may be vertexes or
+	//! paths of vertexes and edges. The ID of each vertex found is added to a_Found, returns the number
+	//! of objects in the results.
+	size_t				Merge( const Json::Value & a_Result, IdSet & a_Found );
+	//! Size the next pull chunk from the number of results & objects pulled in the last one.
+	void				OnPulled( size_t a_Results, size_t a_Objects );
+
+	//! Send a gremlin query to the remote graph, returns false if it can't be sent.
+	virtual bool		Query( const std::string & a_Query, const Json::Value & a_Bindings,
+							QueryCallback a_Callback );
+
+protected:
+	//! Types
+	struct Update
+	{
+		Update() : m_Version( 0 )
+		{}
+
+		SelfVertex::SP		m_spVertex;
+		SelfEdge::SP		m_spEdge;
+		unsigned int		m_Version;			// version being sent
+	};
+	typedef std::list<Update>					UpdateList;
+	typedef boost::unordered_set<std::string>	KeySet;
+
+	//! Data
+	SelfGraph *			m_pGraph;
+	UpdateList			m_Queue;
+	KeySet				m_Queued;				// keys of the updates in m_Queue
+	UpdateList			m_Sending;
+	size_t				m_BatchBytes;
+	size_t				m_PullSize;
+
+	static std::string	GetKey( const Update & a_Update );
+	bool				AddUpdate( Update & a_Update, std::string & a_Script, Json::Value & a_Bindings, size_t & a_Bytes );
+	void				OnSent( const Json::Value & a_Result );
+	void				SendEach( UpdateList & a_Updates );
+	SelfVertex::SP		MergeVertex( const Json::Value & a_Object );
+	void				MergeEdge( const Json::Value & a_Object );
+};
+
+//----------------------------------
+
+inline size_t GraphSync::GetBatchBytes() const
+{
+	return m_BatchBytes;
+}
+
+inline size_t GraphSync::GetPullSize() const
+{
+	return m_PullSize;
+}
+
+inline size_t GraphSync::GetQueued() const
+{
+	return m_Queue.size();
+}
+
+inline bool GraphSync::IsSending() const
+{
+	return m_Sending.size() > 0;
+}
+
+#endif // SELF_GRAPH_SYNC_H
@@ -0,0 +1,179 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#ifndef SELF_HANDLE_TABLE_H
+#define SELF_HANDLE_TABLE_H
+
+#include <string>
+#include <vector>
+
+#include "boost/shared_ptr.hpp"
+#include "boost/noncopyable.hpp"
+#include "boost/unordered_set.hpp"
+#include "boost/functional/hash.hpp"
+
+//! Handles are small integers that index a HandleTable
+typedef unsigned int		GraphHandle;
+#define INVALID_GRAPH_HANDLE	((GraphHandle)0xffffffff)
+
+//! This keeps the vertices or edges of a SelfGraph in a dense table, each object is given a handle that indexes
+//! the table. Objects are found by id through a hash index that holds just the handles, so the id string is only
+//! stored in the object itself. The id of an object must not change while it's in the table, remove it first.
+//! T must provide GetId(), GetHandle() and SetHandle().
+template<typename T>
+class HandleTable : public boost::noncopyable
+{
+public:
+	//! Types
+	typedef boost::shared_ptr<T>		SP;
+
+	//! Construction
+	HandleTable() : m_Index( 0, IdHash( &m_Objects ), IdEqual( &m_Objects ) )
+	{}
+
+	//! Accessors
+	size_t				GetSize() const
+	{
+		return m_Index.size();
+	}
+	//! One past the highest handle in use, walk the table from 0 to this and skip the NULL entries.
+	GraphHandle			GetEnd() const
+	{
+		return (GraphHandle)m_Objects.size();
+	}
+	//! Get the object for a handle, returns NULL if the handle is not in use.
+	SP					Get( GraphHandle a_Handle ) const
+	{
+		if ( a_Handle >= m_Objects.size() )
+			return SP();
+		return m_Objects[ a_Handle ];
+	}
+	SP					Find( const std::string & a_Id ) const
+	{
+		typename Index::const_iterator iHandle = m_Index.find( a_Id, IdHash( &m_Objects ), IdEqual( &m_Objects ) );
+		if ( iHandle == m_Index.end() )
+			return SP();
+		return m_Objects[ *iHandle ];
+	}
+
+	//! Mutators
+	//! Add an object to this table, an object with the same id is replaced and it's handle is given to the new object.
+	GraphHandle			Add( const SP & a_spObject )
+	{
+		typename Index::iterator iHandle = m_Index.find( a_spObject->GetId(), IdHash( &m_Objects ), IdEqual( &m_Objects ) );
+		if ( iHandle != m_Index.end() )
+		{
+			GraphHandle handle = *iHandle;
+			if ( m_Objects[ handle ] != a_spObject )
+			{
+				m_Objects[ handle ]->SetHandle( INVALID_GRAPH_HANDLE );
+				m_Objects[ handle ] = a_spObject;
+				a_spObject->SetHandle( handle );
+			}
+			return handle;
+		}
+
+		GraphHandle handle = (GraphHandle)m_Objects.size();
+		if ( m_Free.size() > 0 )
+		{
+			handle = m_Free.back();
+			m_Free.pop_back();
+			m_Objects[ handle ] = a_spObject;
+		}
+		else
+			m_Objects.push_back( a_spObject );
+
+		a_spObject->SetHandle( handle );
+		m_Index.insert( handle );
+		return handle;
+	}
+	bool				Remove( const std::string & a_Id )
+	{
+		typename Index::iterator iHandle = m_Index.find( a_Id, IdHash( &m_Objects ), IdEqual( &m_Objects ) );
+		if ( iHandle == m_Index.end() )
+			return false;
+
+		GraphHandle handle = *iHandle;
+		m_Index.erase( iHandle );
+		m_Objects[ handle ]->SetHandle( INVALID_GRAPH_HANDLE );
+		m_Objects[ handle ].reset();
+		m_Free.push_back( handle );
+		return true;
+	}
+	void				Clear()
+	{
+		for(size_t i=0;i<m_Objects.size();++i)
+			if ( m_Objects[i] )
+				m_Objects[i]->SetHandle( INVALID_GRAPH_HANDLE );
+
+		m_Index.clear();
+		m_Objects.clear();
+		m_Free.clear();
+	}
+
+private:
+	//! Types
+	typedef std::vector<SP>				ObjectList;
+	typedef std::vector<GraphHandle>	HandleList;
+
+	//! hash & compare handles by the id of the object they refer to, or against an id directly
+	struct IdHash
+	{
+		IdHash( const ObjectList * a_pObjects ) : m_pObjects( a_pObjects )
+		{}
+
+		size_t operator()( GraphHandle a_Handle ) const
+		{
+			return boost::hash<std::string>()( (*m_pObjects)[ a_Handle ]->GetId() );
+		}
+		size_t operator()( const std::string & a_Id ) const
+		{
+			return boost::hash<std::string>()( a_Id );
+		}
+
+		const ObjectList *	m_pObjects;
+	};
+	struct IdEqual
+	{
+		IdEqual( const ObjectList * a_pObjects ) : m_pObjects( a_pObjects )
+		{}
+
+		bool operator()( GraphHandle a_Handle1, GraphHandle a_Handle2 ) const
+		{
+			return a_Handle1 == a_Handle2;
+		}
+		bool operator()( const std::string & a_Id, GraphHandle a_Handle ) const
+		{
+			return (*m_pObjects)[ a_Handle ]->GetId() == a_Id;
+		}
+		bool operator()( GraphHandle a_Handle, const std::string & a_Id ) const
+		{
+			return (*m_pObjects)[ a_Handle ]->GetId() == a_Id;
+		}
+
+		const ObjectList *	m_pObjects;
+	};
+	typedef boost::unordered_set<GraphHandle, IdHash, IdEqual>	Index;
+
+	//! Data
+	ObjectList			m_Objects;			// indexed by handle, NULL if the handle is free
+	HandleList			m_Free;				// free handles, reused before the table grows
+	Index				m_Index;			// handles by object id
+};
+
+#endif // SELF_HANDLE_TABLE_H
@@ -31,10 +31,14 @@ void SelfEdge::Serialize(Json::Value & json)
 	json["m_Id"] = m_Id;
 	json["m_SourceId"] = m_SourceId;
 	json["m_DestinationId"] = m_DestinationId;
-	json["m_Label"] = m_Label;
+	json["m_Label"] = GetLabel();
 	json["m_fTime"] = m_fTime;
-	if (!m_Properties.isNull())
-		json["m_Properties"] = m_Properties;
+	if ( m_Version > 0 )
+		json["m_Version"] = m_Version;
+	if ( m_SyncedVersion > 0 )
+		json["m_SyncedVersion"] = m_SyncedVersion;
+	if (!m_Properties.IsNull())
+		m_Properties.GetJson( json["m_Properties"] );
 }
 
 void SelfEdge::Deserialize(const Json::Value & json)
@@ -42,10 +46,15 @@ void SelfEdge::Deserialize(const Json::Value & json)
 	m_Id = json["m_Id"].asString();
 	m_SourceId = json["m_SourceId"].asString();
 	m_DestinationId = json["m_DestinationId"].asString();
-	m_Label = json["m_Label"].asString();
+	m_LabelId = EdgeLabel::Intern( json["m_Label"].asString() );
 	m_fTime = json["m_fTime"].asDouble();
+	m_Version = json["m_Version"].asUInt();
+	m_SyncedVersion = json["m_SyncedVersion"].asUInt();
 	if (json.isMember("m_Properties"))
-		m_Properties = json["m_Properties"];
+	{
+		m_Properties.Set( json["m_Properties"] );
+		m_Properties.Compact();
+	}
 }
 
 bool SelfEdge::Save()
@@ -57,6 +66,7 @@ bool SelfEdge::Save()
 		return false;
 
 	m_fTime = Time().GetEpochTime();
+	m_Version += 1;
 
 	SaveLocal();
 
@@ -72,10 +82,10 @@ bool SelfEdge::Save()
 				m_spThis = shared_from_this();
 
 				if ( pGraph->m_pGraph->CreateEdge( pGraph->m_GraphId, 
-					m_SourceId, m_DestinationId, m_Label, m_Properties,
+					m_SourceId, m_DestinationId, GetLabel(), m_Properties.GetJson(),
 					DELEGATE( SelfEdge, OnEdgeCreated, const Json::Value &, shared_from_this() ) ) )
 				{
-					pGraph->m_nPendingOps += 1;
+					pGraph->OnOpStarted();
 				}
 			}
 			else if ( m_bCreated )
@@ -87,14 +97,10 @@ bool SelfEdge::Save()
 		}
 		else
 		{
-			m_spThis = shared_from_this();
+			// updates are sent to the graph service in batches
 			m_bUpdated = false;
-
-			if ( pGraph->m_pGraph->UpdateEdge( pGraph->m_GraphId,
-				m_Id, m_Properties, DELEGATE( SelfEdge, OnEdgeUpdated, const Json::Value &, shared_from_this() ) ) )
-			{
-				pGraph->m_nPendingOps += 1;
-			}
+			pGraph->GetSync()->Queue( shared_from_this() );
+			pGraph->GetSync()->Send();
 		}
 	}
 	else if (! m_bCreated )
@@ -106,6 +112,24 @@ bool SelfEdge::Save()
 	return true;
 }
 
+bool SelfEdge::SendUpdate()
+{
+	SelfGraph * pGraph = DynamicCast<SelfGraph>( m_pGraph );
+	if ( pGraph == NULL || pGraph->m_pGraph == NULL )
+		return false;
+
+	m_spThis = shared_from_this();
+	if (! pGraph->m_pGraph->UpdateEdge( pGraph->m_GraphId,
+		m_Id, m_Properties.GetJson(), DELEGATE( SelfEdge, OnEdgeUpdated, const Json::Value &, shared_from_this() ) ) )
+	{
+		m_spThis.reset();
+		return false;
+	}
+
+	pGraph->OnOpStarted();
+	return true;
+}
+
 bool SelfEdge::Drop()
 {
 	SelfGraph * pGraph = DynamicCast<SelfGraph>( m_pGraph );
@@ -132,7 +156,7 @@ bool SelfEdge::Drop()
 		if ( pGraph->m_pGraph->DeleteEdge( pGraph->m_GraphId, m_Id,
 			DELEGATE( SelfEdge, OnEdgeDeleted, const Json::Value &, this ) ) )
 		{
-			pGraph->m_nPendingOps += 1;
+			pGraph->OnOpStarted();
 		}
 	}
 
@@ -174,6 +198,7 @@ void SelfEdge::OnEdgeCreated( const Json::Value & a_Result )
 
 		m_Id = id;
 		m_nRetries = 0;
+		m_SyncedVersion = m_Version;
 
 		m_NotificationList.Invoke( EdgeEvent(IEdge::E_COMMITTED, shared_from_this()) );
 
@@ -194,16 +219,16 @@ void SelfEdge::OnEdgeCreated( const Json::Value & a_Result )
 		if ( ! m_bDropped && ++m_nRetries < MAX_RETRIES ) 
 		{
 			if ( pGraph->m_pGraph->CreateEdge( pGraph->m_GraphId,
-				m_SourceId, m_DestinationId, m_Label, m_Properties, 
+				m_SourceId, m_DestinationId, GetLabel(), m_Properties.GetJson(), 
 				DELEGATE( SelfEdge, OnEdgeCreated, const Json::Value &, shared_from_this() ) ) )
 			{
-				pGraph->m_nPendingOps += 1;
+				pGraph->OnOpStarted();
 				bRetry = true;
 			}
 		}
 	}
 
-	pGraph->m_nPendingOps -= 1;
+	pGraph->OnOpDone();
 	if (! bRetry )
 		m_spThis.reset();
 }
@@ -220,15 +245,21 @@ void SelfEdge::OnEdgeUpdated( const Json::Value & a_Result )
 		if ( ++m_nRetries < MAX_RETRIES )
 		{
 			if ( pGraph->m_pGraph->UpdateEdge( pGraph->m_GraphId,
-				m_Id, m_Properties, DELEGATE( SelfEdge, OnEdgeUpdated, const Json::Value &, shared_from_this() ) ) )
+				m_Id, m_Properties.GetJson(), DELEGATE( SelfEdge, OnEdgeUpdated, const Json::Value &, shared_from_this() ) ) )
 			{
-				pGraph->m_nPendingOps += 1;
+				pGraph->OnOpStarted();
 				bRetry = true;
 			}
 		}
 	}
+	else
+	{
+		m_nRetries = 0;
+		m_SyncedVersion = m_Version;
+		SaveLocal();
+	}
 
-	pGraph->m_nPendingOps -= 1;
+	pGraph->OnOpDone();
 	if (! bRetry )
 		m_spThis.reset();
 }
@@ -247,7 +278,7 @@ void SelfEdge::OnEdgeDeleted( const Json::Value & a_Result )
 			if ( pGraph->m_pGraph->DeleteEdge( pGraph->m_GraphId, m_Id,
 				DELEGATE( SelfEdge, OnEdgeDeleted, const Json::Value &, shared_from_this() ) ) )
 			{
-				pGraph->m_nPendingOps += 1;
+				pGraph->OnOpStarted();
 				bRetry = true;
 			}
 		}
@@ -258,7 +289,7 @@ void SelfEdge::OnEdgeDeleted( const Json::Value & a_Result )
 		m_nRetries = 0;
 	}
 
-	pGraph->m_nPendingOps -= 1;
+	pGraph->OnOpDone();
 	if (! bRetry )
 		m_spThis.reset();
 }
@@ -268,12 +299,9 @@ void SelfEdge::SaveLocal()
 	SelfGraph * pGraph = DynamicCast<SelfGraph>( m_pGraph );
 	assert( pGraph != NULL );
 
-	pGraph->m_EdgeMap[ m_Id ] = shared_from_this();
-	if ( pGraph->m_pStorage != NULL )
-	{
-		pGraph->m_pStorage->Save( "edge_" + m_Id,
-			ISerializable::SerializeObject( this ) );
-	}
+	// the graph writes this edge to local storage with the next flush
+	pGraph->m_Edges.Add( shared_from_this() );
+	pGraph->MarkDirty( shared_from_this() );
 }
 
 void SelfEdge::DeleteLocal()
@@ -281,9 +309,6 @@ void SelfEdge::DeleteLocal()
 	SelfGraph * pGraph = DynamicCast<SelfGraph>( m_pGraph );
 	assert( pGraph != NULL );
 
-	if ( pGraph->m_pStorage != NULL )
-		pGraph->m_pStorage->Delete( "edge_" + m_Id );
-
-	pGraph->m_EdgeMap.erase( m_Id );
+	pGraph->MarkDeleted( "edge_" + m_Id );
+	pGraph->m_Edges.Remove( m_Id );
 }
-
@@ -20,6 +20,7 @@
 #define SELF_EDGE_H
 
 #include "models/IEdge.h"
+#include "HandleTable.h"
 
 class SELF_API SelfEdge : public IEdge
 {
@@ -29,7 +30,8 @@ public:
 	typedef boost::shared_ptr<SelfEdge>			SP;
 	typedef boost::weak_ptr<SelfEdge>			WP;
 
-	SelfEdge() : m_bDropped(false), m_bCreated(false), m_bUpdated(false), m_nRetries(0)
+	SelfEdge() : m_bDropped(false), m_bCreated(false), m_bUpdated(false), m_nRetries(0), m_Handle(INVALID_GRAPH_HANDLE),
+		m_Version(0), m_SyncedVersion(0)
 	{}
 
 	//! ISerializable interface
@@ -49,6 +51,21 @@ public:
 	//! Returns false if edge can't find source or destination in local cache
 	bool ResolveEdge();
 
+	//! Get the handle of this edge in the local graph, INVALID_GRAPH_HANDLE if it's not in the local graph.
+	GraphHandle GetHandle() const
+	{
+		return m_Handle;
+	}
+	//! The version is increased by each Save(), the synced version is the last version in the remote graph.
+	unsigned int GetVersion() const
+	{
+		return m_Version;
+	}
+	unsigned int GetSyncedVersion() const
+	{
+		return m_SyncedVersion;
+	}
+
 protected:
 	//! Data
 	bool				m_bDropped;
@@ -56,6 +73,14 @@ protected:
 	bool				m_bUpdated;
 	SP					m_spThis;
 	int					m_nRetries;
+	GraphHandle			m_Handle;
+	unsigned int		m_Version;
+	unsigned int		m_SyncedVersion;
+
+	void				SetHandle(GraphHandle a_Handle)
+	{
+		m_Handle = a_Handle;
+	}
 
 	//! Callbacks
 	void				OnEdgeCreated(const Json::Value & a_Result);
@@ -63,10 +88,13 @@ protected:
 	void				OnEdgeDeleted(const Json::Value & a_Result);
 	void				SaveLocal();
 	void				DeleteLocal();
+	bool				SendUpdate();
 
 	friend class SelfGraph;
 	friend class SelfVertex;
 	friend class ISelfTraverser;
+	friend class GraphSync;
+	template<typename T> friend class HandleTable;
 };
 
 #endif
@@ -45,8 +45,14 @@ SelfGraph::SelfGraph() :
 	m_bError( false ),
 	m_pGraph( NULL ),
 	m_pStorage( NULL ), 
-	m_nPendingOps( 0 )
-{}
+	m_nPendingOps( 0 ),
+	m_bClosing( false ),
+	m_bDropping( false ),
+	m_bFlushing( false ),
+	m_bFlushFailed( false )
+{
+	m_spSync = GraphSync::SP( new GraphSync( this ) );
+}
 
 SelfGraph::SelfGraph( const std::string & a_GraphId ) : IGraph( a_GraphId ),
 	m_bLoading( false ),
@@ -55,12 +61,25 @@ SelfGraph::SelfGraph( const std::string & a_GraphId ) : IGraph( a_GraphId ),
 	m_bError( false ),
 	m_pGraph( NULL ),
 	m_pStorage( NULL ), 
-	m_nPendingOps( 0 )
-{}
+	m_nPendingOps( 0 ),
+	m_bClosing( false ),
+	m_bDropping( false ),
+	m_bFlushing( false ),
+	m_bFlushFailed( false )
+{
+	m_spSync = GraphSync::SP( new GraphSync( this ) );
+}
 
 SelfGraph::~SelfGraph()
 {
-	Close();
+	// pending operations keep a reference to us, so none are left by now. Anything not yet flushed is 
+	// still in the journal for the next load.
+	if ( m_bLoaded || m_bClosing )
+	{
+		m_bLoaded = false;
+		m_spFlushTimer.reset();
+		FinishClose();
+	}
 }
 
 void SelfGraph::Serialize(Json::Value & json)
@@ -68,17 +87,26 @@ void SelfGraph::Serialize(Json::Value & json)
 	json["m_GraphId"] = m_GraphId;
 
 	int i =0;
-	for( VertexMap::const_iterator iVertex = m_VertexMap.begin(); iVertex != m_VertexMap.end(); ++iVertex )
-		json["m_Verts"][i++] = ISerializable::SerializeObject( iVertex->second.get() );
+	for( GraphHandle h = 0; h < m_Vertices.GetEnd(); ++h )
+	{
+		SelfVertex::SP spVertex = m_Vertices.Get( h );
+		if ( spVertex )
+			json["m_Verts"][i++] = ISerializable::SerializeObject( spVertex.get() );
+	}
 	i = 0;
-	for( EdgeMap::const_iterator iEdge = m_EdgeMap.begin(); iEdge != m_EdgeMap.end(); ++iEdge )
-		json["m_Edges"][i++] = ISerializable::SerializeObject( iEdge->second.get() );
+	for( GraphHandle h = 0; h < m_Edges.GetEnd(); ++h )
+	{
+		SelfEdge::SP spEdge = m_Edges.Get( h );
+		if ( spEdge )
+			json["m_Edges"][i++] = ISerializable::SerializeObject( spEdge.get() );
+	}
 }
 
 void SelfGraph::Deserialize(const Json::Value & json)
 {
-	m_VertexMap.clear();
-	m_EdgeMap.clear();
+	m_Vertices.Clear();
+	m_Edges.Clear();
+	ClearChanges();
 
 	if (json.isMember("m_GraphId"))
 		m_GraphId = json["m_GraphId"].asString();
@@ -89,7 +117,7 @@ void SelfGraph::Deserialize(const Json::Value & json)
 		SelfVertex::SP spVertex( ISerializable::DeserializeObject<SelfVertex>( verts[i], new SelfVertex() ) );
 		spVertex->SetGraph( this );
 
-		m_VertexMap[ spVertex->GetId() ] = spVertex;
+		m_Vertices.Add( spVertex );
 	}
 
 	const Json::Value & edges = json["m_Edges"];
@@ -98,18 +126,18 @@ void SelfGraph::Deserialize(const Json::Value & json)
 		SelfEdge::SP spEdge( ISerializable::DeserializeObject<SelfEdge>( edges[i], new SelfEdge() ) );
 		spEdge->SetGraph( this );
 
-		VertexMap::iterator iSource = m_VertexMap.find( spEdge->GetSourceId() );
-		VertexMap::iterator iDest = m_VertexMap.find( spEdge->GetDestinationId() );
-		if ( iSource == m_VertexMap.end() || iDest == m_VertexMap.end() )
+		SelfVertex::SP spSource = m_Vertices.Find( spEdge->GetSourceId() );
+		SelfVertex::SP spDest = m_Vertices.Find( spEdge->GetDestinationId() );
+		if ( !spSource || !spDest )
 		{
 			Log::Error( "SelfGraph", "Failed to connect edge %s", spEdge->GetId().c_str() );
 			continue;
 		}
 
-		spEdge->SetSource( iSource->second );
-		spEdge->SetDestination( iDest->second );
+		spEdge->SetSource( spSource );
+		spEdge->SetDestination( spDest );
 
-		m_EdgeMap[ spEdge->GetId() ] = spEdge;
+		m_Edges.Add( spEdge );
 	}
 }
 
@@ -117,6 +145,11 @@ bool SelfGraph::Load( OnGraphLoaded a_Callback )
 {
 	if ( m_bLoading )
 		return true;
+	if ( m_bClosing )
+	{
+		Log::Error( "SelfGraph", "Graph %s is still closing.", m_GraphId.c_str() );
+		return false;
+	}
 
 	m_bLoading = true;
 	m_OnGraphLoaded = a_Callback;
@@ -128,6 +161,15 @@ bool SelfGraph::Load( OnGraphLoaded a_Callback )
 		return false;
 	}
 
+	// changes are written in batches, the journal keeps the changes in between so they are not lost
+	if (! m_Journal.Open( GetJournalFile() ) )
+		Log::Warning( "SelfGraph", "Changes to graph %s will not be journaled.", m_GraphId.c_str() );
+	if ( TimerPool::Instance() != NULL )
+	{
+		m_spFlushTimer = TimerPool::Instance()->StartTimer( 
+			VOID_DELEGATE( SelfGraph, Flush, this ), GRAPH_SAVE_INTERVAL, true, true );
+	}
+
 	// load all vertexes first..
 	m_pStorage->Load( "vertex_%", DELEGATE(SelfGraph, OnLoadVertex, Json::Value *, this ) );
 	return true;
@@ -141,6 +183,7 @@ bool SelfGraph::Connect( OnGraphConnected a_Callback, const std::string & a_Serv
 		return false;
 
 	m_bCreated = false;
+	m_bError = false;
 	m_OnGraphConnected = a_Callback;
 
 	m_pGraph = Config::Instance()->FindService<Graph>( a_ServiceId );
@@ -152,20 +195,13 @@ bool SelfGraph::Connect( OnGraphConnected a_Callback, const std::string & a_Serv
 
 	if ( m_pGraph->GetSchema( m_GraphId ) == NULL )
 	{
+		// we continue connecting in OnGraphCreated()..
 		Log::Status( "SelfGraph", "Creating remote graph %s", m_GraphId.c_str() );
 		m_pGraph->CreateGraph( m_GraphId, DELEGATE( SelfGraph, OnGraphCreated, const Json::Value &, this) );
-
-		while(! m_bCreated && !m_bError )
-		{
-			ThreadPool::Instance()->ProcessMainThread();
-			boost::this_thread::sleep( boost::posix_time::milliseconds(5) );
-		}
-
-		if ( m_bError )
-			return false;
 	}
+	else
+		DiscoverModels();
 
-	DiscoverModels();
 	return true;
 }
 
@@ -186,71 +222,56 @@ void SelfGraph::Clear()
 	{
 		m_pStorage->Drop();
 		m_pStorage->Start( m_GraphId, Json::Value() );
+
+		// nothing in the journal applies to the new store
+		m_Journal.Remove();
+		m_Journal.Open( GetJournalFile() );
 	}
 
-	m_VertexMap.clear();
-	m_EdgeMap.clear();
+	m_Vertices.Clear();
+	m_Edges.Clear();
+	ClearChanges();
+	// a batch still being written is not queued again if it fails
+	m_FlushVertices.clear();
+	m_FlushEdges.clear();
+	m_FlushDeleted.clear();
 
 	// TODO: send gremlin command to wipe all vertexes
 }
 
-bool SelfGraph::Close()
+bool SelfGraph::Close( OnGraphClosed a_Callback /*= OnGraphClosed()*/ )
 {
 	if ( !m_bLoaded )
 		return false;
 
 	m_bLoaded = false;
 	m_bLoading = false;
-
-	// wait for all pending operations to complete..
-	while( m_nPendingOps > 0 )
-	{
-		ThreadPool::Instance()->ProcessMainThread();
-		boost::this_thread::sleep( boost::posix_time::milliseconds(5));
-	}
-
-	if ( m_pStorage != NULL )
-	{
-		if (! m_pStorage->Stop() )
-		{
-			Log::Error( "SelfGraph", "Failed to stop storage." );
-			return false;
-		}
-
-		delete m_pStorage;
-		m_pStorage = NULL;
-	}
-
+	m_bClosing = true;
+	m_bDropping = false;
+	m_OnGraphClosed = a_Callback;
+	m_spFlushTimer.reset();
+
+	// the storage is closed once all pending operations are done, see OnOpDone()..
+	Flush();
+	ContinueClose();
 	return true;
 }
 
-bool SelfGraph::Drop()
+bool SelfGraph::Drop( OnGraphClosed a_Callback /*= OnGraphClosed()*/ )
 {
 	if (! m_bLoaded )
 		return false;
 	
 	m_bLoaded = false;
 	m_bLoading = false;
-
-	// wait for all pending operations to complete..
-	while( m_nPendingOps > 0 )
-	{
-		ThreadPool::Instance()->ProcessMainThread();
-		boost::this_thread::sleep( boost::posix_time::milliseconds(5));
-	}
-
-	if (m_pGraph != NULL )
-		m_pGraph->DeleteGraph( m_GraphId, DELEGATE( SelfGraph, OnGraphDeleted, const Json::Value &, this ) );
-
-	if ( m_pStorage != NULL )
-	{
-		m_pStorage->Drop();
-		delete m_pStorage;
-		m_pStorage = NULL;
-	}
-
-	m_VertexMap.clear();
-	m_EdgeMap.clear();
+	m_bClosing = true;
+	m_bDropping = true;
+	m_OnGraphClosed = a_Callback;
+	m_spFlushTimer.reset();
+
+	// nothing needs to be written, everything is about to be destroyed..
+	ClearChanges();
+	ContinueClose();
 	return true;
 }
 
@@ -302,6 +323,8 @@ IVertex::SP SelfGraph::CreateVertex( const std::string & a_Label, const Property
 	spNewVertex->SetLabel( a_Label );
 	spNewVertex->SetProperties( a_Properties );
 	spNewVertex->Save();
+	// nothing outside holds a reference into the properties yet
+	spNewVertex->CompactProperties();
 
 	// if we have an active model, then associate all vertexes with that given
 	// model. This is done because titan DB requires an index to be able to search using gremlin.
@@ -313,11 +336,7 @@ IVertex::SP SelfGraph::CreateVertex( const std::string & a_Label, const Property
 
 IVertex::SP SelfGraph::FindVertex(  const VertexId & a_Id )
 {
-	VertexMap::iterator iVertex = m_VertexMap.find( a_Id );
-	if ( iVertex != m_VertexMap.end() )
-		return iVertex->second;
-
-	return IVertex::SP();
+	return m_Vertices.Find( a_Id );
 }
 
 IEdge::SP SelfGraph::CreateEdge(
@@ -341,17 +360,14 @@ IEdge::SP SelfGraph::CreateEdge(
 	spNewEdge->SetDestination( spDest );
 	spNewEdge->SetProperties( a_Properties );
 	spNewEdge->Save();
+	spNewEdge->CompactProperties();
 
 	return spNewEdge;
 }
 
 IEdge::SP SelfGraph::FindEdge(  const VertexId & a_Id )
 {
-	EdgeMap::iterator iEdge = m_EdgeMap.find( a_Id );
-	if ( iEdge != m_EdgeMap.end() )
-		return iEdge->second;
-
-	return IEdge::SP();
+	return m_Edges.Find( a_Id );
 }
 
 std::string SelfGraph::ToString()
@@ -359,6 +375,305 @@ std::string SelfGraph::ToString()
 	return ISerializable::ToJson().toStyledString();
 }
 
+void SelfGraph::Flush()
+{
+	// only one batch at a time, the journal of the batch being written has to stay as it is
+	if ( m_pStorage == NULL || m_bFlushing || !HasChanges() )
+		return;
+
+	// the changes are held until the batch is written, so they can be queued again if it fails
+	m_FlushVertices.swap( m_DirtyVertices );
+	m_FlushEdges.swap( m_DirtyEdges );
+	m_FlushDeleted.swap( m_Deleted );
+
+	// objects with just a new synced version are written with the rest, unless they are already in the batch
+	for( DirtyVertexMap::const_iterator iVertex = m_SyncedVertices.begin(); iVertex != m_SyncedVertices.end(); ++iVertex )
+	{
+		if (! iVertex->second->m_bDropped && m_FlushDeleted.find( iVertex->first ) == m_FlushDeleted.end() )
+			m_FlushVertices.insert( *iVertex );
+	}
+	for( DirtyEdgeMap::const_iterator iEdge = m_SyncedEdges.begin(); iEdge != m_SyncedEdges.end(); ++iEdge )
+	{
+		if (! iEdge->second->m_bDropped && m_FlushDeleted.find( iEdge->first ) == m_FlushDeleted.end() )
+			m_FlushEdges.insert( *iEdge );
+	}
+	m_SyncedVertices.clear();
+	m_SyncedEdges.clear();
+
+	IDataStore::Batch batch;
+	for( DirtyVertexMap::const_iterator iVertex = m_FlushVertices.begin(); iVertex != m_FlushVertices.end(); ++iVertex )
+	{
+		batch.m_Save.push_back( IDataStore::Batch::SaveList::value_type( iVertex->first, 
+			ISerializable::SerializeObject( iVertex->second.get() ) ) );
+	}
+	for( DirtyEdgeMap::const_iterator iEdge = m_FlushEdges.begin(); iEdge != m_FlushEdges.end(); ++iEdge )
+	{
+		batch.m_Save.push_back( IDataStore::Batch::SaveList::value_type( iEdge->first, 
+			ISerializable::SerializeObject( iEdge->second.get() ) ) );
+	}
+	batch.m_Delete.insert( batch.m_Delete.end(), m_FlushDeleted.begin(), m_FlushDeleted.end() );
+
+	// start a new journal for changes made while this batch is written, a rotated journal left by a failed 
+	// batch is kept and the new changes are added to it, since this batch holds it's changes as well.
+	m_Journal.Rotate();
+
+	Log::Debug( "SelfGraph", "Flushing graph %s (%u saved, %u deleted)", m_GraphId.c_str(), 
+		(unsigned int)batch.m_Save.size(), (unsigned int)batch.m_Delete.size() );
+	if ( m_pStorage->Commit( batch, DELEGATE( SelfGraph, OnFlushed, bool, this ) ) )
+	{
+		m_bFlushing = true;
+		OnOpStarted();
+	}
+	else
+	{
+		Log::Error( "SelfGraph", "Failed to start flush of graph %s, changes will be retried.", m_GraphId.c_str() );
+		m_bFlushFailed = true;
+		RequeueFlush();
+	}
+}
+
+void SelfGraph::MarkDirty( const SelfVertex::SP & a_spVertex )
+{
+	if ( m_pStorage == NULL )
+		return;
+
+	std::string key( "vertex_" + a_spVertex->GetId() );
+	m_Deleted.erase( key );
+	m_DirtyVertices[ key ] = a_spVertex;
+	m_Journal.Save( key, ISerializable::SerializeObject( a_spVertex.get() ) );
+}
+
+void SelfGraph::MarkDirty( const SelfEdge::SP & a_spEdge )
+{
+	if ( m_pStorage == NULL )
+		return;
+
+	std::string key( "edge_" + a_spEdge->GetId() );
+	m_Deleted.erase( key );
+	m_DirtyEdges[ key ] = a_spEdge;
+	m_Journal.Save( key, ISerializable::SerializeObject( a_spEdge.get() ) );
+}
+
+void SelfGraph::MarkDeleted( const std::string & a_Key )
+{
+	if ( m_pStorage == NULL )
+		return;
+
+	m_DirtyVertices.erase( a_Key );
+	m_DirtyEdges.erase( a_Key );
+	m_Deleted.insert( a_Key );
+	m_Journal.Delete( a_Key );
+}
+
+void SelfGraph::MarkSynced( const SelfVertex::SP & a_spVertex )
+{
+	if ( m_pStorage == NULL )
+		return;
+
+	// a vertex waiting to be flushed is written with it's synced version anyway, losing this in a 
+	// crash just means the vertex is sent again, so it doesn't go into the journal.
+	std::string key( "vertex_" + a_spVertex->GetId() );
+	if ( m_DirtyVertices.find( key ) == m_DirtyVertices.end() )
+		m_SyncedVertices[ key ] = a_spVertex;
+}
+
+void SelfGraph::MarkSynced( const SelfEdge::SP & a_spEdge )
+{
+	if ( m_pStorage == NULL )
+		return;
+
+	std::string key( "edge_" + a_spEdge->GetId() );
+	if ( m_DirtyEdges.find( key ) == m_DirtyEdges.end() )
+		m_SyncedEdges[ key ] = a_spEdge;
+}
+
+void SelfGraph::OnFlushed( bool a_bSuccess )
+{
+	m_bFlushing = false;
+	m_bFlushFailed = !a_bSuccess;
+
+	if ( a_bSuccess )
+	{
+		// every record in the rotated journal was in this batch
+		m_FlushVertices.clear();
+		m_FlushEdges.clear();
+		m_FlushDeleted.clear();
+		m_Journal.Retire();
+	}
+	else
+	{
+		Log::Error( "SelfGraph", "Failed to flush graph %s, changes will be retried.", m_GraphId.c_str() );
+		RequeueFlush();
+	}
+
+	OnOpDone();
+}
+
+void SelfGraph::RequeueFlush()
+{
+	// anything changed again since the batch was taken is newer than what the batch has
+	for( DirtyVertexMap::const_iterator iVertex = m_FlushVertices.begin(); iVertex != m_FlushVertices.end(); ++iVertex )
+	{
+		if ( m_DirtyVertices.find( iVertex->first ) == m_DirtyVertices.end() 
+			&& m_Deleted.find( iVertex->first ) == m_Deleted.end() )
+			m_DirtyVertices[ iVertex->first ] = iVertex->second;
+	}
+	for( DirtyEdgeMap::const_iterator iEdge = m_FlushEdges.begin(); iEdge != m_FlushEdges.end(); ++iEdge )
+	{
+		if ( m_DirtyEdges.find( iEdge->first ) == m_DirtyEdges.end() 
+			&& m_Deleted.find( iEdge->first ) == m_Deleted.end() )
+			m_DirtyEdges[ iEdge->first ] = iEdge->second;
+	}
+	for( KeySet::const_iterator iKey = m_FlushDeleted.begin(); iKey != m_FlushDeleted.end(); ++iKey )
+	{
+		if ( m_DirtyVertices.find( *iKey ) == m_DirtyVertices.end() 
+			&& m_DirtyEdges.find( *iKey ) == m_DirtyEdges.end() )
+			m_Deleted.insert( *iKey );
+	}
+
+	m_FlushVertices.clear();
+	m_FlushEdges.clear();
+	m_FlushDeleted.clear();
+}
+
+void SelfGraph::Recover()
+{
+	GraphJournal::RecordList records;
+	if (! m_Journal.Read( records ) || records.size() == 0 )
+		return;
+
+	const std::string VERTEX_PREFIX( "vertex_" );
+	const std::string EDGE_PREFIX( "edge_" );
+	for(size_t i=0;i<records.size();++i)
+	{
+		const GraphJournal::Record & record = records[i];
+		if ( record.m_Op == GraphJournal::OP_DELETE )
+		{
+			if ( StringUtil::StartsWith( record.m_Key, VERTEX_PREFIX ) )
+				m_Vertices.Remove( record.m_Key.substr( VERTEX_PREFIX.size() ) );
+			else if ( StringUtil::StartsWith( record.m_Key, EDGE_PREFIX ) )
+				m_Edges.Remove( record.m_Key.substr( EDGE_PREFIX.size() ) );
+			MarkDeleted( record.m_Key );
+		}
+		else if ( StringUtil::StartsWith( record.m_Key, VERTEX_PREFIX ) )
+		{
+			SelfVertex::SP spVertex( ISerializable::DeserializeObject<SelfVertex>( record.m_Data, new SelfVertex() ) );
+			spVertex->SetGraph( this );
+
+			m_Vertices.Add( spVertex );
+			m_Deleted.erase( record.m_Key );
+			m_DirtyVertices[ record.m_Key ] = spVertex;
+		}
+		else if ( StringUtil::StartsWith( record.m_Key, EDGE_PREFIX ) )
+		{
+			SelfEdge::SP spEdge( ISerializable::DeserializeObject<SelfEdge>( record.m_Data, new SelfEdge() ) );
+			spEdge->SetGraph( this );
+
+			m_Edges.Add( spEdge );
+			m_Deleted.erase( record.m_Key );
+			m_DirtyEdges[ record.m_Key ] = spEdge;
+		}
+	}
+
+	Log::Status( "SelfGraph", "Recovered %u changes to graph %s from the journal.", 
+		(unsigned int)records.size(), m_GraphId.c_str() );
+	Flush();
+}
+
+void SelfGraph::ClearChanges()
+{
+	m_DirtyVertices.clear();
+	m_DirtyEdges.clear();
+	m_Deleted.clear();
+	m_SyncedVertices.clear();
+	m_SyncedEdges.clear();
+}
+
+void SelfGraph::OnOpStarted()
+{
+	// the callbacks of our operations are bound to us, so we are kept until the last one is done
+	if ( m_nPendingOps++ == 0 )
+		m_spThis = boost::static_pointer_cast<SelfGraph>( shared_from_this() );
+}
+
+void SelfGraph::OnOpDone()
+{
+	SP spThis( m_spThis );
+
+	m_nPendingOps -= 1;
+	if ( m_bClosing )
+		ContinueClose();
+
+	// we may be destroyed once spThis goes out of scope
+	if ( m_nPendingOps == 0 )
+		m_spThis.reset();
+}
+
+void SelfGraph::ContinueClose()
+{
+	// the operations we waited on may have made changes of their own, those are flushed as well. If the
+	// last batch failed we don't keep retrying, the changes are in the journal for the next load.
+	if (! m_bDropping && !m_bFlushFailed )
+		Flush();
+	if ( m_nPendingOps > 0 )
+		return;
+
+	FinishClose();
+}
+
+void SelfGraph::FinishClose()
+{
+	bool bSuccess = true;
+	bool bDropping = m_bDropping;
+	m_bClosing = false;
+	m_bDropping = false;
+
+	if ( bDropping )
+	{
+		ClearChanges();
+		m_Journal.Remove();
+
+		if (m_pGraph != NULL )
+		{
+			OnOpStarted();
+			m_pGraph->DeleteGraph( m_GraphId, DELEGATE( SelfGraph, OnGraphDeleted, const Json::Value &, this ) );
+		}
+
+		if ( m_pStorage != NULL )
+			m_pStorage->Drop();
+
+		m_Vertices.Clear();
+		m_Edges.Clear();
+	}
+	else
+	{
+		m_Journal.Close();
+
+		if ( m_pStorage != NULL && !m_pStorage->Stop() )
+		{
+			Log::Error( "SelfGraph", "Failed to stop storage." );
+			bSuccess = false;
+		}
+	}
+
+	delete m_pStorage;
+	m_pStorage = NULL;
+
+	OnGraphClosed callback( m_OnGraphClosed );
+	m_OnGraphClosed = OnGraphClosed();
+	if ( callback.IsValid() )
+		callback( bSuccess );
+}
+
+std::string SelfGraph::GetJournalFile() const
+{
+	std::string instanceData( "./" );
+	if ( Config::Instance() != NULL )
+		instanceData = Config::Instance()->GetInstanceDataPath();
+
+	return instanceData + "db/" + m_GraphId + ".journal";
+}
+
 //--------------------------
 
 void SelfGraph::OnGraphCreated( const Json::Value & a_Result )
@@ -367,18 +682,49 @@ void SelfGraph::OnGraphCreated( const Json::Value & a_Result )
 	{
 		Log::Error( "SelfGraph", "Failed to create graph %s", m_GraphId.c_str() );
 		m_bError = true;
+
+		if ( m_OnGraphConnected.IsValid() )
+			m_OnGraphConnected( IGraph::SP() );
 	}
 	else
 	{
 		Log::Status( "SelfGraph", "Graph %s created.", m_GraphId.c_str() );
 		m_bCreated = true;
+
+		// send anything changed locally while we were not connected
+		QueueUnsynced();
+		DiscoverModels();
 	}
 }
 
+void SelfGraph::QueueUnsynced()
+{
+	for( GraphHandle h = 0; h < m_Vertices.GetEnd(); ++h )
+	{
+		SelfVertex::SP spVertex = m_Vertices.Get( h );
+		if ( spVertex && spVertex->GetId()[0] != LOCAL_ID_CHAR 
+			&& spVertex->GetVersion() > spVertex->GetSyncedVersion() )
+			m_spSync->Queue( spVertex );
+	}
+	for( GraphHandle h = 0; h < m_Edges.GetEnd(); ++h )
+	{
+		SelfEdge::SP spEdge = m_Edges.Get( h );
+		if ( spEdge && spEdge->GetId()[0] != LOCAL_ID_CHAR 
+			&& spEdge->GetVersion() > spEdge->GetSyncedVersion() )
+			m_spSync->Queue( spEdge );
+	}
+
+	if ( m_spSync->GetQueued() > 0 )
+		Log::Status( "SelfGraph", "Sending %u changes to graph %s", (unsigned int)m_spSync->GetQueued(), m_GraphId.c_str() );
+	m_spSync->Send();
+}
+
 void SelfGraph::OnGraphDeleted( const Json::Value & a_Result )
 {
 	if ( a_Result.isNull() )
 		Log::Error( "SelfGraph", "Failed to delete graph %s", m_GraphId.c_str() );
+
+	OnOpDone();
 }
 
 void SelfGraph::OnLoadVertex(Json::Value * a_Json )
@@ -392,7 +738,7 @@ void SelfGraph::OnLoadVertex(Json::Value * a_Json )
 			SelfVertex::SP spVertex( ISerializable::DeserializeObject<SelfVertex>( *a_Json, new SelfVertex() ) );
 			spVertex->SetGraph( this );
 
-			m_VertexMap[ spVertex->GetId() ] = spVertex;
+			m_Vertices.Add( spVertex );
 			// TODO: Index properties for faster searching
 		}
 	}
@@ -416,7 +762,7 @@ void SelfGraph::OnLoadEdge(Json::Value * a_Json )
 			SelfEdge::SP spEdge( ISerializable::DeserializeObject<SelfEdge>( *a_Json, new SelfEdge() ) );
 			spEdge->SetGraph( this );
 
-			m_EdgeMap[ spEdge->GetId() ] = spEdge;
+			m_Edges.Add( spEdge );
 			// TODO: Index properties for faster searching
 		}
 	}
@@ -430,18 +776,22 @@ void SelfGraph::OnLoadEdge(Json::Value * a_Json )
 
 void SelfGraph::OnLoadDone()
 {
+	// apply any changes that didn't make it into the store last time
+	Recover();
+
 	// enumerate all edges, connect them to their actual vertexes
-	for( EdgeMap::iterator iEdge = m_EdgeMap.begin(); 
-		iEdge != m_EdgeMap.end(); ++iEdge )
+	for( GraphHandle h = 0; h < m_Edges.GetEnd(); ++h )
 	{
-		SelfEdge::SP spEdge = iEdge->second;
-		VertexMap::iterator iSource = m_VertexMap.find( spEdge->GetSourceId() );
-		VertexMap::iterator iDest = m_VertexMap.find( spEdge->GetDestinationId() );
-		if ( iSource == m_VertexMap.end() || iDest == m_VertexMap.end() )
+		SelfEdge::SP spEdge = m_Edges.Get( h );
+		if (! spEdge )
+			continue;
+		SelfVertex::SP spSource = m_Vertices.Find( spEdge->GetSourceId() );
+		SelfVertex::SP spDest = m_Vertices.Find( spEdge->GetDestinationId() );
+		if ( !spSource || !spDest )
 			continue;
 
-		spEdge->SetSource( iSource->second );
-		spEdge->SetDestination( iDest->second );
+		spEdge->SetSource( spSource );
+		spEdge->SetDestination( spDest );
 	}
 
 	DiscoverModels();
@@ -449,7 +799,7 @@ void SelfGraph::OnLoadDone()
 	// we are done loading..!
 	m_bLoaded = true;
 	Log::Status( "SelfGraph", "Graph %s loaded (%u verts, %u edges local)", 
-		m_GraphId.c_str(), m_VertexMap.size(), m_EdgeMap.size() );
+		m_GraphId.c_str(), m_Vertices.GetSize(), m_Edges.GetSize() );
 
 	if ( m_OnGraphLoaded.IsValid() )
 		m_OnGraphLoaded( shared_from_this() );
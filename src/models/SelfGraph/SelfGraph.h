@@ -22,8 +22,13 @@
 #include <map>
 #include <set>
 
+#include "boost/unordered_map.hpp"
+#include "boost/unordered_set.hpp"
+
 #include "SelfEdge.h"
 #include "SelfVertex.h"
+#include "GraphJournal.h"
+#include "GraphSync.h"
 
 #include "utils/ISerializable.h"
 #include "models/IGraph.h"
@@ -62,8 +67,8 @@ public:
 	virtual bool		Import(const Json::Value & a_Import);
 	virtual bool		Export(Json::Value & a_Export);
 	virtual void		Clear();
-	virtual bool		Close();
-	virtual bool		Drop();
+	virtual bool		Close( OnGraphClosed a_Callback = OnGraphClosed() );
+	virtual bool		Drop( OnGraphClosed a_Callback = OnGraphClosed() );
 
 	virtual void		SetModel(const std::string & a_Group);
 	virtual ITraverser::SP CreateTraverser(const Condition & a_spCond = ITraverser::NULL_CONDITION);
@@ -81,11 +86,27 @@ public:
 
 	virtual std::string ToString();
 
+	//! Write the vertices and edges changed since the last flush to the local data store in one batch. This
+	//! is done on a timer, changes in between are kept in a journal so they can be recovered.
+	void				Flush();
+
+	//! Get a vertex or edge in the local graph by it's handle, returns NULL if the handle is not in use.
+	SelfVertex::SP		GetVertex( GraphHandle a_Handle ) const;
+	SelfEdge::SP		GetEdge( GraphHandle a_Handle ) const;
+
+	//! The object that batches updates to & merges results from the remote graph, this may be replaced
+	//! to sync with something other than the graph service.
+	const GraphSync::SP &	GetSync() const;
+	void				SetSync( const GraphSync::SP & a_spSync );
+
 protected:
 	//! Types
-	typedef std::map<VertexId, SelfVertex::SP>			VertexMap;
+	typedef HandleTable<SelfVertex>						VertexTable;
 	typedef std::map<std::string, IVertex::SP>			GroupMap;
-	typedef std::map<EdgeId, SelfEdge::SP>				EdgeMap;
+	typedef HandleTable<SelfEdge>						EdgeTable;
+	typedef boost::unordered_map<std::string, SelfVertex::SP>	DirtyVertexMap;		// by data store key
+	typedef boost::unordered_map<std::string, SelfEdge::SP>		DirtyEdgeMap;
+	typedef boost::unordered_set<std::string>					KeySet;
 
 	//! Data
 	bool				m_bLoading;
@@ -96,14 +117,51 @@ protected:
 	IDataStore *		m_pStorage;				// local data storage for graph data
 	OnGraphLoaded		m_OnGraphLoaded;
 	OnGraphConnected	m_OnGraphConnected;
+	OnGraphClosed		m_OnGraphClosed;
 	volatile size_t		m_nPendingOps;
+	SP					m_spThis;				// keeps us around while operations are pending
+	bool				m_bClosing;				// true while waiting on pending operations to close
+	bool				m_bDropping;
 
 	GroupMap			m_Models;				// map of all available models
 	IVertex::SP			m_ActiveModel;			// currently active model
 
-	VertexMap			m_VertexMap;			// local vertex data, used only if remote graph is not available
-	EdgeMap				m_EdgeMap;
-
+	VertexTable			m_Vertices;				// local vertex data, used only if remote graph is not available
+	EdgeTable			m_Edges;
+
+	DirtyVertexMap		m_DirtyVertices;		// changes not yet flushed to m_pStorage
+	DirtyEdgeMap		m_DirtyEdges;
+	KeySet				m_Deleted;
+	DirtyVertexMap		m_SyncedVertices;		// only the synced version changed, these are not journaled
+	DirtyEdgeMap		m_SyncedEdges;
+	DirtyVertexMap		m_FlushVertices;		// changes in the batch being written
+	DirtyEdgeMap		m_FlushEdges;
+	KeySet				m_FlushDeleted;
+	GraphJournal		m_Journal;
+	TimerPool::ITimer::SP
+						m_spFlushTimer;
+	bool				m_bFlushing;			// true while a batch is being written
+	bool				m_bFlushFailed;			// true if the last batch failed to write
+	GraphSync::SP		m_spSync;
+
+	void				MarkDirty(const SelfVertex::SP & a_spVertex);
+	void				MarkDirty(const SelfEdge::SP & a_spEdge);
+	void				MarkDeleted(const std::string & a_Key);
+	void				MarkSynced(const SelfVertex::SP & a_spVertex);
+	void				MarkSynced(const SelfEdge::SP & a_spEdge);
+	void				OnFlushed(bool a_bSuccess);
+	void				RequeueFlush();
+	void				Recover();
+	void				ClearChanges();
+	std::string			GetJournalFile() const;
+	bool				HasChanges() const;
+
+	void				OnOpStarted();
+	void				OnOpDone();
+	void				ContinueClose();
+	void				FinishClose();
+
+	void				QueueUnsynced();
 	void				OnGraphCreated(const Json::Value & a_Result);
 	void				OnGraphDeleted(const Json::Value & a_Result);
 	void				OnLoadVertex(Json::Value * a_Json);
@@ -119,7 +177,36 @@ protected:
 	friend class FilterTraverser;
 	friend class OutTraverser;
 	friend class InTraverser;
+	friend class GraphSync;
 };
 
+//----------------------------------
+
+inline SelfVertex::SP SelfGraph::GetVertex( GraphHandle a_Handle ) const
+{
+	return m_Vertices.Get( a_Handle );
+}
+
+inline SelfEdge::SP SelfGraph::GetEdge( GraphHandle a_Handle ) const
+{
+	return m_Edges.Get( a_Handle );
+}
+
+inline const GraphSync::SP & SelfGraph::GetSync() const
+{
+	return m_spSync;
+}
+
+inline void SelfGraph::SetSync( const GraphSync::SP & a_spSync )
+{
+	m_spSync = a_spSync;
+}
+
+inline bool SelfGraph::HasChanges() const
+{
+	return m_DirtyVertices.size() > 0 || m_DirtyEdges.size() > 0 || m_Deleted.size() > 0
+		|| m_SyncedVertices.size() > 0 || m_SyncedEdges.size() > 0;
+}
+
 #endif // SELF_LOCAL_GRAPH_H
 
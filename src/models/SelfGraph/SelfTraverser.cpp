@@ -16,8 +16,11 @@
 */
 
 
+#include <algorithm>
+
 #include "SelfTraverser.h"
 #include "SelfGraph.h"
+#include "utils/ThreadPool.h"
 
 RTTI_IMPL(ISelfTraverser, ITraverser);
 
@@ -62,6 +65,8 @@ bool ISelfTraverser::Start(TraverseCallback a_Callback)
 
 	m_Callback = a_Callback;
 	m_Results.clear();
+	m_Pending.clear();
+	m_bDone = false;
 
 	// If we have a remote graph, send our traverse request to that graph..
 	if ( pGraph->m_pGraph != NULL && !m_bRemoteDone )
@@ -85,34 +90,58 @@ bool ISelfTraverser::Start(TraverseCallback a_Callback)
 
 void ISelfTraverser::ExecuteTraverse()
 {
-	SelfGraph * pGraph = DynamicCast<SelfGraph>( m_pGraph );
-	assert( pGraph != NULL );
+	// traverse the local graph, a top level traverser starts from all the vertexes in the local graph..
+	OnLocalTraverse();
 
-	// if this is a top level filter, then pull all vertex objects from the local graph..
-	if (! m_spNext )
+	// if we got any results or we didn't send a remote traversal, then invoke the callback
+	if ( m_Results.size() > 0 || !m_bRemoteTraverse )
 	{
-		SelfGraph * pGraph = DynamicCast<SelfGraph>( m_pGraph );
-		assert( pGraph );
+		m_bLocalTraverse = true;
+		m_bRemoteTraverse = false;		// the callback is done with by the time the remote results arrive
+		SendResults();
+	}
+}
 
-		m_Results.clear();
-		for( SelfGraph::VertexMap::const_iterator iVertex = pGraph->m_VertexMap.begin(); 
-			iVertex != pGraph->m_VertexMap.end(); ++iVertex )
-		{
-			m_Results.push_back( iVertex->second );
-		}
+void ISelfTraverser::SendResults()
+{
+	if ( m_Offset > 0 )
+		m_Results.erase( m_Results.begin(), m_Results.begin() + std::min( m_Offset, m_Results.size() ) );
+	if ( m_Limit > 0 && m_Results.size() > m_Limit )
+		m_Results.resize( m_Limit );
 
+	if ( m_BatchSize == 0 || m_Results.size() <= m_BatchSize )
+	{
+		m_bDone = true;
+		TraverseCallback callback( m_Callback );
+		m_Callback.Reset();
+		callback( shared_from_this() );
+		return;
 	}
 
-	// traverse the local graph..
-	OnLocalTraverse();
+	// give the results to the callback a batch at a time, so whatever the callback does with them
+	// doesn't hold up the main thread for all the results at once..
+	m_Pending.swap( m_Results );
+	m_Sent = 0;
+	SendBatch();
+}
 
-	// if we got any results or we didn't send a remote traversal, then invoke the callback
-	if ( m_Results.size() > 0 || !m_bRemoteTraverse )
+void ISelfTraverser::SendBatch()
+{
+	size_t end = std::min( m_Sent + m_BatchSize, m_Pending.size() );
+	m_Results.assign( m_Pending.begin() + m_Sent, m_Pending.begin() + end );
+	m_Sent = end;
+	m_bDone = m_Sent >= m_Pending.size();
+
+	TraverseCallback callback( m_Callback );
+	if ( m_bDone )
 	{
-		m_bLocalTraverse = true;
-		m_Callback( shared_from_this() );
+		m_Pending.clear();
 		m_Callback.Reset();
 	}
+	else
+		ThreadPool::Instance()->InvokeOnMain( VOID_DELEGATE( ISelfTraverser, SendBatch, shared_from_this() ) );
+
+	callback( shared_from_this() );
 }
 
 bool ISelfTraverser::SendGremlinQuery()
@@ -140,23 +169,52 @@ bool ISelfTraverser::SendGremlinQuery()
 		traversers.push_front( spTraverse );
 		spTraverse = DynamicCast<ISelfTraverser>( spTraverse->m_spNext );
 	}
+
+	// a chain of filters finds the vertexes without visiting any edges, so we don't need the path
+	m_bPathNeeded = false;
 	for( std::list<ISelfTraverser::SP>::iterator iTraverse = traversers.begin(); 
 		iTraverse != traversers.end(); ++iTraverse )
 	{
 		(*iTraverse)->BuildGremlinQuery( m_Query, m_Bindings );
 		(*iTraverse)->m_bRemoteDone = true;		// set the flag as we traverse, we only want to do one gremlin query for a chain..
+		if ( DynamicCast<FilterTraverser>( iTraverse->get() ) == NULL )
+			m_bPathNeeded = true;
 	}
 
-	// this gives us all the edges and vertexes visited during this query so we can cache them locally..
-	m_Query += ".path()";		
-
-	pGraph->m_pGraph->Query( pGraph->m_GraphId, m_Query, m_Bindings, 
-		DELEGATE( ISelfTraverser, OnGremlinQuery, const Json::Value &, this ) );
+	m_PullOffset = 0;
+	m_Found.clear();
 
 	m_spThis = shared_from_this();
+	if (! SendPull() )
+	{
+		m_spThis.reset();
+		return false;
+	}
+
 	return true;
 }
 
+bool ISelfTraverser::SendPull()
+{
+	SelfGraph * pGraph = DynamicCast<SelfGraph>( m_pGraph );
+	assert( pGraph );
+
+	// pull the results in chunks, we only need enough to fill our limit, the offset is applied to the local results
+	size_t cap = GetResultCap();
+	m_PullEnd = m_PullOffset + pGraph->GetSync()->GetPullSize();
+	if ( cap > 0 && m_PullEnd > cap )
+		m_PullEnd = cap;
+
+	std::string query( m_Query );
+	query += StringUtil::Format( ".range(%u,%u)", (unsigned int)m_PullOffset, (unsigned int)m_PullEnd );
+	// this gives us all the edges and vertexes visited during this query so we can cache them locally..
+	if ( m_bPathNeeded )
+		query += ".path()";		
+
+	return pGraph->GetSync()->Query( query, m_Bindings, 
+		DELEGATE( ISelfTraverser, OnGremlinQuery, const Json::Value &, this ) );
+}
+
 void ISelfTraverser::OnNextDone( ITraverser::SP a_Results)
 {
 	// our next traverser is done, pull it's results into ours then run the traverse
@@ -174,109 +232,39 @@ void ISelfTraverser::OnGremlinQuery( const Json::Value & a_Result )
 	Log::Debug( "ISelfTraverser", "OnGremlinQuery: %s\nResult:\n%s", 
 		m_Query.c_str(), a_Result.toStyledString().c_str() );
 
-	std::set<std::string> foundVertexes;
 	if (! a_Result.isNull() )
 	{
-		const Json::Value & data = a_Result["result"]["data"];
-		for(size_t i=0;i<data.size();++i)
+		size_t results = a_Result["result"]["data"].size();
+		size_t objects = pGraph->GetSync()->Merge( a_Result, m_Found );
+		pGraph->GetSync()->OnPulled( results, objects );
+
+		// a full chunk means there may be more, pull the next chunk unless we have enough for our limit
+		bool bComplete = results < m_PullEnd - m_PullOffset;
+		m_PullOffset += results;
+		if (! bComplete && (GetResultCap() == 0 || m_PullOffset < GetResultCap()) )
 		{
-			// do vertexes first
-			const Json::Value & objects = data[i]["objects"];
-			for(size_t k=0;k<objects.size();++k)
-			{
-				const Json::Value & object = objects[k];
-				std::string type( object["type"].asString() );
-				if ( type == "vertex" ) 
-				{
-					std::string id( object["id"].asString() );
-					std::string label( object["label"].asString() );
-
-					SelfVertex::SP spVertex;
-					SelfGraph::VertexMap::iterator iVertex = pGraph->m_VertexMap.find( id );
-					if ( iVertex == pGraph->m_VertexMap.end() )
-					{
-						spVertex = SelfVertex::SP( new SelfVertex() );
-						spVertex->SetGraph( pGraph );
-						spVertex->SetId( id );
-						spVertex->SetLabel( label );
-					}
-					else
-						spVertex = iVertex->second;
-
-					Json::Value newProps;
-					const Json::Value & props = object["properties"];
-					for( Json::ValueConstIterator iProp = props.begin(); iProp != props.end(); ++iProp )
-						newProps[ iProp.name() ] = (*iProp)[0]["value"];
-
-					spVertex->SetProperties( newProps );
-					spVertex->SaveLocal();
-
-					foundVertexes.insert( id );
-				}
-			}
-
-			// now do the edges, we do this after all the vertexes so we can actually find them in the map..
-			for(size_t k=0;k<objects.size();++k)
-			{
-				const Json::Value & object = objects[k];
-				std::string type( object["type"].asString() );
-				if ( type == "edge" )
-				{
-					std::string id( object["id"].asString() );
-					std::string label( object["label"].asString() );
-					std::string inV( object["inV"].asString() );
-					std::string outV( object["outV"].asString() );
-
-					SelfGraph::VertexMap::iterator iSource = pGraph->m_VertexMap.find( outV );
-					if ( iSource == pGraph->m_VertexMap.end() )
-					{
-						Log::Warning( "ISelfTraverser", "Failed to find outV %s", outV.c_str() );
-						continue;
-					}
-					SelfGraph::VertexMap::iterator iDest = pGraph->m_VertexMap.find( inV );
-					if ( iDest == pGraph->m_VertexMap.end() )
-					{
-						Log::Warning( "ISelfTraverser", "Failed to find inV %s", inV.c_str() );
-						continue;
-					}
-
-					SelfEdge::SP spEdge;
-					SelfGraph::EdgeMap::iterator iEdge = pGraph->m_EdgeMap.find( id );
-					if ( iEdge == pGraph->m_EdgeMap.end() )
-					{
-						spEdge = SelfEdge::SP( new SelfEdge() );
-						spEdge->SetGraph( pGraph );
-						spEdge->SetId( id );
-						spEdge->SetLabel( label );
-						spEdge->SetSource( iSource->second );
-						spEdge->SetDestination( iDest->second );
-					}
-					else
-						spEdge = iEdge->second;
-
-					Json::Value newProps;
-					const Json::Value & props = object["properties"];
-					for( Json::ValueConstIterator iProp = props.begin(); iProp != props.end(); ++iProp )
-						newProps[ iProp.name() ] = (*iProp);
-					spEdge->SetProperties( newProps );
-					spEdge->SaveLocal();
-				}
-			}
+			if ( SendPull() )
+				return;
+			Log::Error( "ISelfTraverser", "Failed to pull more results for query: %s", m_Query.c_str() );
 		}
 
-		// check the local results, remove any vertexes we didn't find in the remote traverse
-		if ( m_bLocalTraverse )
+		// check the local results, remove any vertexes we didn't find in the remote traverse. Only if we
+		// pulled everything, a limit or a failed pull may have stopped us before finding them..
+		if ( m_bLocalTraverse && bComplete )
 		{
 			for(size_t k=0;k<m_Results.size();++k)
 			{
-				if ( foundVertexes.find( m_Results[k]->GetId() ) == foundVertexes.end() )
+				if ( m_Found.find( m_Results[k]->GetId() ) == m_Found.end() )
 				{
 					Log::Status( "SelfTraverser", "Removing local only vertex: %s", m_Results[k]->ToJson().toStyledString().c_str() );
 					m_Results[k]->Drop();
 				}
 			}
 		}
+		m_Found.clear();
 
+		// write everything we merged to the local store in one batch
+		pGraph->Flush();
 	}
 	else
 	{
@@ -364,6 +352,142 @@ std::string ISelfTraverser::GremlinCondition( IConditional::SP a_spCondition, Js
 	return cond;
 }
 
+bool ISelfTraverser::FindLabel( const IConditional::SP & a_spCondition, std::string & a_Label, bool & a_bOnlyLabel )
+{
+	if (! a_spCondition )
+		return false;
+
+	if ( a_spCondition->GetRTTI() == LogicalCondition::GetStaticRTTI() )
+	{
+		// any label required by a term of an AND is required by the whole condition
+		LogicalCondition * pLogicalCond = (LogicalCondition *)a_spCondition.get();
+		if ( pLogicalCond->m_LogicOp != Logic::AND )
+			return false;
+
+		for(size_t i=0;i<pLogicalCond->m_Conditions.size();++i)
+		{
+			if ( FindLabel( pLogicalCond->m_Conditions[i], a_Label, a_bOnlyLabel ) )
+			{
+				a_bOnlyLabel = a_bOnlyLabel && pLogicalCond->m_Conditions.size() == 1;
+				return true;
+			}
+		}
+	}
+	else if ( a_spCondition->GetRTTI().IsType( &EqualityCondition::GetStaticRTTI() ) )
+	{
+		EqualityCondition * pEqCond = (EqualityCondition *)a_spCondition.get();
+		if ( pEqCond->m_Path == "_label" && pEqCond->m_EqualOp == Logic::EQ && pEqCond->m_Value.isString() )
+		{
+			a_Label = pEqCond->m_Value.asString();
+			a_bOnlyLabel = true;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool ISelfTraverser::TestCondition( const PropertyStore & a_Properties ) const
+{
+	if (! m_spCondition )
+		return true;
+	if ( a_Properties.IsExpanded() )
+		return m_spCondition->Test( a_Properties.Get() );
+
+	Json::Value properties;
+	return TestCondition( m_spCondition, a_Properties, properties );
+}
+
+bool ISelfTraverser::TestCondition( const IConditional::SP & a_spCondition, const PropertyStore & a_Properties, Json::Value & a_Json )
+{
+	if ( a_spCondition->GetRTTI() == LogicalCondition::GetStaticRTTI() )
+	{
+		LogicalCondition * pLogicalCond = (LogicalCondition *)a_spCondition.get();
+		if ( (pLogicalCond->m_LogicOp == Logic::AND || pLogicalCond->m_LogicOp == Logic::OR) 
+			&& pLogicalCond->m_Conditions.size() > 0 )
+		{
+			bool bAnd = pLogicalCond->m_LogicOp == Logic::AND;
+			for(size_t i=0;i<pLogicalCond->m_Conditions.size();++i)
+			{
+				if ( TestCondition( pLogicalCond->m_Conditions[i], a_Properties, a_Json ) != bAnd )
+					return !bAnd;
+			}
+			return bAnd;
+		}
+	}
+	else if ( a_spCondition->GetRTTI().IsType( &EqualityCondition::GetStaticRTTI() ) )
+	{
+		// a top level property is read on its own, a path into a property needs the whole json
+		EqualityCondition * pEqCond = (EqualityCondition *)a_spCondition.get();
+		if ( pEqCond->m_Path.find_first_of( "/.[" ) == std::string::npos )
+		{
+			Json::Value property( Json::objectValue );
+			Json::Value value;
+			if ( a_Properties.Find( pEqCond->m_Path, value ) )
+				property[ pEqCond->m_Path ] = value;
+			return pEqCond->Test( property );
+		}
+	}
+
+	if ( a_Json.isNull() )
+		a_Properties.GetJson( a_Json );
+	return a_spCondition->Test( a_Json );
+}
+
+void ISelfTraverser::TraverseEdges( bool a_bOut, VertextList & a_Results )
+{
+	// with a label in our condition, only the edges in the bucket for that label need to be looked at
+	std::string label;
+	bool bOnlyLabel = false;
+	EdgeLabel::Id labelId = 0;
+	bool bLabeled = FindLabel( m_spCondition, label, bOnlyLabel );
+	if ( bLabeled && !EdgeLabel::Find( label, labelId ) )
+		return;				// no edge has ever had this label
+
+	// a top level traverser starts from every vertex in the local graph
+	if (! m_spNext )
+	{
+		SelfGraph * pGraph = DynamicCast<SelfGraph>( m_pGraph );
+		assert( pGraph != NULL );
+
+		m_Results.clear();
+		m_Results.reserve( pGraph->m_Vertices.GetSize() );
+		for( GraphHandle h = 0; h < pGraph->m_Vertices.GetEnd(); ++h )
+		{
+			SelfVertex::SP spVertex = pGraph->m_Vertices.Get( h );
+			if ( spVertex )
+				m_Results.push_back( spVertex );
+		}
+	}
+
+	size_t cap = GetResultCap();
+	for (size_t i = 0; i < m_Results.size() && (cap == 0 || a_Results.size() < cap); ++i)
+	{
+		const IVertex::SP & spVertex = m_Results[i];
+		if (! spVertex)
+			continue;
+
+		const IVertex::EdgeBucketList & buckets = a_bOut ? spVertex->GetOutBuckets() : spVertex->GetInBuckets();
+		for(size_t b=0;b<buckets.size();++b)
+		{
+			if ( bLabeled && buckets[b].m_Label != labelId )
+				continue;
+
+			const IVertex::EdgeList & edges = buckets[b].m_Edges;
+			for(size_t k=0;k<edges.size() && (cap == 0 || a_Results.size() < cap);++k)
+			{
+				if ( bOnlyLabel || TestCondition( edges[k]->GetPropertyStore() ) )
+					a_Results.push_back( a_bOut ? edges[k]->GetDestination() : edges[k]->GetSource() );
+			}
+		}
+	}
+}
+
+size_t ISelfTraverser::GetResultCap() const
+{
+	return m_Limit > 0 ? m_Offset + m_Limit : 0;
+}
+
 //----------------------------------------------
 
 void FilterTraverser::BuildGremlinQuery( std::string & a_Query, Json::Value & a_Bindings )
@@ -378,15 +502,42 @@ void FilterTraverser::BuildGremlinQuery( std::string & a_Query, Json::Value & a_
 
 void FilterTraverser::OnLocalTraverse()
 {
+	// a condition on just the label can be tested without unpacking the properties of every vertex
+	std::string label;
+	bool bOnlyLabel = false;
+	FindLabel( m_spCondition, label, bOnlyLabel );
+
+	// we can stop looking once we have enough results for our limit
+	size_t cap = GetResultCap();
+
 	VertextList results;
-	for(size_t i=0;i<m_Results.size();++i)
+	if (! m_spNext )
 	{
-		const IVertex::SP & spVertex = m_Results[i];
-		if (! spVertex)
-			continue;
-		if ( m_spCondition && !m_spCondition->Test( spVertex->GetProperties() ) )
-			continue;
-		results.push_back( spVertex );
+		// a top level filter tests the vertexes in the local graph directly, without copying them all first
+		SelfGraph * pGraph = DynamicCast<SelfGraph>( m_pGraph );
+		assert( pGraph != NULL );
+
+		for( GraphHandle h = 0; h < pGraph->m_Vertices.GetEnd() && (cap == 0 || results.size() < cap); ++h )
+		{
+			SelfVertex::SP spVertex = pGraph->m_Vertices.Get( h );
+			if (! spVertex)
+				continue;
+			if ( bOnlyLabel ? spVertex->GetLabel() != label : !TestCondition( spVertex->GetPropertyStore() ) )
+				continue;
+			results.push_back( spVertex );
+		}
+	}
+	else
+	{
+		for(size_t i=0;i<m_Results.size() && (cap == 0 || results.size() < cap);++i)
+		{
+			const IVertex::SP & spVertex = m_Results[i];
+			if (! spVertex)
+				continue;
+			if ( bOnlyLabel ? spVertex->GetLabel() != label : !TestCondition( spVertex->GetPropertyStore() ) )
+				continue;
+			results.push_back( spVertex );
+		}
 	}
 	m_Results.swap( results );
 }
@@ -409,20 +560,7 @@ void OutTraverser::BuildGremlinQuery( std::string & a_Query, Json::Value & a_Bin
 void OutTraverser::OnLocalTraverse()
 {
 	VertextList results;
-	for (size_t i = 0; i < m_Results.size(); ++i)
-	{
-		const IVertex::SP & spVertex = m_Results[i];
-		if (! spVertex)
-			continue;
-
-		const IVertex::EdgeList & out = spVertex->GetOutEdges();
-		for(size_t k=0;k<out.size();++k)
-		{
-			if (! m_spCondition || m_spCondition->Test( out[k]->GetProperties() ) )
-				results.push_back( out[k]->GetDestination() );
-		}
-	}
-
+	TraverseEdges( true, results );
 	m_Results.swap( results );
 }
 
@@ -443,20 +581,7 @@ void InTraverser::BuildGremlinQuery( std::string & a_Query, Json::Value & a_Bind
 void InTraverser::OnLocalTraverse()
 {
 	VertextList results;
-	for (size_t i = 0; i < m_Results.size(); ++i)
-	{
-		const IVertex::SP & spVertex = m_Results[i];
-		if (! spVertex)
-			continue;
-
-		const IVertex::EdgeList & in = spVertex->GetInEdges();
-		for(size_t k=0;k<in.size();++k)
-		{
-			if (! m_spCondition || m_spCondition->Test( in[k]->GetProperties() ) )
-				results.push_back( in[k]->GetSource() );
-		}
-	}
-
+	TraverseEdges( false, results );
 	m_Results.swap( results );
 }
 
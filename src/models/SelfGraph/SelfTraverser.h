@@ -19,6 +19,8 @@
 #ifndef SELF_TRAVERSER_H
 #define SELF_TRAVERSER_H
 
+#include <set>
+
 #include "models/ITraverser.h"
 
 //! base class for all traverser classes
@@ -32,10 +34,10 @@ public:
 	typedef boost::shared_ptr<ISelfTraverser>		SP;
 	typedef boost::weak_ptr<ISelfTraverser>			WP;
 
-	ISelfTraverser() : m_bRemoteTraverse( false ), m_bRemoteDone( false ), m_bLocalTraverse( false )
+	ISelfTraverser() : m_bRemoteTraverse( false ), m_bRemoteDone( false ), m_bLocalTraverse( false ), m_Sent( 0 ), m_bPathNeeded( true ), m_PullOffset( 0 ), m_PullEnd( 0 )
 	{}
 	ISelfTraverser(const Condition & a_Condition, SP a_spNext = SP())
-		: ITraverser(a_Condition, a_spNext), m_bRemoteTraverse( false ), m_bRemoteDone( false )
+		: ITraverser(a_Condition, a_spNext), m_bRemoteTraverse( false ), m_bRemoteDone( false ), m_bLocalTraverse( false ), m_Sent( 0 ), m_bPathNeeded( true ), m_PullOffset( 0 ), m_PullEnd( 0 )
 	{}
 
 	//! ITraverser interface
@@ -57,17 +59,38 @@ protected:
 	bool			m_bRemoteDone;
 	bool			m_bLocalTraverse;
 
-	std::string		m_Query;			// our gremlin query
+	std::string		m_Query;			// our gremlin query, without the range of each pull
 	Json::Value		m_Bindings;			// our bindings
+	VertextList		m_Pending;			// results not yet given to the callback when sending in batches
+	size_t			m_Sent;
+	bool			m_bPathNeeded;		// true if we need the edges visited, not just the vertexes found
+	size_t			m_PullOffset;		// number of remote results pulled so far
+	size_t			m_PullEnd;			// end of the range of the pull in progress
+	std::set<std::string>
+					m_Found;			// ID's of the vertexes found by the remote traverse
 
 	//! Static functions
 	static const char * GetEqualityOp(Logic::EqualityOp a_Op);
 	static const char * GetLogicalOp(Logic::LogicalOp a_LogOp);
 	static std::string GremlinCondition( IConditional::SP a_spCondition, Json::Value & a_Bindings );
+	//! Find the label a condition requires, returns false if objects with any label may pass.
+	static bool FindLabel( const IConditional::SP & a_spCondition, std::string & a_Label, bool & a_bOnlyLabel );
+	//! Test our condition against packed properties, without keeping them expanded.
+	bool TestCondition( const PropertyStore & a_Properties ) const;
+	//! Test a condition reading single properties from the store, a_Json is filled with all the properties
+	//! only if a term of the condition can't be tested one property at a time.
+	static bool TestCondition( const IConditional::SP & a_spCondition, const PropertyStore & a_Properties, Json::Value & a_Json );
+	//! Add the other end of each edge that passes our condition to a_Results.
+	void TraverseEdges( bool a_bOut, VertextList & a_Results );
+	//! Returns the number of results needed to fill our limit, or 0 if we need them all.
+	size_t GetResultCap() const;
 
 	//! Execute our traverse
 	void ExecuteTraverse();
 	bool SendGremlinQuery();
+	bool SendPull();
+	void SendResults();
+	void SendBatch();
 
 	//! Callbacks
 	void OnNextDone( ITraverser::SP a_spTraverser );
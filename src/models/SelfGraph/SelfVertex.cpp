@@ -32,8 +32,12 @@ void SelfVertex::Serialize(Json::Value & json)
 	json["m_Id"] = m_Id;
 	json["m_Label"] = m_Label;
 	json["m_fTime"] = m_fTime;
-	if (!m_Properties.isNull())
-		json["m_Properties"] = m_Properties;
+	if ( m_Version > 0 )
+		json["m_Version"] = m_Version;
+	if ( m_SyncedVersion > 0 )
+		json["m_SyncedVersion"] = m_SyncedVersion;
+	if (!m_Properties.IsNull())
+		m_Properties.GetJson( json["m_Properties"] );
 }
 
 void SelfVertex::Deserialize(const Json::Value & json)
@@ -41,8 +45,13 @@ void SelfVertex::Deserialize(const Json::Value & json)
 	m_Id = json["m_Id"].asString();
 	m_Label = json["m_Label"].asString();
 	m_fTime = json["m_fTime"].asDouble();
+	m_Version = json["m_Version"].asUInt();
+	m_SyncedVersion = json["m_SyncedVersion"].asUInt();
 	if (json.isMember("m_Properties"))
-		m_Properties = json["m_Properties"];
+	{
+		m_Properties.Set( json["m_Properties"] );
+		m_Properties.Compact();
+	}
 }
 
 IVertex::EdgeSP SelfVertex::CreateEdge( const std::string & a_Label, const IVertex::SP & a_Dst, const PropertyMap & a_Properties )
@@ -62,6 +71,7 @@ bool SelfVertex::Save()
 	if ( m_bDropped )
 		return false;
 
+	m_Version += 1;
 	SaveLocal();
 
 	// save changes into the graph service first..
@@ -77,9 +87,9 @@ bool SelfVertex::Save()
 				m_spThis = shared_from_this();
 
 				if ( pGraph->m_pGraph->Createvertex( pGraph->m_GraphId,
-					m_Label, m_Properties, DELEGATE( SelfVertex, OnVertexCreated, const Json::Value &, shared_from_this() ) ) )
+					m_Label, m_Properties.GetJson(), DELEGATE( SelfVertex, OnVertexCreated, const Json::Value &, shared_from_this() ) ) )
 				{
-					pGraph->m_nPendingOps += 1;
+					pGraph->OnOpStarted();
 				}
 			}
 			else
@@ -91,15 +101,10 @@ bool SelfVertex::Save()
 		}
 		else
 		{
-			// update existing vertex
-			m_spThis = shared_from_this();
+			// updates are sent to the graph service in batches
 			m_bUpdated = false;		// clear any updated flag
-
-			if ( pGraph->m_pGraph->UpdateVertex( pGraph->m_GraphId,
-				m_Id, m_Properties, DELEGATE( SelfVertex, OnVertexUpdated, const Json::Value &, shared_from_this() ) ) )
-			{
-				pGraph->m_nPendingOps += 1;
-			}
+			pGraph->GetSync()->Queue( shared_from_this() );
+			pGraph->GetSync()->Send();
 		}
 	}
 	else if (! m_bCreated )
@@ -107,7 +112,25 @@ bool SelfVertex::Save()
 		m_bCreated = true;
 		m_NotificationList.Invoke( VertexEvent(IVertex::E_COMMITTED,shared_from_this()) );
 	}
-	
+
+	return true;
+}
+
+bool SelfVertex::SendUpdate()
+{
+	SelfGraph * pGraph = DynamicCast<SelfGraph>( m_pGraph );
+	if ( pGraph == NULL || pGraph->m_pGraph == NULL )
+		return false;
+
+	m_spThis = shared_from_this();
+	if (! pGraph->m_pGraph->UpdateVertex( pGraph->m_GraphId,
+		m_Id, m_Properties.GetJson(), DELEGATE( SelfVertex, OnVertexUpdated, const Json::Value &, shared_from_this() ) ) )
+	{
+		m_spThis.reset();
+		return false;
+	}
+
+	pGraph->OnOpStarted();
 	return true;
 }
 
@@ -127,9 +150,9 @@ bool SelfVertex::Drop()
 
 	// remove all edges connected to this vertex as well..
 	while( m_InEdges.size() > 0 )
-		m_InEdges[m_InEdges.size() - 1]->Drop();
+		m_InEdges.back().m_Edges.back()->Drop();
 	while( m_OutEdges.size() > 0 )
-		m_OutEdges[m_OutEdges.size() - 1]->Drop();
+		m_OutEdges.back().m_Edges.back()->Drop();
 
 	// delete from the cloud
 	if ( pGraph->m_pGraph != NULL && m_Id[0] != LOCAL_ID_CHAR )
@@ -137,7 +160,7 @@ bool SelfVertex::Drop()
 		if ( pGraph->m_pGraph->DeleteVertex( pGraph->m_GraphId, m_Id,
 			DELEGATE( SelfVertex, OnVertexDeleted, const Json::Value &, shared_from_this() ) ) )
 		{
-			pGraph->m_nPendingOps += 1;
+			pGraph->OnOpStarted();
 		}
 	}
 
@@ -160,6 +183,7 @@ void SelfVertex::OnVertexCreated( const Json::Value & a_Result )
 
 		m_Id = id;
 		m_nRetries = 0;
+		m_SyncedVersion = m_Version;
 
 		m_NotificationList.Invoke( VertexEvent(IVertex::E_COMMITTED,shared_from_this()) );
 
@@ -173,15 +197,20 @@ void SelfVertex::OnVertexCreated( const Json::Value & a_Result )
 			else
 				SaveLocal();			// just save local changes such as the ID change
 
-			for(size_t i=0;i<m_OutEdges.size();++i)
+			EdgeList out;
+			GetOutEdges( out );
+			for(size_t i=0;i<out.size();++i)
 			{
-				SelfEdge::SP spEdge = DynamicCast<SelfEdge>( m_OutEdges[i] );
+				SelfEdge::SP spEdge = DynamicCast<SelfEdge>( out[i] );
 				spEdge->SetSourceId( m_Id );
 				spEdge->Save();
 			}
-			for(size_t i=0;i<m_InEdges.size();++i)
+
+			EdgeList in;
+			GetInEdges( in );
+			for(size_t i=0;i<in.size();++i)
 			{
-				SelfEdge::SP spEdge = DynamicCast<SelfEdge>( m_InEdges[i] );
+				SelfEdge::SP spEdge = DynamicCast<SelfEdge>( in[i] );
 				spEdge->SetDestinationId( m_Id );
 				spEdge->Save();
 			}
@@ -196,15 +225,15 @@ void SelfVertex::OnVertexCreated( const Json::Value & a_Result )
 		if ( ! m_bDropped && ++m_nRetries < MAX_RETRIES ) 
 		{
 			if ( pGraph->m_pGraph->Createvertex( pGraph->m_GraphId,
-				m_Label, m_Properties, DELEGATE( SelfVertex, OnVertexCreated, const Json::Value &, shared_from_this() ) ) )
+				m_Label, m_Properties.GetJson(), DELEGATE( SelfVertex, OnVertexCreated, const Json::Value &, shared_from_this() ) ) )
 			{
-				pGraph->m_nPendingOps += 1;
+				pGraph->OnOpStarted();
 				bRetry = true;
 			}
 		}
 	}
 
-	pGraph->m_nPendingOps -= 1;
+	pGraph->OnOpDone();
 	if (! bRetry )
 		m_spThis.reset();
 }
@@ -221,15 +250,21 @@ void SelfVertex::OnVertexUpdated( const Json::Value & a_Result )
 		if ( ++m_nRetries < MAX_RETRIES )
 		{
 			if ( pGraph->m_pGraph->UpdateVertex( pGraph->m_GraphId,
-				m_Id, m_Properties, DELEGATE( SelfVertex, OnVertexUpdated, const Json::Value &, shared_from_this() ) ) )
+				m_Id, m_Properties.GetJson(), DELEGATE( SelfVertex, OnVertexUpdated, const Json::Value &, shared_from_this() ) ) )
 			{
-				pGraph->m_nPendingOps += 1;
+				pGraph->OnOpStarted();
 				bRetry = true;
 			}
 		}
 	}
+	else
+	{
+		m_nRetries = 0;
+		m_SyncedVersion = m_Version;
+		SaveLocal();
+	}
 	
-	pGraph->m_nPendingOps -= 1;
+	pGraph->OnOpDone();
 	if (! bRetry )
 		m_spThis.reset();
 }
@@ -248,7 +283,7 @@ void SelfVertex::OnVertexDeleted( const Json::Value & a_Result )
 			if ( pGraph->m_pGraph->DeleteVertex( pGraph->m_GraphId, m_Id,
 				DELEGATE( SelfVertex, OnVertexDeleted, const Json::Value &, shared_from_this() ) ) )
 			{
-				pGraph->m_nPendingOps += 1;
+				pGraph->OnOpStarted();
 				bRetry = true;
 			}
 		}
@@ -259,7 +294,7 @@ void SelfVertex::OnVertexDeleted( const Json::Value & a_Result )
 		m_nRetries = 0;
 	}
 
-	pGraph->m_nPendingOps -= 1;
+	pGraph->OnOpDone();
 	if (! bRetry )
 		m_spThis.reset();
 }
@@ -271,12 +306,10 @@ void SelfVertex::SaveLocal()
 
 	m_fTime = Time().GetEpochTime();
 
-	pGraph->m_VertexMap[ m_Id ] = shared_from_this();
-	if ( pGraph->m_pStorage != NULL )
-	{
-		pGraph->m_pStorage->Save( "vertex_" + m_Id, 
-			ISerializable::SerializeObject( this ) );
-	}
+	// the graph writes this vertex to local storage with the next flush
+	pGraph->m_Vertices.Add( shared_from_this() );
+	pGraph->MarkDirty( shared_from_this() );
+	pGraph->GetVertexNotifications().Invoke( VertexEvent( IVertex::E_MODIFIED, shared_from_this() ) );
 }
 
 void SelfVertex::DeleteLocal()
@@ -285,9 +318,6 @@ void SelfVertex::DeleteLocal()
 	assert( pGraph != NULL );
 
 	// delete from local storage
-	if ( pGraph->m_pStorage != NULL )
-		pGraph->m_pStorage->Delete( "vertex_" + m_Id );
-
-	pGraph->m_VertexMap.erase( m_Id );
+	pGraph->MarkDeleted( "vertex_" + m_Id );
+	pGraph->m_Vertices.Remove( m_Id );
 }
-
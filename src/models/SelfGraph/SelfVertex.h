@@ -20,6 +20,7 @@
 #define SELF_VERTEX_H
 
 #include "models/IVertex.h"
+#include "HandleTable.h"
 
 class SELF_API SelfVertex : public IVertex
 {
@@ -29,7 +30,8 @@ public:
 	typedef boost::shared_ptr<SelfVertex>		SP;
 	typedef boost::weak_ptr<SelfVertex>			WP;
 
-	SelfVertex() : m_bDropped( false ), m_bCreated( false ), m_bUpdated( false ), m_nRetries( 0 )
+	SelfVertex() : m_bDropped( false ), m_bCreated( false ), m_bUpdated( false ), m_nRetries( 0 ), 
+		m_Handle( INVALID_GRAPH_HANDLE ), m_Version( 0 ), m_SyncedVersion( 0 )
 	{}
 
 	//! ISerializable interface
@@ -48,6 +50,21 @@ public:
 		return boost::static_pointer_cast<SelfVertex>( IVertex::shared_from_this() );
 	}
 
+	//! Get the handle of this vertex in the local graph, INVALID_GRAPH_HANDLE if it's not in the local graph.
+	GraphHandle			GetHandle() const
+	{
+		return m_Handle;
+	}
+	//! The version is increased by each Save(), the synced version is the last version in the remote graph.
+	unsigned int		GetVersion() const
+	{
+		return m_Version;
+	}
+	unsigned int		GetSyncedVersion() const
+	{
+		return m_SyncedVersion;
+	}
+
 protected:
 	//! Data
 	SP					m_spThis;
@@ -55,6 +72,14 @@ protected:
 	bool				m_bCreated;
 	bool				m_bUpdated;
 	int					m_nRetries;
+	GraphHandle			m_Handle;
+	unsigned int		m_Version;
+	unsigned int		m_SyncedVersion;
+
+	void				SetHandle( GraphHandle a_Handle )
+	{
+		m_Handle = a_Handle;
+	}
 
 	//! Callbacks
 	void				OnVertexCreated( const Json::Value & a_Result );
@@ -62,10 +87,13 @@ protected:
 	void				OnVertexDeleted( const Json::Value & a_Result );
 	void				SaveLocal();
 	void				DeleteLocal();
+	bool				SendUpdate();
 
 	friend class SelfGraph;
 	friend class SelfEdge;
 	friend class ISelfTraverser;
+	friend class GraphSync;
+	template<typename T> friend class HandleTable;
 };
 
 #endif
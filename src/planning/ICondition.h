@@ -47,6 +47,11 @@ public:
 	virtual float Test( Goal::SP a_spGoal ) = 0;
 	//! Make a new instance of this ICondition object.
 	virtual ICondition * Clone() = 0;
+	//! Returns the relative cost of Test(), plans evaluate their cheapest conditions first.
+	virtual int GetCost() const
+	{
+		return 1;
+	}
 };
 
 #endif
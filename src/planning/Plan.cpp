@@ -16,6 +16,8 @@
 */
 
 
+#include <algorithm>
+
 #include "Plan.h"
 #include "utils/UniqueID.h"
 
@@ -45,15 +47,20 @@ void Plan::Deserialize(const Json::Value & json)
 	DeserializeVector("m_PreConditions", json, m_PreConditions);
 	DeserializeVector("m_Actions", json, m_Actions);
 	DeserializeVector( "m_PostConditions", json, m_PostConditions );
+
+	SortPreConditions();
 }
 
 
 //! Check if this plan is a valid plan for the given goal object, returns a value between 0.0 (no) to 1.0 (yes)
 float Plan::TestPreConditions( Goal::SP a_spGoal )
 {
+	if ( m_TestOrder.size() != m_PreConditions.size() )
+		SortPreConditions();
+
 	float fValid = 1.0f;
-	for( size_t i=0;i<m_PreConditions.size();++i)
-		fValid *= m_PreConditions[i]->Test( a_spGoal );
+	for( size_t i=0;i<m_TestOrder.size() && fValid > 0.0f;++i)
+		fValid *= m_PreConditions[ m_TestOrder[i] ]->Test( a_spGoal );
 
 	return fValid;
 }
@@ -67,4 +74,25 @@ float Plan::TestPostConditions( Goal::SP a_spGoal )
 	return fValid;
 }
 
+struct PreConditionCost
+{
+	PreConditionCost( const Plan::Conditions & a_Conditions ) : m_Conditions( a_Conditions )
+	{}
+
+	bool operator()( size_t a, size_t b ) const
+	{
+		return m_Conditions[a]->GetCost() < m_Conditions[b]->GetCost();
+	}
 
+	const Plan::Conditions & m_Conditions;
+};
+
+void Plan::SortPreConditions()
+{
+	m_TestOrder.resize( m_PreConditions.size() );
+	for( size_t i=0;i<m_TestOrder.size();++i)
+		m_TestOrder[i] = i;
+
+	// keep the original order for conditions of the same cost
+	std::stable_sort( m_TestOrder.begin(), m_TestOrder.end(), PreConditionCost( m_PreConditions ) );
+}
@@ -67,6 +67,7 @@ public:
 	void SetPostConditions( const Conditions & a_Conditions );
 
 	//! Check if this plan is a valid plan for the given goal object, returns a value between 0.0 (no) to 1.0 (yes)
+	//! The cheapest pre-conditions are tested first, testing stops as soon as any condition returns 0.
 	float TestPreConditions( Goal::SP a_spGoal );	
 	float TestPostConditions( Goal::SP a_spGoal );
 
@@ -77,6 +78,10 @@ private:
 	Conditions		m_PreConditions;
 	Actions			m_Actions;
 	Conditions		m_PostConditions;
+	std::vector<size_t>
+					m_TestOrder;				// indexes into m_PreConditions sorted by cost
+
+	void			SortPreConditions();
 };
 
 //----------------------------------
@@ -114,6 +119,7 @@ inline void Plan::SetPlanId(const std::string & a_PlanId)
 inline void Plan::SetPreConditions(const Conditions & a_Conditions)
 {
 	m_PreConditions = a_Conditions;
+	SortPreConditions();
 }
 
 inline void Plan::SetActions(const Actions & a_Actions)
@@ -16,10 +16,14 @@
 */
 
 
+#include <algorithm>
+
 #include "PlanManager.h"
 #include "planning/actions/UseSkillAction.h"
 #include "planning/conditions/GoalParamsConditon.h"
+#include "planning/conditions/GoalNameCondition.h"
 #include "utils/MD5.h"
+#include "utils/StringUtil.h"
 
 REG_SERIALIZABLE(PlanManager);
 RTTI_IMPL(PlanManager, ISerializable);
@@ -42,6 +46,8 @@ void PlanManager::Deserialize(const Json::Value & json)
 
 	if ( json.isMember( "m_fMinPlanScore" ) )
 		m_fMinPlanScore = json["m_fMinPlanScore"].asFloat();
+
+	RebuildIndex();
 }
 
 bool PlanManager::Start()
@@ -97,16 +103,28 @@ Plan::SP PlanManager::SelectPlan( const Goal::SP & a_spGoal )
 {
 	Plan::SP spBestPlan;
 
-	// search the local DB for the best plan for the provided goal object..
+	// search the local DB for the best plan for the provided goal object, only the plans
+	// that could match this goal are tested..
 	float fBestPlan = m_fMinPlanScore;
-	for( PlanMap::iterator iPlan = m_Plans.begin(); iPlan != m_Plans.end(); ++iPlan )
+	TestPlans( m_Unindexed, a_spGoal, spBestPlan, fBestPlan );
+
+	std::string key;
+	if ( GetIndexKey( a_spGoal->GetName(), key ) )
 	{
-		float fPlanScore = iPlan->second->TestPreConditions( a_spGoal );
-		if ( fPlanScore > fBestPlan )
-		{
-			spBestPlan = iPlan->second;
-			fBestPlan = fPlanScore;
-		}
+		PlanBuckets::const_iterator iBucket = m_GoalIndex.find( key );
+		if ( iBucket != m_GoalIndex.end() )
+			TestPlans( iBucket->second, a_spGoal, spBestPlan, fBestPlan );
+	}
+
+	const ParamsMap & params = a_spGoal->GetParams();
+	for( ParamIndex::const_iterator iParam = m_ParamIndex.begin(); iParam != m_ParamIndex.end(); ++iParam )
+	{
+		if (! params.ValidPath( iParam->first ) || !GetIndexKey( params[ iParam->first ], key ) )
+			continue;
+
+		PlanBuckets::const_iterator iBucket = iParam->second.find( key );
+		if ( iBucket != iParam->second.end() )
+			TestPlans( iBucket->second, a_spGoal, spBestPlan, fBestPlan );
 	}
 
 	return spBestPlan;
@@ -119,7 +137,11 @@ bool PlanManager::AddPlan( const Plan::SP & a_spPlan, bool a_bAddRemote /*= true
 	if (! a_spPlan->IsEnabled() )
 		return false;
 
-	m_Plans[a_spPlan->GetPlanId()] = a_spPlan;
+	Plan::SP & spPlan = m_Plans[a_spPlan->GetPlanId()];
+	if ( spPlan )
+		UnindexPlan( spPlan );
+	spPlan = a_spPlan;
+	IndexPlan( a_spPlan );
 
 	if (a_bAddRemote)
 		new SavePlan( this, a_spPlan );
@@ -139,7 +161,12 @@ bool PlanManager::DeletePlan( const Plan::SP & a_spPlan )
 	if (!spDelete->Start(DELEGATE(PlanManager, OnDeletePlan, ITraverser::SP, this)))
 		Log::Error("PlanManager", "Failed to traverse plans for deletion");
 
-	m_Plans.erase( a_spPlan->GetPlanId() );
+	PlanMap::iterator iPlan = m_Plans.find( a_spPlan->GetPlanId() );
+	if ( iPlan != m_Plans.end() )
+	{
+		UnindexPlan( iPlan->second );
+		m_Plans.erase( iPlan );
+	}
 	return true;
 }
 
@@ -209,6 +236,133 @@ void PlanManager::OnDeletePlan(ITraverser::SP a_spTraverser)
 		a_spTraverser->GetResult(i)->Drop();
 }
 
+void PlanManager::IndexPlan( const Plan::SP & a_spPlan )
+{
+	// a plan is indexed by the first pre-condition that requires a specific value, preferring the goal
+	// name. The index is just a filter, the pre-conditions are still tested for any selected plan.
+	const Plan::Conditions & conditions = a_spPlan->GetPreConditions();
+	std::string key;
+	for(size_t i=0;i<conditions.size();++i)
+	{
+		GoalNameCondition * pName = DynamicCast<GoalNameCondition>( conditions[i].get() );
+		if ( pName != NULL && pName->m_GoalNameOp == ICondition::EQ && GetIndexKey( pName->m_GoalName, key ) )
+		{
+			m_GoalIndex[ key ].push_back( a_spPlan );
+			return;
+		}
+	}
+
+	for(size_t i=0;i<conditions.size();++i)
+	{
+		GoalParamsCondition * pParams = DynamicCast<GoalParamsCondition>( conditions[i].get() );
+		if ( pParams == NULL || (pParams->m_LogicalOp != ICondition::AND && pParams->m_Params.size() > 1) )
+			continue;
+
+		for(size_t k=0;k<pParams->m_Params.size();++k)
+		{
+			const GoalParamsCondition::ParamCondition & param = pParams->m_Params[k];
+			if ( param.m_Op == ICondition::EQ && GetIndexKey( param.m_Value, key ) )
+			{
+				m_ParamIndex[ param.m_Name ][ key ].push_back( a_spPlan );
+				return;
+			}
+		}
+	}
+
+	m_Unindexed.push_back( a_spPlan );
+}
+
+static bool RemovePlan( std::vector<Plan::SP> & a_Plans, const Plan::SP & a_spPlan )
+{
+	std::vector<Plan::SP>::iterator iPlan = std::find( a_Plans.begin(), a_Plans.end(), a_spPlan );
+	if ( iPlan == a_Plans.end() )
+		return false;
+
+	a_Plans.erase( iPlan );
+	return true;
+}
+
+void PlanManager::UnindexPlan( const Plan::SP & a_spPlan )
+{
+	if ( RemovePlan( m_Unindexed, a_spPlan ) )
+		return;
+
+	for( PlanBuckets::iterator iBucket = m_GoalIndex.begin(); iBucket != m_GoalIndex.end(); ++iBucket )
+	{
+		if ( RemovePlan( iBucket->second, a_spPlan ) )
+		{
+			if ( iBucket->second.size() == 0 )
+				m_GoalIndex.erase( iBucket );
+			return;
+		}
+	}
+
+	for( ParamIndex::iterator iParam = m_ParamIndex.begin(); iParam != m_ParamIndex.end(); ++iParam )
+	{
+		for( PlanBuckets::iterator iBucket = iParam->second.begin(); iBucket != iParam->second.end(); ++iBucket )
+		{
+			if ( RemovePlan( iBucket->second, a_spPlan ) )
+			{
+				if ( iBucket->second.size() == 0 )
+					iParam->second.erase( iBucket );
+				if ( iParam->second.size() == 0 )
+					m_ParamIndex.erase( iParam );
+				return;
+			}
+		}
+	}
+}
+
+void PlanManager::RebuildIndex()
+{
+	m_GoalIndex.clear();
+	m_ParamIndex.clear();
+	m_Unindexed.clear();
+
+	for( PlanMap::iterator iPlan = m_Plans.begin(); iPlan != m_Plans.end(); ++iPlan )
+		if ( iPlan->second )
+			IndexPlan( iPlan->second );
+}
+
+void PlanManager::TestPlans( const PlanList & a_Plans, const Goal::SP & a_spGoal, 
+	Plan::SP & a_spBestPlan, float & a_fBestScore )
+{
+	for( PlanList::const_iterator iPlan = a_Plans.begin(); iPlan != a_Plans.end(); ++iPlan )
+	{
+		const Plan::SP & spPlan = *iPlan;
+
+		float fPlanScore = spPlan->TestPreConditions( a_spGoal );
+		if ( fPlanScore < a_fBestScore )
+			continue;
+
+		// on a tie, select the plan with the lowest ID so the order the buckets are tested doesn't matter
+		if ( fPlanScore > a_fBestScore || (a_spBestPlan && spPlan->GetPlanId() < a_spBestPlan->GetPlanId()) )
+		{
+			a_spBestPlan = spPlan;
+			a_fBestScore = fPlanScore;
+		}
+	}
+}
+
+bool PlanManager::GetIndexKey( const Json::Value & a_Value, std::string & a_Key )
+{
+	// a key only needs to match at least every value that could pass the equality test. Strings are
+	// kept as is since EQ is case sensitive in both TestEqualityOp() and GoalParamsCondition, numbers
+	// are normalized so 1 and 1.0 land in the same bucket.
+	if ( a_Value.isString() )
+	{
+		a_Key = a_Value.asString();
+		return true;
+	}
+	if ( a_Value.isNumeric() )
+	{
+		a_Key = StringUtil::Format( "%g", a_Value.asDouble() );
+		return true;
+	}
+
+	return false;
+}
+
 //--------------------------------------------
 
 PlanManager::SavePlan::SavePlan( PlanManager * a_pManager, const Plan::SP & a_spPlan ) : 
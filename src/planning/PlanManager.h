@@ -90,9 +90,26 @@ private:
 		void OnFindPlan( ITraverser::SP a_spTraverser );
 	};
 
+	//! Plans are indexed by the goal name or goal param value required by their pre-conditions, so SelectPlan()
+	//! only needs to test the plans that could possibly match a goal.
+	typedef std::vector< Plan::SP >					PlanList;
+	typedef std::map< std::string, PlanList >		PlanBuckets;
+	typedef std::map< std::string, PlanBuckets >	ParamIndex;
+
 	//! Data
 	bool			m_bActive;
 	volatile int	m_nPendingOps;
+	PlanBuckets		m_GoalIndex;				// goal name -> plans
+	ParamIndex		m_ParamIndex;				// param path -> param value -> plans
+	PlanList		m_Unindexed;				// plans that must always be tested
+
+	void			IndexPlan( const Plan::SP & a_spPlan );
+	void			UnindexPlan( const Plan::SP & a_spPlan );
+	void			RebuildIndex();
+	void			TestPlans( const PlanList & a_Plans, const Goal::SP & a_spGoal, 
+						Plan::SP & a_spBestPlan, float & a_fBestScore );
+
+	static bool		GetIndexKey( const Json::Value & a_Value, std::string & a_Key );
 
 	//! Serialized Data
 	PlanMap			m_Plans;
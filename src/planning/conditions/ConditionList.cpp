@@ -57,3 +57,11 @@ ICondition * ConditionList::Clone()
 	return new ConditionList(*this);
 }
 
+int ConditionList::GetCost() const
+{
+	int cost = 1;
+	for (size_t i = 0; i < m_Conditions.size(); ++i)
+		cost += m_Conditions[i]->GetCost();
+	return cost;
+}
+
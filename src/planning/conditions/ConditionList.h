@@ -38,6 +38,7 @@ struct SELF_API ConditionList : public ICondition
 	//! ICondition interface
 	virtual float Test(Goal::SP a_spGoal);
 	virtual ICondition * Clone();
+	virtual int GetCost() const;
 
 	std::vector<ICondition::SP>	m_Conditions;		// additional conditions to test
 	LogicalOp					m_LogicalOp;		// logical operation between all conditions
@@ -17,6 +17,7 @@
 
 
 #include "GoalParamsConditon.h"
+#include "utils/StringUtil.h"
 
 REG_SERIALIZABLE(GoalParamsCondition);
 RTTI_IMPL(GoalParamsCondition, ICondition);
@@ -51,31 +52,111 @@ void GoalParamsCondition::Deserialize(const Json::Value & json)
 		c.m_Op = GetEqualityOp(( *iElement)["m_Op"].asString() );
 	}
 	m_LogicalOp = GetLogicalOp(json["m_LogicalOp"].asString());
+
+	Compile();
 }
 
 //! ICondition interface
 float GoalParamsCondition::Test(Goal::SP a_spGoal)
 {
-	const ParamsMap & params = a_spGoal->GetParams();
+	if ( m_Compiled.size() != m_Params.size() )
+		Compile();
 
-	std::vector<bool> values;
-	for (size_t i = 0; i < m_Params.size(); ++i)
+	const Json::Value & params = a_spGoal->GetParams().GetData();
+	if ( m_bShortCircuit )
 	{
-		Json::Value value;
-		if (params.ValidPath(m_Params[i].m_Name))
-			value = params[m_Params[i].m_Name];
-
-		values.push_back( TestEqualityOp(m_Params[i].m_Op, m_Params[i].m_Value, value) );
+		// AND stops at the first false, OR stops at the first true..
+		bool bAnd = m_LogicalOp == AND;
+		for (size_t i = 0; i < m_Compiled.size(); ++i)
+		{
+			if ( TestParam( m_Compiled[i], params ) != bAnd )
+				return bAnd ? 0.0f : 1.0f;
+		}
+		return bAnd ? 1.0f : 0.0f;
 	}
 
+	std::vector<bool> values;
+	for (size_t i = 0; i < m_Compiled.size(); ++i)
+		values.push_back( TestParam( m_Compiled[i], params ) );
+
 	if (TestLogicalOp(m_LogicalOp, values))
 		return 1.0f;
 
 	return 0.0f;
 }
 
+void GoalParamsCondition::Compile()
+{
+	m_Compiled.resize( m_Params.size() );
+	for (size_t i = 0; i < m_Params.size(); ++i)
+	{
+		const ParamCondition & param = m_Params[i];
+
+		CompiledParam & compiled = m_Compiled[i];
+		compiled = CompiledParam();
+		compiled.m_Index = i;
+		StringUtil::Split( param.m_Name, std::string( 1, PARAMS_PATH_SEPERATOR ), compiled.m_Path );
+
+		// only EQ & NE against simple values have a fast path, anything else goes through TestEqualityOp(). Strings
+		// are compared case sensitive just like TestEqualityOp(), PlanManager indexes plans by the same rule.
+		if ( param.m_Op == EQ || param.m_Op == NE )
+		{
+			compiled.m_bEqual = param.m_Op == EQ;
+			if ( param.m_Value.isNull() )
+				compiled.m_Type = VT_NULL;
+			else if ( param.m_Value.isString() )
+			{
+				compiled.m_Type = VT_STRING;
+				compiled.m_String = param.m_Value.asString();
+			}
+			else if ( param.m_Value.isBool() )
+			{
+				compiled.m_Type = VT_BOOL;
+				compiled.m_bValue = param.m_Value.asBool();
+			}
+		}
+	}
+
+	// with no params, leave the result up to TestLogicalOp()
+	m_bShortCircuit = m_Params.size() > 0 && (m_LogicalOp == AND || m_LogicalOp == OR);
+}
+
+bool GoalParamsCondition::TestParam( const CompiledParam & a_Param, const Json::Value & a_Params )
+{
+	const Json::Value * pValue = ParamsMap::ResolvePath( a_Params, a_Param.m_Path );
+
+	bool bEqual = false;
+	switch( a_Param.m_Type )
+	{
+	case VT_NULL:
+		bEqual = pValue == NULL || pValue->isNull();
+		break;
+	case VT_STRING:
+		bEqual = pValue != NULL && pValue->isString() && a_Param.m_String == pValue->asCString();
+		break;
+	case VT_BOOL:
+		bEqual = pValue != NULL && pValue->isBool() && pValue->asBool() == a_Param.m_bValue;
+		break;
+	default:
+		{
+			const ParamCondition & param = m_Params[ a_Param.m_Index ];
+			if ( pValue != NULL )
+				return TestEqualityOp( param.m_Op, param.m_Value, *pValue );
+			return TestEqualityOp( param.m_Op, param.m_Value, Json::Value() );
+		}
+	}
+
+	return bEqual == a_Param.m_bEqual;
+}
+
 ICondition * GoalParamsCondition::Clone()
 {
 	return new GoalParamsCondition(*this);
 }
 
+int GoalParamsCondition::GetCost() const
+{
+	// each param requires a path lookup into the goal params
+	return 1 + (int)m_Params.size();
+}
+
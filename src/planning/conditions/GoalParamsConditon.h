@@ -43,15 +43,18 @@ struct SELF_API GoalParamsCondition : public ICondition
 	};
 
 	//! COnstructions
-	GoalParamsCondition() : m_LogicalOp(AND)
+	GoalParamsCondition() : m_LogicalOp(AND), m_bShortCircuit(false)
 	{}
 	GoalParamsCondition(const std::vector<ParamCondition> & a_Params, LogicalOp a_LogOp = AND) :
-		m_Params(a_Params), m_LogicalOp(a_LogOp)
-	{}
+		m_Params(a_Params), m_LogicalOp(a_LogOp), m_bShortCircuit(false)
+	{
+		Compile();
+	}
 	GoalParamsCondition(const std::string & a_Name, const  Json::Value & a_Value, 
-		EqualityOp a_Op = ICondition::EQ, LogicalOp a_LogOp = AND) : m_LogicalOp(a_LogOp)
+		EqualityOp a_Op = ICondition::EQ, LogicalOp a_LogOp = AND) : m_LogicalOp(a_LogOp), m_bShortCircuit(false)
 	{
 		m_Params.push_back(ParamCondition(a_Name, a_Value, a_Op));
+		Compile();
 	}
 
 	//! ISerializable interface
@@ -61,10 +64,43 @@ struct SELF_API GoalParamsCondition : public ICondition
 	//! ICondition interface
 	virtual float Test(Goal::SP a_spGoal);
 	virtual ICondition * Clone();
+	virtual int GetCost() const;
+
+	//! Compile m_Params for Test(), this must be called again if m_Params is changed.
+	void Compile();
 
 	std::vector<ParamCondition>
 						m_Params;
 	LogicalOp			m_LogicalOp;
+
+private:
+	//! Types
+	enum ValueType {
+		VT_JSON,				// no fast path, TestEqualityOp() is used
+		VT_NULL,
+		VT_STRING,
+		VT_BOOL
+	};
+
+	//! A param condition with the path split and the value converted for testing
+	struct CompiledParam
+	{
+		CompiledParam() : m_Index(0), m_Type(VT_JSON), m_bEqual(true), m_bValue(false)
+		{}
+
+		size_t						m_Index;		// index into m_Params
+		std::vector<std::string>	m_Path;
+		ValueType					m_Type;
+		bool						m_bEqual;		// true for EQ, false for NE
+		std::string					m_String;
+		bool						m_bValue;
+	};
+
+	//! Data
+	std::vector<CompiledParam>	m_Compiled;
+	bool						m_bShortCircuit;	// true if m_LogicalOp can stop at the first result
+
+	bool TestParam( const CompiledParam & a_Param, const Json::Value & a_Params );
 };
 
 #endif
@@ -0,0 +1,352 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include <algorithm>
+#include <math.h>
+
+#include "AudioBus.h"
+#include "ISensor.h"
+#include "utils/Time.h"
+#include "utils/Log.h"
+#include "utils/ThreadPool.h"
+
+AudioBus::BusMap AudioBus::sm_Buses;
+
+AudioBus::SP AudioBus::Attach( ISensor * a_pSensor, float a_fBufferTime /*= 2.0f*/ )
+{
+	if ( a_pSensor == NULL )
+		return SP();
+
+	BusMap::iterator iBus = sm_Buses.find( a_pSensor );
+	if ( iBus != sm_Buses.end() )
+	{
+		SP spBus = iBus->second.lock();
+		if ( spBus )
+			return spBus;
+	}
+
+	SP spBus( new AudioBus( a_pSensor, a_fBufferTime ) );
+	sm_Buses[ a_pSensor ] = spBus;
+
+	// we don't hold a reference to ourselves, we un-subscribe once all our consumers let go of us.
+	spBus->m_spListener->m_wpBus = spBus;
+	a_pSensor->Subscribe( DELEGATE( Listener, OnAudioData, IData *, spBus->m_spListener.get() ) );
+	return spBus;
+}
+
+AudioBus::AudioBus( ISensor * a_pSensor, float a_fBufferTime ) :
+	m_pSensor( a_pSensor ),
+	m_fBufferTime( a_fBufferTime ),
+	m_Rate( 0 ),
+	m_Channels( 0 ),
+	m_ResampleRate( 0 ),
+	m_pFrame( NULL ),
+	m_spListener( new Listener( a_pSensor ) ),
+	m_fResamplePos( 0.0 ),
+	m_LastSample( 0.0f )
+{}
+
+AudioBus::~AudioBus()
+{
+	// the sensor can't be changed while it's sending us a frame, un-subscribe once it's done
+	ThreadPool * pPool = ThreadPool::Instance();
+	if ( m_spListener->m_bSending && pPool != NULL )
+	{
+		m_spListener->m_spSensor = m_pSensor->shared_from_this();
+		pPool->InvokeOnMain( VOID_DELEGATE( Listener, Unsubscribe, m_spListener ) );
+	}
+	else
+		m_spListener->Unsubscribe();
+
+	BusMap::iterator iBus = sm_Buses.find( m_pSensor );
+	if ( iBus != sm_Buses.end() && iBus->second.expired() )
+		sm_Buses.erase( iBus );
+}
+
+boost::uint64_t AudioBus::GetWritten( BufferType a_Type ) const
+{
+	switch( a_Type )
+	{
+	case BT_PCM16:
+		return m_PCM.m_Written;
+	case BT_FLOAT:
+		return m_Float.m_Written;
+	case BT_RESAMPLED:
+		return m_Resampled.m_Written;
+	default:
+		return 0;
+	}
+}
+
+double AudioBus::GetSampleTime( BufferType a_Type, boost::uint64_t a_Position ) const
+{
+	double rate = a_Type == BT_RESAMPLED ? (double)m_ResampleRate : (double)(m_Rate * m_Channels);
+	if ( rate <= 0.0 )
+		return 0.0;
+
+	double time = a_Type == BT_PCM16 ? m_PCM.m_fTime : a_Type == BT_FLOAT ? m_Float.m_fTime : m_Resampled.m_fTime;
+	return time - ((double)GetWritten( a_Type ) - (double)a_Position) / rate;
+}
+
+void AudioBus::SetResampleRate( unsigned int a_Rate )
+{
+	if ( m_ResampleRate != a_Rate )
+	{
+		m_ResampleRate = a_Rate;
+		m_fResamplePos = 0.0;
+		Allocate();
+	}
+}
+
+void AudioBus::Subscribe( FrameCallback a_Callback )
+{
+	m_Callbacks.push_back( a_Callback );
+}
+
+void AudioBus::Unsubscribe( void * a_pObject )
+{
+	for( CallbackList::iterator iCallback = m_Callbacks.begin(); iCallback != m_Callbacks.end(); )
+	{
+		if ( (*iCallback).IsObject( a_pObject ) )
+			m_Callbacks.erase( iCallback++ );
+		else
+			++iCallback;
+	}
+}
+
+AudioBus::Cursor AudioBus::OpenCursor( BufferType a_Type ) const
+{
+	Cursor cursor;
+	cursor.m_Type = a_Type;
+	cursor.m_Position = GetWritten( a_Type );
+	return cursor;
+}
+
+size_t AudioBus::Available( Cursor & a_Cursor ) const
+{
+	switch( a_Cursor.m_Type )
+	{
+	case BT_PCM16:
+		return m_PCM.Available( a_Cursor.m_Position, a_Cursor.m_Dropped );
+	case BT_FLOAT:
+		return m_Float.Available( a_Cursor.m_Position, a_Cursor.m_Dropped );
+	case BT_RESAMPLED:
+		return m_Resampled.Available( a_Cursor.m_Position, a_Cursor.m_Dropped );
+	default:
+		return 0;
+	}
+}
+
+size_t AudioBus::Read( Cursor & a_Cursor, short * a_pSamples, size_t a_nMax )
+{
+	if ( a_Cursor.m_Type != BT_PCM16 )
+		return 0;
+	return m_PCM.Read( a_Cursor.m_Position, a_Cursor.m_Dropped, a_pSamples, a_nMax );
+}
+
+size_t AudioBus::Read( Cursor & a_Cursor, float * a_pSamples, size_t a_nMax )
+{
+	if ( a_Cursor.m_Type == BT_FLOAT )
+		return m_Float.Read( a_Cursor.m_Position, a_Cursor.m_Dropped, a_pSamples, a_nMax );
+	if ( a_Cursor.m_Type == BT_RESAMPLED )
+		return m_Resampled.Read( a_Cursor.m_Position, a_Cursor.m_Dropped, a_pSamples, a_nMax );
+	return 0;
+}
+
+void AudioBus::Allocate()
+{
+	size_t samples = (size_t)(m_Rate * m_Channels * m_fBufferTime);
+	m_PCM.Allocate( samples );
+	m_Float.Allocate( samples );
+	m_Resampled.Allocate( (size_t)(m_ResampleRate * m_fBufferTime) );
+}
+
+void AudioBus::OnAudioData( IData * a_pData )
+{
+	AudioData * pAudio = DynamicCast<AudioData>( a_pData );
+	if ( pAudio == NULL )
+		return;
+
+	if ( pAudio->GetBPS() == 16 && pAudio->GetChannels() > 0 && pAudio->GetFrequency() > 0 )
+	{
+		if ( pAudio->GetFrequency() != m_Rate || pAudio->GetChannels() != m_Channels )
+		{
+			Log::Debug( "AudioBus", "Audio format changed to %u hz, %u channels.", pAudio->GetFrequency(), pAudio->GetChannels() );
+
+			m_Rate = pAudio->GetFrequency();
+			m_Channels = pAudio->GetChannels();
+			m_fResamplePos = 0.0;
+			Allocate();
+		}
+
+		double now = Time().GetEpochTime();
+		const short * pSamples = (const short *)pAudio->GetWaveData().data();
+		size_t nSamples = pAudio->GetWaveData().size() / sizeof(short);
+
+		m_PCM.Write( pSamples, nSamples );
+		m_PCM.m_fTime = now;
+
+		// convert once, every consumer of this sensor reads from the same buffer. Our buffers
+		// only grow, so there is nothing to allocate once we have seen the largest frame.
+		if ( m_Convert.size() < nSamples )
+			m_Convert.resize( nSamples );
+		for(size_t i=0;i<nSamples;++i)
+			m_Convert[i] = ((float)pSamples[i]) / 32768.0f;
+		if ( nSamples > 0 )
+			m_Float.Write( &m_Convert[0], nSamples );
+		m_Float.m_fTime = now;
+
+		size_t nFrames = nSamples / m_Channels;
+		if ( m_ResampleRate > 0 && nFrames > 0 )
+		{
+			// mix down to mono, then linear resample carrying our position over to the next frame
+			if ( m_Mono.size() < nFrames )
+				m_Mono.resize( nFrames );
+			for(size_t i=0;i<nFrames;++i)
+			{
+				float sum = 0.0f;
+				for(unsigned int c=0;c<m_Channels;++c)
+					sum += m_Convert[ i * m_Channels + c ];
+				m_Mono[i] = sum / m_Channels;
+			}
+
+			double step = (double)m_Rate / m_ResampleRate;
+			size_t nMaxResampled = (size_t)(nFrames / step) + 2;
+			if ( m_Resample.size() < nMaxResampled )
+				m_Resample.resize( nMaxResampled );
+
+			size_t nResampled = 0;
+			while( m_fResamplePos <= (double)(nFrames - 1) && nResampled < nMaxResampled )
+			{
+				int i0 = (int)floor( m_fResamplePos );
+				double frac = m_fResamplePos - i0;
+				float a = i0 < 0 ? m_LastSample : m_Mono[i0];
+				float b = (size_t)(i0 + 1) < nFrames ? m_Mono[i0 + 1] : a;
+				m_Resample[ nResampled++ ] = (float)(a + (b - a) * frac);
+				m_fResamplePos += step;
+			}
+			m_fResamplePos -= nFrames;
+			m_LastSample = m_Mono[nFrames - 1];
+
+			if ( nResampled > 0 )
+				m_Resampled.Write( &m_Resample[0], nResampled );
+			m_Resampled.m_fTime = now;
+		}
+	}
+
+	// hold a reference, a callback may release the last reference to this bus
+	SP spThis( shared_from_this() );
+
+	m_pFrame = pAudio;
+	CallbackList callbacks( m_Callbacks );
+	for( CallbackList::iterator iCallback = callbacks.begin(); iCallback != callbacks.end(); ++iCallback )
+		(*iCallback)( this );
+	m_pFrame = NULL;
+}
+
+//----------------------------------
+
+void AudioBus::Listener::OnAudioData( IData * a_pData )
+{
+	m_bSending = true;
+	AudioBus::SP spBus = m_wpBus.lock();
+	if ( spBus )
+	{
+		spBus->OnAudioData( a_pData );
+		// if this is the last reference, the bus will leave us subscribed until the sensor is done
+		spBus.reset();
+	}
+	m_bSending = false;
+}
+
+void AudioBus::Listener::Unsubscribe()
+{
+	if ( m_pSensor != NULL )
+		m_pSensor->Unsubscribe( this );
+	m_pSensor = NULL;
+	m_spSensor.reset();
+}
+
+//----------------------------------
+
+template<typename T>
+void AudioBus::Ring<T>::Allocate( size_t a_nSamples )
+{
+	m_Samples.assign( a_nSamples, T() );
+	m_Start = m_Written;
+}
+
+template<typename T>
+void AudioBus::Ring<T>::Write( const T * a_pSamples, size_t a_nCount )
+{
+	size_t capacity = m_Samples.size();
+	if ( capacity == 0 )
+	{
+		m_Written += a_nCount;
+		return;
+	}
+
+	// only the newest samples will fit..
+	if ( a_nCount > capacity )
+	{
+		a_pSamples += a_nCount - capacity;
+		m_Written += a_nCount - capacity;
+		a_nCount = capacity;
+	}
+
+	size_t start = (size_t)(m_Written % capacity);
+	size_t first = std::min( a_nCount, capacity - start );
+	std::copy( a_pSamples, a_pSamples + first, m_Samples.begin() + start );
+	std::copy( a_pSamples + first, a_pSamples + a_nCount, m_Samples.begin() );
+	m_Written += a_nCount;
+}
+
+template<typename T>
+size_t AudioBus::Ring<T>::Available( boost::uint64_t & a_Position, boost::uint64_t & a_Dropped ) const
+{
+	// move the cursor forward to the oldest sample we still have, if it fell behind
+	boost::uint64_t oldest = m_Written > m_Samples.size() ? m_Written - m_Samples.size() : 0;
+	if ( oldest < m_Start )
+		oldest = m_Start;
+	if ( a_Position < oldest )
+	{
+		a_Dropped += oldest - a_Position;
+		a_Position = oldest;
+	}
+	if ( a_Position > m_Written )
+		a_Position = m_Written;
+
+	return (size_t)(m_Written - a_Position);
+}
+
+template<typename T>
+size_t AudioBus::Ring<T>::Read( boost::uint64_t & a_Position, boost::uint64_t & a_Dropped, T * a_pSamples, size_t a_nMax ) const
+{
+	size_t count = std::min( Available( a_Position, a_Dropped ), a_nMax );
+	if ( count == 0 )
+		return 0;
+
+	size_t capacity = m_Samples.size();
+	size_t start = (size_t)(a_Position % capacity);
+	size_t first = std::min( count, capacity - start );
+	std::copy( m_Samples.begin() + start, m_Samples.begin() + start + first, a_pSamples );
+	std::copy( m_Samples.begin(), m_Samples.begin() + (count - first), a_pSamples + first );
+	a_Position += count;
+
+	return count;
+}
@@ -0,0 +1,199 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#ifndef SELF_AUDIO_BUS_H
+#define SELF_AUDIO_BUS_H
+
+#include <list>
+#include <map>
+#include <vector>
+
+#include "boost/enable_shared_from_this.hpp"
+#include "boost/shared_ptr.hpp"
+#include "boost/cstdint.hpp"
+
+#include "utils/Delegate.h"
+#include "AudioData.h"
+#include "SelfLib.h"
+
+class ISensor;
+
+//! This object subscribes to a single audio sensor and converts each frame of audio once into ring
+//! buffers of 16-bit samples, normalized float samples, and optionally mono float samples resampled
+//! to another rate. Any number of consumers can share the bus for a sensor, each reading the buffers
+//! through their own Cursor. Use AudioBus::Attach() to get the bus for a sensor, the bus
+//! un-subscribes from the sensor once the last reference is released.
+class SELF_API AudioBus : public boost::enable_shared_from_this<AudioBus>
+{
+public:
+	//! Types
+	typedef boost::shared_ptr<AudioBus>		SP;
+	typedef boost::weak_ptr<AudioBus>		WP;
+	typedef Delegate<AudioBus *>			FrameCallback;
+
+	enum BufferType {
+		BT_PCM16,				// interleaved 16-bit samples as received from the sensor
+		BT_FLOAT,				// interleaved samples normalized to -1.0 to 1.0
+		BT_RESAMPLED,			// mono samples normalized and resampled to GetResampleRate()
+
+		BT_COUNT
+	};
+
+	//! A consumers read position in one of our buffers
+	struct Cursor
+	{
+		Cursor() : m_Type( BT_FLOAT ), m_Position( 0 ), m_Dropped( 0 )
+		{}
+
+		BufferType			m_Type;
+		boost::uint64_t		m_Position;			// absolute sample position
+		boost::uint64_t		m_Dropped;			// number of samples lost because this cursor fell behind
+	};
+
+	//! Construction
+	//! Get the shared bus for the given sensor, a_fBufferTime is how many seconds of audio are kept
+	//! in each buffer, this is only used when the bus is first created.
+	static SP Attach( ISensor * a_pSensor, float a_fBufferTime = 2.0f );
+	~AudioBus();
+
+	//! Accessors
+	ISensor *			GetSensor() const;
+	unsigned int		GetRate() const;
+	unsigned int		GetChannels() const;
+	unsigned int		GetResampleRate() const;
+	//! Returns the frame currently being processed, this is only valid during a FrameCallback.
+	const AudioData *	GetFrame() const;
+	//! Returns the total number of samples ever written into the given buffer
+	boost::uint64_t		GetWritten( BufferType a_Type ) const;
+	//! Returns the epoch time of the sample at the given position in the given buffer.
+	double				GetSampleTime( BufferType a_Type, boost::uint64_t a_Position ) const;
+
+	//! Mutators
+	//! Enable the resampled buffer at the given rate, 0 disables it.
+	void				SetResampleRate( unsigned int a_Rate );
+
+	//! Add a callback that is invoked after each frame is written into our buffers.
+	void				Subscribe( FrameCallback a_Callback );
+	//! Remove all callbacks for the given object.
+	void				Unsubscribe( void * a_pObject );
+
+	//! Create a cursor that starts reading at the next sample written into the given buffer.
+	Cursor				OpenCursor( BufferType a_Type ) const;
+	//! Returns the number of samples waiting for the given cursor.
+	size_t				Available( Cursor & a_Cursor ) const;
+	//! Read samples for the cursor, returns the number of samples read.
+	size_t				Read( Cursor & a_Cursor, short * a_pSamples, size_t a_nMax );
+	size_t				Read( Cursor & a_Cursor, float * a_pSamples, size_t a_nMax );
+
+private:
+	//! Types
+	typedef std::list< FrameCallback >			CallbackList;
+	typedef std::map< ISensor *, WP >			BusMap;
+
+	//! This object is subscribed to the sensor instead of the bus, so the bus can be released
+	//! from inside a frame callback while the sensor is still sending that frame.
+	struct Listener
+	{
+		typedef boost::shared_ptr<Listener>		SP;
+
+		Listener( ISensor * a_pSensor ) : m_pSensor( a_pSensor ), m_bSending( false )
+		{}
+
+		ISensor *			m_pSensor;
+		WP					m_wpBus;
+		bool				m_bSending;			// true while the sensor is sending us a frame
+		boost::shared_ptr<ISensor>
+							m_spSensor;			// keeps the sensor around until a deferred un-subscribe
+
+		void OnAudioData( IData * a_pData );
+		void Unsubscribe();
+	};
+
+	template<typename T>
+	struct Ring
+	{
+		Ring() : m_Written( 0 ), m_Start( 0 ), m_fTime( 0.0 )
+		{}
+
+		std::vector<T>		m_Samples;
+		boost::uint64_t		m_Written;
+		boost::uint64_t		m_Start;			// position of the first sample since we were last allocated
+		double				m_fTime;			// time of the last sample written
+
+		void Allocate( size_t a_nSamples );
+		void Write( const T * a_pSamples, size_t a_nCount );
+		size_t Read( boost::uint64_t & a_Position, boost::uint64_t & a_Dropped, T * a_pSamples, size_t a_nMax ) const;
+		size_t Available( boost::uint64_t & a_Position, boost::uint64_t & a_Dropped ) const;
+	};
+
+	//! Construction
+	AudioBus( ISensor * a_pSensor, float a_fBufferTime );
+
+	//! Data
+	ISensor *			m_pSensor;
+	float				m_fBufferTime;
+	unsigned int		m_Rate;
+	unsigned int		m_Channels;
+	unsigned int		m_ResampleRate;
+	const AudioData *	m_pFrame;
+	CallbackList		m_Callbacks;
+	Listener::SP		m_spListener;
+
+	Ring<short>			m_PCM;
+	Ring<float>			m_Float;
+	Ring<float>			m_Resampled;
+	std::vector<float>	m_Convert;				// conversion buffers, kept to avoid allocating each frame
+	std::vector<float>	m_Mono;
+	std::vector<float>	m_Resample;
+	double				m_fResamplePos;
+	float				m_LastSample;
+
+	static BusMap		sm_Buses;
+
+	void				Allocate();
+	void				OnAudioData( IData * a_pData );
+};
+
+//----------------------------------
+
+inline ISensor * AudioBus::GetSensor() const
+{
+	return m_pSensor;
+}
+
+inline unsigned int AudioBus::GetRate() const
+{
+	return m_Rate;
+}
+
+inline unsigned int AudioBus::GetChannels() const
+{
+	return m_Channels;
+}
+
+inline unsigned int AudioBus::GetResampleRate() const
+{
+	return m_ResampleRate;
+}
+
+inline const AudioData * AudioBus::GetFrame() const
+{
+	return m_pFrame;
+}
+
+#endif // SELF_AUDIO_BUS_H
@@ -21,35 +21,59 @@
 
 #include <vector>
 #include <cstring>
+
+#include "boost/cstdint.hpp"
+
 #include "IData.h"
 #include "SelfLib.h"
 
-//! This class holds png encoded depth data 
+//! This class holds a depth frame, either png encoded or as raw 16-bit depth samples. The raw frame is
+//! packed as a u16 width, u16 height, then width * height u16 depth samples in row order, this lets a sensor
+//! hand depth to the extractors and classifiers without a png encode and decode at each step.
 class SELF_API DepthVideoData : public IData
 {
 public:
 	RTTI_DECL();
 
-	DepthVideoData()
+	//! Types
+	typedef boost::uint16_t		Sample;
+
+	//! Constants
+	static const char *			RAW_DEPTH_TYPE;
+	static const size_t			RAW_HEADER_SIZE = sizeof(boost::uint16_t) * 2;
+
+	DepthVideoData() : m_bRaw( false )
 	{}
 	DepthVideoData(std::vector<unsigned char> a_BinaryData) :
-		m_BinaryData((const char *)&a_BinaryData[0], a_BinaryData.size())
+		m_BinaryData((const char *)&a_BinaryData[0], a_BinaryData.size()),
+		m_bRaw( false )
 	{}
 	DepthVideoData( const std::string & a_BinaryData ) :
-		m_BinaryData( a_BinaryData )
+		m_BinaryData( a_BinaryData ),
+		m_bRaw( false )
 	{}
 	DepthVideoData(const unsigned char * a_pBinaryData, int a_BinaryLength) :
-		m_BinaryData((const char *)a_pBinaryData, a_BinaryLength)
+		m_BinaryData((const char *)a_pBinaryData, a_BinaryLength),
+		m_bRaw( false )
 	{}
+	//! Construct a raw depth frame, a_pSamples must contain a_Width * a_Height samples.
+	DepthVideoData( int a_Width, int a_Height, const Sample * a_pSamples ) :
+		m_bRaw( true )
+	{
+		PackRaw( a_Width, a_Height, a_pSamples, m_BinaryData );
+	}
 
 	//! ISerializable interface
 	virtual void Serialize(Json::Value & json)
 	{
 		json["m_BinaryData"] = StringUtil::EncodeBase64( m_BinaryData );
+		if ( m_bRaw )
+			json["m_bRaw"] = m_bRaw;
 	}
 	virtual void Deserialize(const Json::Value & json)
 	{
 		m_BinaryData = StringUtil::DecodeBase64( json["m_BinaryData"].asString() );
+		m_bRaw = json["m_bRaw"].isBool() && json["m_bRaw"].asBool() && IsRawValid( m_BinaryData );
 	}
 
 	//! IData interface
@@ -60,19 +84,77 @@ public:
 	}
 	virtual bool FromBinary( const std::string & a_Type, const std::string & a_Input)
 	{
+		m_bRaw = StringUtil::Compare( a_Type, RAW_DEPTH_TYPE, true ) == 0;
+		if ( m_bRaw && !IsRawValid( a_Input ) )
+			return false;
 		m_BinaryData = a_Input;
 		return true;
 	}
 
 	//!Accessors
+	//! Returns the png data, or the packed raw frame if IsRaw() is true.
 	const std::string & GetBinaryData() const
 	{
 		return m_BinaryData;
 	}
+	bool IsRaw() const
+	{
+		return m_bRaw;
+	}
+	int GetWidth() const
+	{
+		return m_bRaw ? GetRawWidth( m_BinaryData ) : 0;
+	}
+	int GetHeight() const
+	{
+		return m_bRaw ? GetRawHeight( m_BinaryData ) : 0;
+	}
+	//! Returns the raw depth samples, NULL if this is a png frame.
+	const Sample * GetSamples() const
+	{
+		return m_bRaw ? GetRawSamples( m_BinaryData ) : NULL;
+	}
+
+	//! Helpers for the packed raw depth format
+	static void PackRaw( int a_Width, int a_Height, const Sample * a_pSamples, std::string & a_Output )
+	{
+		boost::uint16_t header[2] = { (boost::uint16_t)a_Width, (boost::uint16_t)a_Height };
+		size_t samples = (size_t)a_Width * (size_t)a_Height;
+
+		a_Output.resize( RAW_HEADER_SIZE + (samples * sizeof(Sample)) );
+		memcpy( &a_Output[0], header, RAW_HEADER_SIZE );
+		if ( samples > 0 )
+			memcpy( &a_Output[RAW_HEADER_SIZE], a_pSamples, samples * sizeof(Sample) );
+	}
+	static bool IsRawValid( const std::string & a_Raw )
+	{
+		if ( a_Raw.size() < RAW_HEADER_SIZE )
+			return false;
+		return a_Raw.size() == RAW_HEADER_SIZE + ((size_t)GetRawWidth( a_Raw ) * GetRawHeight( a_Raw ) * sizeof(Sample));
+	}
+	static int GetRawWidth( const std::string & a_Raw )
+	{
+		boost::uint16_t width = 0;
+		if ( a_Raw.size() >= RAW_HEADER_SIZE )
+			memcpy( &width, a_Raw.data(), sizeof(width) );
+		return width;
+	}
+	static int GetRawHeight( const std::string & a_Raw )
+	{
+		boost::uint16_t height = 0;
+		if ( a_Raw.size() >= RAW_HEADER_SIZE )
+			memcpy( &height, a_Raw.data() + sizeof(height), sizeof(height) );
+		return height;
+	}
+	static const Sample * GetRawSamples( const std::string & a_Raw )
+	{
+		return a_Raw.size() >= RAW_HEADER_SIZE ? (const Sample *)(a_Raw.data() + RAW_HEADER_SIZE) : NULL;
+	}
 
 private:
 	//!Data
 	std::string			m_BinaryData;
+	bool				m_bRaw;
 };
 
 #endif //SELF_DEPTH_VIDEODATA_H
@@ -23,35 +23,49 @@
 #include "utils/Sound.h"
 #include "utils/TimerPool.h"
 
-#include <fstream>
-#include <time.h>
+#include <algorithm>
+#include <string.h>
 
 #include "boost/filesystem/operations.hpp"
 #include "boost/filesystem/path.hpp"
-#include "boost/progress.hpp"
-#include <iostream>
+#include "boost/interprocess/file_mapping.hpp"
+#include "boost/interprocess/mapped_region.hpp"
 
 //REG_OVERRIDE_SERIALIZABLE( Microphone, DiskAudioSensor );
 REG_SERIALIZABLE( DiskAudioSensor );
 RTTI_IMPL(DiskAudioSensor, Microphone);
 
+static unsigned int ReadLE( const char * a_pData, size_t a_Bytes )
+{
+	unsigned int value = 0;
+	for(size_t i=0;i<a_Bytes;++i)
+		value |= ((unsigned int)(unsigned char)a_pData[i]) << (i * 8);
+	return value;
+}
+
+static boost::chrono::steady_clock::duration ToDuration( double a_fSeconds )
+{
+	return boost::chrono::duration_cast<boost::chrono::steady_clock::duration>( boost::chrono::duration<double>( a_fSeconds ) );
+}
+
 DiskAudioSensor::DiskAudioSensor() : 
 	m_CaptureAudio( false ), 
 	m_Paused( false ),
-	m_Error( false ),
 	m_CaptureStopped( true ), 
-	m_RecordingsPath( "" )
-{
-	Log::Status("DiskAudioSensor", "making an audio sensor");
-}
+	m_RecordingsPath( "./etc/tests/audio_files" ),
+	m_fFrameTime( 0.1f ),
+	m_fReplaySpeed( 1.0f ),
+	m_fStartDelay( 5.0f ),
+	m_fSilenceTime( 1.5f ),
+	m_fFlushTime( 30.0f ),
+	m_MaxPendingFrames( 10 ),
+	m_PendingFrames( 0 )
+{}
 
 DiskAudioSensor::~DiskAudioSensor()
 {
 	// stop our streaming thread..
-	m_CaptureAudio = false;
-	while(! m_CaptureStopped )
-		tthread::this_thread::yield();
-
+	StopCapture();
 }
 
 void DiskAudioSensor::Serialize(Json::Value & json)
@@ -59,6 +73,12 @@ void DiskAudioSensor::Serialize(Json::Value & json)
 	Microphone::Serialize(json);
 
 	json["m_RecordingsPath"] = m_RecordingsPath;
+	json["m_fFrameTime"] = m_fFrameTime;
+	json["m_fReplaySpeed"] = m_fReplaySpeed;
+	json["m_fStartDelay"] = m_fStartDelay;
+	json["m_fSilenceTime"] = m_fSilenceTime;
+	json["m_fFlushTime"] = m_fFlushTime;
+	json["m_MaxPendingFrames"] = m_MaxPendingFrames;
 }
 
 void DiskAudioSensor::Deserialize(const Json::Value & json)
@@ -67,6 +87,25 @@ void DiskAudioSensor::Deserialize(const Json::Value & json)
 
 	if ( json.isMember("m_RecordingsPath") )
 		m_RecordingsPath = json["m_RecordingsPath"].asString();
+	if ( json["m_fFrameTime"].isNumeric() )
+		m_fFrameTime = json["m_fFrameTime"].asFloat();
+	if ( json["m_fReplaySpeed"].isNumeric() )
+		m_fReplaySpeed = json["m_fReplaySpeed"].asFloat();
+	if ( json["m_fStartDelay"].isNumeric() )
+		m_fStartDelay = json["m_fStartDelay"].asFloat();
+	if ( json["m_fSilenceTime"].isNumeric() )
+		m_fSilenceTime = json["m_fSilenceTime"].asFloat();
+	if ( json["m_fFlushTime"].isNumeric() )
+		m_fFlushTime = json["m_fFlushTime"].asFloat();
+	if ( json["m_MaxPendingFrames"].isNumeric() )
+		m_MaxPendingFrames = json["m_MaxPendingFrames"].asInt();
+
+	if ( m_RecordingsPath.size() == 0 )
+		m_RecordingsPath = "./etc/tests/audio_files";
+	if ( m_fFrameTime <= 0.0f )
+		m_fFrameTime = 0.1f;
+	if ( m_MaxPendingFrames < 1 )
+		m_MaxPendingFrames = 1;
 }
 
 bool DiskAudioSensor::OnStart()
@@ -84,108 +123,250 @@ bool DiskAudioSensor::OnStart()
 
 bool DiskAudioSensor::OnStop()
 {
-	m_CaptureAudio = false;
-	while(! m_CaptureStopped )
-		tthread::this_thread::yield();
+	StopCapture();
 	return true;
 }
 
 void DiskAudioSensor::OnPause()
 {
+	boost::unique_lock<boost::mutex> lock( m_CaptureLock );
 	m_Paused = true;
 }
 
 void DiskAudioSensor::OnResume()
 {
+	boost::unique_lock<boost::mutex> lock( m_CaptureLock );
 	m_Paused = false;
+	m_CaptureEvent.notify_all();
 }
 
-void DiskAudioSensor::CaptureAudio( void * )
+void DiskAudioSensor::StopCapture()
 {
-	std::string pauseData;
-	pauseData.append(30000, '\0');
-
-	double time = Time().GetEpochTime() + 5.0;
-	while (Time().GetEpochTime() < time)
-		tthread::this_thread::yield();
-
-	std::vector<std::string> audioTestFiles;
+	boost::unique_lock<boost::mutex> lock( m_CaptureLock );
+	m_CaptureAudio = false;
+	m_CaptureEvent.notify_all();
 
+	while(! m_CaptureStopped )
+		m_CaptureEvent.wait( lock );
+}
 
-	boost::filesystem::directory_iterator end_iter;
-	for ( boost::filesystem::directory_iterator dir_itr( "./etc/tests/audio_files" );
-		  dir_itr != end_iter;
-		  ++dir_itr )
+void DiskAudioSensor::CaptureAudio( void * )
+{
+	m_Deadline = Clock::now();
+	if ( WaitUntil( m_Deadline + ToDuration( m_fStartDelay ) ) )
 	{
+		std::vector<std::string> audioTestFiles;
+
 		try
 		{
-
-			if ( boost::filesystem::is_regular_file( dir_itr->status() ) )
+			boost::filesystem::directory_iterator end_iter;
+			for ( boost::filesystem::directory_iterator dir_itr( m_RecordingsPath ); dir_itr != end_iter; ++dir_itr )
 			{
-				std::cout << "this is what is being added to the vector: " << dir_itr->path().filename() << "\n";
-				audioTestFiles.push_back(dir_itr->path().filename().string());
-
+				if ( boost::filesystem::is_regular_file( dir_itr->status() ) )
+					audioTestFiles.push_back( dir_itr->path().string() );
 			}
 		}
 		catch ( const std::exception & ex )
 		{
-			Log::Status("DiskAudioSensor", "Caught Exception: %s", ex.what() );
+			Log::Error( "DiskAudioSensor", "Caught Exception: %s", ex.what() );
 		}
+		std::sort( audioTestFiles.begin(), audioTestFiles.end() );
+
+		Log::Status( "DiskAudioSensor", "Replaying %u files from %s at %.1fx", 
+			(unsigned int)audioTestFiles.size(), m_RecordingsPath.c_str(), m_fReplaySpeed );
+
+		m_Deadline = Clock::now();
+		for(std::vector<std::string>::const_iterator it = audioTestFiles.begin(); it != audioTestFiles.end(); ++it)
+		{
+			if (! WaitForResume() )
+				break;
+			if (! ReplayFile( *it ) )
+				break;
+		}
+
+		//Give some time for things to flush
+		Log::Status( "DiskAudioSensor", "cleaning up audio sensor" );
+		WaitUntil( Clock::now() + ToDuration( m_fFlushTime ) );
 	}
 
-	Log::Status("DiskAudioSensor", "GOT ALL FILES DOING WORK NOW");
-	for(std::vector<std::string>::const_iterator it = audioTestFiles.begin(); it != audioTestFiles.end(); ++it)
-	{
-		Log::Status("DiskAudioSensor", "file name: %s", (*it).c_str());
+	boost::unique_lock<boost::mutex> lock( m_CaptureLock );
+	m_CaptureStopped = true;
+	m_CaptureEvent.notify_all();
+}
 
-		while(m_Paused && m_CaptureAudio)
-			tthread::this_thread::yield();
-		if(!m_CaptureAudio)
-			break;
+bool DiskAudioSensor::ReplayFile( const std::string & a_File )
+{
+	Format format;
+	format.m_Rate = m_RecordingHZ;
+	format.m_Channels = m_RecordingChannels;
+	format.m_Bits = m_RecordingBits;
+
+	try {
+		if ( boost::filesystem::file_size( a_File ) == 0 )
+			return true;
+
+		// map the file rather than reading it, recordings used for load testing can be large
+		boost::interprocess::file_mapping file( a_File.c_str(), boost::interprocess::read_only );
+		boost::interprocess::mapped_region region( file, boost::interprocess::read_only );
+
+		const char * pData = (const char *)region.get_address();
+		size_t offset = 0;
+		size_t bytes = region.get_size();
+		if (! ParseWave( pData, region.get_size(), format, offset, bytes ) )
+		{
+			Log::Error( "DiskAudioSensor", "Unsupported audio file %s, format: 0x%x, rate: %d, channels: %d, bits: %d", 
+				a_File.c_str(), format.m_Tag, format.m_Rate, format.m_Channels, format.m_Bits );
+			return true;
+		}
+
+		Log::Status( "DiskAudioSensor", "Replaying %s, rate: %d, channels: %d, bits: %d", 
+			a_File.c_str(), format.m_Rate, format.m_Channels, format.m_Bits );
+
+		Clock::time_point start = Clock::now();
+		if (! ReplayAudio( pData + offset, bytes, format ) )
+			return false;
 
-		try {
-			std::string fullPath = "./etc/tests/audio_files/" + (*it);
-			std::ifstream input( fullPath.c_str(), std::ios::binary );
-			std::string buffer((std::istreambuf_iterator<char>(input)),
-							   (std::istreambuf_iterator<char>()));
-			buffer.append(15000, '\0');
+		double elapsed = boost::chrono::duration<double>( Clock::now() - start ).count();
+		double duration = ((double)bytes / format.GetFrameSize()) / format.m_Rate;
+		Log::Debug( "DiskAudioSensor", "Replayed %.2f seconds of audio in %.2f seconds.", duration, elapsed );
 
-			if((buffer.size() & 1) == 1)
-				buffer.append(1, '\0');
+		// silence between each file, 8-bit PCM is unsigned
+		std::string silence( (size_t)(m_fSilenceTime * format.m_Rate) * format.GetFrameSize(), format.m_Bits == 8 ? (char)0x80 : '\0' );
+		if ( silence.size() > 0 && !ReplayAudio( silence.data(), silence.size(), format ) )
+			return false;
+	}
+	catch(const std::exception & ex )
+	{
+		Log::Error("DiskAudioSensor", "Caught Exception: %s", ex.what() );
+	}
+
+	return m_CaptureAudio;
+}
 
-			ThreadPool::Instance()->InvokeOnMain<AudioData *>(DELEGATE(DiskAudioSensor, SendAudio, AudioData *, this),
-															  new AudioData(buffer, 16000, 1, 16 ));
+bool DiskAudioSensor::ReplayAudio( const char * a_pData, size_t a_Bytes, const Format & a_Format )
+{
+	size_t frameSize = a_Format.GetFrameSize();
+	size_t chunkSize = std::max<size_t>( 1, (size_t)(a_Format.m_Rate * m_fFrameTime) ) * frameSize;
 
-			double waitUntil = Time().GetEpochTime() + (buffer.size() / (16000.0 * 2.0));
-			while (Time().GetEpochTime() < waitUntil)
-				tthread::this_thread::yield();
+	for(size_t offset = 0; offset < a_Bytes; offset += chunkSize )
+	{
+		if (! WaitForResume() )
+			return false;
 
-			ThreadPool::Instance()->InvokeOnMain<AudioData *>(DELEGATE(DiskAudioSensor, SendAudio, AudioData *, this),
-															  new AudioData(pauseData, 16000, 1, 16 ));
+		size_t bytes = std::min( chunkSize, a_Bytes - offset );
+		bytes -= bytes % frameSize;
+		if ( bytes == 0 )
+			break;
 
-			waitUntil = Time().GetEpochTime() + (pauseData.size() / (16000.0 * 2.0));
-			while (Time().GetEpochTime() < waitUntil)
-				tthread::this_thread::yield();
+		// limit the frames waiting on the main thread, so replaying faster than real-time can't flood it
+		{
+			boost::unique_lock<boost::mutex> lock( m_CaptureLock );
+			while( m_CaptureAudio && m_PendingFrames >= m_MaxPendingFrames )
+				m_CaptureEvent.wait( lock );
+			if (! m_CaptureAudio )
+				return false;
+			m_PendingFrames += 1;
 		}
-		catch(const std::exception & ex )
+
+		ThreadPool::Instance()->InvokeOnMain<AudioData *>( DELEGATE(DiskAudioSensor, SendAudio, AudioData *, this),
+			new AudioData( std::string( a_pData + offset, bytes ), a_Format.m_Rate, a_Format.m_Channels, a_Format.m_Bits ) );
+
+		if ( m_fReplaySpeed > 0.0f )
 		{
-			Log::Error("DiskAudioSensor", "Caught Exception: %s", ex.what() );
+			// pace against when this frame should end rather than when we finished sending it, so we don't drift
+			double seconds = (((double)bytes / frameSize) / a_Format.m_Rate) / m_fReplaySpeed;
+			Clock::time_point now = Clock::now();
+			if ( m_Deadline + ToDuration( 1.0 ) < now )
+				m_Deadline = now;				// we fell too far behind, don't burst to catch up
+			m_Deadline += ToDuration( seconds );
+
+			if (! WaitUntil( m_Deadline ) )
+				return false;
 		}
 	}
 
-	//Give 30 seconds for things to flush
-	time = Time().GetEpochTime();
+	return m_CaptureAudio;
+}
 
-	Log::Status("DiskAudioSensor", "cleaning up audio sensor");
+bool DiskAudioSensor::WaitUntil( const Clock::time_point & a_Time )
+{
+	boost::unique_lock<boost::mutex> lock( m_CaptureLock );
+	while( m_CaptureAudio && Clock::now() < a_Time )
+		m_CaptureEvent.wait_until( lock, a_Time );
 
-	while (Time().GetEpochTime() < (time + 30.0))
-		tthread::this_thread::yield();
+	return m_CaptureAudio;
+}
 
-	m_CaptureStopped = true;
+bool DiskAudioSensor::WaitForResume()
+{
+	if (! m_Paused )
+		return m_CaptureAudio;
+
+	boost::unique_lock<boost::mutex> lock( m_CaptureLock );
+	while( m_Paused && m_CaptureAudio )
+		m_CaptureEvent.wait( lock );
+
+	m_Deadline = Clock::now();
+	return m_CaptureAudio;
 }
 
 void DiskAudioSensor::SendAudio( AudioData * a_pData )
 {
+	{
+		boost::unique_lock<boost::mutex> lock( m_CaptureLock );
+		m_PendingFrames -= 1;
+		m_CaptureEvent.notify_all();
+	}
+
 	// now send the data to all subscribers for this microphone..
 	SendData(a_pData);
-}
\ No newline at end of file
+}
+
+bool DiskAudioSensor::ParseWave( const char * a_pData, size_t a_Size, Format & a_Format, size_t & a_Offset, size_t & a_Bytes )
+{
+	// no header, this is raw PCM in the format of our microphone
+	if ( a_Size < 12 || memcmp( a_pData, "RIFF", 4 ) != 0 || memcmp( a_pData + 8, "WAVE", 4 ) != 0 )
+	{
+		a_Offset = 0;
+		a_Bytes = a_Size;
+	}
+	else
+	{
+		bool bData = false;
+		size_t offset = 12;
+		while( offset + 8 <= a_Size )
+		{
+			size_t size = ReadLE( a_pData + offset + 4, 4 );
+			if ( memcmp( a_pData + offset, "fmt ", 4 ) == 0 && offset + 8 + 16 <= a_Size )
+			{
+				a_Format.m_Tag = ReadLE( a_pData + offset + 8, 2 );
+				a_Format.m_Channels = ReadLE( a_pData + offset + 10, 2 );
+				a_Format.m_Rate = ReadLE( a_pData + offset + 12, 4 );
+				a_Format.m_Bits = ReadLE( a_pData + offset + 22, 2 );
+
+				// WAVE_FORMAT_EXTENSIBLE keeps the real format in the first 2 bytes of the sub-format GUID
+				if ( a_Format.m_Tag == Format::EXTENSIBLE_TAG && size >= 40 && offset + 8 + 26 <= a_Size )
+					a_Format.m_Tag = ReadLE( a_pData + offset + 8 + 24, 2 );
+			}
+			else if ( memcmp( a_pData + offset, "data", 4 ) == 0 )
+			{
+				// streamed WAV files may have an unknown data size, so clamp to the end of the file
+				a_Offset = offset + 8;
+				a_Bytes = std::min( size, a_Size - a_Offset );
+				bData = true;
+				break;
+			}
+
+			if ( size > a_Size - offset - 8 )
+				break;
+			offset += 8 + size + (size & 1);
+		}
+
+		if (! bData )
+			return false;
+	}
+
+	// float, ADPCM and other compressed formats would be streamed as noise
+	return a_Format.m_Tag == Format::PCM_TAG && (a_Format.m_Bits == 8 || a_Format.m_Bits == 16) 
+		&& a_Format.m_Channels > 0 && a_Format.m_Rate > 0;
+}
@@ -19,8 +19,16 @@
 #ifndef SELF_DISKAUDIOSENSOR_H
 #define SELF_DISKAUDIOSENSOR_H
 
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/condition_variable.hpp"
+#include "boost/chrono.hpp"
+
 #include "sensors/Microphone.h"
 
+//! This sensor replays recorded audio files from disk as if they were coming from a microphone. PCM WAV files
+//! may be any rate, channel count, and 8 or 16 bit, files without a RIFF header are treated as raw PCM in
+//! the format of the Microphone. Files are memory mapped and streamed in frames paced against a monotonic
+//! clock, m_fReplaySpeed can be raised above 1.0 to replay faster than real-time for load testing.
 class SELF_API DiskAudioSensor : public Microphone
 {
 public:
@@ -30,6 +38,26 @@ public:
 	typedef boost::shared_ptr<DiskAudioSensor>		SP;
 	typedef boost::weak_ptr<DiskAudioSensor>		WP;
 
+	//! Format of a file being replayed
+	struct Format
+	{
+		Format() : m_Tag( PCM_TAG ), m_Rate( 0 ), m_Channels( 0 ), m_Bits( 0 )
+		{}
+
+		static const int PCM_TAG = 1;
+		static const int EXTENSIBLE_TAG = 0xfffe;
+
+		int m_Tag;				// format tag from the fmt chunk, the sub-format for WAVE_FORMAT_EXTENSIBLE
+		int m_Rate;
+		int m_Channels;
+		int m_Bits;
+
+		int GetFrameSize() const
+		{
+			return m_Channels * (m_Bits / 8);
+		}
+	};
+
 	//! Construction
 	DiskAudioSensor();
 	~DiskAudioSensor();
@@ -60,17 +88,38 @@ public:
 	virtual void OnPause();
 	virtual void OnResume();
 
+	//! Finds the format and the samples in a WAV file, a file without a RIFF header is left in the
+	//! given format. Returns false if the file has no data or it isn't 8 or 16 bit PCM.
+	static bool ParseWave( const char * a_pData, size_t a_Size, Format & a_Format, size_t & a_Offset, size_t & a_Bytes );
+
 private:
+	//! Types
+	typedef boost::chrono::steady_clock		Clock;
+
 	//! Data
 	volatile bool m_CaptureAudio;
 	volatile bool m_Paused;
 	volatile bool m_CaptureStopped;
 
 	std::string m_RecordingsPath;
-	bool m_Error;
-	void *m_CaptureEvents[2];
+	float m_fFrameTime;				// how many seconds of audio to send in each AudioData
+	float m_fReplaySpeed;			// 1.0 is real-time, 2.0 twice as fast, 0 as fast as the subscribers can take it
+	float m_fStartDelay;			// how long to wait before sending the first file
+	float m_fSilenceTime;			// seconds of silence sent after each file
+	float m_fFlushTime;				// how long to wait after the last file before reporting we are done
+	int m_MaxPendingFrames;			// maximum number of frames waiting for the main thread
+
+	boost::mutex m_CaptureLock;
+	boost::condition_variable m_CaptureEvent;
+	int m_PendingFrames;
+	Clock::time_point m_Deadline;
 
 	void CaptureAudio(void *);
+	void StopCapture();
+	bool ReplayFile( const std::string & a_File );
+	bool ReplayAudio( const char * a_pData, size_t a_Bytes, const Format & a_Format );
+	bool WaitUntil( const Clock::time_point & a_Time );
+	bool WaitForResume();
 	void SendAudio(AudioData *a_pData);
 };
 
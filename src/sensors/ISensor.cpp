@@ -17,10 +17,13 @@
 
 
 #include "ISensor.h"
+#include "SessionRecorder.h"
 #include "utils/UniqueID.h"
 
 RTTI_IMPL( ISensor, ISerializable );
 
+SessionRecorder * ISensor::sm_pRecorder = NULL;
+
 ISensor::ISensor( const std::string & a_SensorName ) : 
 	m_bEnabled( true ),
 	m_SensorName( a_SensorName ),
@@ -132,6 +135,11 @@ bool ISensor::Unsubscribe( void * obj )
 	return true;
 }
 
+void ISensor::SetRecorder( SessionRecorder * a_pRecorder )
+{
+	sm_pRecorder = a_pRecorder;
+}
+
 void ISensor::AddOverride()
 {
 	assert( m_Overrides >= 0 );
@@ -173,6 +181,8 @@ void ISensor::OnSubscriber( const ITopics::SubInfo & a_Sub )
 void ISensor::SendData( IData * a_Data )
 {
 	a_Data->SetOrigin( this );
+	if ( sm_pRecorder != NULL )
+		sm_pRecorder->Record( this, a_Data );
 
 	if ( m_TopicSubscribers > 0 )
 	{
@@ -37,6 +37,7 @@
 #undef GetBinaryType
 
 class SensorManager;
+class SessionRecorder;
 
 //! This is the base class for all sensors that can receive some type of input from an external 
 //! source. Examples include connected video camera, microphone input, or data through a connected
@@ -115,6 +116,9 @@ public:
 	void AddOverride();
 	void RemoveOverride();
 
+	//! Set the recorder that receives all data sent by any sensor, NULL to stop recording.
+	static void SetRecorder( SessionRecorder * a_pRecorder );
+
 protected:
 
 	//! Types
@@ -133,6 +137,9 @@ protected:
 	SensorManager *		m_pManager;
 	std::vector< SP >	m_Overriden;
 
+	static SessionRecorder *
+						sm_pRecorder;
+
 	void OnSubscriber( const ITopics::SubInfo & a_Sub );
 	//! Send data to all subscribers of this sensor, note this function takes ownership
 	//! of the IData object and will delete it once it's done processing with all sensors.
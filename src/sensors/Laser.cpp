@@ -21,25 +21,48 @@
 REG_SERIALIZABLE( Laser );
 RTTI_IMPL( Laser, ISensor );
 
+Laser::~Laser()
+{
+    // any scan already queued holds a reference to us, so this is only a scan that was never sent
+    m_spScanTimer.reset();
+    delete m_pScan;
+}
+
 void Laser::Serialize(Json::Value & json)
 {
     ISensor::Serialize( json );
+
+    json["m_MaxScanPoints"] = m_MaxScanPoints;
+    json["m_fMaxScanTime"] = m_fMaxScanTime;
 }
 
 void Laser::Deserialize(const Json::Value & json)
 {
     ISensor::Deserialize( json );
+
+    if ( json["m_MaxScanPoints"].isNumeric() )
+        m_MaxScanPoints = json["m_MaxScanPoints"].asInt();
+    if ( json["m_fMaxScanTime"].isNumeric() )
+        m_fMaxScanTime = json["m_fMaxScanTime"].asFloat();
 }
 
 bool Laser::OnStart()
 {
     Log::Debug( "Laser", "OnStart() invoked." );
+
+    // send any scan that stops receiving points, AddPoint() only checks the age of the scan it's adding to
+    if ( TimerPool::Instance() != NULL && m_fMaxScanTime > 0.0f )
+    {
+        m_spScanTimer = TimerPool::Instance()->StartTimer(
+            VOID_DELEGATE( Laser, OnScanTimer, this ), m_fMaxScanTime, true, true );
+    }
     return true;
 }
 
 bool Laser::OnStop()
 {
     Log::Debug( "Laser", "OnStop() invoked." );
+    m_spScanTimer.reset();
     return true;
 }
 
@@ -49,3 +72,51 @@ void Laser::OnPause()
 void Laser::OnResume()
 {}
 
+
+void Laser::AddPoint( float a_fDistance, float a_fAzimuthalAngle, float a_fElevationAngle )
+{
+    boost::unique_lock<boost::mutex> lock( m_ScanLock );
+
+    double now = Time().GetEpochTime();
+    if ( m_pScan == NULL )
+    {
+        m_pScan = new LaserData();
+        m_pScan->SetTimeStamp( now );
+        m_pScan->Reserve( (size_t)m_MaxScanPoints );
+    }
+
+    m_pScan->AddPoint( LaserData::Point( a_fDistance, a_fAzimuthalAngle, a_fElevationAngle, 
+        (float)(now - m_pScan->GetTimeStamp()) ) );
+
+    if ( (int)m_pScan->GetPointCount() >= m_MaxScanPoints || (now - m_pScan->GetTimeStamp()) >= m_fMaxScanTime )
+        QueueScan();
+}
+
+void Laser::SendScan()
+{
+    boost::unique_lock<boost::mutex> lock( m_ScanLock );
+    QueueScan();
+}
+
+void Laser::QueueScan()
+{
+    // m_ScanLock must be locked before calling this
+    if ( m_pScan != NULL )
+    {
+        Laser::SP spThis( boost::static_pointer_cast<Laser>( shared_from_this() ) );
+        ThreadPool::Instance()->InvokeOnMain<LaserData *>( DELEGATE( Laser, OnSendScan, LaserData *, spThis ), m_pScan );
+        m_pScan = NULL;
+    }
+}
+
+void Laser::OnScanTimer()
+{
+    boost::unique_lock<boost::mutex> lock( m_ScanLock );
+    if ( m_pScan != NULL && (Time().GetEpochTime() - m_pScan->GetTimeStamp()) >= m_fMaxScanTime )
+        QueueScan();
+}
+
+void Laser::OnSendScan( LaserData * a_pScan )
+{
+    SendData( a_pScan );
+}
@@ -19,23 +19,37 @@
 #ifndef SELF_LASER_H
 #define SELF_LASER_H
 
+#include "boost/thread/mutex.hpp"
+
 #include "SelfInstance.h"
 #include "ISensor.h"
 #include "LaserData.h"
 
 #include "utils/ThreadPool.h"
+#include "utils/TimerPool.h"
 #include "utils/Time.h"
 
 #include "SelfLib.h"
 
-//! Base class for a Laser Sensor class
+//! Base class for a Laser Sensor class, implementations call AddPoint() for each point of a sweep
+//! from any thread, the points are sent as a single LaserData scan when SendScan() is called or the scan
+//! reaches m_MaxScanPoints or m_fMaxScanTime. A scan is sent by a timer once it's m_fMaxScanTime old,
+//! even if no more points are added.
+//! A scan holds a reference to this sensor until it's been sent on the main thread.
 class SELF_API Laser : public ISensor
 {
 public:
     RTTI_DECL();
 
-    Laser() : ISensor( "Laser" )
+    //! Types
+    typedef boost::shared_ptr<Laser>        SP;
+
+    Laser() : ISensor( "Laser" ),
+        m_MaxScanPoints( 4096 ),
+        m_fMaxScanTime( 0.1f ),
+        m_pScan( NULL )
     {}
+    ~Laser();
 
     //! ISerialiazable interface
     virtual void Serialize(Json::Value & json);
@@ -46,12 +60,34 @@ public:
     {
         return "LaserData";
     }
+    virtual const char * GetBinaryType()
+    {
+        return LaserData::BINARY_TYPE;
+    }
 
     virtual bool OnStart();
     virtual bool OnStop();
     virtual void OnPause();
     virtual void OnResume();
 
+    //! Add a point to the current scan, this may be invoked from any thread.
+    void AddPoint( float a_fDistance, float a_fAzimuthalAngle, float a_fElevationAngle );
+    //! Send the current scan to our subscribers on the main thread.
+    void SendScan();
+
+protected:
+    //! Data
+    int             m_MaxScanPoints;        // send the scan once it has this many points
+    float           m_fMaxScanTime;         // send the scan once it's this many seconds old
+
+    boost::mutex    m_ScanLock;
+    LaserData *     m_pScan;
+    TimerPool::ITimer::SP
+                    m_spScanTimer;
+
+    void            QueueScan();
+    void            OnScanTimer();
+    void            OnSendScan( LaserData * a_pScan );
 };
 
 #endif	// SELF_LASER_H
\ No newline at end of file
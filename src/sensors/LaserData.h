@@ -19,23 +19,49 @@
 #ifndef SELF_LASERDATA_H
 #define SELF_LASERDATA_H
 
+#include <vector>
+#include <string.h>
+
+#include "boost/cstdint.hpp"
+
 #include "IData.h"
 #include "SelfLib.h"
 
+//! This data object holds a scan of points from a laser sensor, a single point is just a scan with
+//! one point in it. The points are packed into an array so a full sweep of a lidar can be sent with
+//! a single SendData(), ToBinary() packs the scan as a 32-bit point count, a 64-bit double for the 
+//! time of the scan, then 4 floats for each point.
 class SELF_API LaserData : public IData
 {
 public:
 	RTTI_DECL();
 
-	LaserData() : 
-		m_fDistance( 0.0f ), 
-		m_fAzimuthalAngle( 0.0f ), 
-		m_fElevationAngle( 0.0f )
+	//! The binary type returned by ToBinary()
+	static const char * BINARY_TYPE;
+
+	//! Types
+	struct Point
+	{
+		Point() : m_fDistance( 0.0f ), m_fAzimuthalAngle( 0.0f ), m_fElevationAngle( 0.0f ), m_fTimeOffset( 0.0f )
+		{}
+		Point( float a_Distance, float a_AzimuthalAngle, float a_ElevationAngle, float a_fTimeOffset = 0.0f ) :
+			m_fDistance( a_Distance ), m_fAzimuthalAngle( a_AzimuthalAngle ), m_fElevationAngle( a_ElevationAngle ), m_fTimeOffset( a_fTimeOffset )
+		{}
+
+		float		m_fDistance;
+		float		m_fAzimuthalAngle;
+		float		m_fElevationAngle;
+		float		m_fTimeOffset;			// seconds from the start of the scan
+	};
+	typedef std::vector<Point>		PointList;
+
+	LaserData() : m_fTimeStamp( 0.0 )
 	{}
-	LaserData(float a_Distance, float a_AzimuthalAngle, float a_ElevationAngle) : 
-		m_fDistance(a_Distance),
-		m_fAzimuthalAngle(a_AzimuthalAngle),
-		m_fElevationAngle(a_ElevationAngle)
+	LaserData(float a_Distance, float a_AzimuthalAngle, float a_ElevationAngle) : m_fTimeStamp( 0.0 )
+	{
+		m_Points.push_back( Point( a_Distance, a_AzimuthalAngle, a_ElevationAngle ) );
+	}
+	LaserData( double a_fTimeStamp, const PointList & a_Points ) : m_fTimeStamp( a_fTimeStamp ), m_Points( a_Points )
 	{}
 
 	~LaserData()
@@ -44,35 +70,148 @@ public:
 	//! ISerializable interface
 	virtual void Serialize(Json::Value & json)
 	{
-		json["m_fDistance"] = m_fDistance;
-		json["m_fAzimuthalAngle"] = m_fAzimuthalAngle;
-		json["m_fElevationAngle"] = m_fElevationAngle;
+		json["m_fTimeStamp"] = m_fTimeStamp;
+
+		Json::Value & points = json["m_Points"];
+		points = Json::Value( Json::arrayValue );
+		for(size_t i=0;i<m_Points.size();++i)
+		{
+			Json::Value & point = points[(Json::ArrayIndex)i];
+			point[0] = m_Points[i].m_fDistance;
+			point[1] = m_Points[i].m_fAzimuthalAngle;
+			point[2] = m_Points[i].m_fElevationAngle;
+			point[3] = m_Points[i].m_fTimeOffset;
+		}
 	}
 	virtual void Deserialize(const Json::Value & json)
 	{
-		m_fDistance = json["m_fDistance"].asFloat();
-		m_fAzimuthalAngle = json["m_fAzimuthalAngle"].asFloat();
-		m_fElevationAngle = json["m_fElevationAngle"].asFloat();
+		m_fTimeStamp = json["m_fTimeStamp"].asDouble();
+		m_Points.clear();
+
+		const Json::Value & points = json["m_Points"];
+		if ( points.isArray() )
+		{
+			m_Points.reserve( points.size() );
+			for(Json::ArrayIndex i=0;i<points.size();++i)
+			{
+				const Json::Value & point = points[i];
+				m_Points.push_back( Point( point[0].asFloat(), point[1].asFloat(), point[2].asFloat(), point[3].asFloat() ) );
+			}
+		}
+		else if ( json.isMember( "m_fDistance" ) )
+		{
+			// single point from before we had scans
+			m_Points.push_back( Point( json["m_fDistance"].asFloat(), 
+				json["m_fAzimuthalAngle"].asFloat(), json["m_fElevationAngle"].asFloat() ) );
+		}
+	}
+
+	//! IData interface
+	virtual bool ToBinary( std::string & a_Output )
+	{
+		boost::uint32_t count = (boost::uint32_t)m_Points.size();
+
+		a_Output.resize( sizeof(count) + sizeof(m_fTimeStamp) + (count * sizeof(float) * 4) );
+		char * pOutput = &a_Output[0];
+		memcpy( pOutput, &count, sizeof(count) );
+		memcpy( pOutput + sizeof(count), &m_fTimeStamp, sizeof(m_fTimeStamp) );
+
+		float * pPoints = (float *)(pOutput + sizeof(count) + sizeof(m_fTimeStamp));
+		for(size_t i=0;i<m_Points.size();++i)
+		{
+			*pPoints++ = m_Points[i].m_fDistance;
+			*pPoints++ = m_Points[i].m_fAzimuthalAngle;
+			*pPoints++ = m_Points[i].m_fElevationAngle;
+			*pPoints++ = m_Points[i].m_fTimeOffset;
+		}
+		return true;
+	}
+	virtual bool FromBinary( const std::string & a_Type, const std::string & a_Input )
+	{
+		if ( StringUtil::Compare( a_Type, BINARY_TYPE, true ) != 0 )
+			return IData::FromBinary( a_Type, a_Input );
+
+		boost::uint32_t count = 0;
+		const size_t HEADER_SIZE = sizeof(count) + sizeof(m_fTimeStamp);
+		const size_t POINT_SIZE = sizeof(float) * 4;
+		if ( a_Input.size() < HEADER_SIZE )
+			return false;
+
+		// check the count against the size we have, count * POINT_SIZE can overflow a 32-bit size_t
+		memcpy( &count, a_Input.data(), sizeof(count) );
+		size_t payload = a_Input.size() - HEADER_SIZE;
+		if ( (payload % POINT_SIZE) != 0 || (payload / POINT_SIZE) != count )
+			return false;
+		memcpy( &m_fTimeStamp, a_Input.data() + sizeof(count), sizeof(m_fTimeStamp) );
+
+		float points[4];
+		m_Points.resize( count );
+		for(size_t i=0;i<count;++i)
+		{
+			memcpy( points, a_Input.data() + HEADER_SIZE + (i * sizeof(points)), sizeof(points) );
+			m_Points[i] = Point( points[0], points[1], points[2], points[3] );
+		}
+		return true;
 	}
 
 	//!Accessors
+	double GetTimeStamp() const
+	{
+		return m_fTimeStamp;
+	}
+	const PointList & GetPoints() const
+	{
+		return m_Points;
+	}
+	size_t GetPointCount() const
+	{
+		return m_Points.size();
+	}
+	//! Returns the index of the nearest point further than a_fMinDistance, -1 if none are found.
+	int FindNearest( float a_fMinDistance = 0.0f ) const
+	{
+		int nearest = -1;
+		for(size_t i=0;i<m_Points.size();++i)
+		{
+			float distance = m_Points[i].m_fDistance;
+			if ( distance > a_fMinDistance && (nearest < 0 || distance < m_Points[nearest].m_fDistance) )
+				nearest = (int)i;
+		}
+		return nearest;
+	}
+
+	//! These return the first point of the scan, use GetPoints() for the whole scan
 	float GetDistance() const
 	{
-		return m_fDistance;
+		return m_Points.size() > 0 ? m_Points[0].m_fDistance : 0.0f;
 	}
 	float GetAzimuthalAngle() const
 	{
-		return m_fAzimuthalAngle;
+		return m_Points.size() > 0 ? m_Points[0].m_fAzimuthalAngle : 0.0f;
 	}
 	float GetElevationAngle() const
 	{
-		return m_fElevationAngle;
+		return m_Points.size() > 0 ? m_Points[0].m_fElevationAngle : 0.0f;
 	}
+
+	//! Mutators
+	void SetTimeStamp( double a_fTimeStamp )
+	{
+		m_fTimeStamp = a_fTimeStamp;
+	}
+	void AddPoint( const Point & a_Point )
+	{
+		m_Points.push_back( a_Point );
+	}
+	void Reserve( size_t a_nPoints )
+	{
+		m_Points.reserve( a_nPoints );
+	}
+
 private:
 	//!Data
-	float		m_fDistance;
-	float		m_fAzimuthalAngle;	
-	float		m_fElevationAngle;
+	double		m_fTimeStamp;			// epoch time of the start of the scan
+	PointList	m_Points;
 };
 
 #endif //SELF_LASERATA_H
@@ -0,0 +1,103 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include "ReplaySensor.h"
+
+RTTI_IMPL( ReplaySensor, ISensor );
+REG_SERIALIZABLE( ReplaySensor );
+
+ReplaySensor::ReplaySensor( const std::string & a_SensorName,
+	const std::string & a_DataType,
+	const std::string & a_BinaryType ) :
+	ISensor( a_SensorName ),
+	m_DataType( a_DataType ),
+	m_BinaryType( a_BinaryType ),
+	m_bPaused( false )
+{}
+
+ReplaySensor::ReplaySensor() : ISensor( "Replay" ), m_bPaused( false )
+{}
+
+ReplaySensor::~ReplaySensor()
+{}
+
+void ReplaySensor::Serialize(Json::Value & json)
+{
+	ISensor::Serialize( json );
+
+	json["m_DataType"] = m_DataType;
+	json["m_BinaryType"] = m_BinaryType;
+}
+
+void ReplaySensor::Deserialize(const Json::Value & json)
+{
+	ISensor::Deserialize( json );
+
+	m_DataType = json["m_DataType"].asString();
+	m_BinaryType = json["m_BinaryType"].asString();
+}
+
+bool ReplaySensor::OnStart()
+{
+	return true;
+}
+
+bool ReplaySensor::OnStop()
+{
+	return true;
+}
+
+void ReplaySensor::OnPause()
+{
+	m_bPaused = true;
+}
+
+void ReplaySensor::OnResume()
+{
+	m_bPaused = false;
+}
+
+bool ReplaySensor::Replay( const std::string & a_Format, const std::string & a_Data )
+{
+	// a paused sensor doesn't send anything, so just drop the data
+	if ( m_bPaused )
+		return true;
+
+	IData * pData = NULL;
+	if ( StringUtil::Compare( a_Format, "application/json", true ) == 0 )
+		pData = ISerializable::DeserializeObject<IData>( a_Data );
+	else
+	{
+		ISerializable * pUncasted = ISerializable::GetSerializableFactory().CreateObject( m_DataType );
+		pData = DynamicCast<IData>( pUncasted );
+		if ( pData == NULL || !pData->FromBinary( a_Format, a_Data ) )
+		{
+			delete pUncasted;
+			pData = NULL;
+		}
+	}
+
+	if ( pData == NULL )
+	{
+		Log::Error( "ReplaySensor", "Failed to restore %s data in format %s", m_DataType.c_str(), a_Format.c_str() );
+		return false;
+	}
+
+	SendData( pData );
+	return true;
+}
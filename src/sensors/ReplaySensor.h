@@ -0,0 +1,72 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#ifndef SELF_REPLAY_SENSOR_H
+#define SELF_REPLAY_SENSOR_H
+
+#include "sensors/ISensor.h"
+#include "SelfLib.h"
+
+//! This sensor stands in for a sensor recorded by the SessionRecorder, the SessionReplay pushes the
+//! recorded data back through this sensor.
+class SELF_API ReplaySensor : public ISensor
+{
+public:
+	RTTI_DECL();
+
+	//! Types
+	typedef boost::shared_ptr< ReplaySensor >		SP;
+	typedef boost::weak_ptr< ReplaySensor >			WP;
+
+	//! Construction
+	ReplaySensor( const std::string & a_SensorName,
+		const std::string & a_DataType,
+		const std::string & a_BinaryType );
+	ReplaySensor();
+	~ReplaySensor();
+
+	//! ISerializable interface
+	virtual void Serialize(Json::Value & json);
+	virtual void Deserialize(const Json::Value & json);
+
+	//! ISensor interface
+	virtual const char * GetDataType()
+	{
+		return m_DataType.c_str();
+	}
+	virtual const char * GetBinaryType()
+	{
+		return m_BinaryType.c_str();
+	}
+
+	virtual bool OnStart();
+	virtual bool OnStop();
+	virtual void OnPause();
+	virtual void OnResume();
+
+	//! Restore the recorded data and send it to our subscribers, returns false if the data could not be restored.
+	bool Replay( const std::string & a_Format, const std::string & a_Data );
+
+protected:
+	//! Data
+	std::string m_DataType;
+	std::string m_BinaryType;
+	bool		m_bPaused;
+};
+
+#endif
@@ -59,8 +59,10 @@ RTTI_IMPL(VideoData, IData);
 REG_SERIALIZABLE( VideoData );
 RTTI_IMPL(DepthVideoData, IData);
 REG_SERIALIZABLE( DepthVideoData );
+const char * DepthVideoData::RAW_DEPTH_TYPE = "application/x-depth16";
 RTTI_IMPL(LaserData, IData);
 REG_SERIALIZABLE( LaserData );
+const char * LaserData::BINARY_TYPE = "application/x-laser-scan";
 
 SensorManager::SensorManager() : m_bActive( false ), m_pTopicManager( NULL )
 {}
@@ -88,6 +90,14 @@ bool SensorManager::FindSensorsByDataType(const std::string & a_DataType, Sensor
 	return sensors.end() != sensors.begin();
 }
 
+//! Session files are relative to our instance data unless an absolute path is given
+static std::string GetSessionPath( SelfInstance * a_pInstance, const std::string & a_File )
+{
+	if ( (a_File.size() > 0 && a_File[0] == '/') || a_File.find( ':' ) != std::string::npos )
+		return a_File;
+	return a_pInstance->GetInstanceDataPath() + a_File;
+}
+
 bool SensorManager::Start()
 {
 	SelfInstance * pInstance = SelfInstance::GetInstance();
@@ -106,6 +116,22 @@ bool SensorManager::Start()
 	for ( SelfInstance::SensorList::const_iterator iSensor = sensors.begin(); iSensor != sensors.end(); ++iSensor )
 		AddSensor( (*iSensor) );
 
+	const SelfInstance::LocalConfig & config = pInstance->GetLocalConfig();
+	if ( config.m_RecordSession.size() > 0 )
+	{
+		m_spRecorder = SessionRecorder::SP( new SessionRecorder() );
+		if ( m_spRecorder->Start( GetSessionPath( pInstance, config.m_RecordSession ) ) )
+			ISensor::SetRecorder( m_spRecorder.get() );
+		else
+			m_spRecorder.reset();
+	}
+	if ( config.m_ReplaySession.size() > 0 )
+	{
+		m_spReplay = SessionReplay::SP( new SessionReplay( GetSessionPath( pInstance, config.m_ReplaySession ), config.m_fReplaySpeed ) );
+		if (! m_spReplay->Start( this ) )
+			m_spReplay.reset();
+	}
+
 	m_pTopicManager->RegisterTopic( "sensor-manager", "application/json",
 		DELEGATE( SensorManager, OnSubscriber, const ITopics::SubInfo &, this ) );
 	m_pTopicManager->Subscribe( "sensor-manager", 
@@ -127,6 +153,17 @@ bool SensorManager::Stop()
 	}
 
 	Log::Status( "SensorManager", "SensorManager stopping." );
+	if ( m_spReplay )
+	{
+		m_spReplay->Stop();
+		m_spReplay.reset();
+	}
+	if ( m_spRecorder )
+	{
+		ISensor::SetRecorder( NULL );
+		m_spRecorder->Stop();
+		m_spRecorder.reset();
+	}
 	m_Sensors.clear();
 
 	m_bActive = false;
@@ -26,6 +26,8 @@
 #include "utils/Delegate.h"
 #include "utils/RTTI.h"
 #include "ISensor.h"
+#include "SessionRecorder.h"
+#include "SessionReplay.h"
 #include "SelfLib.h"				// include last
 
 //! Forward declare
@@ -151,6 +153,8 @@ private:
 	SensorList				m_Sensors;				// list of active sensors
 	RegistryMap				m_RegistryMap;
 	TopicManager *			m_pTopicManager;
+	SessionRecorder::SP		m_spRecorder;			// records all sensor data when enabled
+	SessionReplay::SP		m_spReplay;				// replays a recorded session in place of our sensors
 
 	//! Callbacks
 	void					OnSubscriber( const ITopics::SubInfo & a_Info );
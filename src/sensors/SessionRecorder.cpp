@@ -0,0 +1,155 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "SessionRecorder.h"
+#include "ISensor.h"
+#include "AudioData.h"
+#include "utils/Log.h"
+
+const char * SessionRecorder::SESSION_MAGIC = "SELFSES1";
+
+SessionRecorder::SessionRecorder() : m_pFile( NULL ), m_Records( 0 )
+{}
+
+SessionRecorder::~SessionRecorder()
+{
+	Stop();
+}
+
+bool SessionRecorder::Start( const std::string & a_File )
+{
+	boost::unique_lock<boost::mutex> lock( m_Lock );
+	if ( m_pFile != NULL )
+		return false;
+
+	m_pFile = fopen( a_File.c_str(), "wb" );
+	if ( m_pFile == NULL )
+	{
+		Log::Error( "SessionRecorder", "Failed to open %s for recording.", a_File.c_str() );
+		return false;
+	}
+
+	// video frames are large, so give the file a generous buffer
+	setvbuf( m_pFile, NULL, _IOFBF, 1024 * 1024 );
+	fwrite( SESSION_MAGIC, 1, SESSION_MAGIC_SIZE, m_pFile );
+
+	m_File = a_File;
+	m_Sensors.clear();
+	m_Start = Clock::now();
+	m_Records = 0;
+
+	Log::Status( "SessionRecorder", "Recording session to %s", m_File.c_str() );
+	return true;
+}
+
+void SessionRecorder::Stop()
+{
+	boost::unique_lock<boost::mutex> lock( m_Lock );
+	if ( m_pFile != NULL )
+	{
+		fclose( m_pFile );
+		m_pFile = NULL;
+
+		Log::Status( "SessionRecorder", "Recorded %u records from %u sensors into %s",
+			(unsigned int)m_Records, (unsigned int)m_Sensors.size(), m_File.c_str() );
+	}
+}
+
+void SessionRecorder::Record( ISensor * a_pSensor, IData * a_pData )
+{
+	boost::unique_lock<boost::mutex> lock( m_Lock );
+	if ( m_pFile == NULL )
+		return;
+
+	double time = boost::chrono::duration<double>( Clock::now() - m_Start ).count();
+
+	SensorMap::iterator iSensor = m_Sensors.find( a_pSensor );
+	if ( iSensor == m_Sensors.end() )
+	{
+		boost::uint32_t index = (boost::uint32_t)m_Sensors.size();
+		iSensor = m_Sensors.insert( SensorMap::value_type( a_pSensor, index ) ).first;
+
+		Json::Value sensor;
+		sensor["m_Index"] = index;
+		sensor["m_SensorId"] = a_pSensor->GetSensorId();
+		sensor["m_SensorName"] = a_pSensor->GetSensorName();
+		sensor["m_DataType"] = a_pSensor->GetDataType();
+		sensor["m_BinaryType"] = a_pSensor->GetBinaryType();
+		WriteRecord( RT_SENSOR, Json::FastWriter().write( sensor ) );
+	}
+
+	// the format is whatever IData::FromBinary() needs to restore the data, audio carries its own format
+	// since some sensors send a different format than their binary type. Anything else that can't be
+	// restored from binary is recorded as JSON.
+	std::string format( a_pSensor->GetBinaryType() );
+	std::string payload;
+
+	AudioData * pAudio = DynamicCast<AudioData>( a_pData );
+	if ( pAudio != NULL )
+	{
+		if ( pAudio->GetBPS() == 16 )
+		{
+			format = StringUtil::Format( "audio/L16;rate=%u;channels=%u", pAudio->GetFrequency(), pAudio->GetChannels() );
+			payload = pAudio->GetWaveData();
+		}
+		else
+		{
+			format = "application/json";
+			payload = Json::FastWriter().write( ISerializable::SerializeObject( a_pData ) );
+		}
+	}
+	else if ( StringUtil::Compare( format, "application/json", true ) == 0 )
+		payload = Json::FastWriter().write( ISerializable::SerializeObject( a_pData ) );
+	else if (! a_pData->ToBinary( payload ) )
+	{
+		Log::Warning( "SessionRecorder", "Failed to convert %s to binary.", a_pData->GetRTTI().GetName().c_str() );
+		return;
+	}
+	if ( format.size() > 0xffff )
+		format.resize( 0xffff );
+
+	boost::uint16_t formatSize = (boost::uint16_t)format.size();
+
+	std::string body;
+	body.reserve( sizeof(boost::uint32_t) + sizeof(double) + sizeof(formatSize) + format.size() + payload.size() );
+	body.append( (const char *)&iSensor->second, sizeof(boost::uint32_t) );
+	body.append( (const char *)&time, sizeof(double) );
+	body.append( (const char *)&formatSize, sizeof(formatSize) );
+	body += format;
+	body += payload;
+
+	WriteRecord( RT_DATA, body );
+	m_Records += 1;
+}
+
+void SessionRecorder::WriteRecord( RecordType a_Type, const std::string & a_Body )
+{
+	unsigned char type = (unsigned char)a_Type;
+	boost::uint32_t size = (boost::uint32_t)a_Body.size();
+
+	fwrite( &type, sizeof(type), 1, m_pFile );
+	fwrite( &size, sizeof(size), 1, m_pFile );
+	if ( fwrite( a_Body.data(), 1, a_Body.size(), m_pFile ) != a_Body.size() )
+	{
+		Log::Error( "SessionRecorder", "Failed to write to %s, recording stopped.", m_File.c_str() );
+		fclose( m_pFile );
+		m_pFile = NULL;
+	}
+}
@@ -0,0 +1,107 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#ifndef SELF_SESSION_RECORDER_H
+#define SELF_SESSION_RECORDER_H
+
+#include <stdio.h>
+#include <map>
+#include <string>
+
+#include "boost/shared_ptr.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/chrono.hpp"
+#include "boost/cstdint.hpp"
+
+#include "SelfLib.h"
+
+class ISensor;
+class IData;
+
+//! This object records everything sent by ISensor::SendData() into a session log, which can be replayed
+//! later through SessionReplay. The log starts with SESSION_MAGIC followed by records, each record is
+//! a type byte, a 32-bit length, then the body. A RT_SENSOR record is written the first time a sensor sends
+//! data, the body is a JSON description of the sensor. A RT_DATA record body is the 32-bit sensor index,
+//! a 64-bit double of seconds since the recording started, a 16-bit length prefixed format and the binary
+//! data as returned by IData::ToBinary(). Numbers are written in the byte order of the host.
+class SELF_API SessionRecorder
+{
+public:
+	//! Types
+	typedef boost::shared_ptr<SessionRecorder>		SP;
+	typedef boost::weak_ptr<SessionRecorder>		WP;
+
+	enum RecordType {
+		RT_SENSOR = 1,
+		RT_DATA = 2
+	};
+
+	static const char *		SESSION_MAGIC;
+	static const size_t		SESSION_MAGIC_SIZE = 8;
+
+	//! Construction
+	SessionRecorder();
+	~SessionRecorder();
+
+	//! Accessors
+	bool				IsRecording() const;
+	const std::string &	GetFile() const;
+	size_t				GetRecordCount() const;
+
+	//! Start recording into the given file, any existing file is replaced.
+	bool				Start( const std::string & a_File );
+	//! Stop recording and close our file.
+	void				Stop();
+
+	//! Invoked by ISensor::SendData() for each data object sent by a sensor.
+	void				Record( ISensor * a_pSensor, IData * a_pData );
+
+private:
+	//! Types
+	typedef boost::chrono::steady_clock			Clock;
+	typedef std::map< ISensor *, boost::uint32_t >	SensorMap;
+
+	//! Data
+	boost::mutex		m_Lock;
+	std::string			m_File;
+	FILE *				m_pFile;
+	SensorMap			m_Sensors;
+	Clock::time_point	m_Start;
+	size_t				m_Records;
+
+	void				WriteRecord( RecordType a_Type, const std::string & a_Body );
+};
+
+//----------------------------------
+
+inline bool SessionRecorder::IsRecording() const
+{
+	return m_pFile != NULL;
+}
+
+inline const std::string & SessionRecorder::GetFile() const
+{
+	return m_File;
+}
+
+inline size_t SessionRecorder::GetRecordCount() const
+{
+	return m_Records;
+}
+
+#endif // SELF_SESSION_RECORDER_H
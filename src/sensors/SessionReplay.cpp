@@ -0,0 +1,254 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include <string.h>
+#include <set>
+
+#include "SessionReplay.h"
+#include "SessionRecorder.h"
+#include "SensorManager.h"
+#include "utils/ThreadPool.h"
+#include "utils/Log.h"
+
+SessionReplay::SessionReplay( const std::string & a_File, float a_fSpeed /*= 1.0f*/, int a_MaxPending /*= 32*/ ) :
+	m_File( a_File ),
+	m_fSpeed( a_fSpeed ),
+	m_MaxPending( a_MaxPending > 0 ? a_MaxPending : 1 ),
+	m_pManager( NULL ),
+	m_bStop( false ),
+	m_bStopped( true ),
+	m_bFinished( false ),
+	m_Pending( 0 ),
+	m_Records( 0 ),
+	m_Replayed( 0 )
+{}
+
+SessionReplay::~SessionReplay()
+{
+	Stop();
+}
+
+bool SessionReplay::Start( SensorManager * a_pManager )
+{
+	if (! m_bStopped || a_pManager == NULL )
+		return false;
+
+	try {
+		// map the session, recordings with video can be many gigabytes
+		boost::interprocess::file_mapping mapping( m_File.c_str(), boost::interprocess::read_only );
+		boost::interprocess::mapped_region region( mapping, boost::interprocess::read_only );
+		m_Mapping.swap( mapping );
+		m_Region.swap( region );
+	}
+	catch( const std::exception & ex )
+	{
+		Log::Error( "SessionReplay", "Failed to open session %s: %s", m_File.c_str(), ex.what() );
+		return false;
+	}
+
+	const char * pSession = (const char *)m_Region.get_address();
+	if ( m_Region.get_size() < SessionRecorder::SESSION_MAGIC_SIZE
+		|| memcmp( pSession, SessionRecorder::SESSION_MAGIC, SessionRecorder::SESSION_MAGIC_SIZE ) != 0 )
+	{
+		Log::Error( "SessionReplay", "%s is not a recorded session.", m_File.c_str() );
+		return false;
+	}
+
+	// find all the sensors before we start, so they are all in place before any data is sent
+	m_Sensors.clear();
+	m_Records = 0;
+
+	size_t offset = SessionRecorder::SESSION_MAGIC_SIZE;
+	unsigned char type = 0;
+	const char * pBody = NULL;
+	size_t size = 0;
+	while( ReadRecord( offset, type, pBody, size ) )
+	{
+		if ( type == SessionRecorder::RT_SENSOR )
+		{
+			Json::Value sensor;
+			if (! Json::Reader( Json::Features::strictMode() ).parse( std::string( pBody, size ), sensor ) )
+			{
+				Log::Error( "SessionReplay", "Failed to parse sensor in %s", m_File.c_str() );
+				continue;
+			}
+
+			size_t index = sensor["m_Index"].asUInt();
+			if ( index >= m_Sensors.size() )
+				m_Sensors.resize( index + 1 );
+			m_Sensors[index] = ReplaySensor::SP( new ReplaySensor( "Replay " + sensor["m_SensorName"].asString(),
+				sensor["m_DataType"].asString(), sensor["m_BinaryType"].asString() ) );
+		}
+		else if ( type == SessionRecorder::RT_DATA )
+			m_Records += 1;
+	}
+
+	// only the first sensor of each type overrides the live sensors, otherwise it would override our other sensors
+	m_pManager = a_pManager;
+	std::set<std::string> overrides;
+	for(size_t i=0;i<m_Sensors.size();++i)
+	{
+		if (! m_Sensors[i] )
+			continue;
+		bool bOverride = overrides.insert( m_Sensors[i]->GetDataType() ).second;
+		m_pManager->AddSensor( m_Sensors[i], bOverride );
+	}
+
+	Log::Status( "SessionReplay", "Replaying %u records from %u sensors in %s at %.1fx",
+		(unsigned int)m_Records, (unsigned int)m_Sensors.size(), m_File.c_str(), m_fSpeed );
+
+	m_bStop = false;
+	m_bStopped = false;
+	m_bFinished = false;
+	m_Pending = 0;
+	m_Replayed = 0;
+	ThreadPool::Instance()->InvokeOnThread<void *>( DELEGATE( SessionReplay, Play, void *, shared_from_this() ), 0 );
+
+	return true;
+}
+
+void SessionReplay::Stop()
+{
+	{
+		boost::unique_lock<boost::mutex> lock( m_Lock );
+		m_bStop = true;
+		m_Event.notify_all();
+
+		while(! m_bStopped )
+			m_Event.wait( lock );
+	}
+
+	if ( m_pManager != NULL )
+	{
+		for(size_t i=0;i<m_Sensors.size();++i)
+			if ( m_Sensors[i] )
+				m_pManager->RemoveSensor( m_Sensors[i] );
+		m_pManager = NULL;
+	}
+	m_Sensors.clear();
+}
+
+bool SessionReplay::ReadRecord( size_t & a_Offset, unsigned char & a_Type, const char * & a_pBody, size_t & a_Size ) const
+{
+	const char * pSession = (const char *)m_Region.get_address();
+	size_t sessionSize = m_Region.get_size();
+
+	boost::uint32_t size = 0;
+	if ( a_Offset + 1 + sizeof(size) > sessionSize )
+		return false;
+
+	a_Type = (unsigned char)pSession[ a_Offset ];
+	memcpy( &size, pSession + a_Offset + 1, sizeof(size) );
+	if ( size > sessionSize - a_Offset - 1 - sizeof(size) )
+	{
+		Log::Warning( "SessionReplay", "Session %s is truncated.", m_File.c_str() );
+		return false;
+	}
+
+	a_pBody = pSession + a_Offset + 1 + sizeof(size);
+	a_Size = size;
+	a_Offset += 1 + sizeof(size) + size;
+	return true;
+}
+
+void SessionReplay::Play( void * )
+{
+	Clock::time_point start = Clock::now();
+
+	size_t offset = SessionRecorder::SESSION_MAGIC_SIZE;
+	unsigned char type = 0;
+	const char * pBody = NULL;
+	size_t size = 0;
+	while(! m_bStop && ReadRecord( offset, type, pBody, size ) )
+	{
+		boost::uint32_t index = 0;
+		double time = 0.0;
+		boost::uint16_t formatSize = 0;
+
+		const size_t HEADER_SIZE = sizeof(index) + sizeof(time) + sizeof(formatSize);
+		if ( type != SessionRecorder::RT_DATA || size < HEADER_SIZE )
+			continue;
+
+		memcpy( &index, pBody, sizeof(index) );
+		memcpy( &time, pBody + sizeof(index), sizeof(time) );
+		memcpy( &formatSize, pBody + sizeof(index) + sizeof(time), sizeof(formatSize) );
+		if ( index >= m_Sensors.size() || !m_Sensors[index] || HEADER_SIZE + formatSize > size )
+			continue;
+
+		// pace against the recorded time, so any time we spend here doesn't add up over the session
+		if ( m_fSpeed > 0.0f )
+		{
+			Clock::time_point due = start + boost::chrono::duration_cast<Clock::duration>(
+				boost::chrono::duration<double>( time / m_fSpeed ) );
+			if (! WaitUntil( due ) )
+				break;
+		}
+
+		// limit the records waiting on the main thread, the records are still sent in order
+		{
+			boost::unique_lock<boost::mutex> lock( m_Lock );
+			while(! m_bStop && m_Pending >= m_MaxPending )
+				m_Event.wait( lock );
+			if ( m_bStop )
+				break;
+			m_Pending += 1;
+		}
+
+		Record * pRecord = new Record();
+		pRecord->m_spSensor = m_Sensors[index];
+		pRecord->m_Format.assign( pBody + HEADER_SIZE, formatSize );
+		pRecord->m_Data.assign( pBody + HEADER_SIZE + formatSize, size - HEADER_SIZE - formatSize );
+
+		ThreadPool::Instance()->InvokeOnMain<Record *>( DELEGATE( SessionReplay, SendRecord, Record *, shared_from_this() ), pRecord );
+	}
+
+	double elapsed = boost::chrono::duration<double>( Clock::now() - start ).count();
+	Log::Status( "SessionReplay", "Session %s %s after %.2f seconds.", m_File.c_str(),
+		m_bStop ? "stopped" : "finished", elapsed );
+
+	boost::unique_lock<boost::mutex> lock( m_Lock );
+	m_bFinished = !m_bStop;
+	m_bStopped = true;
+	m_Event.notify_all();
+}
+
+bool SessionReplay::WaitUntil( const Clock::time_point & a_Time )
+{
+	boost::unique_lock<boost::mutex> lock( m_Lock );
+	while(! m_bStop && Clock::now() < a_Time )
+		m_Event.wait_until( lock, a_Time );
+
+	return !m_bStop;
+}
+
+void SessionReplay::SendRecord( Record * a_pRecord )
+{
+	{
+		boost::unique_lock<boost::mutex> lock( m_Lock );
+		m_Pending -= 1;
+		m_Event.notify_all();
+	}
+
+	if (! m_bStop )
+	{
+		a_pRecord->m_spSensor->Replay( a_pRecord->m_Format, a_pRecord->m_Data );
+		m_Replayed += 1;
+	}
+
+	delete a_pRecord;
+}
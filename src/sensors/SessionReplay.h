@@ -0,0 +1,125 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#ifndef SELF_SESSION_REPLAY_H
+#define SELF_SESSION_REPLAY_H
+
+#include <vector>
+
+#include "boost/enable_shared_from_this.hpp"
+#include "boost/shared_ptr.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/condition_variable.hpp"
+#include "boost/chrono.hpp"
+#include "boost/interprocess/file_mapping.hpp"
+#include "boost/interprocess/mapped_region.hpp"
+
+#include "ReplaySensor.h"
+#include "SelfLib.h"
+
+class SensorManager;
+
+//! This object replays a session log written by the SessionRecorder. A ReplaySensor is added to the
+//! SensorManager for each recorded sensor, overriding any live sensors of the same data type, then all
+//! records are sent on the main thread in the order they were recorded. a_fSpeed of 1.0 replays with the
+//! original timing, 2.0 twice as fast, and 0 replays as fast as the main thread can take the data.
+class SELF_API SessionReplay : public boost::enable_shared_from_this<SessionReplay>
+{
+public:
+	//! Types
+	typedef boost::shared_ptr<SessionReplay>		SP;
+	typedef boost::weak_ptr<SessionReplay>			WP;
+
+	//! Construction
+	SessionReplay( const std::string & a_File, float a_fSpeed = 1.0f, int a_MaxPending = 32 );
+	~SessionReplay();
+
+	//! Accessors
+	const std::string &	GetFile() const;
+	bool				IsFinished() const;
+	size_t				GetRecordCount() const;
+	size_t				GetReplayedCount() const;
+
+	//! Map the session, add our sensors to the given manager and start replaying.
+	bool				Start( SensorManager * a_pManager );
+	//! Stop replaying and remove our sensors, this blocks until our thread has stopped.
+	void				Stop();
+
+private:
+	//! Types
+	typedef boost::chrono::steady_clock			Clock;
+	typedef std::vector< ReplaySensor::SP >		SensorList;
+
+	struct Record
+	{
+		ReplaySensor::SP	m_spSensor;
+		std::string			m_Format;
+		std::string			m_Data;
+	};
+
+	//! Data
+	std::string			m_File;
+	float				m_fSpeed;
+	int					m_MaxPending;
+	SensorManager *		m_pManager;
+	SensorList			m_Sensors;				// indexed by the sensor index in the session
+
+	boost::interprocess::file_mapping
+						m_Mapping;
+	boost::interprocess::mapped_region
+						m_Region;
+
+	boost::mutex		m_Lock;
+	boost::condition_variable
+						m_Event;
+	volatile bool		m_bStop;
+	volatile bool		m_bStopped;
+	volatile bool		m_bFinished;
+	int					m_Pending;
+	size_t				m_Records;
+	size_t				m_Replayed;
+
+	bool				ReadRecord( size_t & a_Offset, unsigned char & a_Type, const char * & a_pBody, size_t & a_Size ) const;
+	void				Play( void * );
+	bool				WaitUntil( const Clock::time_point & a_Time );
+	void				SendRecord( Record * a_pRecord );
+};
+
+//----------------------------------
+
+inline const std::string & SessionReplay::GetFile() const
+{
+	return m_File;
+}
+
+inline bool SessionReplay::IsFinished() const
+{
+	return m_bFinished;
+}
+
+inline size_t SessionReplay::GetRecordCount() const
+{
+	return m_Records;
+}
+
+inline size_t SessionReplay::GetReplayedCount() const
+{
+	return m_Replayed;
+}
+
+#endif // SELF_SESSION_REPLAY_H
@@ -24,17 +24,24 @@
 REG_SERIALIZABLE( GestureSkill );
 RTTI_IMPL( GestureSkill, ISkill);
 
-GestureSkill::GestureSkill() : m_bReplaceParams( false )
+GestureSkill::GestureSkill() : 
+	m_bReplaceParams( false ),
+	m_pHandleManager( NULL ),
+	m_GestureHandle( GestureManager::INVALID_HANDLE )
 {}
 
 GestureSkill::GestureSkill(const std::string & a_GestureID) :
 	m_GestureId( a_GestureID ),
-	m_bReplaceParams( false )
+	m_bReplaceParams( false ),
+	m_pHandleManager( NULL ),
+	m_GestureHandle( GestureManager::INVALID_HANDLE )
 {}
 
 GestureSkill::GestureSkill( const GestureSkill & a_Copy ) :
 	m_GestureId( a_Copy.m_GestureId ),
-	m_bReplaceParams( a_Copy.m_bReplaceParams )
+	m_bReplaceParams( a_Copy.m_bReplaceParams ),
+	m_pHandleManager( a_Copy.m_pHandleManager ),
+	m_GestureHandle( a_Copy.m_GestureHandle )
 {}
 
 void GestureSkill::Serialize(Json::Value & json)
@@ -51,7 +58,7 @@ void GestureSkill::Deserialize(const Json::Value & json)
 	ISkill::Deserialize( json );
 
 	if ( json.isMember( "m_GestureId" ) )
-		m_GestureId = json["m_GestureId"].asString();
+		SetGestureId( json["m_GestureId"].asString() );
 	if ( json.isMember( "m_GestureParams" ) )
 		ISerializable::DeserializeObject( json["m_GestureParams"], &m_GestureParams );
 	if ( json.isMember( "m_bReplaceParams" ) )
@@ -103,8 +110,17 @@ void GestureSkill::StartGesture()
 	bool bSuccess = false;
 	bool bFound = false;
 
-	std::vector<IGesture::SP> gestures;
-	if ( pInstance->GetGestureManager()->FindGestures( m_GestureId, gestures ) )
+	// resolve our gesture ID into a handle once, after that finding the gestures is just an index. The ID
+	// has no handle until a gesture with that ID has been added, so keep trying until it does.
+	GestureManager * pManager = pInstance->GetGestureManager();
+	if ( m_pHandleManager != pManager || m_GestureHandle == GestureManager::INVALID_HANDLE )
+	{
+		m_GestureHandle = pManager->FindGestureHandle( m_GestureId );
+		m_pHandleManager = pManager;
+	}
+
+	const GestureManager::GestureList & gestures = pManager->GetGestures( m_GestureHandle );
+	if ( gestures.size() > 0 )
 	{
 		bFound = true;
 
@@ -23,6 +23,7 @@
 
 #include <list>
 #include "ISkill.h"
+#include "gestures/GestureManager.h"
 
 //! This skill executes a gestures in the gesture manager.
 class SELF_API GestureSkill : public ISkill
@@ -50,6 +51,7 @@ public:
 	void SetGestureId(const std::string & a_GestureId)
 	{
 		m_GestureId = a_GestureId;
+		m_pHandleManager = NULL;
 	}
 	void SetGestureParams( const ParamsMap & a_Params )
 	{
@@ -72,6 +74,8 @@ private:
 	ParamsMap m_GestureParams;		
 	bool m_bReplaceParams;
 	IGesture::SP m_spGesture;
+	GestureManager * m_pHandleManager;		// manager that issued m_GestureHandle
+	GestureManager::GestureHandle m_GestureHandle;
 
 	void StartGesture();
 	void OnGestureCompleted( const IGesture::Result & a_State );
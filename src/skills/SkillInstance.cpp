@@ -30,6 +30,15 @@ SkillInstance::SkillInstance( SkillManager * a_pManager, const std::string & a_S
 	m_pManager->AddInstance( this );
 	m_eState = US_FINDING;
 
+	// use the resolved skill if we have one, this avoids a traverse and parsing the skill data
+	m_spSkill = m_pManager->FindCachedSkill( a_Skill );
+	if ( m_spSkill )
+	{
+		m_eState = US_EXECUTING;
+		m_spSkill->UseSkill( DELEGATE( SkillInstance, OnSkillState, ISkill *, this), m_Params );
+		return;
+	}
+
 	IGraph::SP spGraph = SelfInstance::GetInstance()->GetKnowledgeGraph();
 	spGraph->SetModel("world");
 
@@ -88,11 +97,14 @@ void SkillInstance::OnSelectSkill( ITraverser::SP a_spTraverser )
 
 	if ( spBestSkill )
 	{
-		m_spSkill = m_pManager->FindCachedSkill( (*spBestSkill)["name"].asString() );
+		std::string name( (*spBestSkill)["name"].asString() );
+		if ( m_pManager->FindCachedVertex( name ) == spBestSkill )
+			m_spSkill = m_pManager->FindCachedSkill( name );
 		if (! m_spSkill )
 		{
 			m_spSkill = ISkill::SP( ISerializable::DeserializeObject<ISkill>( (*spBestSkill)["data"].asString() ) );
-			m_pManager->CacheSkill( m_spSkill );
+			if (! m_pManager->CacheSkill( m_spSkill, spBestSkill ) )
+				m_spSkill = m_pManager->FindCachedSkill( name );		// a newer skill was already cached
 		}
 	}
 
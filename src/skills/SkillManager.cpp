@@ -30,7 +30,11 @@ SkillManager::SkillManager()
 {}
 
 SkillManager::~SkillManager()
-{}
+{
+	for( SkillCache::iterator iSkill = m_SkillCache.begin(); iSkill != m_SkillCache.end(); ++iSkill )
+		if ( iSkill->second.m_spVertex )
+			iSkill->second.m_spVertex->GetNotificationList().Remove( this );
+}
 
 bool SkillManager::Start()
 {
@@ -40,6 +44,11 @@ bool SkillManager::Start()
 
 	Log::Status("SkillManager", "SkillManager started.");
 
+	// watch for skills added to or changed in the graph, e.g. merged in from a remote graph
+	IGraph::SP spGraph = pInstance->GetKnowledgeGraph();
+	if ( spGraph )
+		spGraph->GetVertexNotifications().Add( DELEGATE( SkillManager, OnGraphVertexEvent, const IVertex::VertexEvent &, this ) );
+
 	const std::string & skillPath = SelfInstance::GetInstance()->GetStaticDataPath();
 
 	// load the skill DB from local storage..
@@ -70,6 +79,10 @@ bool SkillManager::Start()
 
 bool SkillManager::Stop()
 {
+	IGraph::SP spGraph = SelfInstance::GetInstance() != NULL ? SelfInstance::GetInstance()->GetKnowledgeGraph() : IGraph::SP();
+	if ( spGraph )
+		spGraph->GetVertexNotifications().Remove( this );
+
 	return true;
 }
 
@@ -85,7 +98,7 @@ bool SkillManager::AddSkill(const ISkill::SP & a_spSkill )
 	if (! a_spSkill->IsEnabled() )
 		return false;
 
-	new SaveSkill( a_spSkill );
+	new SaveSkill( this, a_spSkill );
 	return true;
 }
 
@@ -94,7 +107,7 @@ bool SkillManager::DeleteSkill(const ISkill::SP & a_spSkill)
 	if (!a_spSkill)
 		return false;
 
-	m_SkillCache.erase( a_spSkill->GetSkillName() );
+	UncacheSkill( a_spSkill->GetSkillName() );
 
 	ITraverser::SP spDelete = SelfInstance::GetInstance()->GetKnowledgeGraph()->CreateTraverser( LabelCondition( "skill" ) )->
 		Filter( EqualityCondition( "name", Logic::EQ, a_spSkill->GetSkillName() ) );
@@ -110,7 +123,7 @@ bool SkillManager::DeleteSkill(const std::string & a_Skill )
 		return false;
 
 	// remove any cached skill
-	m_SkillCache.erase( a_Skill );
+	UncacheSkill( a_Skill );
 
 	ITraverser::SP spDelete = SelfInstance::GetInstance()->GetKnowledgeGraph()->CreateTraverser( LabelCondition( "skill" ) )->
 		Filter( EqualityCondition( "name", Logic::EQ, a_Skill ) );
@@ -130,10 +143,82 @@ void SkillManager::RemoveInstance( SkillInstance * a_pInstance )
 	m_ActiveSkills.erase( a_pInstance );
 }
 
-void SkillManager::CacheSkill( const ISkill::SP & a_spSkill )
+bool SkillManager::CacheSkill( const ISkill::SP & a_spSkill, const IVertex::SP & a_spVertex )
 {
-	if ( a_spSkill )
-		m_SkillCache[ a_spSkill->GetSkillName() ] = a_spSkill;
+	if (! a_spSkill )
+		return false;
+
+	double fTime = a_spVertex ? a_spVertex->GetTime() : 0.0;
+
+	CachedSkill & cached = m_SkillCache[ a_spSkill->GetSkillName() ];
+	if ( cached.m_spSkill && cached.m_spVertex != a_spVertex && cached.m_fTime > fTime )
+		return false;		// we already have a newer version of this skill
+
+	// watch the vertex, so we know if this skill gets changed or dropped from the graph..
+	if ( cached.m_spVertex != a_spVertex )
+	{
+		if ( cached.m_spVertex )
+			cached.m_spVertex->GetNotificationList().Remove( this );
+		if ( a_spVertex )
+			a_spVertex->GetNotificationList().Add( DELEGATE( SkillManager, OnSkillVertexEvent, const IVertex::VertexEvent &, this ) );
+	}
+
+	cached.m_spSkill = a_spSkill;
+	cached.m_spVertex = a_spVertex;
+	cached.m_HashId = a_spVertex ? (*a_spVertex)["hashId"].asString() : std::string();
+	cached.m_fTime = fTime;
+
+	return true;
+}
+
+void SkillManager::UncacheSkill( const std::string & a_Name )
+{
+	SkillCache::iterator iSkill = m_SkillCache.find( a_Name );
+	if ( iSkill != m_SkillCache.end() )
+	{
+		if ( iSkill->second.m_spVertex )
+			iSkill->second.m_spVertex->GetNotificationList().Remove( this );
+		m_SkillCache.erase( iSkill );
+	}
+}
+
+void SkillManager::OnSkillVertexEvent( const IVertex::VertexEvent & a_Event )
+{
+	const IVertex::SP & spVertex = a_Event.m_spVertex;
+	if (! spVertex )
+		return;
+
+	std::string name( (*spVertex)["name"].asString() );
+	SkillCache::iterator iSkill = m_SkillCache.find( name );
+	if ( iSkill == m_SkillCache.end() || iSkill->second.m_spVertex != spVertex )
+		return;
+
+	// the skill was replaced by a remote graph or is being removed, the next UseSkill() will
+	// resolve this skill from the graph again.
+	if ( a_Event.m_Type == IVertex::E_DROPPING 
+		|| (a_Event.m_Type == IVertex::E_MODIFIED && (*spVertex)["hashId"].asString() != iSkill->second.m_HashId) )
+	{
+		Log::Debug( "SkillManager", "Skill %s changed in the graph, removing from cache.", name.c_str() );
+		UncacheSkill( name );
+	}
+}
+
+void SkillManager::OnGraphVertexEvent( const IVertex::VertexEvent & a_Event )
+{
+	const IVertex::SP & spVertex = a_Event.m_spVertex;
+	if (! spVertex || spVertex->GetLabel() != "skill" )
+		return;
+
+	std::string name( (*spVertex)["name"].asString() );
+	SkillCache::iterator iSkill = m_SkillCache.find( name );
+	if ( iSkill == m_SkillCache.end() )
+		return;
+	if ( iSkill->second.m_spVertex == spVertex && (*spVertex)["hashId"].asString() == iSkill->second.m_HashId )
+		return;
+
+	// another vertex for this skill was saved, the next UseSkill() will pick the newest from the graph
+	Log::Debug( "SkillManager", "Skill %s saved into the graph, removing from cache.", name.c_str() );
+	UncacheSkill( name );
 }
 
 void SkillManager::OnDeleteSkill( ITraverser::SP a_spTraveser )
@@ -161,19 +246,20 @@ void SkillManager::OnSkillDeleted( const Json::Value & response)
 
 //--------------------------------------------
 
-SkillManager::SaveSkill::SaveSkill( const ISkill::SP & a_spSkill ) : m_spSkill( a_spSkill ),
+SkillManager::SaveSkill::SaveSkill( SkillManager * a_pManager, const ISkill::SP & a_spSkill ) : 
+	m_pManager( a_pManager ),
+	m_spSkill( a_spSkill ),
 	m_Data( ISerializable::SerializeObject( a_spSkill.get() ) ),
 	m_HashId( JsonHelpers::Hash( m_Data, "GUID_" ) )
 {
 	IGraph::SP spGraph = SelfInstance::GetInstance()->GetKnowledgeGraph();
 	spGraph->SetModel( "world" );
 
-	// search for an existing skill with the same hashId, if not found then create the vertex in our graph.
+	// search for all the versions of this skill, so we can tell if ours is already saved and if it's the newest.
 	ITraverser::SP spTraverser = spGraph->CreateTraverser(
 		LogicalCondition( Logic::AND, 
 			LabelCondition( "skill" ),
-			EqualityCondition( "name", Logic::EQ, m_spSkill->GetSkillName() ),
-			EqualityCondition( "hashId", Logic::EQ, m_HashId )
+			EqualityCondition( "name", Logic::EQ, m_spSkill->GetSkillName() )
 		)
 	);
 	if (! spTraverser->Start( DELEGATE( SaveSkill, OnFindSkill, ITraverser::SP, this ) ) )
@@ -182,8 +268,22 @@ SkillManager::SaveSkill::SaveSkill( const ISkill::SP & a_spSkill ) : m_spSkill(
 
 void SkillManager::SaveSkill::OnFindSkill( ITraverser::SP a_spTraverser )
 {
-	// create the vertex if the skill isn't already in our graph..
-	if ( a_spTraverser->Size() == 0 )
+	// find the vertex for our version of the skill and the newest vertex for any version of it..
+	IVertex::SP spVertex;
+	IVertex::SP spNewest;
+	for(size_t i=0;i<a_spTraverser->Size();++i)
+	{
+		const IVertex::SP & spSkill = a_spTraverser->GetResults()[i];
+		if (! spSkill )
+			continue;
+		if ( (*spSkill)["hashId"].asString() == m_HashId && (!spVertex || spVertex->GetTime() < spSkill->GetTime()) )
+			spVertex = spSkill;
+		if ( !spNewest || spNewest->GetTime() < spSkill->GetTime() )
+			spNewest = spSkill;
+	}
+
+	// create the vertex if our version isn't already in our graph..
+	if (! spVertex )
 	{
 		Json::Value skill;
 		skill["data"] = m_Data.toStyledString();
@@ -192,9 +292,16 @@ void SkillManager::SaveSkill::OnFindSkill( ITraverser::SP a_spTraverser )
 
 		Log::Status( "SkillManager", "Adding skill %s to the graph.", m_spSkill->GetSkillName().c_str() );
 		a_spTraverser->GetGraph()->SetModel("world");
-		a_spTraverser->GetGraph()->CreateVertex( "skill", skill );
+		spVertex = a_spTraverser->GetGraph()->CreateVertex( "skill", skill );
 	}
 
+	// we already have the skill object, so cache it now and UseSkill() won't need to search or parse. If a newer
+	// version was saved (e.g. merged from a remote graph), it's not cached so UseSkill() will load that one instead.
+	if ( spVertex && spNewest && spNewest != spVertex && spVertex->GetTime() < spNewest->GetTime() )
+		Log::Debug( "SkillManager", "Newer version of skill %s found in the graph, not caching.", m_spSkill->GetSkillName().c_str() );
+	else
+		m_pManager->CacheSkill( m_spSkill, spVertex );
+
 	delete this;			// free this request object
 }
 
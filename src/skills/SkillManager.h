@@ -23,6 +23,8 @@
 #include <map>
 #include <set>
 
+#include <boost/unordered_map.hpp>
+
 #include "SkillInstance.h"
 #include "ISkill.h"
 
@@ -55,7 +57,10 @@ public:
 
 	//! Accessors
 	const SkillSet & GetActiveSkills() const;
-	const ISkill::SP & FindCachedSkill( const std::string & a_GUID ) const;
+	//! Returns the resolved skill for the given name, NULL_SKILL if the name has not been resolved yet.
+	const ISkill::SP & FindCachedSkill( const std::string & a_Name ) const;
+	//! Returns the vertex the cached skill was loaded from, NULL if not cached.
+	IVertex::SP FindCachedVertex( const std::string & a_Name ) const;
 
 	//! Use a skill by it's ID with the given parameters. The callback if provided
 	//! will be invoked as the state changes for the skill. This object will be deleted
@@ -95,27 +100,46 @@ public:
 
 	void AddInstance( SkillInstance * a_pInstance );
 	void RemoveInstance( SkillInstance * a_pInstance );
-	//! Cache a skill by it's GUID
-	void CacheSkill( const ISkill::SP & a_spSkill );
+	//! Cache a skill by it's name along with the vertex it was resolved from, the newest vertex for
+	//! a name always wins. Returns false if a newer skill is already cached.
+	bool CacheSkill( const ISkill::SP & a_spSkill, const IVertex::SP & a_spVertex );
+	//! Remove a skill from our cache, the next UseSkill() will search the graph again.
+	void UncacheSkill( const std::string & a_Name );
 
 private:
 	//! Types
 	struct SaveSkill
 	{
+		SkillManager *	m_pManager;
 		ISkill::SP		m_spSkill;
 		Json::Value		m_Data;
 		std::string		m_HashId;
 
-		SaveSkill( const ISkill::SP & a_spSkill );
+		SaveSkill( SkillManager * a_pManager, const ISkill::SP & a_spSkill );
 		void OnFindSkill( ITraverser::SP a_spTraverser );
 	};
 
+	//! This is the resolved skill for a given name
+	struct CachedSkill
+	{
+		CachedSkill() : m_fTime( 0.0 )
+		{}
+
+		ISkill::SP		m_spSkill;
+		IVertex::SP		m_spVertex;			// the vertex this skill was loaded from
+		std::string		m_HashId;
+		double			m_fTime;
+	};
+	typedef boost::unordered_map< std::string, CachedSkill >	SkillCache;
+
 	//! Data
 	IVertex::SP		m_spSkills;
 	SkillSet		m_ActiveSkills;
-	SkillMap		m_SkillCache;
+	SkillCache		m_SkillCache;
 
 	void OnDeleteSkill( ITraverser::SP a_spTraveser );
+	void OnSkillVertexEvent( const IVertex::VertexEvent & a_Event );
+	void OnGraphVertexEvent( const IVertex::VertexEvent & a_Event );
 	void OnSkillAdded( const Json::Value & );
     void OnSkillDeleted( const Json::Value & );
 };
@@ -127,15 +151,24 @@ inline const SkillManager::SkillSet & SkillManager::GetActiveSkills() const
 	return m_ActiveSkills;
 }
 
-inline const ISkill::SP & SkillManager::FindCachedSkill( const std::string & a_GUID ) const
+inline const ISkill::SP & SkillManager::FindCachedSkill( const std::string & a_Name ) const
 {
-	SkillMap::const_iterator iSkill = m_SkillCache.find( a_GUID );
+	SkillCache::const_iterator iSkill = m_SkillCache.find( a_Name );
 	if ( iSkill != m_SkillCache.end() )
-		return iSkill->second;
+		return iSkill->second.m_spSkill;
 
 	return NULL_SKILL;
 }
 
+inline IVertex::SP SkillManager::FindCachedVertex( const std::string & a_Name ) const
+{
+	SkillCache::const_iterator iSkill = m_SkillCache.find( a_Name );
+	if ( iSkill != m_SkillCache.end() )
+		return iSkill->second.m_spVertex;
+
+	return IVertex::SP();
+}
+
 inline void SkillManager::UseSkill( const std::string & a_skill, const ParamsMap & a_Params,
 	const Delegate<SkillInstance *> & a_Callback,
 	const IThing::SP & a_spParent )
@@ -155,34 +155,7 @@ bool DataStoreSQLL::Drop()
 bool DataStoreSQLL::Save( const std::string & a_ID, const Json::Value & a_Data,
 	Delegate<bool> a_Callback /*= Delegate<bool>()*/ )
 {
-	Json::Value save(a_Data);
-	ApplyDefinition(save, m_Definition);
-	save["_id"] = a_ID;
-
-	char * pQuery = sqlite3_mprintf("REPLACE INTO data(id,data) VALUES('%q','%q'); ",
-		a_ID.c_str(), save.toStyledString().c_str() );
-	std::string insert( pQuery );
-	sqlite3_free( pQuery );
-
-	Json::Value & indexes = m_Definition["_Indexed"];
-	for (size_t i = 0; i < indexes.size(); ++i)
-	{
-		const std::string & index = indexes[i].asString();
-		Json::Value & value = JsonHelpers::Resolve(save, index);
-
-		if (value.isObject() || value.isArray())
-		{
-			Log::Warning("DataStoreSQLL", "Cannot index object/array.");
-			continue;
-		}
-
-		char * pQuery = sqlite3_mprintf("REPLACE INTO data_index(key,value,id) VALUES('%q','%q','%q'); ",
-			index.c_str(), value.asCString(), a_ID.c_str() );
-		insert += pQuery;
-		sqlite3_free( pQuery );
-	}
-
-	PushCommand( new ExecCommand( insert, a_Callback ) );
+	PushCommand( new ExecCommand( GetSaveSQL( a_ID, a_Data ), a_Callback ) );
 	return true;
 }
 
@@ -196,9 +169,21 @@ bool DataStoreSQLL::Load( const std::string & a_ID, Delegate<Json::Value *> a_Ca
 
 bool DataStoreSQLL::Delete( const std::string & a_ID, Delegate<bool> a_Callback /*= Delegate<bool>()*/ )
 {
-	std::string query( "DELETE FROM data where id='" + a_ID + "'; DELETE FROM data_index where id='" + a_ID + "';" );
-	PushCommand( new ExecCommand( query, a_Callback ) );
+	PushCommand( new ExecCommand( GetDeleteSQL( a_ID ), a_Callback ) );
+	return true;
+}
 
+bool DataStoreSQLL::Commit( const Batch & a_Batch, Delegate<bool> a_Callback /*= Delegate<bool>()*/ )
+{
+	// one transaction for the whole batch, so sqlite only syncs the file once
+	std::string sql( "BEGIN TRANSACTION; " );
+	for( Batch::SaveList::const_iterator iSave = a_Batch.m_Save.begin(); iSave != a_Batch.m_Save.end(); ++iSave )
+		sql += GetSaveSQL( iSave->first, iSave->second );
+	for( Batch::DeleteList::const_iterator iDelete = a_Batch.m_Delete.begin(); iDelete != a_Batch.m_Delete.end(); ++iDelete )
+		sql += GetDeleteSQL( *iDelete );
+	sql += "COMMIT; ";
+
+	PushCommand( new ExecCommand( sql, a_Callback ) );
 	return true;
 }
 
@@ -240,6 +225,48 @@ void DataStoreSQLL::ApplyDefinition(Json::Value & json, const Json::Value & def)
 	}
 }
 
+std::string DataStoreSQLL::GetSaveSQL( const std::string & a_ID, const Json::Value & a_Data )
+{
+	Json::Value save(a_Data);
+	ApplyDefinition(save, m_Definition);
+	save["_id"] = a_ID;
+
+	char * pQuery = sqlite3_mprintf("REPLACE INTO data(id,data) VALUES('%q','%q'); ",
+		a_ID.c_str(), save.toStyledString().c_str() );
+	std::string insert( pQuery );
+	sqlite3_free( pQuery );
+
+	Json::Value & indexes = m_Definition["_Indexed"];
+	for (size_t i = 0; i < indexes.size(); ++i)
+	{
+		const std::string & index = indexes[i].asString();
+		Json::Value & value = JsonHelpers::Resolve(save, index);
+
+		if (value.isObject() || value.isArray())
+		{
+			Log::Warning("DataStoreSQLL", "Cannot index object/array.");
+			continue;
+		}
+
+		char * pQuery = sqlite3_mprintf("REPLACE INTO data_index(key,value,id) VALUES('%q','%q','%q'); ",
+			index.c_str(), value.asCString(), a_ID.c_str() );
+		insert += pQuery;
+		sqlite3_free( pQuery );
+	}
+
+	return insert;
+}
+
+std::string DataStoreSQLL::GetDeleteSQL( const std::string & a_ID )
+{
+	char * pQuery = sqlite3_mprintf( "DELETE FROM data where id='%q'; DELETE FROM data_index where id='%q'; ",
+		a_ID.c_str(), a_ID.c_str() );
+	std::string query( pQuery );
+	sqlite3_free( pQuery );
+
+	return query;
+}
+
 std::string DataStoreSQLL::GetWhereOp(Logic::EqualityOp a_Op)
 {
 	static const char * TEXT[] =
@@ -354,6 +381,10 @@ void DataStoreSQLL::ExecCommand::Execute( sqlite3 * a_pDB )
 	{
 		Log::Error("DataStoreSQLL", "Failed to query data: %s", sqlite3_errmsg(a_pDB));
 		bSuccess = false;
+
+		// don't leave a failed batch open, or every command after it would join the transaction
+		if (! sqlite3_get_autocommit(a_pDB) )
+			sqlite3_exec(a_pDB, "ROLLBACK;", NULL, NULL, NULL);
 	}
 
 	ThreadPool::Instance()->InvokeOnMain<bool>( m_Callback, bSuccess );
@@ -45,6 +45,8 @@ public:
 		Delegate<Json::Value *> a_Callback);
 	virtual bool Delete(const std::string & a_ID,
 		Delegate<bool> a_Callback = Delegate<bool>());
+	virtual bool Commit(const Batch & a_Batch,
+		Delegate<bool> a_Callback = Delegate<bool>());
 	virtual bool Find(const Conditions & a_Conditions,
 		Delegate<QueryResults *> a_Callback);
 
@@ -109,6 +111,9 @@ private:
 	static std::string GetWhereOp(Logic::EqualityOp a_Op);
 	static std::string GetWhereClause(const Conditions & a_Conditions, Logic::LogicalOp a_LogOp = Logic::AND );
 
+	std::string GetSaveSQL(const std::string & a_ID, const Json::Value & a_Data);
+	std::string GetDeleteSQL(const std::string & a_ID);
+
 	void PushCommand( ICommand * a_pCommand );
 	void ProcessCommandQueue();
 };
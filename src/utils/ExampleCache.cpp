@@ -0,0 +1,494 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fstream>
+#include <algorithm>
+
+#include "boost/cstdint.hpp"
+#include "boost/crc.hpp"
+#include "boost/filesystem.hpp"
+
+#include "ExampleCache.h"
+#include "utils/Log.h"
+#include "utils/Time.h"
+#include "utils/StringUtil.h"
+
+const std::string POSITIVE_SUFFIX( "_positive_examples" );
+const std::string NEGATIVE_SUFFIX( "_negative_examples" );
+const std::string ARCHIVE_EXT( ".zip" );
+const std::string TEMP_EXT( ".tmp" );
+const std::string UNSENT_PATH( "unsent/" );
+const std::string SENDING_PATH( "sending/" );
+
+//! zip records, all entries are stored without compression since jpeg images don't compress
+const boost::uint32_t LOCAL_HEADER_SIG = 0x04034b50;
+const boost::uint32_t CENTRAL_HEADER_SIG = 0x02014b50;
+const boost::uint32_t END_RECORD_SIG = 0x06054b50;
+const size_t LOCAL_HEADER_SIZE = 30;
+const size_t END_RECORD_SIZE = 22;
+const size_t MAX_COMMENT_SIZE = 0xffff;
+const size_t MAX_ENTRIES = 0xffff;
+
+static void PutU16( std::string & a_Data, boost::uint16_t a_Value )
+{
+	char bytes[2] = { (char)(a_Value & 0xff), (char)(a_Value >> 8) };
+	a_Data.append( bytes, sizeof(bytes) );
+}
+
+static void PutU32( std::string & a_Data, boost::uint32_t a_Value )
+{
+	PutU16( a_Data, (boost::uint16_t)(a_Value & 0xffff) );
+	PutU16( a_Data, (boost::uint16_t)(a_Value >> 16) );
+}
+
+static boost::uint32_t GetU16( const char * a_pData )
+{
+	const unsigned char * pData = (const unsigned char *)a_pData;
+	return pData[0] | (pData[1] << 8);
+}
+
+static boost::uint32_t GetU32( const char * a_pData )
+{
+	return GetU16( a_pData ) | (GetU16( a_pData + 2 ) << 16);
+}
+
+ExampleCache::ExampleCache() : m_MaxSize( 0 ), m_Size( 0 ), m_SentId( 0 )
+{}
+
+bool ExampleCache::Initialize( const std::string & a_Path, size_t a_MaxSize )
+{
+	Uninitialize();
+
+	m_Path = a_Path;
+	if ( m_Path.size() > 0 && m_Path[ m_Path.size() - 1 ] != '/' )
+		m_Path += '/';
+	m_MaxSize = a_MaxSize;
+
+	try {
+		boost::filesystem::create_directories( m_Path );
+		boost::filesystem::create_directories( m_Path + UNSENT_PATH );
+
+		// anything left from a send that never finished is still in the full archives
+		boost::filesystem::remove_all( m_Path + SENDING_PATH );
+		boost::filesystem::create_directories( m_Path + SENDING_PATH );
+
+		// index the archives once, after this the index is kept up to date as examples are added
+		for( boost::filesystem::directory_iterator p( m_Path ); p != boost::filesystem::directory_iterator(); ++p )
+		{
+			if (! boost::filesystem::is_regular_file( p->status() ) )
+				continue;
+			if ( p->path().extension().string() == TEMP_EXT )
+			{
+				// an append that never finished, the archive it was replacing is still intact
+				boost::filesystem::remove( p->path() );
+				continue;
+			}
+			if ( p->path().extension().string() != ARCHIVE_EXT )
+				continue;
+
+			Archive archive;
+			archive.m_Id = p->path().stem().string();
+			if (! ParseId( archive.m_Id, archive.m_Class, archive.m_ePolarity ) )
+				continue;
+
+			std::string directory;
+			size_t offset = 0;
+			archive.m_Path = p->path().string();
+			if (! ReadDirectory( archive.m_Path, directory, offset, archive.m_Count ) )
+			{
+				Log::Warning( "ExampleCache", "Ignoring invalid archive %s", archive.m_Path.c_str() );
+				continue;
+			}
+			archive.m_Size = (size_t)boost::filesystem::file_size( p->path() );
+			archive.m_Updated = (double)boost::filesystem::last_write_time( p->path() );
+
+			archive.m_UnsentPath = m_Path + UNSENT_PATH + archive.m_Id + ARCHIVE_EXT;
+			if ( boost::filesystem::exists( archive.m_UnsentPath ) 
+				&& !ReadDirectory( archive.m_UnsentPath, directory, offset, archive.m_UnsentCount ) )
+			{
+				Log::Warning( "ExampleCache", "Ignoring invalid archive %s", archive.m_UnsentPath.c_str() );
+				boost::filesystem::remove( archive.m_UnsentPath );
+				archive.m_UnsentCount = 0;
+			}
+
+			m_Size += archive.m_Size;
+			m_Archives[ archive.m_ePolarity ][ archive.m_Class ] = archive;
+		}
+	}
+	catch( const std::exception & ex )
+	{
+		Log::Error( "ExampleCache", "Failed to index %s: %s", m_Path.c_str(), ex.what() );
+		return false;
+	}
+
+	Log::Status( "ExampleCache", "Indexed %u positive and %u negative archives, %u bytes in %s",
+		(unsigned int)m_Archives[POSITIVE].size(), (unsigned int)m_Archives[NEGATIVE].size(), 
+		(unsigned int)m_Size, m_Path.c_str() );
+	Evict( NULL );
+	return true;
+}
+
+void ExampleCache::Uninitialize()
+{
+	for(int i=0;i<POLARITY_COUNT;++i)
+		m_Archives[i].clear();
+	m_Size = 0;
+}
+
+const ExampleCache::Archive * ExampleCache::Add( const std::string & a_Class, Polarity a_ePolarity, const ImageList & a_Images )
+{
+	if ( m_Path.size() == 0 || a_Class.size() == 0 || a_Images.size() == 0 )
+		return NULL;
+
+	ArchiveMap::iterator iArchive = m_Archives[ a_ePolarity ].find( a_Class );
+	bool bNew = iArchive == m_Archives[ a_ePolarity ].end();
+	if ( bNew )
+	{
+		Archive archive;
+		archive.m_Id = GetId( a_Class, a_ePolarity );
+		archive.m_Class = a_Class;
+		archive.m_ePolarity = a_ePolarity;
+		archive.m_Path = m_Path + archive.m_Id + ARCHIVE_EXT;
+		archive.m_UnsentPath = m_Path + UNSENT_PATH + archive.m_Id + ARCHIVE_EXT;
+
+		// a file we failed to index can't be appended to, start it again
+		boost::system::error_code error;
+		boost::filesystem::remove( archive.m_Path, error );
+		boost::filesystem::remove( archive.m_UnsentPath, error );
+
+		iArchive = m_Archives[ a_ePolarity ].insert( ArchiveMap::value_type( a_Class, archive ) ).first;
+	}
+
+	Archive & archive = iArchive->second;
+	if ( archive.m_Count + a_Images.size() > MAX_ENTRIES || !AppendImages( archive.m_Path, archive.m_Count, a_Images ) )
+	{
+		Log::Error( "ExampleCache", "Failed to add %u images to %s", (unsigned int)a_Images.size(), archive.m_Path.c_str() );
+		if ( bNew )
+			m_Archives[ a_ePolarity ].erase( iArchive );
+		return NULL;
+	}
+
+	boost::system::error_code error;
+	size_t size = (size_t)boost::filesystem::file_size( archive.m_Path, error );
+	m_Size = m_Size - archive.m_Size + size;
+	archive.m_Size = size;
+	archive.m_Count += a_Images.size();
+	archive.m_Updated = Time().GetEpochTime();
+
+	if ( archive.m_UnsentCount + a_Images.size() <= MAX_ENTRIES 
+		&& AppendImages( archive.m_UnsentPath, archive.m_UnsentCount, a_Images ) )
+	{
+		archive.m_UnsentCount += a_Images.size();
+	}
+	else
+		Log::Error( "ExampleCache", "Failed to add %u images to %s", (unsigned int)a_Images.size(), archive.m_UnsentPath.c_str() );
+
+	Evict( &archive );
+	return &archive;
+}
+
+const ExampleCache::Archive * ExampleCache::Find( const std::string & a_Class, Polarity a_ePolarity ) const
+{
+	ArchiveMap::const_iterator iArchive = m_Archives[ a_ePolarity ].find( a_Class );
+	if ( iArchive != m_Archives[ a_ePolarity ].end() )
+		return &iArchive->second;
+	return NULL;
+}
+
+const ExampleCache::Archive * ExampleCache::Find( const std::string & a_Id ) const
+{
+	std::string className;
+	Polarity ePolarity = POSITIVE;
+	if (! ParseId( a_Id, className, ePolarity ) )
+		return NULL;
+	return Find( className, ePolarity );
+}
+
+bool ExampleCache::Remove( const std::string & a_Class, Polarity a_ePolarity )
+{
+	ArchiveMap::iterator iArchive = m_Archives[ a_ePolarity ].find( a_Class );
+	if ( iArchive == m_Archives[ a_ePolarity ].end() )
+		return false;
+
+	boost::system::error_code error;
+	boost::filesystem::remove( iArchive->second.m_Path, error );
+	boost::filesystem::remove( iArchive->second.m_UnsentPath, error );
+	m_Size -= iArchive->second.m_Size;
+	m_Archives[ a_ePolarity ].erase( iArchive );
+	return true;
+}
+
+bool ExampleCache::TakeUnsent( const std::string & a_Id, std::string & a_Path )
+{
+	std::string className;
+	Polarity ePolarity = POSITIVE;
+	if (! ParseId( a_Id, className, ePolarity ) )
+		return false;
+	ArchiveMap::iterator iArchive = m_Archives[ ePolarity ].find( className );
+	if ( iArchive == m_Archives[ ePolarity ].end() || iArchive->second.m_UnsentCount == 0 )
+		return false;
+
+	// moved so examples added while this is being sent start a new unsent archive
+	Archive & archive = iArchive->second;
+	std::string path( m_Path + SENDING_PATH + archive.m_Id + StringUtil::Format( "_%u", m_SentId++ ) + ARCHIVE_EXT );
+
+	boost::system::error_code error;
+	boost::filesystem::rename( archive.m_UnsentPath, path, error );
+	if ( error )
+	{
+		Log::Error( "ExampleCache", "Failed to move %s: %s", archive.m_UnsentPath.c_str(), error.message().c_str() );
+		return false;
+	}
+
+	archive.m_UnsentCount = 0;
+	a_Path = path;
+	return true;
+}
+
+void ExampleCache::RemoveSent( const std::string & a_Path )
+{
+	boost::system::error_code error;
+	boost::filesystem::remove( a_Path, error );
+}
+
+void ExampleCache::ClearUnsent()
+{
+	boost::system::error_code error;
+	for(int i=0;i<POLARITY_COUNT;++i)
+	{
+		for( ArchiveMap::iterator iArchive = m_Archives[i].begin(); iArchive != m_Archives[i].end(); ++iArchive )
+		{
+			boost::filesystem::remove( iArchive->second.m_UnsentPath, error );
+			iArchive->second.m_UnsentCount = 0;
+		}
+	}
+}
+
+std::string ExampleCache::GetId( const std::string & a_Class, Polarity a_ePolarity )
+{
+	return a_Class + (a_ePolarity == POSITIVE ? POSITIVE_SUFFIX : NEGATIVE_SUFFIX);
+}
+
+bool ExampleCache::ParseId( const std::string & a_Id, std::string & a_Class, Polarity & a_ePolarity )
+{
+	const std::string * pSuffixes[] = { &POSITIVE_SUFFIX, &NEGATIVE_SUFFIX };
+	for(int i=0;i<POLARITY_COUNT;++i)
+	{
+		const std::string & suffix = *pSuffixes[i];
+		if ( a_Id.size() > suffix.size() && a_Id.compare( a_Id.size() - suffix.size(), suffix.size(), suffix ) == 0 )
+		{
+			a_Class = a_Id.substr( 0, a_Id.size() - suffix.size() );
+			a_ePolarity = (Polarity)i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void ExampleCache::Evict( const Archive * a_pKeep )
+{
+	while( m_MaxSize > 0 && m_Size > m_MaxSize )
+	{
+		// remove the archive updated least recently, but never the one we just added to
+		ArchiveMap::iterator iOldest;
+		int oldest = -1;
+		for(int i=0;i<POLARITY_COUNT;++i)
+		{
+			for( ArchiveMap::iterator iArchive = m_Archives[i].begin(); iArchive != m_Archives[i].end(); ++iArchive )
+			{
+				if ( &iArchive->second == a_pKeep )
+					continue;
+				if ( oldest < 0 || iArchive->second.m_Updated < iOldest->second.m_Updated )
+				{
+					iOldest = iArchive;
+					oldest = i;
+				}
+			}
+		}
+
+		if ( oldest < 0 )
+		{
+			Log::Warning( "ExampleCache", "Cache %s is %u bytes, over the maximum of %u bytes", 
+				m_Path.c_str(), (unsigned int)m_Size, (unsigned int)m_MaxSize );
+			break;
+		}
+
+		Log::Status( "ExampleCache", "Evicting %s, %u bytes", iOldest->second.m_Id.c_str(), (unsigned int)iOldest->second.m_Size );
+		Remove( iOldest->second.m_Class, (Polarity)oldest );
+	}
+}
+
+bool ExampleCache::ReadDirectory( const std::string & a_Path, std::string & a_Directory, 
+	size_t & a_DirectoryOffset, size_t & a_Count )
+{
+	std::ifstream input( a_Path.c_str(), std::ios::in | std::ios::binary );
+	if (! input.is_open() )
+		return false;
+
+	// the end record is at the end of the file, followed only by the archive comment
+	input.seekg( 0, std::ios::end );
+	size_t fileSize = (size_t)input.tellg();
+	if ( fileSize < END_RECORD_SIZE )
+		return false;
+
+	size_t tailSize = std::min( fileSize, END_RECORD_SIZE + MAX_COMMENT_SIZE );
+	std::string tail( tailSize, 0 );
+	input.seekg( fileSize - tailSize );
+	input.read( &tail[0], tailSize );
+	if (! input )
+		return false;
+
+	size_t end = std::string::npos;
+	for(size_t i=tailSize - END_RECORD_SIZE + 1;i>0;--i)
+	{
+		if ( GetU32( &tail[i - 1] ) == END_RECORD_SIG )
+		{
+			end = i - 1;
+			break;
+		}
+	}
+	if ( end == std::string::npos )
+		return false;
+
+	size_t endOffset = fileSize - tailSize + end;
+	size_t count = GetU16( &tail[end + 10] );
+	size_t directorySize = GetU32( &tail[end + 12] );
+	size_t directoryOffset = GetU32( &tail[end + 16] );
+	if ( directoryOffset + directorySize > endOffset )
+		return false;
+
+	a_Directory.resize( directorySize );
+	input.seekg( directoryOffset );
+	if ( directorySize > 0 )
+		input.read( &a_Directory[0], directorySize );
+	if (! input )
+		return false;
+
+	a_DirectoryOffset = directoryOffset;
+	a_Count = count;
+	return true;
+}
+
+bool ExampleCache::AppendImages( const std::string & a_Path, size_t a_First, const ImageList & a_Images )
+{
+	std::string directory;
+	size_t offset = 0;
+	size_t count = 0;
+	bool bExists = boost::filesystem::exists( a_Path );
+	if ( bExists && !ReadDirectory( a_Path, directory, offset, count ) )
+		return false;
+
+	time_t now = time( NULL );
+	struct tm * pLocal = localtime( &now );
+	boost::uint16_t dosTime = (boost::uint16_t)((pLocal->tm_hour << 11) | (pLocal->tm_min << 5) | (pLocal->tm_sec / 2));
+	boost::uint16_t dosDate = (boost::uint16_t)(((pLocal->tm_year - 80) << 9) | ((pLocal->tm_mon + 1) << 5) | pLocal->tm_mday);
+
+	// the new entries go where the old directory started, followed by the old and new directory entries
+	size_t start = offset;
+	std::string entries;
+	for(size_t i=0;i<a_Images.size();++i)
+	{
+		const std::string & image = a_Images[i];
+
+		char name[32];
+		snprintf( name, sizeof(name), "%u.jpg", (unsigned int)(a_First + i) );
+		boost::uint16_t nameSize = (boost::uint16_t)strlen( name );
+
+		boost::crc_32_type crc;
+		crc.process_bytes( image.data(), image.size() );
+
+		std::string header;
+		PutU16( header, 20 );					// version needed
+		PutU16( header, 0 );					// flags
+		PutU16( header, 0 );					// stored
+		PutU16( header, dosTime );
+		PutU16( header, dosDate );
+		PutU32( header, crc.checksum() );
+		PutU32( header, (boost::uint32_t)image.size() );
+		PutU32( header, (boost::uint32_t)image.size() );
+		PutU16( header, nameSize );
+		PutU16( header, 0 );					// extra
+
+		PutU32( entries, LOCAL_HEADER_SIG );
+		entries += header;
+		entries.append( name, nameSize );
+		entries += image;
+
+		PutU32( directory, CENTRAL_HEADER_SIG );
+		PutU16( directory, 20 );				// version made by
+		directory += header;
+		PutU16( directory, 0 );					// comment
+		PutU16( directory, 0 );					// disk
+		PutU16( directory, 0 );					// internal attributes
+		PutU32( directory, 0 );					// external attributes
+		PutU32( directory, (boost::uint32_t)offset );
+		directory.append( name, nameSize );
+
+		offset += LOCAL_HEADER_SIZE + nameSize + image.size();
+		count += 1;
+	}
+
+	entries += directory;
+
+	PutU32( entries, END_RECORD_SIG );
+	PutU16( entries, 0 );
+	PutU16( entries, 0 );
+	PutU16( entries, (boost::uint16_t)count );
+	PutU16( entries, (boost::uint16_t)count );
+	PutU32( entries, (boost::uint32_t)directory.size() );
+	PutU32( entries, (boost::uint32_t)offset );
+	PutU16( entries, 0 );
+
+	// the existing entries are copied as they are into a new file which then replaces the archive, so
+	// the archive is never left without a valid directory
+	std::string temp( a_Path + TEMP_EXT );
+	std::ofstream output( temp.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+	if (! output.is_open() )
+		return false;
+	if ( bExists )
+	{
+		std::ifstream input( a_Path.c_str(), std::ios::in | std::ios::binary );
+		char buffer[ 64 * 1024 ];
+		for(size_t copied = 0;copied < start && input;)
+		{
+			size_t bytes = std::min( sizeof(buffer), start - copied );
+			input.read( buffer, bytes );
+			output.write( buffer, input.gcount() );
+			copied += (size_t)input.gcount();
+		}
+		if (! input )
+			output.setstate( std::ios::failbit );
+	}
+	output.write( entries.data(), entries.size() );
+	output.close();
+
+	boost::system::error_code error;
+	if (! output.fail() )
+		boost::filesystem::rename( temp, a_Path, error );
+	if ( output.fail() || error )
+	{
+		boost::filesystem::remove( temp, error );
+		return false;
+	}
+
+	return true;
+}
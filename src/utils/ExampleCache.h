@@ -0,0 +1,130 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#ifndef SELF_EXAMPLE_CACHE_H
+#define SELF_EXAMPLE_CACHE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "SelfLib.h"
+
+//! This class keeps the training examples for a classifier on disk, as one zip archive of images for each
+//! class and polarity. The archives are indexed when the cache is initialized, new examples are appended
+//! to the end of the archive of their class so existing examples are never re-compressed. Each new example is
+//! also appended to an unsent archive for its class, so a classifier can be updated with only the examples it
+//! hasn't seen. When the cache grows past its maximum size, the archives updated least recently are removed first.
+class SELF_API ExampleCache
+{
+public:
+	//! Types
+	enum Polarity
+	{
+		POSITIVE,
+		NEGATIVE,
+		POLARITY_COUNT
+	};
+
+	struct Archive
+	{
+		Archive() : m_ePolarity( POSITIVE ), m_Size( 0 ), m_Count( 0 ), m_Updated( 0.0 ), m_UnsentCount( 0 )
+		{}
+
+		std::string		m_Id;			// <class>_positive_examples or <class>_negative_examples
+		std::string		m_Class;
+		Polarity		m_ePolarity;
+		std::string		m_Path;
+		size_t			m_Size;			// in bytes
+		size_t			m_Count;		// number of images
+		double			m_Updated;		// epoch time of the last append
+		std::string		m_UnsentPath;	// archive of the examples added since the last TakeUnsent()
+		size_t			m_UnsentCount;
+	};
+	typedef std::map< std::string, Archive >		ArchiveMap;		// by class
+	typedef std::vector< std::string >				ImageList;
+
+	//! Construction
+	ExampleCache();
+
+	//! Accessors
+	const std::string &	GetPath() const;
+	size_t				GetMaxSize() const;
+	size_t				GetSize() const;
+	const ArchiveMap &	GetArchives( Polarity a_ePolarity ) const;
+
+	//! Index the archives in the given directory, creating it if needed.
+	bool				Initialize( const std::string & a_Path, size_t a_MaxSize );
+	void				Uninitialize();
+
+	//! Append the given jpeg images to the archive for a class, returns the archive or NULL on failure.
+	const Archive *		Add( const std::string & a_Class, Polarity a_ePolarity, const ImageList & a_Images );
+	//! Find the archive for a class.
+	const Archive *		Find( const std::string & a_Class, Polarity a_ePolarity ) const;
+	//! Find an archive by its id.
+	const Archive *		Find( const std::string & a_Id ) const;
+	//! Remove the archive for a class.
+	bool				Remove( const std::string & a_Class, Polarity a_ePolarity );
+
+	//! Move the examples not sent yet for an archive into a file of their own, returns false if there
+	//! are none. The caller removes the file with RemoveSent() once it has been sent.
+	bool				TakeUnsent( const std::string & a_Id, std::string & a_Path );
+	void				RemoveSent( const std::string & a_Path );
+	//! Forget the unsent examples of every archive, when all the archives have been sent as they are.
+	void				ClearUnsent();
+
+	static std::string	GetId( const std::string & a_Class, Polarity a_ePolarity );
+	static bool			ParseId( const std::string & a_Id, std::string & a_Class, Polarity & a_ePolarity );
+
+private:
+	//! Data
+	std::string			m_Path;
+	size_t				m_MaxSize;
+	size_t				m_Size;
+	ArchiveMap			m_Archives[ POLARITY_COUNT ];
+	unsigned int		m_SentId;
+
+	void				Evict( const Archive * a_pKeep );
+	static bool			ReadDirectory( const std::string & a_Path, std::string & a_Directory,
+							size_t & a_DirectoryOffset, size_t & a_Count );
+	static bool			AppendImages( const std::string & a_Path, size_t a_First, const ImageList & a_Images );
+};
+
+//----------------------------------
+
+inline const std::string & ExampleCache::GetPath() const
+{
+	return m_Path;
+}
+
+inline size_t ExampleCache::GetMaxSize() const
+{
+	return m_MaxSize;
+}
+
+inline size_t ExampleCache::GetSize() const
+{
+	return m_Size;
+}
+
+inline const ExampleCache::ArchiveMap & ExampleCache::GetArchives( Polarity a_ePolarity ) const
+{
+	return m_Archives[ a_ePolarity ];
+}
+
+#endif // SELF_EXAMPLE_CACHE_H
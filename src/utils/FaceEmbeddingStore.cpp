@@ -0,0 +1,390 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <queue>
+#include <limits>
+
+#include "boost/cstdint.hpp"
+
+#include "FaceEmbeddingStore.h"
+#include "tinyxml/tinyxml.h"
+#include "utils/Log.h"
+
+const char STORE_MAGIC[] = "SELFFACE";
+const size_t STORE_MAGIC_SIZE = sizeof(STORE_MAGIC) - 1;
+const boost::uint32_t STORE_VERSION = 1;
+
+bool FaceEmbeddingStore::Add( const std::string & a_PersonId, const std::string & a_Name,
+	const std::string & a_Gender, const std::vector<float> & a_Features )
+{
+	if ( a_Features.size() == 0 || (m_Dimensions != 0 && a_Features.size() != m_Dimensions) )
+		return false;
+
+	Face face;
+	face.m_PersonId = a_PersonId;
+	face.m_Name = a_Name;
+	face.m_Gender = a_Gender;
+	face.m_Features = a_Features;
+	if (! Normalize( face.m_Features ) )
+		return false;
+
+	// a person keeps only their latest features
+	Remove( a_PersonId );
+
+	m_Dimensions = a_Features.size();
+	m_Faces.push_back( face );
+	m_bDirty = true;
+	return true;
+}
+
+bool FaceEmbeddingStore::Contains( const std::string & a_PersonId ) const
+{
+	for(size_t i=0;i<m_Faces.size();++i)
+		if ( m_Faces[i].m_PersonId == a_PersonId )
+			return true;
+	return false;
+}
+
+bool FaceEmbeddingStore::Remove( const std::string & a_PersonId )
+{
+	bool bRemoved = false;
+	for(size_t i=0;i<m_Faces.size();)
+	{
+		if ( m_Faces[i].m_PersonId == a_PersonId )
+		{
+			m_Faces.erase( m_Faces.begin() + i );
+			bRemoved = true;
+		}
+		else
+			++i;
+	}
+
+	if ( bRemoved )
+		m_bDirty = true;
+	if ( m_Faces.size() == 0 )
+		m_Dimensions = 0;
+	return bRemoved;
+}
+
+void FaceEmbeddingStore::Clear()
+{
+	m_Faces.clear();
+	m_Dimensions = 0;
+	m_bDirty = true;
+}
+
+bool FaceEmbeddingStore::Search( const std::vector<float> & a_Features, size_t a_Count, MatchList & a_Matches ) const
+{
+	a_Matches.clear();
+	if ( m_Faces.size() == 0 || a_Features.size() != m_Dimensions || a_Count == 0 )
+		return false;
+
+	std::vector<float> query( a_Features );
+	if (! Normalize( query ) )
+		return false;
+	if ( m_bDirty )
+		BuildTree();
+
+	// nearest a_Count faces so far, furthest on top
+	typedef std::pair<float,int>	Candidate;
+	std::priority_queue<Candidate> nearest;
+	float tau = std::numeric_limits<float>::max();
+	int visits = 0;
+
+	std::vector<int> pending;
+	pending.push_back( m_Root );
+	while( pending.size() > 0 )
+	{
+		int index = pending.back();
+		pending.pop_back();
+		if ( index < 0 )
+			continue;
+		if ( m_MaxVisits > 0 && visits >= m_MaxVisits )
+			break;
+
+		const Node & node = m_Nodes[ index ];
+		float distance = Distance( query, m_Faces[ node.m_Face ].m_Features );
+		visits += 1;
+
+		if ( nearest.size() < a_Count || distance < nearest.top().first )
+		{
+			nearest.push( Candidate( distance, node.m_Face ) );
+			if ( nearest.size() > a_Count )
+				nearest.pop();
+			if ( nearest.size() == a_Count )
+				tau = nearest.top().first;
+		}
+
+		// push the far side first, so the side the query falls in is searched first
+		if ( distance < node.m_fRadius )
+		{
+			if ( distance + tau >= node.m_fRadius )
+				pending.push_back( node.m_Outside );
+			pending.push_back( node.m_Inside );
+		}
+		else
+		{
+			if ( distance - tau <= node.m_fRadius )
+				pending.push_back( node.m_Inside );
+			pending.push_back( node.m_Outside );
+		}
+	}
+
+	a_Matches.resize( nearest.size() );
+	for(size_t i=a_Matches.size();i>0;--i)
+	{
+		Match & match = a_Matches[i - 1];
+		match.m_Index = (size_t)nearest.top().second;
+		match.m_fDistance = nearest.top().first;
+		// for unit vectors, |a - b|^2 = 2 - 2 cos
+		match.m_fConfidence = std::min( std::max( 1.0f - ((match.m_fDistance * match.m_fDistance) * 0.5f), 0.0f ), 1.0f );
+		nearest.pop();
+	}
+
+	return a_Matches.size() > 0;
+}
+
+bool FaceEmbeddingStore::Load( const std::string & a_File )
+{
+	std::ifstream input( a_File.c_str(), std::ios::in | std::ios::binary );
+	if (! input.is_open() )
+		return false;
+	std::string data( (std::istreambuf_iterator<char>( input )), std::istreambuf_iterator<char>() );
+
+	boost::uint32_t version = 0, dimensions = 0, count = 0;
+	const size_t HEADER_SIZE = STORE_MAGIC_SIZE + sizeof(version) + sizeof(dimensions) + sizeof(count);
+	if ( data.size() < HEADER_SIZE || memcmp( data.data(), STORE_MAGIC, STORE_MAGIC_SIZE ) != 0 )
+	{
+		Log::Error( "FaceEmbeddingStore", "%s is not a face store.", a_File.c_str() );
+		return false;
+	}
+
+	size_t offset = STORE_MAGIC_SIZE;
+	memcpy( &version, data.data() + offset, sizeof(version) ); offset += sizeof(version);
+	memcpy( &dimensions, data.data() + offset, sizeof(dimensions) ); offset += sizeof(dimensions);
+	memcpy( &count, data.data() + offset, sizeof(count) ); offset += sizeof(count);
+	if ( version != STORE_VERSION )
+	{
+		Log::Error( "FaceEmbeddingStore", "Unsupported face store version %u in %s", version, a_File.c_str() );
+		return false;
+	}
+
+	// every face takes at least its string lengths and features, so a count the file can't hold is
+	// refused before anything is allocated for it
+	const size_t MIN_FACE_SIZE = (3 * sizeof(boost::uint16_t)) + ((size_t)dimensions * sizeof(float));
+	if ( (count > 0 && dimensions == 0) || dimensions > (data.size() / sizeof(float))
+		|| count > (data.size() - HEADER_SIZE) / MIN_FACE_SIZE )
+	{
+		Log::Error( "FaceEmbeddingStore", "Face store %s has %u faces of %u values, more than its size allows.", 
+			a_File.c_str(), count, dimensions );
+		return false;
+	}
+
+	FaceList faces;
+	faces.resize( count );
+	for(size_t i=0;i<count;++i)
+	{
+		Face & face = faces[i];
+		std::string * pStrings[] = { &face.m_PersonId, &face.m_Name, &face.m_Gender };
+		for(size_t k=0;k<sizeof(pStrings)/sizeof(pStrings[0]);++k)
+		{
+			boost::uint16_t length = 0;
+			if ( offset + sizeof(length) > data.size() )
+				break;
+			memcpy( &length, data.data() + offset, sizeof(length) );
+			offset += sizeof(length);
+			if ( offset + length > data.size() )
+				break;
+			pStrings[k]->assign( data.data() + offset, length );
+			offset += length;
+		}
+
+		size_t bytes = dimensions * sizeof(float);
+		if ( offset + bytes > data.size() )
+		{
+			Log::Error( "FaceEmbeddingStore", "Face store %s is truncated.", a_File.c_str() );
+			return false;
+		}
+		face.m_Features.resize( dimensions );
+		memcpy( &face.m_Features[0], data.data() + offset, bytes );
+		offset += bytes;
+	}
+
+	if ( offset != data.size() )
+	{
+		Log::Error( "FaceEmbeddingStore", "Face store %s has %u unexpected bytes at the end.", 
+			a_File.c_str(), (unsigned int)(data.size() - offset) );
+		return false;
+	}
+
+	m_Faces.swap( faces );
+	m_Dimensions = m_Faces.size() > 0 ? dimensions : 0;
+	m_bDirty = true;
+	return true;
+}
+
+bool FaceEmbeddingStore::Save( const std::string & a_File ) const
+{
+	std::string data( STORE_MAGIC, STORE_MAGIC_SIZE );
+
+	boost::uint32_t header[3] = { STORE_VERSION, (boost::uint32_t)m_Dimensions, (boost::uint32_t)m_Faces.size() };
+	data.append( (const char *)header, sizeof(header) );
+	for(size_t i=0;i<m_Faces.size();++i)
+	{
+		const Face & face = m_Faces[i];
+		const std::string * pStrings[] = { &face.m_PersonId, &face.m_Name, &face.m_Gender };
+		for(size_t k=0;k<sizeof(pStrings)/sizeof(pStrings[0]);++k)
+		{
+			boost::uint16_t length = (boost::uint16_t)std::min<size_t>( pStrings[k]->size(), 0xffff );
+			data.append( (const char *)&length, sizeof(length) );
+			data.append( pStrings[k]->data(), length );
+		}
+		data.append( (const char *)&face.m_Features[0], face.m_Features.size() * sizeof(float) );
+	}
+
+	std::ofstream output( a_File.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+	if (! output.is_open() )
+	{
+		Log::Error( "FaceEmbeddingStore", "Failed to open %s for writing.", a_File.c_str() );
+		return false;
+	}
+	output.write( data.data(), data.size() );
+	return output.good();
+}
+
+bool FaceEmbeddingStore::ParseF256( const TiXmlDocument & a_F256, std::vector<float> & a_Features )
+{
+	a_Features.clear();
+
+	// walk the document in order, reading the numbers out of each text node
+	std::vector<const TiXmlNode *> pending;
+	pending.push_back( &a_F256 );
+	while( pending.size() > 0 )
+	{
+		const TiXmlNode * pNode = pending.back();
+		pending.pop_back();
+
+		const TiXmlText * pText = pNode->ToText();
+		if ( pText != NULL )
+		{
+			const char * pValue = pText->Value();
+			while( *pValue != 0 )
+			{
+				char * pEnd = NULL;
+				double value = strtod( pValue, &pEnd );
+				if ( pEnd != pValue )
+				{
+					a_Features.push_back( (float)value );
+					pValue = pEnd;
+				}
+				else
+					pValue += 1;		// skip separators
+			}
+		}
+
+		// children are pushed last to first, so they are popped in document order
+		for( const TiXmlNode * pChild = pNode->LastChild(); pChild != NULL; pChild = pChild->PreviousSibling() )
+			pending.push_back( pChild );
+	}
+
+	return a_Features.size() > 0;
+}
+
+void FaceEmbeddingStore::BuildTree() const
+{
+	m_Nodes.clear();
+	m_Nodes.reserve( m_Faces.size() );
+
+	std::vector<int> faces( m_Faces.size() );
+	for(size_t i=0;i<faces.size();++i)
+		faces[i] = (int)i;
+
+	m_Root = BuildNode( faces, 0, faces.size() );
+	m_bDirty = false;
+}
+
+int FaceEmbeddingStore::BuildNode( std::vector<int> & a_Faces, size_t a_Begin, size_t a_End ) const
+{
+	if ( a_Begin >= a_End )
+		return -1;
+
+	// use the middle face as the vantage point, split the others at their median distance from it
+	std::swap( a_Faces[ a_Begin ], a_Faces[ a_Begin + ((a_End - a_Begin) / 2) ] );
+
+	int index = (int)m_Nodes.size();
+	m_Nodes.push_back( Node() );
+	m_Nodes[ index ].m_Face = a_Faces[ a_Begin ];
+
+	size_t first = a_Begin + 1;
+	if ( first < a_End )
+	{
+		const std::vector<float> & vantage = m_Faces[ a_Faces[ a_Begin ] ].m_Features;
+
+		std::vector< std::pair<float,int> > distances;
+		distances.reserve( a_End - first );
+		for(size_t i=first;i<a_End;++i)
+			distances.push_back( std::make_pair( Distance( vantage, m_Faces[ a_Faces[i] ].m_Features ), a_Faces[i] ) );
+
+		size_t median = distances.size() / 2;
+		std::nth_element( distances.begin(), distances.begin() + median, distances.end() );
+		for(size_t i=0;i<distances.size();++i)
+			a_Faces[ first + i ] = distances[i].second;
+
+		float radius = distances[ median ].first;
+		int inside = BuildNode( a_Faces, first, first + median );
+		int outside = BuildNode( a_Faces, first + median, a_End );
+
+		Node & node = m_Nodes[ index ];
+		node.m_fRadius = radius;
+		node.m_Inside = inside;
+		node.m_Outside = outside;
+	}
+
+	return index;
+}
+
+float FaceEmbeddingStore::Distance( const std::vector<float> & a_A, const std::vector<float> & a_B ) const
+{
+	float sum = 0.0f;
+	for(size_t i=0;i<a_A.size();++i)
+	{
+		float d = a_A[i] - a_B[i];
+		sum += d * d;
+	}
+	return sqrtf( sum );
+}
+
+bool FaceEmbeddingStore::Normalize( std::vector<float> & a_Features )
+{
+	float sum = 0.0f;
+	for(size_t i=0;i<a_Features.size();++i)
+		sum += a_Features[i] * a_Features[i];
+	if ( sum <= 0.0f )
+		return false;
+
+	float scale = 1.0f / sqrtf( sum );
+	for(size_t i=0;i<a_Features.size();++i)
+		a_Features[i] *= scale;
+	return true;
+}
@@ -0,0 +1,146 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#ifndef SELF_FACE_EMBEDDING_STORE_H
+#define SELF_FACE_EMBEDDING_STORE_H
+
+#include <vector>
+#include <string>
+
+#include "SelfLib.h"
+
+class TiXmlDocument;
+
+//! This class keeps the feature vectors of known faces so they can be recognized without a round trip to
+//! the face recognition service. Vectors are normalized when added, then searched with a vantage point tree
+//! over the euclidean distance, which for unit vectors orders the same as cosine similarity. The store is
+//! saved as a packed binary file and the tree is rebuilt when the faces change.
+class SELF_API FaceEmbeddingStore
+{
+public:
+	//! Types
+	struct Face
+	{
+		std::string			m_PersonId;
+		std::string			m_Name;
+		std::string			m_Gender;
+		std::vector<float>	m_Features;		// unit length
+	};
+	typedef std::vector<Face>		FaceList;
+
+	struct Match
+	{
+		Match() : m_Index( 0 ), m_fDistance( 0.0f ), m_fConfidence( 0.0f )
+		{}
+
+		size_t				m_Index;		// index of the face in the store
+		float				m_fDistance;
+		float				m_fConfidence;	// cosine similarity, clamped to 0 - 1
+	};
+	typedef std::vector<Match>		MatchList;
+
+	//! Construction
+	FaceEmbeddingStore() : m_Dimensions( 0 ), m_MaxVisits( 0 ), m_Root( -1 ), m_bDirty( false )
+	{}
+
+	//! Accessors
+	size_t				GetCount() const;
+	const Face &		GetFace( size_t a_Index ) const;
+	size_t				GetDimensions() const;
+	int					GetMaxVisits() const;
+	bool				Contains( const std::string & a_PersonId ) const;
+
+	//! Mutators
+	//! Limit how many faces a search may compare against, 0 for an exact search.
+	void				SetMaxVisits( int a_MaxVisits );
+
+	//! Add or replace the features for a person, returns false if the features don't match the
+	//! size of the vectors already in the store.
+	bool				Add( const std::string & a_PersonId, const std::string & a_Name,
+							const std::string & a_Gender, const std::vector<float> & a_Features );
+	//! Remove all features for a person.
+	bool				Remove( const std::string & a_PersonId );
+	void				Clear();
+
+	//! Find the a_Count nearest faces to the given features, nearest first.
+	bool				Search( const std::vector<float> & a_Features, size_t a_Count, MatchList & a_Matches ) const;
+
+	bool				Load( const std::string & a_File );
+	bool				Save( const std::string & a_File ) const;
+
+	//! Read the feature values out of a F256 document, this collects every number in the text
+	//! of the document in order.
+	static bool			ParseF256( const TiXmlDocument & a_F256, std::vector<float> & a_Features );
+
+private:
+	//! Types
+	struct Node
+	{
+		Node() : m_Face( 0 ), m_fRadius( 0.0f ), m_Inside( -1 ), m_Outside( -1 )
+		{}
+
+		int					m_Face;
+		float				m_fRadius;		// faces within this distance of m_Face are inside
+		int					m_Inside;
+		int					m_Outside;
+	};
+	typedef std::vector<Node>		NodeList;
+
+	//! Data
+	size_t				m_Dimensions;
+	int					m_MaxVisits;
+	FaceList			m_Faces;
+
+	mutable NodeList	m_Nodes;
+	mutable int			m_Root;
+	mutable bool		m_bDirty;
+
+	void				BuildTree() const;
+	int					BuildNode( std::vector<int> & a_Faces, size_t a_Begin, size_t a_End ) const;
+	float				Distance( const std::vector<float> & a_A, const std::vector<float> & a_B ) const;
+	static bool			Normalize( std::vector<float> & a_Features );
+};
+
+//----------------------------------
+
+inline size_t FaceEmbeddingStore::GetCount() const
+{
+	return m_Faces.size();
+}
+
+inline const FaceEmbeddingStore::Face & FaceEmbeddingStore::GetFace( size_t a_Index ) const
+{
+	return m_Faces[ a_Index ];
+}
+
+inline size_t FaceEmbeddingStore::GetDimensions() const
+{
+	return m_Dimensions;
+}
+
+inline int FaceEmbeddingStore::GetMaxVisits() const
+{
+	return m_MaxVisits;
+}
+
+inline void FaceEmbeddingStore::SetMaxVisits( int a_MaxVisits )
+{
+	m_MaxVisits = a_MaxVisits;
+}
+
+#endif // SELF_FACE_EMBEDDING_STORE_H
@@ -0,0 +1,211 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include <math.h>
+#include <algorithm>
+
+#include "FaceTracker.h"
+#include "utils/JpegHelpers.h"
+#include "utils/Log.h"
+
+const int MIN_TEMPLATE_SIZE = 4;			// faces smaller than this in reduced pixels aren't tracked
+
+void FaceTracker::Frame::FromImage( const unsigned char * a_pPixels, int a_Width, int a_Height, int a_Depth, int a_Scale )
+{
+	m_Scale = std::max( a_Scale, 1 );
+	m_Width = a_Width / m_Scale;
+	m_Height = a_Height / m_Scale;
+	m_Gray.resize( (size_t)m_Width * m_Height );
+
+	// average each block of the source, using integer luma weights
+	const int blockSize = m_Scale * m_Scale;
+	for(int y=0;y<m_Height;++y)
+	{
+		for(int x=0;x<m_Width;++x)
+		{
+			int sum = 0;
+			for(int by=0;by<m_Scale;++by)
+			{
+				const unsigned char * pPixel = a_pPixels + ((((size_t)(y * m_Scale + by) * a_Width) + (x * m_Scale)) * a_Depth);
+				for(int bx=0;bx<m_Scale;++bx, pPixel += a_Depth)
+				{
+					if ( a_Depth >= 3 )
+						sum += ((pPixel[0] * 77) + (pPixel[1] * 150) + (pPixel[2] * 29)) >> 8;
+					else
+						sum += pPixel[0];
+				}
+			}
+			m_Gray[ (y * m_Width) + x ] = (unsigned char)(sum / blockSize);
+		}
+	}
+}
+
+bool FaceTracker::Frame::FromJpeg( const std::string & a_Jpeg, int a_Scale )
+{
+	int width = 0, height = 0, depth = 0;
+	std::string pixels;
+	if (! JpegHelpers::DecodeImage( a_Jpeg.data(), a_Jpeg.size(), width, height, depth, pixels ) )
+		return false;
+
+	FromImage( (const unsigned char *)pixels.data(), width, height, depth, a_Scale );
+	return true;
+}
+
+size_t FaceTracker::SetFaces( const Frame & a_Frame, const FaceList & a_Faces )
+{
+	m_Faces.clear();
+	for(size_t i=0;i<a_Faces.size();++i)
+	{
+		Face face( a_Faces[i] );
+
+		// clip the face to the frame, in reduced pixels
+		int x0 = std::max( face.m_Left / a_Frame.m_Scale, 0 );
+		int y0 = std::max( face.m_Top / a_Frame.m_Scale, 0 );
+		int x1 = std::min( (face.m_Left + face.m_Width) / a_Frame.m_Scale, a_Frame.m_Width );
+		int y1 = std::min( (face.m_Top + face.m_Height) / a_Frame.m_Scale, a_Frame.m_Height );
+		if ( (x1 - x0) < MIN_TEMPLATE_SIZE || (y1 - y0) < MIN_TEMPLATE_SIZE )
+			continue;
+
+		face.m_TemplateWidth = x1 - x0;
+		face.m_TemplateHeight = y1 - y0;
+		face.m_Template.resize( (size_t)face.m_TemplateWidth * face.m_TemplateHeight );
+
+		float mean = 0.0f;
+		for(int y=y0;y<y1;++y)
+			for(int x=x0;x<x1;++x)
+				mean += a_Frame.m_Gray[ (y * a_Frame.m_Width) + x ];
+		mean /= face.m_Template.size();
+
+		float norm = 0.0f;
+		float * pTemplate = &face.m_Template[0];
+		for(int y=y0;y<y1;++y)
+		{
+			for(int x=x0;x<x1;++x)
+			{
+				float v = a_Frame.m_Gray[ (y * a_Frame.m_Width) + x ] - mean;
+				*pTemplate++ = v;
+				norm += v * v;
+			}
+		}
+		if ( norm <= 0.0f )
+			continue;		// a flat area can't be matched
+
+		face.m_fTemplateNorm = sqrtf( norm );
+		face.m_Left = x0 * a_Frame.m_Scale;
+		face.m_Top = y0 * a_Frame.m_Scale;
+		face.m_fScore = 1.0f;
+		m_Faces.push_back( face );
+	}
+
+	return m_Faces.size();
+}
+
+bool FaceTracker::Track( const Frame & a_Frame )
+{
+	bool bTracked = m_Faces.size() > 0;
+	for(size_t i=0;i<m_Faces.size();)
+	{
+		Face & face = m_Faces[i];
+
+		int cx = face.m_Left / a_Frame.m_Scale;
+		int cy = face.m_Top / a_Frame.m_Scale;
+		int maxX = a_Frame.m_Width - face.m_TemplateWidth;
+		int maxY = a_Frame.m_Height - face.m_TemplateHeight;
+
+		// search around the last position for the best match
+		float best = -1.0f;
+		int bestX = cx, bestY = cy;
+		for(int y=std::max(cy - m_SearchRadius, 0);y<=std::min(cy + m_SearchRadius, maxY);++y)
+		{
+			for(int x=std::max(cx - m_SearchRadius, 0);x<=std::min(cx + m_SearchRadius, maxX);++x)
+			{
+				float score = Correlate( a_Frame, face, x, y );
+				if ( score > best )
+				{
+					best = score;
+					bestX = x;
+					bestY = y;
+				}
+			}
+		}
+
+		if ( best < m_fMinScore )
+		{
+			m_Faces.erase( m_Faces.begin() + i );
+			bTracked = false;
+			continue;
+		}
+
+		// keep the detected size, only the position moves
+		face.m_Left += (bestX - cx) * a_Frame.m_Scale;
+		face.m_Top += (bestY - cy) * a_Frame.m_Scale;
+		face.m_fScore = best;
+		++i;
+	}
+
+	return bTracked;
+}
+
+void FaceTracker::Clear()
+{
+	m_Faces.clear();
+}
+
+void FaceTracker::GetLocation( int a_Left, int a_Top, int a_Width, int a_Height, 
+	int a_ImageWidth, int a_ImageHeight, std::vector<float> & a_Location )
+{
+	a_Location.clear();
+	if ( a_ImageWidth <= 0 || a_ImageHeight <= 0 )
+		return;
+
+	float x = (a_Left + (a_Width * 0.5f)) / a_ImageWidth;
+	float y = (a_Top + (a_Height * 0.5f)) / a_ImageHeight;
+	a_Location.push_back( (x * 2.0f) - 1.0f );
+	a_Location.push_back( (y * 2.0f) - 1.0f );
+}
+
+float FaceTracker::Correlate( const Frame & a_Frame, const Face & a_Face, int a_X, int a_Y )
+{
+	const int count = a_Face.m_TemplateWidth * a_Face.m_TemplateHeight;
+
+	float mean = 0.0f;
+	for(int y=0;y<a_Face.m_TemplateHeight;++y)
+	{
+		const unsigned char * pRow = &a_Frame.m_Gray[ ((a_Y + y) * a_Frame.m_Width) + a_X ];
+		for(int x=0;x<a_Face.m_TemplateWidth;++x)
+			mean += pRow[x];
+	}
+	mean /= count;
+
+	float cross = 0.0f, norm = 0.0f;
+	const float * pTemplate = &a_Face.m_Template[0];
+	for(int y=0;y<a_Face.m_TemplateHeight;++y)
+	{
+		const unsigned char * pRow = &a_Frame.m_Gray[ ((a_Y + y) * a_Frame.m_Width) + a_X ];
+		for(int x=0;x<a_Face.m_TemplateWidth;++x)
+		{
+			float v = pRow[x] - mean;
+			cross += v * (*pTemplate++);
+			norm += v * v;
+		}
+	}
+
+	if ( norm <= 0.0f )
+		return 0.0f;
+	return cross / (sqrtf( norm ) * a_Face.m_fTemplateNorm);
+}
@@ -0,0 +1,146 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#ifndef SELF_FACE_TRACKER_H
+#define SELF_FACE_TRACKER_H
+
+#include <vector>
+#include <string>
+
+#include "jsoncpp/json/json.h"
+#include "SelfLib.h"
+
+//! This class follows faces found by a full face detection across the following frames. Each frame is
+//! reduced to a small grayscale image, then each face is found again by normalized cross correlation
+//! of the face at detection time against the area around its last position. Track() returns false once
+//! any face is lost, so the caller can run a full detection again.
+class SELF_API FaceTracker
+{
+public:
+	//! Types
+	struct Frame
+	{
+		Frame() : m_Width( 0 ), m_Height( 0 ), m_Scale( 1 )
+		{}
+
+		int							m_Width;		// size of the reduced frame
+		int							m_Height;
+		int							m_Scale;		// source pixels per reduced pixel
+		std::vector<unsigned char>	m_Gray;
+
+		//! Reduce an RGB, RGBA or grayscale image by a_Scale into this frame.
+		void FromImage( const unsigned char * a_pPixels, int a_Width, int a_Height, int a_Depth, int a_Scale );
+		//! Decode a jpeg and reduce it into this frame.
+		bool FromJpeg( const std::string & a_Jpeg, int a_Scale );
+	};
+
+	struct Face
+	{
+		Face() : m_Left( 0 ), m_Top( 0 ), m_Width( 0 ), m_Height( 0 ), m_fScore( 0.0f ),
+			m_TemplateWidth( 0 ), m_TemplateHeight( 0 ), m_fTemplateNorm( 0.0f )
+		{}
+		Face( int a_Left, int a_Top, int a_Width, int a_Height, const Json::Value & a_Data = Json::Value() ) :
+			m_Left( a_Left ), m_Top( a_Top ), m_Width( a_Width ), m_Height( a_Height ), m_fScore( 1.0f ), m_Data( a_Data ),
+			m_TemplateWidth( 0 ), m_TemplateHeight( 0 ), m_fTemplateNorm( 0.0f )
+		{}
+
+		int					m_Left;			// location in source pixels
+		int					m_Top;
+		int					m_Width;
+		int					m_Height;
+		float				m_fScore;		// correlation of the last match, 1.0 when detected
+		Json::Value			m_Data;			// anything from the detection to keep with the face
+
+		//! Data used for tracking, in reduced pixels
+		int					m_TemplateWidth;
+		int					m_TemplateHeight;
+		std::vector<float>	m_Template;		// zero mean face pixels
+		float				m_fTemplateNorm;
+	};
+	typedef std::vector<Face>		FaceList;
+
+	//! Construction
+	FaceTracker( int a_SearchRadius = 6, float a_fMinScore = 0.6f ) :
+		m_SearchRadius( a_SearchRadius ),
+		m_fMinScore( a_fMinScore )
+	{}
+
+	//! Accessors
+	const FaceList &	GetFaces() const;
+	bool				HasFaces() const;
+	int					GetSearchRadius() const;
+	float				GetMinScore() const;
+
+	//! Mutators
+	void				SetSearchRadius( int a_Radius );
+	void				SetMinScore( float a_fScore );
+
+	//! Start tracking the given faces, which were detected in a_Frame. Faces too small
+	//! or too flat to track are ignored, returns the number of faces being tracked.
+	size_t				SetFaces( const Frame & a_Frame, const FaceList & a_Faces );
+	//! Find our faces in the next frame, returns false if any face was lost.
+	bool				Track( const Frame & a_Frame );
+	//! Stop tracking all faces.
+	void				Clear();
+
+	//! Location of the center of a face in an image, normalized from -1 to 1 with the center of the image at 0.
+	static void			GetLocation( int a_Left, int a_Top, int a_Width, int a_Height, 
+							int a_ImageWidth, int a_ImageHeight, std::vector<float> & a_Location );
+
+private:
+	//! Data
+	int					m_SearchRadius;		// in reduced pixels
+	float				m_fMinScore;
+	FaceList			m_Faces;
+
+	static float		Correlate( const Frame & a_Frame, const Face & a_Face, int a_X, int a_Y );
+};
+
+//----------------------------------
+
+inline const FaceTracker::FaceList & FaceTracker::GetFaces() const
+{
+	return m_Faces;
+}
+
+inline bool FaceTracker::HasFaces() const
+{
+	return m_Faces.size() > 0;
+}
+
+inline int FaceTracker::GetSearchRadius() const
+{
+	return m_SearchRadius;
+}
+
+inline float FaceTracker::GetMinScore() const
+{
+	return m_fMinScore;
+}
+
+inline void FaceTracker::SetSearchRadius( int a_Radius )
+{
+	m_SearchRadius = a_Radius;
+}
+
+inline void FaceTracker::SetMinScore( float a_fScore )
+{
+	m_fMinScore = a_fScore;
+}
+
+#endif // SELF_FACE_TRACKER_H
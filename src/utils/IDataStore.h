@@ -37,6 +37,16 @@ public:
 	typedef std::list<std::string>			QueryResults;
 	typedef std::vector<IConditional::SP>	Conditions;
 
+	//! A set of records to save and delete together
+	struct Batch
+	{
+		typedef std::list< std::pair<std::string, Json::Value> >	SaveList;
+		typedef std::list<std::string>								DeleteList;
+
+		SaveList		m_Save;
+		DeleteList		m_Delete;
+	};
+
 	virtual ~IDataStore()
 	{}
 
@@ -76,6 +86,11 @@ public:
 	virtual bool Delete(const std::string & a_ID,
 		Delegate<bool> a_Callback = Delegate<bool>()) = 0;
 
+	//! Save and delete a batch of records in a single transaction, the callback is invoked once the whole
+	//! batch has been written or has failed.
+	virtual bool Commit(const Batch & a_Batch,
+		Delegate<bool> a_Callback = Delegate<bool>()) = 0;
+
 	//! Query for data based on conditions, this will invoke your callback with the ID's of all 
 	//! records that match your conditions.
 	virtual bool Find(const Conditions & a_Conditions,
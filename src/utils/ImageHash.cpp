@@ -0,0 +1,84 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include "ImageHash.h"
+#include "utils/JpegHelpers.h"
+
+const int HASH_WIDTH = 9;
+const int HASH_HEIGHT = 8;
+
+boost::uint64_t ImageHash::Hash( const unsigned char * a_pPixels, int a_Width, int a_Height, int a_Depth )
+{
+	if ( a_pPixels == NULL || a_Width < HASH_WIDTH || a_Height < HASH_HEIGHT || a_Depth <= 0 )
+		return 0;
+
+	// average the luma of each cell of the thumbnail in a single pass over the image
+	unsigned int sums[ HASH_HEIGHT ][ HASH_WIDTH ] = { { 0 } };
+	unsigned int counts[ HASH_HEIGHT ][ HASH_WIDTH ] = { { 0 } };
+	for(int y=0;y<a_Height;++y)
+	{
+		int cy = (y * HASH_HEIGHT) / a_Height;
+		const unsigned char * pPixel = a_pPixels + ((size_t)y * a_Width * a_Depth);
+		for(int x=0;x<a_Width;++x, pPixel += a_Depth)
+		{
+			int cx = (x * HASH_WIDTH) / a_Width;
+			if ( a_Depth >= 3 )
+				sums[cy][cx] += ((pPixel[0] * 77) + (pPixel[1] * 150) + (pPixel[2] * 29)) >> 8;
+			else
+				sums[cy][cx] += pPixel[0];
+			counts[cy][cx] += 1;
+		}
+	}
+
+	boost::uint64_t hash = 0;
+	for(int y=0;y<HASH_HEIGHT;++y)
+	{
+		for(int x=0;x<HASH_WIDTH - 1;++x)
+		{
+			// compare the averages without dividing, sums[a] / counts[a] > sums[b] / counts[b]
+			boost::uint64_t left = (boost::uint64_t)sums[y][x] * counts[y][x + 1];
+			boost::uint64_t right = (boost::uint64_t)sums[y][x + 1] * counts[y][x];
+			hash = (hash << 1) | (left > right ? 1 : 0);
+		}
+	}
+
+	return hash;
+}
+
+bool ImageHash::HashJpeg( const std::string & a_Jpeg, boost::uint64_t & a_Hash )
+{
+	int width = 0, height = 0, depth = 0;
+	std::string pixels;
+	if (! JpegHelpers::DecodeImage( a_Jpeg.data(), a_Jpeg.size(), width, height, depth, pixels ) )
+		return false;
+	if ( width < HASH_WIDTH || height < HASH_HEIGHT )
+		return false;
+
+	a_Hash = Hash( (const unsigned char *)pixels.data(), width, height, depth );
+	return true;
+}
+
+int ImageHash::Distance( boost::uint64_t a_A, boost::uint64_t a_B )
+{
+	boost::uint64_t bits = a_A ^ a_B;
+
+	int count = 0;
+	for(;bits != 0;++count)
+		bits &= bits - 1;			// clear the lowest bit
+	return count;
+}
@@ -0,0 +1,42 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#ifndef SELF_IMAGE_HASH_H
+#define SELF_IMAGE_HASH_H
+
+#include <string>
+
+#include "boost/cstdint.hpp"
+#include "SelfLib.h"
+
+//! Perceptual hash of an image, so near identical frames can be found without comparing pixels. This is
+//! a difference hash, the image is reduced to a 9x8 grayscale thumbnail and each bit records if a pixel
+//! is brighter than the pixel to its right. Small changes in noise or exposure flip few bits, the number
+//! of different bits between two hashes measures how much the scene has changed.
+class SELF_API ImageHash
+{
+public:
+	//! Hash an RGB, RGBA or grayscale image.
+	static boost::uint64_t	Hash( const unsigned char * a_pPixels, int a_Width, int a_Height, int a_Depth );
+	//! Decode a jpeg and hash it, returns false if the image could not be decoded.
+	static bool				HashJpeg( const std::string & a_Jpeg, boost::uint64_t & a_Hash );
+	//! Number of bits different between two hashes, 0 - 64.
+	static int				Distance( boost::uint64_t a_A, boost::uint64_t a_B );
+};
+
+#endif // SELF_IMAGE_HASH_H
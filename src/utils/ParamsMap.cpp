@@ -16,6 +16,9 @@
 */
 
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "ParamsMap.h"
 #include "utils/StringUtil.h"
 
@@ -33,58 +36,162 @@ void ParamsMap::Deserialize(const Json::Value & json)
 	m_Data["Type_"] = "ParamsMap";		// make sure we add the Type_ entry..
 }
 
+ParamsMap::TemplateMap	ParamsMap::sm_Templates;
+boost::mutex			ParamsMap::sm_TemplateLock;
+
+//! Maximum number of parsed templates we keep around
+#define MAX_CACHED_TEMPLATES		1024
+
 std::string ParamsMap::ResolveVariables(const std::string & a_Input)
 {
-	std::string result = a_Input;
+	if ( a_Input.find("${") == std::string::npos )
+		return a_Input;
+
+	Template::SP spTemplate = GetTemplate( a_Input );
+
+	std::string result;
+	result.reserve( spTemplate->m_LiteralSize + 32 );
+	for( size_t i=0;i<spTemplate->m_Segments.size();++i)
+	{
+		const Segment & segment = spTemplate->m_Segments[i];
+		if ( segment.m_Path.size() == 0 )
+		{
+			result += segment.m_Text;
+			continue;
+		}
+
+		const Json::Value * pValue = ResolvePath( m_Data, segment.m_Path );
+		if ( pValue == NULL )
+			continue;
+
+		if (! pValue->isObject() && !pValue->isArray() )
+			result += pValue->asString();
+		else
+			result += Json::FastWriter().write( *pValue );
+	}
+
+	return result;
+}
+
+Json::Value ParamsMap::ResolveVariables(const Json::Value & a_Json)
+{
+	Json::Value result( a_Json );
+	ResolveInPlace( result );
+	return result;
+}
 
-	size_t start = result.find("${");
+ParamsMap::Template::SP ParamsMap::GetTemplate( const std::string & a_Input )
+{
+	{
+		boost::unique_lock<boost::mutex> lock( sm_TemplateLock );
+		TemplateMap::iterator iTemplate = sm_Templates.find( a_Input );
+		if ( iTemplate != sm_Templates.end() )
+			return iTemplate->second;
+	}
+
+	Template::SP spTemplate( new Template() );
+	spTemplate->m_LiteralSize = 0;
+
+	size_t offset = 0;
+	size_t start = a_Input.find("${");
 	while (start != std::string::npos)
 	{
-		size_t end = result.find("}", start);
+		size_t end = a_Input.find("}", start);
 		if (end == std::string::npos)
 			break;
 
-		size_t len = (end - start) + 1;
-		std::string var = result.substr(start + 2, len - 3);
-		if (ValidPath(var))
+		if ( start > offset )
 		{
-			const Json::Value & value = operator[](var);
+			spTemplate->m_Segments.push_back( Segment() );
+			spTemplate->m_Segments.back().m_Text = a_Input.substr( offset, start - offset );
+			spTemplate->m_LiteralSize += start - offset;
+		}
 
-			std::string data;
-			if (! value.isObject() && !value.isArray() )
-				data = value.asString();
-			else
-				data = value.toStyledString();
+		std::vector<std::string> path;
+		StringUtil::Split( a_Input.substr( start + 2, end - (start + 2) ), std::string( 1, PARAMS_PATH_SEPERATOR ), path );
+		spTemplate->m_Segments.push_back( Segment() );
+		spTemplate->m_Segments.back().m_Path = path;
+
+		offset = end + 1;
+		start = a_Input.find("${", offset );
+	}
+
+	if ( offset < a_Input.size() )
+	{
+		spTemplate->m_Segments.push_back( Segment() );
+		spTemplate->m_Segments.back().m_Text = a_Input.substr( offset );
+		spTemplate->m_LiteralSize += a_Input.size() - offset;
+	}
+
+	boost::unique_lock<boost::mutex> lock( sm_TemplateLock );
+	if ( sm_Templates.size() >= MAX_CACHED_TEMPLATES )
+		sm_Templates.clear();
+	sm_Templates[ a_Input ] = spTemplate;
 
-			result.replace( start, len, data );
-			end = start + data.size();
+	return spTemplate;
+}
+
+const Json::Value * ParamsMap::ResolvePath( const Json::Value & a_Data, const std::vector<std::string> & a_Path )
+{
+	const Json::Value * pValue = &a_Data;
+	for( size_t i=0;i<a_Path.size();++i)
+	{
+		const std::string & key = a_Path[i];
+		if ( key.size() == 0 )
+			continue;
+
+		if ( pValue->isObject() )
+		{
+			if (! pValue->isMember( key ) )
+				return NULL;
+			pValue = &(*pValue)[ key ];
+		}
+		else if ( pValue->isArray() )
+		{
+			if ( key.find_first_not_of( "0123456789" ) != std::string::npos )
+				return NULL;
+			Json::ArrayIndex index = (Json::ArrayIndex)strtoul( key.c_str(), NULL, 10 );
+			if ( index >= pValue->size() )
+				return NULL;
+			pValue = &(*pValue)[ index ];
 		}
 		else
-			result.replace( start, len, "" );
-
-		start = result.find("${", end );
+			return NULL;
 	}
 
-	return result;
+	return pValue;
 }
 
-Json::Value ParamsMap::ResolveVariables(const Json::Value & a_Json)
+void ParamsMap::ResolveInPlace( Json::Value & a_Json )
 {
 	if (a_Json.isArray())
 	{
-		Json::Value array;
-		for (size_t i = 0; i < a_Json.size(); ++i)
-			array[i] = ResolveVariables(a_Json[i]);
-		return array;
+		for (Json::ArrayIndex i = 0; i < a_Json.size(); ++i)
+			ResolveInPlace(a_Json[i]);
 	}
 	else if (a_Json.isObject())
 	{
-		Json::Value object;
-		for (Json::ValueConstIterator iElement = a_Json.begin(); iElement != a_Json.end(); ++iElement)
-			object[ResolveVariables(iElement.key().asString())] = ResolveVariables(*iElement);
-		return object;
-	}
+		std::vector<std::string> keys( a_Json.getMemberNames() );
+		for (size_t i = 0; i < keys.size(); ++i)
+		{
+			const std::string & key = keys[i];
+			if ( key.find("${") != std::string::npos )
+			{
+				// rename this member, this is rare so we don't mind the copy
+				Json::Value value( a_Json[key] );
+				a_Json.removeMember( key );
 
-	return Json::Value(ResolveVariables(a_Json.asString()));
+				ResolveInPlace( value );
+				a_Json[ ResolveVariables( key ) ] = value;
+			}
+			else
+				ResolveInPlace( a_Json[key] );
+		}
+	}
+	else if (a_Json.isString())
+	{
+		const char * pString = a_Json.asCString();
+		if ( strstr( pString, "${" ) != NULL )
+			a_Json = ResolveVariables( std::string( pString ) );
+	}
 }
-
@@ -21,6 +21,10 @@
 
 #include <map>
 #include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include "jsoncpp/json/json.h"
 #include "utils/ISerializable.h"
@@ -85,18 +89,45 @@ public:
 	}
 
 	//! Resolve any variables in the provides string from this params map. 
-	//! Variable names start with { and end with }. 
+	//! Variable names start with { and end with }. The parsed template is cached, so
+	//! resolving the same string again doesn't need to parse it again.
 	std::string ResolveVariables(const std::string & a_Input);
-	//! Resolve variables found in the provided Json, return the translated json.
+	//! Resolve variables found in the provided Json, return the translated json. Any values
+	//! that contain no variables are returned unchanged.
 	Json::Value ResolveVariables(const Json::Value & a_Json);
 
 	//! ISerializable interface
 	virtual void Serialize(Json::Value & json);
 	virtual void Deserialize(const Json::Value & json);
 
+	//! Resolve a path that has already been split into it's parts, returns NULL if the path is not valid.
+	static const Json::Value *
+						ResolvePath( const Json::Value & a_Data, const std::vector<std::string> & a_Path );
+
 private:
+	//! Types
+	struct Segment
+	{
+		std::string					m_Text;			// literal text, empty for a variable
+		std::vector<std::string>	m_Path;			// split path of the variable
+	};
+	struct Template
+	{
+		typedef boost::shared_ptr<Template>		SP;
+
+		std::vector<Segment>		m_Segments;
+		size_t						m_LiteralSize;
+	};
+	typedef std::map< std::string, Template::SP >	TemplateMap;
+
 	//! Data
 	Json::Value		m_Data;
+
+	static TemplateMap	sm_Templates;
+	static boost::mutex	sm_TemplateLock;
+
+	static Template::SP	GetTemplate( const std::string & a_Input );
+	void				ResolveInPlace( Json::Value & a_Json );
 };
 
 #endif
@@ -0,0 +1,75 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+#include "SimilarFrameCache.h"
+#include "ImageHash.h"
+
+size_t SimilarFrameCache::GetCount( const std::string & a_Origin ) const
+{
+	FrameMap::const_iterator iFrames = m_Frames.find( a_Origin );
+	if ( iFrames == m_Frames.end() )
+		return 0;
+	return iFrames->second.size();
+}
+
+const Json::Value * SimilarFrameCache::Find( const std::string & a_Origin, boost::uint64_t a_Hash, 
+	const std::string & a_ClassifierId, double a_Now )
+{
+	FrameMap::iterator iFrames = m_Frames.find( a_Origin );
+	if ( iFrames == m_Frames.end() )
+		return NULL;
+
+	FrameList & frames = iFrames->second;
+	for( FrameList::iterator iFrame = frames.begin(); iFrame != frames.end(); )
+	{
+		// results from another classifier or from too long ago aren't used again
+		if ( iFrame->m_ClassifierId != a_ClassifierId || (a_Now - iFrame->m_Time) > m_MaxAge )
+		{
+			frames.erase( iFrame++ );
+			continue;
+		}
+		if ( ImageHash::Distance( iFrame->m_Hash, a_Hash ) <= m_MaxDistance )
+			return &iFrame->m_Result;
+		++iFrame;
+	}
+
+	return NULL;
+}
+
+void SimilarFrameCache::Add( const std::string & a_Origin, boost::uint64_t a_Hash, 
+	const std::string & a_ClassifierId, double a_Now, const Json::Value & a_Result )
+{
+	if ( m_MaxFrames <= 0 )
+		return;
+
+	FrameList & frames = m_Frames[ a_Origin ];
+	frames.push_front( Frame() );
+
+	Frame & frame = frames.front();
+	frame.m_Hash = a_Hash;
+	frame.m_ClassifierId = a_ClassifierId;
+	frame.m_Time = a_Now;
+	frame.m_Result = a_Result;
+
+	while( frames.size() > (size_t)m_MaxFrames )
+		frames.pop_back();
+}
+
+void SimilarFrameCache::Clear()
+{
+	m_Frames.clear();
+}
@@ -0,0 +1,95 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+#ifndef SELF_SIMILAR_FRAME_CACHE_H
+#define SELF_SIMILAR_FRAME_CACHE_H
+
+#include <list>
+#include <map>
+#include <string>
+
+#include "boost/cstdint.hpp"
+#include "jsoncpp/json/json.h"
+#include "SelfLib.h"
+
+//! This class keeps the results of the most recent classifications for each origin by the ImageHash of
+//! the frame, so a frame of the same scene can reuse a result instead of being classified again. Results
+//! expire after a time and are dropped once the classifier that made them changes.
+class SELF_API SimilarFrameCache
+{
+public:
+	//! Construction
+	SimilarFrameCache( int a_MaxFrames = 4, int a_MaxDistance = 4, double a_MaxAge = 60.0 ) :
+		m_MaxFrames( a_MaxFrames ),
+		m_MaxDistance( a_MaxDistance ),
+		m_MaxAge( a_MaxAge )
+	{}
+
+	//! Accessors
+	size_t				GetCount( const std::string & a_Origin ) const;
+
+	//! Mutators
+	void				SetMaxFrames( int a_MaxFrames );
+	void				SetMaxDistance( int a_MaxDistance );
+	void				SetMaxAge( double a_MaxAge );
+
+	//! Find the result of a recent frame within the max distance of a_Hash made by a_ClassifierId, expired
+	//! results are removed along the way. The returned result is valid until the cache is changed.
+	const Json::Value *	Find( const std::string & a_Origin, boost::uint64_t a_Hash, 
+							const std::string & a_ClassifierId, double a_Now );
+	//! Keep a new result for the origin, the oldest result is dropped once there are too many.
+	void				Add( const std::string & a_Origin, boost::uint64_t a_Hash, 
+							const std::string & a_ClassifierId, double a_Now, const Json::Value & a_Result );
+	void				Clear();
+
+private:
+	//! Types
+	struct Frame
+	{
+		boost::uint64_t		m_Hash;
+		std::string			m_ClassifierId;
+		double				m_Time;
+		Json::Value			m_Result;
+	};
+	typedef std::list< Frame >					FrameList;
+	typedef std::map< std::string, FrameList >	FrameMap;
+
+	//! Data
+	int					m_MaxFrames;		// recent results kept for each origin
+	int					m_MaxDistance;		// most bits different for frames to be the same scene
+	double				m_MaxAge;			// seconds a result may be reused
+	FrameMap			m_Frames;			// by origin, most recent first
+};
+
+//----------------------------------
+
+inline void SimilarFrameCache::SetMaxFrames( int a_MaxFrames )
+{
+	m_MaxFrames = a_MaxFrames;
+}
+
+inline void SimilarFrameCache::SetMaxDistance( int a_MaxDistance )
+{
+	m_MaxDistance = a_MaxDistance;
+}
+
+inline void SimilarFrameCache::SetMaxAge( double a_MaxAge )
+{
+	m_MaxAge = a_MaxAge;
+}
+
+#endif // SELF_SIMILAR_FRAME_CACHE_H
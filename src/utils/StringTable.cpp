@@ -0,0 +1,66 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include "StringTable.h"
+
+StringTable::StringTable()
+{
+	m_Strings.push_back( std::string() );
+	m_Ids[ std::string() ] = 0;
+}
+
+StringTable::Id StringTable::Intern( const std::string & a_String )
+{
+	boost::unique_lock<boost::mutex> lock( m_Lock );
+
+	IdMap::const_iterator iString = m_Ids.find( a_String );
+	if ( iString != m_Ids.end() )
+		return iString->second;
+
+	Id id = (Id)m_Strings.size();
+	m_Strings.push_back( a_String );
+	m_Ids[ a_String ] = id;
+	return id;
+}
+
+bool StringTable::Find( const std::string & a_String, Id & a_Id )
+{
+	boost::unique_lock<boost::mutex> lock( m_Lock );
+
+	IdMap::const_iterator iString = m_Ids.find( a_String );
+	if ( iString == m_Ids.end() )
+		return false;
+
+	a_Id = iString->second;
+	return true;
+}
+
+const std::string & StringTable::GetText( Id a_Id )
+{
+	boost::unique_lock<boost::mutex> lock( m_Lock );
+
+	if ( a_Id >= m_Strings.size() )
+		return m_Strings[0];
+	return m_Strings[ a_Id ];
+}
+
+size_t StringTable::GetSize()
+{
+	boost::unique_lock<boost::mutex> lock( m_Lock );
+	return m_Strings.size();
+}
@@ -0,0 +1,60 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#ifndef SELF_STRING_TABLE_H
+#define SELF_STRING_TABLE_H
+
+#include <string>
+#include <deque>
+
+#include "boost/unordered_map.hpp"
+#include "boost/thread/mutex.hpp"
+
+#include "SelfLib.h"
+
+//! A table of interned strings, each distinct string is stored once and is referred to by a small integer id.
+//! Ids are handed out in order and never released, the empty string is always id 0. This is thread safe.
+class SELF_API StringTable
+{
+public:
+	//! Types
+	typedef unsigned int		Id;
+
+	//! Construction
+	StringTable();
+
+	//! Get the id for a string, adding the string if it's new.
+	Id							Intern( const std::string & a_String );
+	//! Find the id of a string without adding it, returns false if the string is not in this table.
+	bool						Find( const std::string & a_String, Id & a_Id );
+	//! Get the string for an id, an unknown id returns the empty string.
+	const std::string &			GetText( Id a_Id );
+	//! Get the number of strings in this table.
+	size_t						GetSize();
+
+private:
+	//! Types
+	typedef boost::unordered_map<std::string, Id>	IdMap;
+
+	//! Data
+	boost::mutex				m_Lock;
+	std::deque<std::string>		m_Strings;		// a deque, so references to a string stay valid as strings are added
+	IdMap						m_Ids;
+};
+
+#endif // SELF_STRING_TABLE_H
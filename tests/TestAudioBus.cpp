@@ -0,0 +1,259 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+#include "utils/UnitTest.h"
+#include "utils/ThreadPool.h"
+#include "sensors/AudioBus.h"
+#include "sensors/ISensor.h"
+
+//! A sensor we can push audio frames through directly
+class TestAudioSensor : public ISensor
+{
+public:
+	TestAudioSensor() : ISensor( "TestAudioSensor" ), m_nStarted( 0 ), m_nStopped( 0 )
+	{}
+
+	virtual const char * GetDataType()
+	{
+		return "AudioData";
+	}
+	virtual bool OnStart()
+	{
+		m_nStarted += 1;
+		return true;
+	}
+	virtual bool OnStop()
+	{
+		m_nStopped += 1;
+		return true;
+	}
+	virtual void OnPause()
+	{}
+	virtual void OnResume()
+	{}
+
+	void Send( const std::vector<short> & a_Samples, unsigned int a_Rate, unsigned int a_Channels )
+	{
+		std::string wave( (const char *)&a_Samples[0], a_Samples.size() * sizeof(short) );
+		SendData( new AudioData( wave, a_Rate, a_Channels, 16 ) );
+	}
+
+	int		m_nStarted;
+	int		m_nStopped;
+};
+
+//! A consumer of a bus, that may release the bus from inside it's frame callback
+struct TestAudioConsumer
+{
+	TestAudioConsumer() : m_nFrames( 0 ), m_nSensorFrames( 0 ), m_bRelease( false )
+	{}
+
+	AudioBus::SP	m_spBus;
+	int				m_nFrames;
+	int				m_nSensorFrames;
+	bool			m_bRelease;
+
+	void OnFrame( AudioBus * a_pBus )
+	{
+		m_nFrames += 1;
+		if ( m_bRelease )
+			m_spBus.reset();
+	}
+	void OnSensorData( IData * a_pData )
+	{
+		m_nSensorFrames += 1;
+	}
+};
+
+class TestAudioBus : public UnitTest
+{
+public:
+	TestAudioBus() : UnitTest( "TestAudioBus" )
+	{}
+
+	virtual void RunTest()
+	{
+		ThreadPool pool( 1 );
+
+		TestConversion();
+		TestRing();
+		TestResample();
+		TestRelease( pool );
+	}
+
+	void TestConversion()
+	{
+		boost::shared_ptr<TestAudioSensor> spSensor( new TestAudioSensor() );
+		AudioBus::SP spBus = AudioBus::Attach( spSensor.get() );
+		Test( spBus.get() != NULL );
+		Test( AudioBus::Attach( spSensor.get() ) == spBus );
+		Test( spSensor->m_nStarted == 1 );
+
+		AudioBus::Cursor pcm = spBus->OpenCursor( AudioBus::BT_PCM16 );
+		AudioBus::Cursor floats = spBus->OpenCursor( AudioBus::BT_FLOAT );
+
+		std::vector<short> samples;
+		for(int i=0;i<320;++i)
+			samples.push_back( (short)((i * 97) % 65536 - 32768) );
+		spSensor->Send( samples, 16000, 2 );
+
+		Test( spBus->GetRate() == 16000 );
+		Test( spBus->GetChannels() == 2 );
+		Test( spBus->GetWritten( AudioBus::BT_PCM16 ) == samples.size() );
+		Test( spBus->Available( pcm ) == samples.size() );
+
+		std::vector<short> read( samples.size() );
+		Test( spBus->Read( pcm, &read[0], read.size() ) == samples.size() );
+		Test( read == samples );
+		Test( spBus->Available( pcm ) == 0 );
+
+		// a cursor of one type can't read another type..
+		std::vector<float> values( samples.size() );
+		Test( spBus->Read( floats, &read[0], read.size() ) == 0 );
+		Test( spBus->Read( floats, &values[0], values.size() ) == samples.size() );
+		for(size_t i=0;i<samples.size();++i)
+			Test( values[i] == samples[i] / 32768.0f );
+		Test( floats.m_Dropped == 0 );
+
+		// a larger frame followed by a smaller one must not leave old converted samples behind..
+		floats = spBus->OpenCursor( AudioBus::BT_FLOAT );
+		std::vector<short> small( 4, 16384 );
+		spSensor->Send( small, 16000, 2 );
+		Test( spBus->Read( floats, &values[0], values.size() ) == small.size() );
+		for(size_t i=0;i<small.size();++i)
+			Test( values[i] == 0.5f );
+
+		spBus.reset();
+		Test( spSensor->m_nStopped == 1 );
+	}
+
+	void TestRing()
+	{
+		// 0.01 seconds of 8khz mono is 80 samples
+		boost::shared_ptr<TestAudioSensor> spSensor( new TestAudioSensor() );
+		AudioBus::SP spBus = AudioBus::Attach( spSensor.get(), 0.01f );
+
+		std::vector<short> frame( 50 );
+		spSensor->Send( MakeRamp( frame, 0 ), 8000, 1 );
+
+		// a cursor opened now doesn't see what has already been written..
+		AudioBus::Cursor late = spBus->OpenCursor( AudioBus::BT_PCM16 );
+		Test( spBus->Available( late ) == 0 );
+
+		AudioBus::Cursor cursor;
+		cursor.m_Type = AudioBus::BT_PCM16;
+		Test( spBus->Available( cursor ) == 50 );
+
+		// wrap around the end of the ring, the oldest samples are dropped..
+		spSensor->Send( MakeRamp( frame, 50 ), 8000, 1 );
+		Test( spBus->GetWritten( AudioBus::BT_PCM16 ) == 100 );
+		Test( spBus->Available( late ) == 50 );
+		Test( spBus->Available( cursor ) == 80 );
+		Test( cursor.m_Dropped == 20 );
+
+		std::vector<short> read( 100 );
+		Test( spBus->Read( cursor, &read[0], 30 ) == 30 );
+		Test( spBus->Read( cursor, &read[30], 100 ) == 50 );
+		for(size_t i=0;i<80;++i)
+			Test( read[i] == (short)(20 + i) );
+
+		// a frame larger than the ring only keeps the newest samples..
+		std::vector<short> large( 200 );
+		spSensor->Send( MakeRamp( large, 100 ), 8000, 1 );
+		Test( spBus->GetWritten( AudioBus::BT_PCM16 ) == 300 );
+		Test( spBus->Read( late, &read[0], read.size() ) == 80 );
+		Test( late.m_Dropped == 170 );
+		for(size_t i=0;i<80;++i)
+			Test( read[i] == (short)(220 + i) );
+
+		// a format change re-allocates, cursors don't read anything from before the change..
+		AudioBus::Cursor before = spBus->OpenCursor( AudioBus::BT_PCM16 );
+		spSensor->Send( MakeRamp( frame, 0 ), 16000, 1 );
+		Test( spBus->GetRate() == 16000 );
+		Test( spBus->Available( cursor ) == 50 );
+		Test( spBus->Read( before, &read[0], read.size() ) == 50 );
+		Test( read[0] == 0 );
+	}
+
+	void TestResample()
+	{
+		boost::shared_ptr<TestAudioSensor> spSensor( new TestAudioSensor() );
+		AudioBus::SP spBus = AudioBus::Attach( spSensor.get() );
+		spBus->SetResampleRate( 8000 );
+
+		AudioBus::Cursor cursor = spBus->OpenCursor( AudioBus::BT_RESAMPLED );
+
+		// stereo 16khz down to mono 8khz, the channels are mixed and every other frame is kept
+		std::vector<short> frame;
+		for(int i=0;i<160;++i)
+		{
+			frame.push_back( 8192 );
+			frame.push_back( 24576 );
+		}
+		for(int i=0;i<10;++i)
+			spSensor->Send( frame, 16000, 2 );
+
+		Test( spBus->GetWritten( AudioBus::BT_RESAMPLED ) == 800 );
+
+		std::vector<float> read( 1000 );
+		Test( spBus->Read( cursor, &read[0], read.size() ) == 800 );
+		for(size_t i=0;i<800;++i)
+			Test( read[i] == 0.5f );
+	}
+
+	void TestRelease( ThreadPool & a_Pool )
+	{
+		boost::shared_ptr<TestAudioSensor> spSensor( new TestAudioSensor() );
+
+		TestAudioConsumer consumer;
+		consumer.m_spBus = AudioBus::Attach( spSensor.get() );
+		consumer.m_spBus->Subscribe( DELEGATE( TestAudioConsumer, OnFrame, AudioBus *, &consumer ) );
+		spSensor->Subscribe( DELEGATE( TestAudioConsumer, OnSensorData, IData *, &consumer ) );
+
+		std::vector<short> frame( 32 );
+		spSensor->Send( frame, 16000, 1 );
+		Test( consumer.m_nFrames == 1 );
+		Test( consumer.m_nSensorFrames == 1 );
+
+		// releasing the last reference to the bus from it's callback leaves the sensor sending
+		// to the rest of it's subscribers..
+		consumer.m_bRelease = true;
+		spSensor->Send( frame, 16000, 1 );
+		Test( !consumer.m_spBus );
+		Test( consumer.m_nFrames == 2 );
+		Test( consumer.m_nSensorFrames == 2 );
+
+		// the released bus doesn't receive anything more, it's un-subscribed on the main thread
+		spSensor->Send( frame, 16000, 1 );
+		Test( consumer.m_nFrames == 2 );
+		Test( consumer.m_nSensorFrames == 3 );
+
+		a_Pool.ProcessMainThread();
+		Test( spSensor->m_nStopped == 0 );
+		spSensor->Unsubscribe( &consumer );
+		Test( spSensor->m_nStopped == 1 );
+	}
+
+	static std::vector<short> & MakeRamp( std::vector<short> & a_Samples, int a_Start )
+	{
+		for(size_t i=0;i<a_Samples.size();++i)
+			a_Samples[i] = (short)(a_Start + i);
+		return a_Samples;
+	}
+};
+
+TestAudioBus TEST_AUDIO_BUS;
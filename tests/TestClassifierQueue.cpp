@@ -0,0 +1,175 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include "utils/UnitTest.h"
+#include "classifiers/IClassifier.h"
+
+//! Classifier that just records the work it's given, work is finished by the test
+class QueueTestClassifier : public IClassifier
+{
+public:
+	virtual const char * GetName() const
+	{
+		return "QueueTestClassifier";
+	}
+	virtual bool OnStart()
+	{
+		return true;
+	}
+	virtual bool OnStop()
+	{
+		return true;
+	}
+
+	virtual bool OnWork( const std::string & a_Origin, const IThing::SP & a_spThing )
+	{
+		m_Started.push_back( (*a_spThing)["n"].asInt() );
+		return true;
+	}
+
+	std::vector<int>	m_Started;
+};
+
+class TestClassifierQueue : public UnitTest
+{
+public:
+	TestClassifierQueue() : UnitTest( "TestClassifierQueue" )
+	{}
+
+	static IThing::SP MakeThing( int n )
+	{
+		Json::Value data;
+		data["n"] = n;
+		return IThing::SP( new IThing( TT_PERCEPTION, "Work", data ) );
+	}
+
+	virtual void RunTest()
+	{
+		// drop oldest, the newest item waits while the first is active
+		{
+			QueueTestClassifier classifier;
+			Json::Value config;
+			config["m_MaxQueueDepth"] = 2;
+			config["m_DropPolicy"] = "oldest";
+			classifier.Deserialize( config );
+
+			for(int i=0;i<5;++i)
+				classifier.QueueWork( "camera", MakeThing( i ) );
+			Test( classifier.m_Started.size() == 1 && classifier.m_Started[0] == 0 );
+
+			classifier.WorkDone( "camera", classifier.GetWorkGeneration() );
+			classifier.WorkDone( "camera", classifier.GetWorkGeneration() );
+			classifier.WorkDone( "camera", classifier.GetWorkGeneration() );
+			Test( classifier.m_Started.size() == 3 );
+			Test( classifier.m_Started[1] == 3 && classifier.m_Started[2] == 4 );
+
+			IClassifier::WorkMetrics metrics = classifier.GetWorkMetrics()["camera"];
+			Test( metrics.m_Dropped == 2 );
+			Test( metrics.m_Completed == 3 );
+			Test( metrics.m_PeakDepth == 2 );
+			Test( metrics.m_Depth == 0 && metrics.m_Active == 0 );
+		}
+
+		// drop newest, the first queued items are kept
+		{
+			QueueTestClassifier classifier;
+			Json::Value config;
+			config["m_MaxQueueDepth"] = 2;
+			config["m_DropPolicy"] = "newest";
+			classifier.Deserialize( config );
+
+			for(int i=0;i<5;++i)
+				classifier.QueueWork( "camera", MakeThing( i ) );
+			classifier.WorkDone( "camera", classifier.GetWorkGeneration() );
+			classifier.WorkDone( "camera", classifier.GetWorkGeneration() );
+			Test( classifier.m_Started.size() == 3 );
+			Test( classifier.m_Started[1] == 1 && classifier.m_Started[2] == 2 );
+		}
+
+		// sampled, 1 in 3 of the items arriving at a full queue replace the oldest
+		{
+			QueueTestClassifier classifier;
+			Json::Value config;
+			config["m_MaxQueueDepth"] = 1;
+			config["m_DropPolicy"] = "sampled";
+			config["m_SampleRate"] = 3;
+			classifier.Deserialize( config );
+
+			for(int i=0;i<8;++i)
+				classifier.QueueWork( "camera", MakeThing( i ) );
+			classifier.WorkDone( "camera", classifier.GetWorkGeneration() );
+			Test( classifier.m_Started.size() == 2 );
+			Test( classifier.m_Started[1] == 7 );
+			Test( classifier.GetWorkMetrics()["camera"].m_Dropped == 6 );
+		}
+
+		// the concurrency limit is shared by all origins, each origin gets a turn
+		{
+			QueueTestClassifier classifier;
+			Json::Value config;
+			config["m_MaxQueueDepth"] = 4;
+			config["m_MaxActive"] = 2;
+			config["m_MaxActivePerOrigin"] = 2;
+			classifier.Deserialize( config );
+
+			for(int i=0;i<3;++i)
+			{
+				classifier.QueueWork( "a", MakeThing( i ) );
+				classifier.QueueWork( "b", MakeThing( 10 + i ) );
+			}
+			Test( classifier.m_Started.size() == 2 );
+			Test( classifier.m_Started[0] == 0 && classifier.m_Started[1] == 10 );
+
+			unsigned int generation = classifier.GetWorkGeneration();
+			classifier.WorkDone( "a", generation );
+			Test( classifier.m_Started.size() == 3 );
+			Test( classifier.m_Started[2] == 1 );
+
+			Json::Value metrics;
+			classifier.GetWorkMetrics( metrics );
+			Test( metrics["active"].asInt() == 2 );
+			Test( metrics["origins"]["a"]["completed"].asInt() == 1 );
+
+			// the next free slot goes to "b" even though "a" still has work waiting
+			classifier.WorkDone( "a", generation );
+			Test( classifier.m_Started.size() == 4 );
+			Test( classifier.m_Started[3] == 11 );
+			Test( classifier.GetWorkMetrics()["a"].m_Depth == 1 );
+
+			// then back to "a"..
+			classifier.WorkDone( "b", generation );
+			Test( classifier.m_Started.size() == 5 );
+			Test( classifier.m_Started[4] == 2 );
+
+			// work finishing after the queues are cleared is ignored, even once newer work has started
+			classifier.ClearWork();
+			Test( classifier.GetWorkGeneration() != generation );
+			classifier.WorkDone( "b", generation );
+			Test( classifier.GetWorkMetrics().size() == 0 );
+
+			classifier.QueueWork( "b", MakeThing( 20 ) );
+			Test( classifier.m_Started.size() == 6 );
+			classifier.WorkDone( "b", generation );
+			Test( classifier.GetWorkMetrics()["b"].m_Active == 1 );
+			classifier.WorkDone( "b", classifier.GetWorkGeneration() );
+			Test( classifier.GetWorkMetrics()["b"].m_Active == 0 );
+		}
+	}
+};
+
+TestClassifierQueue TEST_CLASSIFIER_QUEUE;
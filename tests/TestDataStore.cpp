@@ -29,6 +29,8 @@ public:
 	bool m_bFindTested;
 	bool m_bDeleteTested;
 	bool m_bLogicCondTested;
+	bool m_bCommitTested;
+	bool m_bBatchLoadTested;
 
 	//! Construction
 	TestDataStore() : UnitTest("TestDataStore"),
@@ -36,7 +38,9 @@ public:
 		m_bLoadTested(false),
 		m_bFindTested(false),
 		m_bDeleteTested(false),
-		m_bLogicCondTested(false)
+		m_bLogicCondTested(false),
+		m_bCommitTested(false),
+		m_bBatchLoadTested(false)
 	{}
 
 	virtual void RunTest()
@@ -88,7 +92,25 @@ public:
 		Spin(m_bDeleteTested);
 		Test(m_bDeleteTested);
 
-		Test(pStore->Delete("B"));
+		// save and delete together in one batch
+		Json::Value data3;
+		data3["ID"] = 3;
+		data3["payload"] = "Kale";
+		data3["category"] = "veg";
+
+		IDataStore::Batch batch;
+		batch.m_Save.push_back(IDataStore::Batch::SaveList::value_type("C", data3));
+		batch.m_Delete.push_back("B");
+		Test(pStore->Commit(batch, DELEGATE(TestDataStore, OnCommit, bool, this)));
+		Spin(m_bCommitTested);
+		Test(m_bCommitTested);
+
+		Test(pStore->Load("%", DELEGATE(TestDataStore, OnBatchLoad, Json::Value *, this)));
+		Spin(m_bBatchLoadTested);
+		Test(m_bBatchLoadTested);
+		Test(m_BatchLoaded.size() == 1 && m_BatchLoaded[0] == "Kale");
+
+		Test(pStore->Delete("C"));
 
 		delete pStore;
 	}
@@ -126,6 +148,22 @@ public:
 		m_bDeleteTested = true;
 		Test(a_bSuccess);
 	}
+
+	void OnCommit(bool a_bSuccess)
+	{
+		m_bCommitTested = true;
+		Test(a_bSuccess);
+	}
+
+	std::vector<std::string> m_BatchLoaded;
+	void OnBatchLoad(Json::Value * a_Data)
+	{
+		if ((*a_Data)["_done"].asBool())
+			m_bBatchLoadTested = true;
+		else
+			m_BatchLoaded.push_back((*a_Data)["payload"].asString());
+		delete a_Data;
+	}
 };
 
 TestDataStore TEST_DATA_STORE;
\ No newline at end of file
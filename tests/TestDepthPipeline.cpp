@@ -0,0 +1,120 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include "utils/UnitTest.h"
+#include "extractors/DepthExtractor.h"
+#include "sensors/DepthVideoData.h"
+#include "blackboard/DepthImage.h"
+
+class TestDepthPipeline : public UnitTest
+{
+public:
+	TestDepthPipeline() : UnitTest( "TestDepthPipeline" )
+	{}
+
+	typedef DepthVideoData::Sample		Sample;
+
+	virtual void RunTest()
+	{
+		// synthetic 64x48 frame, depth increases with x and y, with a hole of no depth and one near point
+		const int WIDTH = 64, HEIGHT = 48;
+		std::vector<Sample> frame( WIDTH * HEIGHT );
+		for(int y=0;y<HEIGHT;++y)
+			for(int x=0;x<WIDTH;++x)
+				frame[ y * WIDTH + x ] = (Sample)(1000 + (y * 100) + x);
+		for(int y=0;y<4;++y)
+			for(int x=0;x<4;++x)
+				frame[ y * WIDTH + x ] = 0;
+		frame[ 10 * WIDTH + 21 ] = 250;
+
+		// the packed frame should survive the trip through the binary format
+		DepthVideoData video( WIDTH, HEIGHT, &frame[0] );
+		Test( video.IsRaw() );
+		Test( video.GetWidth() == WIDTH && video.GetHeight() == HEIGHT );
+
+		std::string binary;
+		Test( video.ToBinary( binary ) );
+		Test( binary.size() == DepthVideoData::RAW_HEADER_SIZE + (frame.size() * sizeof(Sample)) );
+
+		DepthVideoData restored;
+		Test( restored.FromBinary( DepthVideoData::RAW_DEPTH_TYPE, binary ) );
+		Test( restored.GetWidth() == WIDTH && restored.GetHeight() == HEIGHT );
+		Test( memcmp( restored.GetSamples(), &frame[0], frame.size() * sizeof(Sample) ) == 0 );
+		Test(! restored.FromBinary( DepthVideoData::RAW_DEPTH_TYPE, binary.substr( 0, binary.size() - 1 ) ) );
+
+		// by default frames are passed through as they are, a png isn't even decoded
+		DepthExtractor extractor;
+		DepthVideoData png( std::string( "not really a png" ) );
+		DepthImage::SP spImage = extractor.CreateDepthImage( &png );
+		Test( spImage.get() != NULL );
+		Test( spImage->GetContent() == png.GetBinaryData() );
+		Test( spImage->GetContentType() != DepthVideoData::RAW_DEPTH_TYPE );
+
+		spImage = extractor.CreateDepthImage( &video );
+		Test( spImage.get() != NULL );
+		Test( spImage->GetContent() == video.GetBinaryData() );
+		Test( spImage->GetContentType() == DepthVideoData::RAW_DEPTH_TYPE );
+		Test( spImage->GetWidth() == WIDTH && spImage->GetHeight() == HEIGHT );
+
+		// decimate the whole frame, each sample is the nearest depth in its block and holes are skipped
+		Json::Value config;
+		config["m_Decimation"] = 4;
+		extractor.Deserialize( config );
+
+		spImage = extractor.CreateDepthImage( &video );
+		Test( spImage.get() != NULL );
+		Test( spImage->GetContentType() == DepthVideoData::RAW_DEPTH_TYPE );
+		Test( spImage->GetWidth() == 16 && spImage->GetHeight() == 12 );
+
+		const std::string & content = spImage->GetContent();
+		Test( DepthVideoData::IsRawValid( content ) );
+		const Sample * pSamples = DepthVideoData::GetRawSamples( content );
+		Test( pSamples[0] == 0 );							// the hole has no depth at all
+		Test( pSamples[1] == 1004 );
+		Test( pSamples[ 2 * 16 + 5 ] == 250 );				// the near point isn't averaged away
+		Test( pSamples[ 11 * 16 + 15 ] == 1000 + (44 * 100) + 60 );
+
+		// crop a region that isn't a multiple of the decimation
+		config["m_RoiX"] = 20;
+		config["m_RoiY"] = 10;
+		config["m_RoiWidth"] = 10;
+		config["m_RoiHeight"] = 5;
+		extractor.Deserialize( config );
+
+		spImage = extractor.CreateDepthImage( &video );
+		Test( spImage.get() != NULL );
+		Test( spImage->GetWidth() == 3 && spImage->GetHeight() == 2 );
+		pSamples = DepthVideoData::GetRawSamples( spImage->GetContent() );
+		Test( pSamples[0] == 250 );
+		Test( pSamples[2] == 1000 + (10 * 100) + 28 );
+		Test( pSamples[5] == 1000 + (14 * 100) + 28 );
+
+		// a region outside the frame is empty rather than out of bounds
+		int outWidth = -1, outHeight = -1;
+		std::vector<Sample> output;
+		DepthExtractor::Downsample( WIDTH, HEIGHT, &frame[0], WIDTH + 10, 0, 8, 8, 2, outWidth, outHeight, output );
+		Test( outWidth == 0 && output.size() == 0 );
+
+		// no decimation or region gives back the same frame
+		DepthExtractor::Downsample( WIDTH, HEIGHT, &frame[0], 0, 0, 0, 0, 1, outWidth, outHeight, output );
+		Test( outWidth == WIDTH && outHeight == HEIGHT );
+		Test( output == frame );
+	}
+};
+
+TestDepthPipeline TEST_DEPTH_PIPELINE;
@@ -0,0 +1,137 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include "utils/UnitTest.h"
+#include "utils/ExampleCache.h"
+#include "utils/ZipFile.h"
+
+#include <ctime>
+#include <fstream>
+#include <iterator>
+
+#include "boost/filesystem.hpp"
+
+class TestExampleCache : public UnitTest
+{
+public:
+	TestExampleCache() : UnitTest( "TestExampleCache" )
+	{}
+
+	virtual void RunTest()
+	{
+		const std::string CACHE_PATH( "./TestExampleCache/" );
+		boost::filesystem::remove_all( CACHE_PATH );
+
+		ExampleCache::ImageList images;
+		for(int i=0;i<10;++i)
+			images.push_back( std::string( 1000, (char)i ) );
+
+		ExampleCache cache;
+		Test( cache.Initialize( CACHE_PATH, 0 ) );
+		Test( cache.GetArchives( ExampleCache::POSITIVE ).size() == 0 );
+
+		// examples for a class are appended to the same archive
+		const ExampleCache::Archive * pArchive = cache.Add( "cup", ExampleCache::POSITIVE, images );
+		Test( pArchive != NULL );
+		Test( pArchive->m_Id == "cup_positive_examples" );
+		Test( pArchive->m_Count == 10 );
+		size_t firstSize = pArchive->m_Size;
+
+		pArchive = cache.Add( "cup", ExampleCache::POSITIVE, images );
+		Test( pArchive != NULL );
+		Test( pArchive->m_Count == 20 );
+		Test( pArchive->m_Size > firstSize && pArchive->m_Size < firstSize * 2 );
+		Test( cache.Add( "cup", ExampleCache::NEGATIVE, images ) != NULL );
+
+		// the archive is a zip with every example in it
+		ZipFile::ZipMap files;
+		Test( ReadZip( pArchive->m_Path, files ) );
+		Test( files.size() == 20 );
+		for(int i=0;i<20;++i)
+			Test( files[ StringUtil::Format( "%d.jpg", i ) ] == images[ i % 10 ] );
+		Test(! boost::filesystem::exists( pArchive->m_Path + ".tmp" ) );
+
+		// only the examples not sent yet are taken, new examples after that start again
+		Test( pArchive->m_UnsentCount == 20 );
+		std::string sent;
+		Test( cache.TakeUnsent( "cup_positive_examples", sent ) );
+		Test( pArchive->m_UnsentCount == 0 );
+		Test( ReadZip( sent, files ) && files.size() == 20 );
+		Test(! cache.TakeUnsent( "cup_positive_examples", sent ) );
+
+		ExampleCache::ImageList more( 1, std::string( 500, 'x' ) );
+		pArchive = cache.Add( "cup", ExampleCache::POSITIVE, more );
+		Test( pArchive != NULL && pArchive->m_Count == 21 && pArchive->m_UnsentCount == 1 );
+		std::string sentMore;
+		Test( cache.TakeUnsent( "cup_positive_examples", sentMore ) && sentMore != sent );
+		Test( ReadZip( sentMore, files ) && files.size() == 1 && files["0.jpg"] == more[0] );
+		Test( ReadZip( pArchive->m_Path, files ) && files.size() == 21 && files["20.jpg"] == more[0] );
+
+		cache.RemoveSent( sent );
+		cache.RemoveSent( sentMore );
+		Test(! boost::filesystem::exists( sent ) && !boost::filesystem::exists( sentMore ) );
+
+		Test( cache.Find( "cup_positive_examples" ) == cache.Find( "cup", ExampleCache::POSITIVE ) );
+		Test( cache.Find( "cup_negative_examples" )->m_ePolarity == ExampleCache::NEGATIVE );
+		Test( cache.Find( "cup" ) == NULL );
+		Test( cache.Find( "ball", ExampleCache::POSITIVE ) == NULL );
+
+		// the archives are indexed again from the directory
+		ExampleCache indexed;
+		Test( indexed.Initialize( CACHE_PATH, 0 ) );
+		Test( indexed.GetSize() == cache.GetSize() );
+		Test( indexed.Find( "cup", ExampleCache::POSITIVE ) != NULL );
+		Test( indexed.Find( "cup", ExampleCache::POSITIVE )->m_Count == 21 );
+		Test( indexed.Find( "cup", ExampleCache::POSITIVE )->m_UnsentCount == 0 );
+		Test( indexed.Find( "cup", ExampleCache::NEGATIVE )->m_Count == 10 );
+		Test( indexed.Find( "cup", ExampleCache::NEGATIVE )->m_UnsentCount == 10 );
+
+		// appending after indexing keeps the earlier examples
+		pArchive = indexed.Add( "cup", ExampleCache::NEGATIVE, images );
+		Test( pArchive != NULL && pArchive->m_Count == 20 );
+
+		// a full cache removes the archives updated least recently, but keeps the one just added to, the
+		// times are set so the order doesn't depend on the resolution of the file times
+		std::time_t now = std::time( NULL );
+		boost::filesystem::last_write_time( CACHE_PATH + "cup_positive_examples.zip", now - 100 );
+		boost::filesystem::last_write_time( CACHE_PATH + "cup_negative_examples.zip", now - 50 );
+
+		ExampleCache small;
+		Test( small.Initialize( CACHE_PATH, indexed.GetSize() ) );
+		pArchive = small.Add( "ball", ExampleCache::POSITIVE, images );
+		Test( pArchive != NULL );
+		Test( small.GetSize() <= small.GetMaxSize() );
+		Test( small.Find( "ball", ExampleCache::POSITIVE ) != NULL );
+		Test( small.Find( "cup", ExampleCache::POSITIVE ) == NULL );
+		Test( small.Find( "cup", ExampleCache::NEGATIVE ) != NULL );
+		Test(! boost::filesystem::exists( CACHE_PATH + "cup_positive_examples.zip" ) );
+
+		boost::filesystem::remove_all( CACHE_PATH );
+	}
+
+	bool ReadZip( const std::string & a_Path, ZipFile::ZipMap & a_Files )
+	{
+		std::ifstream input( a_Path.c_str(), std::ios::in | std::ios::binary );
+		std::string zip( (std::istreambuf_iterator<char>( input )), std::istreambuf_iterator<char>() );
+
+		a_Files.clear();
+		return zip.size() > 0 && ZipFile::Inflate( zip, a_Files );
+	}
+};
+
+TestExampleCache TEST_EXAMPLE_CACHE;
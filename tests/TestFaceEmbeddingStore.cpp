@@ -0,0 +1,154 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include <stdlib.h>
+#include <fstream>
+#include <iterator>
+
+#include "utils/UnitTest.h"
+#include "utils/FaceEmbeddingStore.h"
+#include "tinyxml/tinyxml.h"
+
+#include "boost/filesystem.hpp"
+#include "boost/cstdint.hpp"
+
+class TestFaceEmbeddingStore : public UnitTest
+{
+public:
+	TestFaceEmbeddingStore() : UnitTest( "TestFaceEmbeddingStore" )
+	{}
+
+	virtual void RunTest()
+	{
+		const int DIMENSIONS = 256;
+		const int FACES = 500;
+		const std::string STORE_FILE( "./TestFaceEmbeddingStore.dat" );
+
+		srand( 42 );
+
+		FaceEmbeddingStore store;
+		std::vector< std::vector<float> > known;
+		for(int i=0;i<FACES;++i)
+		{
+			std::vector<float> features;
+			Random( DIMENSIONS, 1.0f, features );
+			known.push_back( features );
+			Test( store.Add( StringUtil::Format( "person%d", i ), StringUtil::Format( "Person %d", i ), "male", features ) );
+		}
+		Test( store.GetCount() == FACES );
+		Test( store.GetDimensions() == DIMENSIONS );
+
+		// vectors of a different size are refused, adding a person again replaces them
+		std::vector<float> wrong( DIMENSIONS / 2, 1.0f );
+		Test(! store.Add( "wrong", "Wrong", "", wrong ) );
+		Test( store.Add( "person0", "Person 0", "male", known[0] ) );
+		Test( store.GetCount() == FACES );
+
+		// a noisy view of each known face should find that face first
+		FaceEmbeddingStore::MatchList matches;
+		for(int i=0;i<FACES;++i)
+		{
+			std::vector<float> query( known[i] );
+			std::vector<float> noise;
+			Random( DIMENSIONS, 0.1f, noise );
+			for(int k=0;k<DIMENSIONS;++k)
+				query[k] += noise[k];
+
+			Test( store.Search( query, 3, matches ) );
+			Test( matches.size() == 3 );
+			Test( store.GetFace( matches[0].m_Index ).m_PersonId == StringUtil::Format( "person%d", i ) );
+			Test( matches[0].m_fConfidence > 0.9f );
+			Test( matches[0].m_fDistance <= matches[1].m_fDistance && matches[1].m_fDistance <= matches[2].m_fDistance );
+		}
+
+		// someone we have never seen should not be recognized
+		std::vector<float> stranger;
+		Random( DIMENSIONS, 1.0f, stranger );
+		Test( store.Search( stranger, 1, matches ) );
+		Test( matches[0].m_fConfidence < 0.5f );
+
+		// save and load it back
+		Test( store.Remove( "person1" ) );
+		Test( store.Save( STORE_FILE ) );
+
+		FaceEmbeddingStore loaded;
+		Test( loaded.Load( STORE_FILE ) );
+		Test( loaded.GetCount() == FACES - 1 );
+		Test( loaded.GetDimensions() == DIMENSIONS );
+		Test( loaded.Search( known[2], 1, matches ) );
+		Test( loaded.GetFace( matches[0].m_Index ).m_PersonId == "person2" );
+		Test( loaded.GetFace( matches[0].m_Index ).m_Name == "Person 2" );
+		Test( loaded.Search( known[1], 1, matches ) );
+		Test( loaded.GetFace( matches[0].m_Index ).m_PersonId != "person1" );
+		Test( loaded.Contains( "person2" ) && !loaded.Contains( "person1" ) );
+
+		// a header claiming more faces than the file holds is refused without touching the store
+		std::string data;
+		Test( ReadFile( STORE_FILE, data ) );
+		std::string damaged( data );
+		boost::uint32_t count = 0x40000000;
+		damaged.replace( 16, sizeof(count), (const char *)&count, sizeof(count) );
+		Test( WriteFile( STORE_FILE, damaged ) );
+		Test(! loaded.Load( STORE_FILE ) );
+		Test( loaded.GetCount() == FACES - 1 );
+
+		// so is a file cut short or with extra bytes
+		Test( WriteFile( STORE_FILE, data.substr( 0, data.size() - 1 ) ) );
+		Test(! loaded.Load( STORE_FILE ) );
+		Test( WriteFile( STORE_FILE, data + "x" ) );
+		Test(! loaded.Load( STORE_FILE ) );
+		Test( WriteFile( STORE_FILE, data ) );
+		Test( loaded.Load( STORE_FILE ) );
+		boost::filesystem::remove( STORE_FILE );
+
+		// the features are read from the text of the F256 document
+		TiXmlDocument xml;
+		xml.Parse( "<F256><data>0.5, -1.25 3e-2</data><data>7</data></F256>" );
+		Test(! xml.Error() );
+
+		std::vector<float> features;
+		Test( FaceEmbeddingStore::ParseF256( xml, features ) );
+		Test( features.size() == 4 );
+		Test( features[0] == 0.5f && features[1] == -1.25f && features[2] == 0.03f && features[3] == 7.0f );
+	}
+
+	bool ReadFile( const std::string & a_File, std::string & a_Data )
+	{
+		std::ifstream input( a_File.c_str(), std::ios::in | std::ios::binary );
+		if (! input.is_open() )
+			return false;
+		a_Data.assign( (std::istreambuf_iterator<char>( input )), std::istreambuf_iterator<char>() );
+		return true;
+	}
+
+	bool WriteFile( const std::string & a_File, const std::string & a_Data )
+	{
+		std::ofstream output( a_File.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+		output.write( a_Data.data(), a_Data.size() );
+		return output.good();
+	}
+
+	void Random( int a_Dimensions, float a_fScale, std::vector<float> & a_Features )
+	{
+		a_Features.resize( a_Dimensions );
+		for(int i=0;i<a_Dimensions;++i)
+			a_Features[i] = (((float)rand() / RAND_MAX) - 0.5f) * a_fScale;
+	}
+};
+
+TestFaceEmbeddingStore TEST_FACE_EMBEDDING_STORE;
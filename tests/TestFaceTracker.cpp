@@ -0,0 +1,134 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include <fstream>
+#include <iterator>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <math.h>
+
+#include "utils/UnitTest.h"
+#include "utils/JpegHelpers.h"
+#include "utils/FaceTracker.h"
+
+class TestFaceTracker : public UnitTest
+{
+public:
+	TestFaceTracker() : UnitTest( "TestFaceTracker" )
+	{}
+
+	int m_Width;
+	int m_Height;
+	int m_Depth;
+
+	virtual void RunTest()
+	{
+		const int SCALE = 4;
+
+		// decode a recorded frame, the following frames are made by moving the camera over it
+		std::ifstream input( "./etc/tests/test.jpg", std::ios::in | std::ios::binary );
+		std::string jpeg( (std::istreambuf_iterator<char>( input )), std::istreambuf_iterator<char>() );
+		Test( jpeg.size() > 0 );
+
+		std::string pixels;
+		Test( JpegHelpers::DecodeImage( jpeg.data(), jpeg.size(), m_Width, m_Height, m_Depth, pixels ) );
+
+		FaceTracker::Frame frame;
+		Test( frame.FromJpeg( jpeg, SCALE ) );
+		Test( frame.m_Width == m_Width / SCALE && frame.m_Height == m_Height / SCALE );
+
+		// a face in the middle of the frame, with something from the detection to carry along
+		Json::Value data;
+		data["gender"]["gender"] = "female";
+
+		FaceTracker::FaceList faces;
+		int left = (m_Width * 3) / 8, top = (m_Height * 3) / 8;
+		faces.push_back( FaceTracker::Face( left, top, m_Width / 4, m_Height / 4, data ) );
+
+		FaceTracker tracker( 6, 0.6f );
+		Test( tracker.SetFaces( frame, faces ) == 1 );
+		Test( tracker.HasFaces() );
+		left = tracker.GetFaces()[0].m_Left;
+		top = tracker.GetFaces()[0].m_Top;
+
+		// the face is in the middle, so it's location is the center of the frame
+		std::vector<float> location;
+		FaceTracker::GetLocation( left, top, m_Width / 4, m_Height / 4, m_Width, m_Height, location );
+		Test( location.size() == 2 );
+		Test( fabs( location[0] ) < 0.01f && fabs( location[1] ) < 0.01f );
+
+		for(int i=1;i<=4;++i)
+		{
+			std::string moved;
+			Move( pixels, 6 * i, -3 * i, moved );
+
+			FaceTracker::Frame next;
+			next.FromImage( (const unsigned char *)moved.data(), m_Width, m_Height, m_Depth, SCALE );
+			Test( tracker.Track( next ) );
+
+			const FaceTracker::Face & face = tracker.GetFaces()[0];
+			Test( abs( face.m_Left - (left + (6 * i)) ) <= SCALE );
+			Test( abs( face.m_Top - (top - (3 * i)) ) <= SCALE );
+			Test( face.m_Width == m_Width / 4 && face.m_Height == m_Height / 4 );
+			Test( face.m_fScore >= 0.6f );
+			Test( face.m_Data["gender"]["gender"].asString() == "female" );
+
+			// the location reported for the tracked face moves with it, right and up, the tracker
+			// is only as precise as a reduced pixel so the smallest move up isn't checked
+			std::vector<float> moved_location;
+			FaceTracker::GetLocation( face.m_Left, face.m_Top, face.m_Width, face.m_Height, m_Width, m_Height, moved_location );
+			Test( moved_location.size() == 2 );
+			Test( moved_location[0] > location[0] );
+			Test( i == 1 || moved_location[1] < location[1] );
+		}
+
+		// a different view loses the face, so a full detection is needed
+		std::string flipped( pixels.size(), 0 );
+		size_t stride = (size_t)m_Width * m_Depth;
+		for(int y=0;y<m_Height;++y)
+			flipped.replace( y * stride, stride, pixels, (m_Height - 1 - y) * stride, stride );
+
+		FaceTracker::Frame other;
+		other.FromImage( (const unsigned char *)flipped.data(), m_Width, m_Height, m_Depth, SCALE );
+		Test(! tracker.Track( other ) );
+		Test(! tracker.HasFaces() );
+
+		// a face too small to track is reported, so the caller knows not to track
+		faces.push_back( FaceTracker::Face( 0, 0, SCALE, SCALE ) );
+		Test( tracker.SetFaces( frame, faces ) == 1 );
+		Test( tracker.GetFaces().size() == 1 );
+	}
+
+	//! Move the image by the given amount, repeating the edge pixels
+	void Move( const std::string & a_Pixels, int a_DX, int a_DY, std::string & a_Moved )
+	{
+		a_Moved.resize( a_Pixels.size() );
+		for(int y=0;y<m_Height;++y)
+		{
+			int sy = std::min( std::max( y - a_DY, 0 ), m_Height - 1 );
+			for(int x=0;x<m_Width;++x)
+			{
+				int sx = std::min( std::max( x - a_DX, 0 ), m_Width - 1 );
+				memcpy( &a_Moved[ ((y * m_Width) + x) * m_Depth ], &a_Pixels[ ((sy * m_Width) + sx) * m_Depth ], m_Depth );
+			}
+		}
+	}
+};
+
+TestFaceTracker TEST_FACE_TRACKER;
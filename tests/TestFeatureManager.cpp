@@ -0,0 +1,165 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+#include "AgentTest.h"
+#include "SelfInstance.h"
+#include "extractors/FeatureManager.h"
+
+//! An extractor that takes a while to start on a thread
+class TestThreadedExtractor : public IExtractor
+{
+public:
+	TestThreadedExtractor( int a_nStartTime, bool a_bFail = false, bool a_bThreaded = true ) : 
+		m_nStartTime( a_nStartTime ), m_bFail( a_bFail ), m_bStarted( false ), m_bStartedOnMain( false ), m_nStopped( 0 )
+	{
+		m_bStartOnThread = a_bThreaded;
+	}
+
+	virtual const char * GetName() const
+	{
+		return "TestThreadedExtractor";
+	}
+	virtual bool OnStart()
+	{
+		m_bStartedOnMain = boost::this_thread::get_id() == sm_MainThread;
+		boost::this_thread::sleep( boost::posix_time::milliseconds( m_nStartTime ) );
+		if ( m_bFail )
+			throw WatsonException( "Failed to start" );
+
+		m_bStarted = true;
+		return true;
+	}
+	virtual bool OnStop()
+	{
+		m_nStopped += 1;
+		return true;
+	}
+
+	int					m_nStartTime;
+	bool				m_bFail;
+	volatile bool		m_bStarted;
+	volatile bool		m_bStartedOnMain;
+	volatile int		m_nStopped;
+
+	static boost::thread::id	sm_MainThread;
+};
+
+boost::thread::id TestThreadedExtractor::sm_MainThread;
+
+class TestFeatureManager : public AgentTest
+{
+public:
+	//! Construction
+	TestFeatureManager() : AgentTest("TestFeatureManager")
+	{}
+
+	virtual void RunTest()
+	{
+		SelfInstance * pInstance = SelfInstance::GetInstance();
+		Test( pInstance != NULL );
+		FeatureManager * pManager = pInstance->GetFeatureManager();
+		Test( pManager != NULL );
+
+		TestThreadedExtractor::sm_MainThread = boost::this_thread::get_id();
+
+		const int START_TIME = 250;
+		std::vector< boost::shared_ptr<TestThreadedExtractor> > extractors;
+		for(int i=0;i<4;++i)
+			extractors.push_back( boost::shared_ptr<TestThreadedExtractor>( new TestThreadedExtractor( START_TIME ) ) );
+
+		// adding extractors doesn't wait for them to start..
+		double start = Time().GetEpochTime();
+		for(size_t i=0;i<extractors.size();++i)
+			Test( pManager->AddFeatureExtractor( extractors[i] ) );
+		Test( (Time().GetEpochTime() - start) < (START_TIME / 1000.0) );
+
+		// they are running once their completion has been handled on the main thread..
+		Test( WaitForState( extractors, IExtractor::AS_RUNNING ) );
+		Log::Status( "TestFeatureManager", "Started %u extractors in %.2f seconds", 
+			(unsigned int)extractors.size(), Time().GetEpochTime() - start );
+		for(size_t i=0;i<extractors.size();++i)
+		{
+			Test( extractors[i]->m_bStarted );
+			Test( !extractors[i]->m_bStartedOnMain );
+		}
+
+		// an extractor that can't start on a thread is queued for the main thread, not started inline..
+		boost::shared_ptr<TestThreadedExtractor> spQueued( new TestThreadedExtractor( 0, false, false ) );
+		Test( pManager->AddFeatureExtractor( spQueued ) );
+		Test( !spQueued->m_bStarted );
+		Test( spQueued->GetState() != IExtractor::AS_RUNNING );
+		std::vector< boost::shared_ptr<TestThreadedExtractor> > queued( 1, spQueued );
+		Test( WaitForState( queued, IExtractor::AS_RUNNING ) );
+		Test( spQueued->m_bStarted );
+		Test( spQueued->m_bStartedOnMain );
+		Test( pManager->RemoveFeatureExtractor( spQueued ) );
+		Test( spQueued->m_nStopped == 1 );
+
+		// a failure is isolated to the extractor that failed..
+		boost::shared_ptr<TestThreadedExtractor> spFailed( new TestThreadedExtractor( 10, true ) );
+		Test( pManager->AddFeatureExtractor( spFailed ) );
+		Wait( 500 );
+		Test( spFailed->GetState() != IExtractor::AS_RUNNING );
+		Test( pManager->RemoveFeatureExtractor( spFailed ) );
+		Test( spFailed->m_nStopped == 0 );
+
+		// an extractor removed while it's still starting is stopped once it's done..
+		boost::shared_ptr<TestThreadedExtractor> spRemoved( new TestThreadedExtractor( START_TIME ) );
+		Test( pManager->AddFeatureExtractor( spRemoved ) );
+		Test( pManager->RemoveFeatureExtractor( spRemoved ) );
+		Wait( START_TIME * 4 );
+		Test( spRemoved->m_bStarted );
+		Test( spRemoved->m_nStopped == 1 );
+		Test( spRemoved->GetState() != IExtractor::AS_RUNNING );
+
+		for(size_t i=0;i<extractors.size();++i)
+		{
+			Test( pManager->RemoveFeatureExtractor( extractors[i] ) );
+			Test( extractors[i]->m_nStopped == 1 );
+		}
+	}
+
+	bool WaitForState( const std::vector< boost::shared_ptr<TestThreadedExtractor> > & a_Extractors, 
+		IExtractor::State a_eState, double a_fTimeout = 10.0 )
+	{
+		double end = Time().GetEpochTime() + a_fTimeout;
+		while( Time().GetEpochTime() < end )
+		{
+			bool bDone = true;
+			for(size_t i=0;i<a_Extractors.size() && bDone;++i)
+				bDone = a_Extractors[i]->GetState() == a_eState;
+			if ( bDone )
+				return true;
+
+			ThreadPool::Instance()->ProcessMainThread();
+			boost::this_thread::sleep( boost::posix_time::milliseconds(1) );
+		}
+		return false;
+	}
+
+	void Wait( int a_nMilliseconds )
+	{
+		double end = Time().GetEpochTime() + (a_nMilliseconds / 1000.0);
+		while( Time().GetEpochTime() < end )
+		{
+			ThreadPool::Instance()->ProcessMainThread();
+			boost::this_thread::sleep( boost::posix_time::milliseconds(1) );
+		}
+	}
+};
+
+TestFeatureManager TEST_FEATURE_MANAGER;
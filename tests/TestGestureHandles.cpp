@@ -0,0 +1,69 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+#include "utils/UnitTest.h"
+#include "gestures/GestureManager.h"
+#include "gestures/IGesture.h"
+
+class TestGestureHandles : public UnitTest
+{
+public:
+	TestGestureHandles() : UnitTest( "TestGestureHandles" )
+	{}
+
+	virtual void RunTest()
+	{
+		GestureManager manager;
+		GestureManager::GestureList gestures;
+
+		// looking up an unknown ID doesn't give it a handle
+		Test(! manager.FindGestures( "unknown", gestures ) );
+		Test( manager.FindGestureHandle( "unknown" ) == GestureManager::INVALID_HANDLE );
+		Test( manager.GetGestures( GestureManager::INVALID_HANDLE ).size() == 0 );
+
+		// adding a gesture gives it's ID a handle, gestures with the same ID share it
+		IGesture::SP spFirst( new IGesture( "test_wave" ) );
+		IGesture::SP spSecond( new IGesture( "test_wave" ) );
+		Test( manager.AddGesture( spFirst ) );
+		GestureManager::GestureHandle handle = manager.FindGestureHandle( "test_wave" );
+		Test( handle != GestureManager::INVALID_HANDLE );
+		Test( manager.GetGestures( handle ).size() == 1 );
+
+		Test( manager.AddGesture( spSecond ) );
+		Test( manager.FindGestureHandle( "test_wave" ) == handle );
+		Test( manager.GetGestures( handle ).size() == 2 );
+		Test( manager.FindGestures( "test_wave", gestures ) && gestures.size() == 2 );
+
+		// an overridden gesture isn't returned until it's restored
+		spFirst->AddOverride();
+		Test( manager.GetGestures( handle ).size() == 1 );
+		Test( manager.GetGestures( handle )[0] == spSecond );
+		spFirst->RemoveOverride();
+		Test( manager.GetGestures( handle ).size() == 2 );
+
+		// the handle stays valid once all the gestures are removed
+		Test( manager.RemoveGesture( spFirst ) );
+		Test( manager.GetGestures( handle ).size() == 1 );
+		Test( manager.RemoveGesture( spSecond ) );
+		Test( manager.GetGestures( handle ).size() == 0 );
+		Test( manager.FindGestureHandle( "test_wave" ) == handle );
+		Test(! manager.FindGestures( "test_wave", gestures ) );
+		Test( manager.FindGestureHandle( "unknown" ) == GestureManager::INVALID_HANDLE );
+	}
+};
+
+TestGestureHandles TEST_GESTURE_HANDLES;
@@ -0,0 +1,179 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include "utils/UnitTest.h"
+#include "gestures/IGesture.h"
+
+#include "boost/thread.hpp"
+
+//! Gesture that exposes the request queue, requests are completed by the test.
+class TestRequestGesture : public IGesture
+{
+public:
+	TestRequestGesture() : IGesture( "TestRequestGesture" ), m_bPreempt( false )
+	{}
+
+	using IGesture::PushRequest;
+	using IGesture::PopRequest;
+	using IGesture::PopAllRequests;
+
+	void SetRequestTimeout( float a_fTimeout )
+	{
+		m_fRequestTimeout = a_fTimeout;
+	}
+	void SetMergeRequests( bool a_bMerge )
+	{
+		m_bMergeRequests = a_bMerge;
+	}
+	const void * GetActive() const
+	{
+		return ActiveRequest();
+	}
+	std::string GetActiveName() const
+	{
+		return ActiveRequest() != NULL ? ActiveRequest()->m_Params["name"].asString() : std::string();
+	}
+	size_t GetQueued() const
+	{
+		return m_Requests.size();
+	}
+
+	virtual bool OnPreempt()
+	{
+		return m_bPreempt;
+	}
+
+	bool		m_bPreempt;
+};
+
+class TestGestureRequests : public UnitTest
+{
+public:
+	TestGestureRequests() : UnitTest( "TestGestureRequests" ),
+		m_nDone( 0 ),
+		m_nErrors( 0 )
+	{}
+
+	static ParamsMap MakeRequest( const char * a_pName, const char * a_pPriority = NULL, float a_fTimeout = 0.0f )
+	{
+		ParamsMap params( "name", a_pName );
+		if ( a_pPriority != NULL )
+			params[ IGesture::PRIORITY_PARAM ] = a_pPriority;
+		if ( a_fTimeout > 0.0f )
+			params[ IGesture::TIMEOUT_PARAM ] = a_fTimeout;
+		return params;
+	}
+
+	virtual void RunTest()
+	{
+		TestRequestGesture gesture;
+		IGesture::GestureDelegate callback( DELEGATE( TestGestureRequests, OnDone, const IGesture::Result &, this ) );
+
+		// requests run in priority order, first come first served within a priority
+		Test( gesture.PushRequest( callback, MakeRequest( "a" ) ) );
+		Test(! gesture.PushRequest( callback, MakeRequest( "b", "low" ) ) );
+		Test(! gesture.PushRequest( callback, MakeRequest( "c", "high" ) ) );
+		Test(! gesture.PushRequest( callback, MakeRequest( "d" ) ) );
+		Test(! gesture.PushRequest( callback, MakeRequest( "e", "high" ) ) );
+		Test( gesture.GetActiveName() == "a" );
+		Test( gesture.PopRequest() && gesture.GetActiveName() == "c" );
+		Test( gesture.PopRequest() && gesture.GetActiveName() == "e" );
+		Test( gesture.PopRequest() && gesture.GetActiveName() == "d" );
+		Test( gesture.PopRequest() && gesture.GetActiveName() == "b" );
+		Test(! gesture.PopRequest() );
+		Test( m_nDone == 5 && m_nErrors == 0 );
+
+		// the priority parameter is namespaced, a gesture's own "priority" parameter is left alone
+		ParamsMap own( "name", "f" );
+		own["priority"] = "urgent";
+		Test( gesture.PushRequest( callback, own ) );
+		Test(! gesture.PushRequest( callback, MakeRequest( "g" ) ) );
+		Test( gesture.PopRequest() && gesture.GetActiveName() == "g" );
+		Test(! gesture.PopRequest() );
+		m_nDone = m_nErrors = 0;
+
+		// requests that wait too long are completed with an error, the active request never expires
+		Test( gesture.PushRequest( callback, MakeRequest( "a", NULL, 0.01f ) ) );
+		Test(! gesture.PushRequest( callback, MakeRequest( "b", NULL, 0.01f ) ) );
+		Test(! gesture.PushRequest( callback, MakeRequest( "c" ) ) );
+		boost::this_thread::sleep( boost::posix_time::milliseconds( 50 ) );
+		Test( gesture.PopRequest() && gesture.GetActiveName() == "c" );
+		Test( m_nDone == 2 && m_nErrors == 1 );
+		Test(! gesture.PopRequest() );
+		m_nDone = m_nErrors = 0;
+
+		// the default timeout applies when the request has none
+		gesture.SetRequestTimeout( 0.01f );
+		Test( gesture.PushRequest( callback, MakeRequest( "a" ) ) );
+		Test(! gesture.PushRequest( callback, MakeRequest( "b" ) ) );
+		boost::this_thread::sleep( boost::posix_time::milliseconds( 50 ) );
+		Test(! gesture.PushRequest( callback, MakeRequest( "c" ) ) );
+		Test( m_nDone == 1 && m_nErrors == 1 && gesture.GetQueued() == 2 );
+		gesture.SetRequestTimeout( 0.0f );
+		Test( gesture.PopRequest() && gesture.GetActiveName() == "c" );
+		Test(! gesture.PopRequest() );
+		m_nDone = m_nErrors = 0;
+
+		// identical queued requests are merged, both callbacks are invoked once it's done
+		gesture.SetMergeRequests( true );
+		Test( gesture.PushRequest( callback, MakeRequest( "a" ) ) );
+		Test(! gesture.PushRequest( callback, MakeRequest( "b" ) ) );
+		Test(! gesture.PushRequest( callback, MakeRequest( "b" ) ) );
+		Test(! gesture.PushRequest( callback, MakeRequest( "b", "high" ) ) );
+		Test( gesture.GetQueued() == 3 );
+		Test( gesture.PopRequest() );
+		Test( gesture.PopRequest() );
+		Test( m_nDone == 2 );
+		Test(! gesture.PopRequest() );
+		Test( m_nDone == 4 && m_nErrors == 0 );
+		gesture.SetMergeRequests( false );
+		m_nDone = m_nErrors = 0;
+
+		// finished requests are reused
+		Test( gesture.PushRequest( callback, MakeRequest( "a" ) ) );
+		const void * pRequest = gesture.GetActive();
+		Test(! gesture.PopRequest() );
+		Test( gesture.PushRequest( callback, MakeRequest( "b" ) ) );
+		Test( gesture.GetActive() == pRequest && gesture.GetActiveName() == "b" );
+		Test(! gesture.PopRequest() );
+		m_nDone = m_nErrors = 0;
+
+		// an urgent request only preempts the active request if the gesture can stop it
+		Test( gesture.PushRequest( callback, MakeRequest( "a" ) ) );
+		Test(! gesture.PushRequest( callback, MakeRequest( "b", "urgent" ) ) );
+		Test( gesture.GetActiveName() == "a" && m_nDone == 0 );
+		gesture.m_bPreempt = true;
+		Test( gesture.PushRequest( callback, MakeRequest( "c", "urgent" ) ) );
+		Test( m_nDone == 1 && m_nErrors == 1 );
+		Test( gesture.GetActiveName() == "b" );
+		gesture.PopAllRequests();
+		Test( gesture.GetQueued() == 0 );
+	}
+
+	void OnDone( const IGesture::Result & a_Result )
+	{
+		m_nDone += 1;
+		if ( a_Result.m_bError )
+			m_nErrors += 1;
+	}
+
+	int		m_nDone;
+	int		m_nErrors;
+};
+
+TestGestureRequests TEST_GESTURE_REQUESTS;
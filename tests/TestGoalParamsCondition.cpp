@@ -0,0 +1,146 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include "utils/UnitTest.h"
+#include "utils/Time.h"
+#include "utils/Log.h"
+#include "planning/conditions/GoalParamsConditon.h"
+#include "blackboard/Goal.h"
+
+//! This is the evaluator GoalParamsCondition used before conditions were compiled, used as
+//! the reference for both the results and the timing.
+struct ReferenceParamsCondition : public GoalParamsCondition
+{
+	ReferenceParamsCondition( const GoalParamsCondition & a_Condition ) : GoalParamsCondition( a_Condition )
+	{}
+
+	float TestReference( Goal::SP a_spGoal )
+	{
+		const ParamsMap & params = a_spGoal->GetParams();
+
+		std::vector<bool> values;
+		for (size_t i = 0; i < m_Params.size(); ++i)
+		{
+			Json::Value value;
+			if (params.ValidPath(m_Params[i].m_Name))
+				value = params[m_Params[i].m_Name];
+
+			values.push_back( TestEqualityOp(m_Params[i].m_Op, m_Params[i].m_Value, value) );
+		}
+
+		if (TestLogicalOp(m_LogicalOp, values))
+			return 1.0f;
+
+		return 0.0f;
+	}
+};
+
+class TestGoalParamsCondition : public UnitTest
+{
+public:
+	TestGoalParamsCondition() : UnitTest( "TestGoalParamsCondition" )
+	{}
+
+	virtual void RunTest()
+	{
+		std::vector<ReferenceParamsCondition> conditions;
+
+		// the same shapes of conditions used by our plans..
+		std::vector<GoalParamsCondition::ParamCondition> answer;
+		answer.push_back( GoalParamsCondition::ParamCondition( "answer/response/0", Json::Value(), ICondition::NE ) );
+		answer.push_back( GoalParamsCondition::ParamCondition( "answer/response/0/id", Json::Value(), ICondition::EQ ) );
+		answer.push_back( GoalParamsCondition::ParamCondition( "answer/answers/0", Json::Value(), ICondition::EQ ) );
+		conditions.push_back( GoalParamsCondition( answer ) );
+		conditions.push_back( GoalParamsCondition( "answer/intent", "weather" ) );
+		conditions.push_back( GoalParamsCondition( "answer/intent", "joke", ICondition::NE ) );
+		conditions.push_back( GoalParamsCondition( "answer/intent", "Weather" ) );
+		conditions.push_back( GoalParamsCondition( "answer/intent", "JOKE", ICondition::NE ) );
+		conditions.push_back( GoalParamsCondition( "answer/confident", true ) );
+		conditions.push_back( GoalParamsCondition( "answer/confidence", 0.5f, ICondition::GT ) );
+
+		std::vector<GoalParamsCondition::ParamCondition> either;
+		either.push_back( GoalParamsCondition::ParamCondition( "answer/intent", "time", ICondition::EQ ) );
+		either.push_back( GoalParamsCondition::ParamCondition( "answer/intent", "date", ICondition::EQ ) );
+		conditions.push_back( GoalParamsCondition( either, ICondition::OR ) );
+
+		// conditions loaded from JSON are compiled in Deserialize()
+		Json::Value json = ISerializable::SerializeObject( &conditions[0] );
+		GoalParamsCondition * pLoaded = ISerializable::DeserializeObject<GoalParamsCondition>( json );
+		Test( pLoaded != NULL );
+		conditions.push_back( *pLoaded );
+		delete pLoaded;
+
+		std::vector<Goal::SP> goals;
+		goals.push_back( MakeGoal( "weather", 0.9, true, true ) );
+		goals.push_back( MakeGoal( "joke", 0.2, false, true ) );
+		goals.push_back( MakeGoal( "time", 0.7, true, false ) );
+		goals.push_back( MakeGoal( "Weather", 0.9, true, true ) );
+		goals.push_back( MakeGoal( "WEATHER", 0.9, true, true ) );
+		goals.push_back( MakeGoal( "Joke", 0.2, false, true ) );
+		goals.push_back( MakeGoal( "Time", 0.7, true, false ) );
+		goals.push_back( Goal::SP( new Goal( "empty" ) ) );
+
+		// the compiled conditions must return the same results as the reference, including the
+		// mixed case strings which must not be folded by the string fast path..
+		for(size_t i=0;i<conditions.size();++i)
+			for(size_t k=0;k<goals.size();++k)
+				Test( conditions[i].Test( goals[k] ) == conditions[i].TestReference( goals[k] ) );
+
+		GoalParamsCondition weather( "answer/intent", "weather" );
+		Test( weather.Test( goals[0] ) == 1.0f );
+		Test( weather.Test( goals[4] ) == 0.0f );
+		Test( weather.Test( goals[5] ) == 0.0f );
+
+		const int ITERATIONS = 20000;
+
+		float fSum = 0.0f;
+		double start = Time().GetEpochTime();
+		for(int n=0;n<ITERATIONS;++n)
+			for(size_t i=0;i<conditions.size();++i)
+				for(size_t k=0;k<goals.size();++k)
+					fSum += conditions[i].TestReference( goals[k] );
+		double reference = Time().GetEpochTime() - start;
+
+		float fCompiledSum = 0.0f;
+		start = Time().GetEpochTime();
+		for(int n=0;n<ITERATIONS;++n)
+			for(size_t i=0;i<conditions.size();++i)
+				for(size_t k=0;k<goals.size();++k)
+					fCompiledSum += conditions[i].Test( goals[k] );
+		double compiled = Time().GetEpochTime() - start;
+
+		Test( fSum == fCompiledSum );
+		Log::Status( "TestGoalParamsCondition", "%d tests, reference: %.3f seconds, compiled: %.3f seconds (%.1fx)",
+			ITERATIONS * conditions.size() * goals.size(), reference, compiled,
+			compiled > 0.0 ? reference / compiled : 0.0 );
+	}
+
+	static Goal::SP MakeGoal( const char * a_pIntent, double a_fConfidence, bool a_bConfident, bool a_bResponse )
+	{
+		ParamsMap params;
+		params["answer/intent"] = a_pIntent;
+		params["answer/confidence"] = a_fConfidence;
+		params["answer/confident"] = a_bConfident;
+		if ( a_bResponse )
+			params["answer/response/0"] = "Here is the answer.";
+
+		return Goal::SP( new Goal( "dialog_answer", params ) );
+	}
+};
+
+TestGoalParamsCondition TEST_GOAL_PARAMS_CONDITION;
@@ -19,6 +19,7 @@
 #include "utils/UnitTest.h"
 #include "utils/Config.h"
 #include "models/IGraph.h"
+#include "models/SelfGraph/SelfGraph.h"
 #include "topics/TopicManager.h"
 #include "services/Graph/Graph.h"
 
@@ -28,14 +29,24 @@ class TestGraph : public UnitTest
 {
 public:
 	int			m_nGraphLoaded;
+	int			m_nGraphClosed;
 	bool		m_bTraverseTested;
+	int			m_nPeople;
+	int			m_nPeopleBatches;
+	bool		m_bPeopleDone;
+	bool		m_bPageTested;
 	bool		m_bGraphConnected;
 	bool		m_bParentReady;
 
 	//! Construction
 	TestGraph() : UnitTest("TestGraph"),
 		m_nGraphLoaded( 0 ),
+		m_nGraphClosed( 0 ),
 		m_bTraverseTested( false ),
+		m_nPeople( 0 ),
+		m_nPeopleBatches( 0 ),
+		m_bPeopleDone( false ),
+		m_bPageTested( false ),
 		m_bGraphConnected( false ),
 		m_bParentReady( false )
 	{}
@@ -65,7 +76,7 @@ public:
 
 		std::string graphId( UniqueID().Get() );
 		IGraph::SP spGraph( IGraph::Create( "SelfGraph", graphId ) );
-		Test( spGraph->Connect( DELEGATE( TestGraph, OnGraphLoaded, IGraph::SP, this) ) );
+		Test( spGraph->Load( DELEGATE( TestGraph, OnGraphLoaded, IGraph::SP, this) ) );
 		Spin(m_nGraphLoaded, 1);
 
 		spGraph->Clear();		// wipe the data from any previous graph..
@@ -81,16 +92,50 @@ public:
 		spRuss->CreateEdge( "reports_to", spRay );
 		spRay->CreateEdge( "reports_to", spGrady );
 
+		// edges are kept in a bucket for each label
+		Test( spRichard->GetOutBuckets().size() == 2 );
+		IVertex::EdgeList bosses;
+		Test( spRichard->FindOutEdges( "reports_to", bosses ) );
+		Test( bosses.size() == 2 );
+		EdgeLabel::Id teamLabel = 0;
+		Test( EdgeLabel::Find( "team", teamLabel ) );
+		Test( spJJ->GetOutEdges( teamLabel ) != NULL && spJJ->GetOutEdges( teamLabel )->size() == 1 );
+		Test( spGrady->GetOutEdges( teamLabel ) == NULL );
+
+		// vertices have a handle into the local graph, and their properties are kept packed once saved
+		SelfGraph::SP spSelfGraph = DynamicCast<SelfGraph>( spGraph );
+		SelfVertex::SP spSelfRichard = DynamicCast<SelfVertex>( spRichard );
+		Test( spSelfGraph.get() != NULL && spSelfRichard.get() != NULL );
+		Test( spSelfGraph->GetVertex( spSelfRichard->GetHandle() ) == spSelfRichard );
+		Test( spSelfGraph->FindVertex( spRichard->GetId() ) == spRichard );
+		Test(! spRichard->GetPropertyStore().IsExpanded() );
+		Test( spRichard->GetProperty( "age" ).asInt() == 46 );
+		Test( spRichard->GetPropertyStore().IsExpanded() );
+		spRichard->CompactProperties();
+
+		// a reference into the properties stays valid across a save until they are released
+		Json::Value & age = spRichard->GetProperty( "age" );
+		spRichard->Save();
+		Test( spRichard->GetPropertyStore().IsExpanded() );
+		Test( age.asInt() == 46 );
+		spRichard->CompactProperties();
+		Test(! spRichard->GetPropertyStore().IsExpanded() );
+
+		Json::Value name;
+		Test( spRichard->GetPropertyStore().Find( "name", name ) && name.asString() == "Richard" );
+
 		// test saving...
 		Json::Value saved_graph;
 		Test( spGraph->Export( saved_graph ) );
 		Log::Debug( "TestGraph", "Graph Exported: %s", saved_graph.toStyledString().c_str() );
 
-		Test( spGraph->Close() );
+		// closing doesn't block, the callback is invoked once everything is written..
+		Test( spGraph->Close( DELEGATE( TestGraph, OnGraphClosed, bool, this ) ) );
+		Spin( m_nGraphClosed, 1 );
 
 		// test loading..
 		IGraph::SP spGraph2( IGraph::Create( "SelfGraph", graphId ));
-		Test( spGraph2->Connect( DELEGATE(TestGraph, OnGraphLoaded, IGraph::SP, this)) );
+		Test( spGraph2->Load( DELEGATE(TestGraph, OnGraphLoaded, IGraph::SP, this)) );
 		Spin(m_nGraphLoaded, 2);
 
 		// create a traversal...
@@ -109,13 +154,26 @@ public:
 		Test( spMyBosssesLoaded->Start( DELEGATE( TestGraph, OnMyBossses, ITraverser::SP, this ) ) );
 		Spin( m_bTraverseTested, 300.0f );
 
+		// get all the people back two at a time..
+		ITraverser::SP spPeople = spGraph2->CreateTraverser( LabelCondition( "person" ) );
+		spPeople->SetBatchSize( 2 );
+		Test( spPeople->Start( DELEGATE( TestGraph, OnPeople, ITraverser::SP, this ) ) );
+		Spin( m_bPeopleDone, 300.0f );
+		Test( m_nPeople == 5 );
+		Test( m_nPeopleBatches == 3 );
+
+		// just the last page of people..
+		ITraverser::SP spPage = spGraph2->CreateTraverser( LabelCondition( "person" ) );
+		spPage->SetLimit( 2, 4 );
+		Test( spPage->Start( DELEGATE( TestGraph, OnPeoplePage, ITraverser::SP, this ) ) );
+		Spin( m_bPageTested, 300.0f );
+
 		bool bWait = false;
 		Spin( bWait, 5.0f );
 
 		// close and destroy this graph..
-		spGraph2->Drop();
-
-		Spin( bWait, 5.0f );
+		Test( spGraph2->Drop( DELEGATE( TestGraph, OnGraphClosed, bool, this ) ) );
+		Spin( m_nGraphClosed, 2 );
 	}
 
 	void OnGraphLoaded(IGraph::SP a_spGraph)
@@ -124,6 +182,27 @@ public:
 		m_nGraphLoaded += 1;
 	}
 
+	void OnGraphClosed( bool a_bSuccess )
+	{
+		Test( a_bSuccess );
+		m_nGraphClosed += 1;
+	}
+
+	void OnPeople( ITraverser::SP a_spResult )
+	{
+		Test( a_spResult->Size() <= 2 );
+		m_nPeople += (int)a_spResult->Size();
+		m_nPeopleBatches += 1;
+		m_bPeopleDone = a_spResult->IsDone();
+	}
+
+	void OnPeoplePage( ITraverser::SP a_spResult )
+	{
+		Test( a_spResult->IsDone() );
+		Test( a_spResult->Size() == 1 );
+		m_bPageTested = true;
+	}
+
 	void OnMyBossses( ITraverser::SP a_spResult )
 	{
 		Test( a_spResult->Size() > 0 );
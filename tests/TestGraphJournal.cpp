@@ -0,0 +1,99 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include "utils/UnitTest.h"
+#include "models/SelfGraph/GraphJournal.h"
+
+#include "boost/filesystem.hpp"
+
+class TestGraphJournal : public UnitTest
+{
+public:
+	//! Construction
+	TestGraphJournal() : UnitTest("TestGraphJournal")
+	{}
+
+	virtual void RunTest()
+	{
+		const std::string JOURNAL_FILE( "./db/TestGraphJournal.journal" );
+
+		GraphJournal journal;
+		journal.Remove();
+		Test( journal.Open( JOURNAL_FILE ) );
+
+		Json::Value vertex;
+		vertex["m_Id"] = "a";
+		vertex["m_Label"] = "person";
+		Test( journal.Save( "vertex_a", vertex ) );
+		Test( journal.Delete( "edge_b" ) );
+
+		GraphJournal::RecordList records;
+		Test( journal.Read( records ) );
+		Test( records.size() == 2 );
+		Test( records[0].m_Op == GraphJournal::OP_SAVE && records[0].m_Key == "vertex_a" && records[0].m_Data == vertex );
+		Test( records[1].m_Op == GraphJournal::OP_DELETE && records[1].m_Key == "edge_b" );
+
+		// changes made while a flush is written go into a new journal, both are read back in order
+		Test( journal.Rotate() );
+		vertex["m_Label"] = "robot";
+		Test( journal.Save( "vertex_a", vertex ) );
+		records.clear();
+		Test( journal.Read( records ) );
+		Test( records.size() == 3 && records[2].m_Data["m_Label"].asString() == "robot" );
+
+		// once the flush is written, only the new changes are left
+		journal.Retire();
+		records.clear();
+		Test( journal.Read( records ) );
+		Test( records.size() == 1 );
+
+		// a failed flush doesn't retire the rotated journal, the next flush adds it's changes to the end of it
+		Test( journal.Rotate() );
+		Test( journal.Delete( "edge_c" ) );
+		Test( journal.Rotate() );
+		records.clear();
+		Test( journal.Read( records ) );
+		Test( records.size() == 2 );
+		Test( records[0].m_Key == "vertex_a" && records[0].m_Data["m_Label"].asString() == "robot" );
+		Test( records[1].m_Op == GraphJournal::OP_DELETE && records[1].m_Key == "edge_c" );
+
+		// that flush holds every rotated record, so once it's written only the newer changes are left
+		Test( journal.Save( "vertex_a", vertex ) );
+		journal.Retire();
+		records.clear();
+		Test( journal.Read( records ) );
+		Test( records.size() == 1 && records[0].m_Key == "vertex_a" );
+		journal.Close();
+
+		// a record cut short by a crash is ignored
+		FILE * pFile = fopen( JOURNAL_FILE.c_str(), "ab" );
+		Test( pFile != NULL );
+		fwrite( "\x01\x10\x00", 1, 3, pFile );
+		fclose( pFile );
+
+		Test( journal.Open( JOURNAL_FILE ) );
+		records.clear();
+		Test( journal.Read( records ) );
+		Test( records.size() == 1 && records[0].m_Key == "vertex_a" );
+
+		journal.Remove();
+		Test(! boost::filesystem::exists( JOURNAL_FILE ) );
+	}
+};
+
+TestGraphJournal TEST_GRAPH_JOURNAL;
@@ -0,0 +1,191 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include "utils/UnitTest.h"
+#include "utils/ThreadPool.h"
+#include "utils/TimerPool.h"
+#include "utils/UniqueID.h"
+#include "models/SelfGraph/SelfGraph.h"
+#include "models/SelfGraph/GraphSync.h"
+
+class TestGraphSync : public UnitTest
+{
+public:
+	//! This sync stands in for the graph service, queries are kept until we reply to them.
+	class MockSync : public GraphSync
+	{
+	public:
+		MockSync( SelfGraph * a_pGraph ) : GraphSync( a_pGraph )
+		{}
+
+		virtual bool Query( const std::string & a_Query, const Json::Value & a_Bindings, QueryCallback a_Callback )
+		{
+			m_Queries.push_back( a_Query );
+			m_Bindings = a_Bindings;
+			m_Callback = a_Callback;
+			return true;
+		}
+
+		void Reply( const Json::Value & a_Result )
+		{
+			QueryCallback callback( m_Callback );
+			m_Callback.Reset();
+			callback( a_Result );
+		}
+
+		std::vector<std::string>	m_Queries;
+		Json::Value					m_Bindings;
+		QueryCallback				m_Callback;
+	};
+
+	int			m_nGraphLoaded;
+	int			m_nGraphClosed;
+
+	//! Construction
+	TestGraphSync() : UnitTest("TestGraphSync"),
+		m_nGraphLoaded( 0 ),
+		m_nGraphClosed( 0 )
+	{}
+
+	static Json::Value MakeVertex( const char * a_pId, const char * a_pName )
+	{
+		Json::Value vertex;
+		vertex["id"] = a_pId;
+		vertex["label"] = "person";
+		vertex["type"] = "vertex";
+		vertex["properties"]["name"][0]["value"] = a_pName;
+
+		return vertex;
+	}
+
+	virtual void RunTest()
+	{
+		ThreadPool pool(1);
+		TimerPool timers;
+
+		SelfGraph::SP spGraph( new SelfGraph( UniqueID().Get() ) );
+		Test( spGraph->Load( DELEGATE( TestGraphSync, OnGraphLoaded, IGraph::SP, this ) ) );
+		Spin( m_nGraphLoaded, 1 );
+
+		MockSync * pSync = new MockSync( spGraph.get() );
+		spGraph->SetSync( GraphSync::SP( pSync ) );
+
+		// results without a path are just the vertexes..
+		Json::Value result;
+		result["result"]["data"][0] = MakeVertex( "1", "Richard" );
+		result["result"]["data"][1] = MakeVertex( "2", "JJ" );
+		result["result"]["data"][2] = MakeVertex( "3", "Grady" );
+
+		GraphSync::IdSet found;
+		Test( pSync->Merge( result, found ) == 3 );
+		Test( found.size() == 3 );
+		SelfVertex::SP spRichard = DynamicCast<SelfVertex>( spGraph->FindVertex( "1" ) );
+		Test( spRichard.get() != NULL );
+		Test( spRichard->GetProperty( "name" ).asString() == "Richard" );
+		Test( spRichard->GetLabel() == "person" );
+
+		// pulling the same results again changes nothing, remote changes are merged
+		found.clear();
+		result["result"]["data"][0]["properties"]["name"][0]["value"] = "Rich";
+		Test( pSync->Merge( result, found ) == 3 );
+		Test( spRichard->GetProperty( "name" ).asString() == "Rich" );
+		Test( spRichard->GetVersion() == spRichard->GetSyncedVersion() );
+
+		// local changes not yet sent win over the remote graph
+		SelfVertex::SP spJJ = DynamicCast<SelfVertex>( spGraph->FindVertex( "2" ) );
+		(*spJJ)["name"] = "Jay";
+		Test( spJJ->Save() );				// no graph service, so this is just saved locally
+		Test( spJJ->GetVersion() > spJJ->GetSyncedVersion() );
+		Test( pSync->Merge( result, found ) == 3 );
+		Test( spJJ->GetProperty( "name" ).asString() == "Jay" );
+
+		// updates are sent in one batch, updates queued more than once are sent once
+		SelfVertex::SP spGrady = DynamicCast<SelfVertex>( spGraph->FindVertex( "3" ) );
+		pSync->Queue( spRichard );
+		pSync->Queue( spJJ );
+		pSync->Queue( spJJ );
+		Test( pSync->GetQueued() == 2 );
+		pSync->Send();
+		Test( pSync->IsSending() );
+		Test( pSync->m_Queries.size() == 1 );
+		Test( pSync->m_Queries[0].find( "V(" ) != std::string::npos );
+
+		// only one batch at a time..
+		pSync->Queue( spGrady );
+		pSync->Send();
+		Test( pSync->m_Queries.size() == 1 );
+
+		// once sent, the next batch goes and the batches get bigger
+		size_t batchBytes = pSync->GetBatchBytes();
+		pSync->Reply( Json::Value( Json::objectValue ) );
+		Test( spJJ->GetVersion() == spJJ->GetSyncedVersion() );
+		Test( pSync->GetBatchBytes() > batchBytes );
+		Test( pSync->m_Queries.size() == 2 );
+		pSync->Reply( Json::Value( Json::objectValue ) );
+		Test(! pSync->IsSending() );
+
+		// a failed batch is sent again in smaller batches
+		pSync->Queue( spRichard );
+		pSync->Queue( spGrady );
+		pSync->Send();
+		batchBytes = pSync->GetBatchBytes();
+		pSync->Reply( Json::Value() );
+		Test( pSync->GetBatchBytes() < batchBytes );
+		Test( pSync->m_Queries.size() == 4 );
+		pSync->Reply( Json::Value( Json::objectValue ) );
+		Test(! pSync->IsSending() && pSync->GetQueued() == 0 );
+
+		// pulls are sized by how many objects each result has
+		pSync->OnPulled( 10, 10 );
+		size_t pullSize = pSync->GetPullSize();
+		pSync->OnPulled( 10, 100 );
+		Test( pSync->GetPullSize() < pullSize );
+		Test( pSync->GetPullSize() >= GraphSync::MIN_PULL_SIZE );
+
+		// a batch being sent keeps the graph around after it's released, until the batch is done
+		pSync->Queue( spRichard );
+		pSync->Send();
+		Test( pSync->IsSending() );
+		Test( spGraph->Drop( DELEGATE( TestGraphSync, OnGraphClosed, bool, this ) ) );
+		Test( m_nGraphClosed == 0 );
+
+		SelfGraph::WP wpGraph( spGraph );
+		spGraph.reset();
+		spRichard.reset();
+		spJJ.reset();
+		spGrady.reset();
+		Test(! wpGraph.expired() );
+		pSync->Reply( Json::Value( Json::objectValue ) );
+		Spin( m_nGraphClosed, 1 );
+		Test( wpGraph.expired() );
+	}
+
+	void OnGraphLoaded( IGraph::SP a_spGraph )
+	{
+		Test( a_spGraph.get() != NULL );
+		m_nGraphLoaded += 1;
+	}
+
+	void OnGraphClosed( bool a_bSuccess )
+	{
+		Test( a_bSuccess );
+		m_nGraphClosed += 1;
+	}
+};
+
+TestGraphSync TEST_GRAPH_SYNC;
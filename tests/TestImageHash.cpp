@@ -0,0 +1,70 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+
+#include "utils/UnitTest.h"
+#include "utils/JpegHelpers.h"
+#include "utils/ImageHash.h"
+
+class TestImageHash : public UnitTest
+{
+public:
+	TestImageHash() : UnitTest( "TestImageHash" )
+	{}
+
+	virtual void RunTest()
+	{
+		std::ifstream input( "./etc/tests/test.jpg", std::ios::in | std::ios::binary );
+		std::string jpeg( (std::istreambuf_iterator<char>( input )), std::istreambuf_iterator<char>() );
+		Test( jpeg.size() > 0 );
+
+		int width = 0, height = 0, depth = 0;
+		std::string pixels;
+		Test( JpegHelpers::DecodeImage( jpeg.data(), jpeg.size(), width, height, depth, pixels ) );
+
+		boost::uint64_t hash = 0;
+		Test( ImageHash::HashJpeg( jpeg, hash ) );
+		Test( hash == ImageHash::Hash( (const unsigned char *)pixels.data(), width, height, depth ) );
+		Test( ImageHash::Distance( hash, hash ) == 0 );
+
+		// sensor noise and a small change in exposure are the same scene
+		std::string noisy( pixels );
+		for(size_t i=0;i<noisy.size();++i)
+		{
+			int value = (unsigned char)noisy[i] + 6 + (int)((i * 7919) % 9) - 4;
+			noisy[i] = (char)std::min( std::max( value, 0 ), 255 );
+		}
+		boost::uint64_t noisyHash = ImageHash::Hash( (const unsigned char *)noisy.data(), width, height, depth );
+		Test( ImageHash::Distance( hash, noisyHash ) <= 4 );
+
+		// a different scene is not
+		std::string flipped( pixels.size(), 0 );
+		size_t stride = (size_t)width * depth;
+		for(int y=0;y<height;++y)
+			flipped.replace( y * stride, stride, pixels, (height - 1 - y) * stride, stride );
+		boost::uint64_t flippedHash = ImageHash::Hash( (const unsigned char *)flipped.data(), width, height, depth );
+		Test( ImageHash::Distance( hash, flippedHash ) > 16 );
+
+		Test(! ImageHash::HashJpeg( "not a jpeg", hash ) );
+	}
+};
+
+TestImageHash TEST_IMAGE_HASH;
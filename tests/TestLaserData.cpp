@@ -0,0 +1,145 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+#include "utils/UnitTest.h"
+#include "utils/ThreadPool.h"
+#include "sensors/Laser.h"
+#include "sensors/LaserData.h"
+
+//! Receives the scans sent by a laser sensor
+struct TestLaserSubscriber
+{
+	TestLaserSubscriber() : m_nScans( 0 ), m_nPoints( 0 )
+	{}
+
+	int		m_nScans;
+	size_t	m_nPoints;
+
+	void OnLaserData( IData * a_pData )
+	{
+		LaserData * pScan = DynamicCast<LaserData>( a_pData );
+		if ( pScan != NULL )
+		{
+			m_nScans += 1;
+			m_nPoints += pScan->GetPointCount();
+		}
+	}
+};
+
+class TestLaserData : public UnitTest
+{
+public:
+	TestLaserData() : UnitTest( "TestLaserData" )
+	{}
+
+	virtual void RunTest()
+	{
+		LaserData::PointList points;
+		for(int i=0;i<100;++i)
+			points.push_back( LaserData::Point( 1.0f + i * 0.5f, i * 0.01f, -0.25f, i * 0.001f ) );
+		LaserData scan( 1234567890.125, points );
+
+		// json round trip..
+		Json::Value json = ISerializable::SerializeObject( &scan );
+		LaserData * pJson = ISerializable::DeserializeObject<LaserData>( json );
+		Test( pJson != NULL );
+		TestEqual( scan, *pJson );
+		delete pJson;
+
+		// a single point from before we had scans..
+		Json::Value single;
+		single["m_fDistance"] = 2.5f;
+		single["m_fAzimuthalAngle"] = 0.5f;
+		single["m_fElevationAngle"] = 0.25f;
+		LaserData legacy;
+		legacy.Deserialize( single );
+		Test( legacy.GetPointCount() == 1 );
+		Test( legacy.GetDistance() == 2.5f && legacy.GetAzimuthalAngle() == 0.5f && legacy.GetElevationAngle() == 0.25f );
+
+		// binary round trip..
+		std::string binary;
+		Test( scan.ToBinary( binary ) );
+		Test( binary.size() == sizeof(boost::uint32_t) + sizeof(double) + points.size() * sizeof(float) * 4 );
+
+		LaserData decoded;
+		Test( decoded.FromBinary( LaserData::BINARY_TYPE, binary ) );
+		TestEqual( scan, decoded );
+
+		LaserData empty;
+		Test( empty.ToBinary( binary ) );
+		Test( decoded.FromBinary( LaserData::BINARY_TYPE, binary ) );
+		Test( decoded.GetPointCount() == 0 );
+
+		// anything that doesn't match the point count is rejected..
+		Test( scan.ToBinary( binary ) );
+		LaserData bad;
+		Test(! bad.FromBinary( LaserData::BINARY_TYPE, binary.substr( 0, binary.size() - 1 ) ) );
+		Test(! bad.FromBinary( LaserData::BINARY_TYPE, binary + std::string( 16, 0 ) ) );
+		Test(! bad.FromBinary( LaserData::BINARY_TYPE, binary.substr( 0, 6 ) ) );
+
+		// a count that only matches the size if count * 16 wraps around 32-bits..
+		std::string wrapped( binary.substr( 0, sizeof(boost::uint32_t) + sizeof(double) + 16 ) );
+		boost::uint32_t count = 0x10000001;
+		memcpy( &wrapped[0], &count, sizeof(count) );
+		Test(! bad.FromBinary( LaserData::BINARY_TYPE, wrapped ) );
+
+		TestLaser();
+	}
+
+	void TestLaser()
+	{
+		ThreadPool pool( 1 );
+
+		TestLaserSubscriber subscriber;
+		Laser::SP spLaser( new Laser() );
+		spLaser->Subscribe( DELEGATE( TestLaserSubscriber, OnLaserData, IData *, &subscriber ) );
+
+		for(int i=0;i<10;++i)
+			spLaser->AddPoint( 1.0f, i * 0.1f, 0.0f );
+		spLaser->SendScan();
+
+		// the queued scan keeps the laser around until it's sent..
+		spLaser.reset();
+		pool.ProcessMainThread();
+		Test( subscriber.m_nScans == 1 );
+		Test( subscriber.m_nPoints == 10 );
+
+		// the scan that was never sent is just deleted with the laser
+		spLaser.reset( new Laser() );
+		spLaser->AddPoint( 1.0f, 0.0f, 0.0f );
+		spLaser.reset();
+		pool.ProcessMainThread();
+		Test( subscriber.m_nScans == 1 );
+	}
+
+	void TestEqual( const LaserData & a_Expected, const LaserData & a_Actual )
+	{
+		Test( a_Expected.GetTimeStamp() == a_Actual.GetTimeStamp() );
+		Test( a_Expected.GetPointCount() == a_Actual.GetPointCount() );
+		for(size_t i=0;i<a_Expected.GetPointCount() && i < a_Actual.GetPointCount();++i)
+		{
+			const LaserData::Point & expected = a_Expected.GetPoints()[i];
+			const LaserData::Point & actual = a_Actual.GetPoints()[i];
+			Test( expected.m_fDistance == actual.m_fDistance );
+			Test( expected.m_fAzimuthalAngle == actual.m_fAzimuthalAngle );
+			Test( expected.m_fElevationAngle == actual.m_fElevationAngle );
+			Test( expected.m_fTimeOffset == actual.m_fTimeOffset );
+		}
+	}
+};
+
+TestLaserData TEST_LASER_DATA;
@@ -0,0 +1,119 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+#include "utils/UnitTest.h"
+#include "utils/ParamsMap.h"
+#include "utils/StringUtil.h"
+
+class TestParamsMap : public UnitTest
+{
+public:
+	TestParamsMap() : UnitTest( "TestParamsMap" )
+	{}
+
+	virtual void RunTest()
+	{
+		TestTemplates();
+		TestScalarTypes();
+	}
+
+	void TestTemplates()
+	{
+		const std::string TEMPLATE( "Hello ${user/name}, it is ${weather/temp} degrees${missing}." );
+
+		ParamsMap params;
+		params["user/name"] = "Bob";
+		params["weather/temp"] = 72;
+		Test( params.ResolveVariables( TEMPLATE ) == "Hello Bob, it is 72 degrees." );
+
+		// the cached template must resolve against the current params, not the params it was parsed with..
+		params["user/name"] = "Alice";
+		params["weather/temp"] = "cold";
+		Test( params.ResolveVariables( TEMPLATE ) == "Hello Alice, it is cold degrees." );
+
+		ParamsMap other;
+		other["user/name"] = "Carol";
+		Test( other.ResolveVariables( TEMPLATE ) == "Hello Carol, it is  degrees." );
+
+		// strings without variables or with an unterminated variable are returned as is..
+		Test( params.ResolveVariables( std::string( "No variables here" ) ) == "No variables here" );
+		Test( params.ResolveVariables( std::string( "${user/name} and ${user" ) ) == "Alice and ${user" );
+		Test( params.ResolveVariables( std::string( "${user/name}${user/name}" ) ) == "AliceAlice" );
+
+		// arrays in a path, objects are written as compact JSON..
+		params["list"][0] = "first";
+		params["list"][1]["value"] = 2;
+		Test( params.ResolveVariables( std::string( "${list/0}" ) ) == "first" );
+		Test( params.ResolveVariables( std::string( "${list/1/value}" ) ) == "2" );
+		Test( params.ResolveVariables( std::string( "${list/2}" ) ) == "" );
+
+		Json::Value object;
+		Test( Json::Reader().parse( params.ResolveVariables( std::string( "${list/1}" ) ), object ) );
+		Test( object == params["list/1"] );
+
+		// overflow the template cache, the results must not change once it has been cleared..
+		for(int i=0;i<2500;++i)
+		{
+			std::string input( StringUtil::Format( "%d:${user/name}", i ) );
+			Test( params.ResolveVariables( input ) == StringUtil::Format( "%d:Alice", i ) );
+		}
+		Test( params.ResolveVariables( TEMPLATE ) == "Hello Alice, it is cold degrees." );
+	}
+
+	void TestScalarTypes()
+	{
+		ParamsMap params;
+		params["name"] = "Bob";
+		params["key"] = "greeting";
+		params["count"] = 3;
+
+		Json::Value json;
+		json["text"] = "Hi ${name}";
+		json["number"] = 5;
+		json["real"] = 0.25;
+		json["flag"] = true;
+		json["empty"] = Json::Value();
+		json["list"][0] = "${count}";
+		json["list"][1] = 7;
+		json["${key}"] = "${name}";
+		json["nested"]["${key}"]["flag"] = false;
+
+		Json::Value result = params.ResolveVariables( json );
+
+		// scalars that aren't strings keep their type..
+		Test( result["number"].isInt() && result["number"].asInt() == 5 );
+		Test( result["real"].isDouble() && result["real"].asDouble() == 0.25 );
+		Test( result["flag"].isBool() && result["flag"].asBool() );
+		Test( result["empty"].isNull() );
+		Test( result["list"][1].isInt() && result["list"][1].asInt() == 7 );
+
+		// strings are resolved into strings, even if the variable is a number..
+		Test( result["text"] == "Hi Bob" );
+		Test( result["list"][0].isString() && result["list"][0].asString() == "3" );
+
+		// keys with variables are renamed..
+		Test( !result.isMember( "${key}" ) );
+		Test( result["greeting"] == "Bob" );
+		Test( result["nested"]["greeting"]["flag"].isBool() && !result["nested"]["greeting"]["flag"].asBool() );
+
+		// the input is left alone..
+		Test( json["text"] == "Hi ${name}" );
+		Test( json.isMember( "${key}" ) );
+	}
+};
+
+TestParamsMap TEST_PARAMS_MAP;
@@ -0,0 +1,145 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+#include "utils/UnitTest.h"
+#include "utils/Log.h"
+#include "planning/PlanManager.h"
+#include "planning/conditions/GoalNameCondition.h"
+#include "planning/conditions/GoalParamsConditon.h"
+#include "blackboard/Goal.h"
+
+class TestPlanIndex : public UnitTest
+{
+public:
+	TestPlanIndex() : UnitTest( "TestPlanIndex" )
+	{}
+
+	virtual void RunTest()
+	{
+		std::vector<Plan::SP> plans;
+		plans.push_back( MakeNamePlan( "plan_greet", "greeting" ) );
+		plans.push_back( MakeNamePlan( "plan_greet_upper", "Greeting" ) );
+		plans.push_back( MakeNamePlan( "plan_greet_ne", "greeting", ICondition::NE ) );
+		plans.push_back( MakeParamsPlan( "plan_weather", GoalParamsCondition( "answer/intent", "weather" ) ) );
+		plans.push_back( MakeParamsPlan( "plan_weather_mixed", GoalParamsCondition( "answer/intent", "Weather" ) ) );
+		plans.push_back( MakeParamsPlan( "plan_count", GoalParamsCondition( "answer/count", 2 ) ) );
+		plans.push_back( MakeParamsPlan( "plan_count_double", GoalParamsCondition( "answer/count", 2.0 ) ) );
+		plans.push_back( MakeParamsPlan( "plan_confident", GoalParamsCondition( "answer/confidence", 0.5f, ICondition::GT ) ) );
+
+		std::vector<GoalParamsCondition::ParamCondition> either;
+		either.push_back( GoalParamsCondition::ParamCondition( "answer/intent", "time", ICondition::EQ ) );
+		either.push_back( GoalParamsCondition::ParamCondition( "answer/intent", "date", ICondition::EQ ) );
+		plans.push_back( MakeParamsPlan( "plan_time", GoalParamsCondition( either, ICondition::OR ) ) );
+
+		PlanManager manager;
+		for(size_t i=0;i<plans.size();++i)
+			Test( manager.AddPlan( plans[i], false ) );
+
+		std::vector<Goal::SP> goals;
+		goals.push_back( MakeGoal( "greeting", "weather", 2, 0.1 ) );
+		goals.push_back( MakeGoal( "Greeting", "Weather", 2, 0.1 ) );
+		goals.push_back( MakeGoal( "GREETING", "WEATHER", 3, 0.1 ) );
+		goals.push_back( MakeGoal( "dialog_answer", "weather", 3, 0.9 ) );
+		goals.push_back( MakeGoal( "dialog_answer", "date", 1, 0.1 ) );
+		goals.push_back( MakeGoal( "dialog_answer", "Date", 2, 0.1 ) );
+		goals.push_back( Goal::SP( new Goal( "empty" ) ) );
+
+		// the index must select the same plan as testing every plan..
+		for(size_t i=0;i<goals.size();++i)
+		{
+			Plan::SP spExpected = FullScan( plans, goals[i] );
+			Plan::SP spSelected = manager.SelectPlan( goals[i] );
+			Log::Debug( "TestPlanIndex", "Goal %s, expected %s, selected %s", goals[i]->GetName().c_str(),
+				spExpected ? spExpected->GetPlanId().c_str() : "none", spSelected ? spSelected->GetPlanId().c_str() : "none" );
+			Test( spExpected == spSelected );
+		}
+
+		// replacing a plan must move it to it's new bucket..
+		plans[3] = MakeParamsPlan( "plan_weather", GoalParamsCondition( "answer/intent", "forecast" ) );
+		Test( manager.AddPlan( plans[3], false ) );
+		for(size_t i=0;i<goals.size();++i)
+			Test( FullScan( plans, goals[i] ) == manager.SelectPlan( goals[i] ) );
+
+		// a deserialized manager rebuilds the index from it's plans..
+		Json::Value json = ISerializable::SerializeObject( &manager );
+		PlanManager * pLoaded = ISerializable::DeserializeObject<PlanManager>( json );
+		Test( pLoaded != NULL );
+		for(size_t i=0;i<goals.size();++i)
+		{
+			Plan::SP spExpected = FullScan( plans, goals[i] );
+			Plan::SP spSelected = pLoaded->SelectPlan( goals[i] );
+			Test( (spExpected ? spExpected->GetPlanId() : "") == (spSelected ? spSelected->GetPlanId() : "") );
+		}
+		delete pLoaded;
+	}
+
+	//! The SelectPlan() used before plans were indexed, every plan is tested.
+	static Plan::SP FullScan( const std::vector<Plan::SP> & a_Plans, const Goal::SP & a_spGoal )
+	{
+		Plan::SP spBestPlan;
+		float fBestPlan = 0.5f;			// PlanManager::m_fMinPlanScore
+		for(size_t i=0;i<a_Plans.size();++i)
+		{
+			float fPlanScore = a_Plans[i]->TestPreConditions( a_spGoal );
+			if ( fPlanScore > fBestPlan 
+				|| (fPlanScore == fBestPlan && spBestPlan && a_Plans[i]->GetPlanId() < spBestPlan->GetPlanId()) )
+			{
+				spBestPlan = a_Plans[i];
+				fBestPlan = fPlanScore;
+			}
+		}
+		return spBestPlan;
+	}
+
+	static Plan::SP MakeNamePlan( const std::string & a_PlanId, const std::string & a_GoalName, 
+		ICondition::EqualityOp a_Op = ICondition::EQ )
+	{
+		GoalNameCondition * pName = new GoalNameCondition();
+		pName->m_GoalName = a_GoalName;
+		pName->m_GoalNameOp = a_Op;
+
+		return MakePlan( a_PlanId, ICondition::SP( pName ) );
+	}
+
+	static Plan::SP MakeParamsPlan( const std::string & a_PlanId, const GoalParamsCondition & a_Condition )
+	{
+		return MakePlan( a_PlanId, ICondition::SP( new GoalParamsCondition( a_Condition ) ) );
+	}
+
+	static Plan::SP MakePlan( const std::string & a_PlanId, const ICondition::SP & a_spCondition )
+	{
+		Plan::Conditions conditions;
+		conditions.push_back( a_spCondition );
+
+		Plan::SP spPlan( new Plan() );
+		spPlan->SetPlanId( a_PlanId );
+		spPlan->SetPreConditions( conditions );
+		return spPlan;
+	}
+
+	static Goal::SP MakeGoal( const char * a_pName, const char * a_pIntent, int a_nCount, double a_fConfidence )
+	{
+		ParamsMap params;
+		params["answer/intent"] = a_pIntent;
+		params["answer/count"] = a_nCount;
+		params["answer/confidence"] = a_fConfidence;
+
+		return Goal::SP( new Goal( a_pName, params ) );
+	}
+};
+
+TestPlanIndex TEST_PLAN_INDEX;
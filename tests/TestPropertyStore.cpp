@@ -0,0 +1,85 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include "utils/UnitTest.h"
+#include "models/PropertyStore.h"
+
+class TestPropertyStore : public UnitTest
+{
+public:
+	//! Construction
+	TestPropertyStore() : UnitTest("TestPropertyStore")
+	{}
+
+	virtual void RunTest()
+	{
+		Json::Value props;
+		props["_label"] = "person";
+		props["name"] = "Richard";
+		props["age"] = 46;
+		props["offset"] = -7;
+		props["count"] = Json::Value( 7u );
+		props["height"] = 1.85;
+		props["active"] = true;
+		props["nothing"] = Json::Value();
+		props["tags"][0] = "one";
+		props["tags"][1] = 2;
+		props["address"]["city"] = "Austin";
+
+		// properties are packed by Compact() and come back the same when asked for
+		PropertyStore store;
+		Test( store.IsNull() );
+		store.Set( props );
+		Test( store.IsExpanded() );
+		Test( store.Compact() );
+		Test(! store.IsExpanded() );
+		Test( store.GetPackedSize() > 0 );
+
+		Json::Value value;
+		Test( store.Find( "age", value ) && value.asInt() == 46 );
+		Test( store.Find( "address", value ) && value["city"].asString() == "Austin" );
+		Test(! store.Find( "missing", value ) );
+		Test(! store.IsExpanded() );
+
+		Json::Value copy;
+		store.GetJson( copy );
+		Test( copy == props );
+		Test(! store.IsExpanded() );
+
+		const PropertyStore & constStore = store;
+		Test( constStore.Get() == props );
+		Test( store.IsExpanded() );
+
+		// changes made through the json are packed by the next Compact()
+		PropertyStore changed( store );
+		changed.Get()["age"] = 47;
+		Test( changed.Compact() );
+		Test( changed.Find( "age", value ) && value.asInt() == 47 );
+		Test( store.Find( "age", value ) && value.asInt() == 46 );
+
+		// only objects can be packed
+		Json::Value list;
+		list[0] = 1;
+		PropertyStore other;
+		other.Set( list );
+		Test(! other.Compact() );
+		Test( other.IsExpanded() && other.Get() == list );
+	}
+};
+
+TestPropertyStore TEST_PROPERTY_STORE;
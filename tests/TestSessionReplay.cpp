@@ -0,0 +1,108 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include "utils/UnitTest.h"
+#include "utils/ThreadPool.h"
+#include "sensors/SensorManager.h"
+#include "sensors/SessionRecorder.h"
+#include "sensors/SessionReplay.h"
+#include "sensors/ReplaySensor.h"
+#include "sensors/AudioData.h"
+#include "sensors/TextData.h"
+
+#include "boost/filesystem.hpp"
+
+class TestSessionReplay : public UnitTest
+{
+public:
+	TestSessionReplay() : UnitTest( "TestSessionReplay" )
+	{}
+
+	virtual void RunTest()
+	{
+		ThreadPool pool( 1 );
+
+		const std::string SESSION_FILE( "./TestSessionReplay.session" );
+		const std::string AUDIO_FORMAT( "audio/L16;rate=16000;channels=1" );
+
+		// record an interleaved session of audio and text, using replay sensors as the source..
+		SessionRecorder recorder;
+		Test( recorder.Start( SESSION_FILE ) );
+		ISensor::SetRecorder( &recorder );
+
+		ReplaySensor::SP spMic( new ReplaySensor( "Microphone", "AudioData", AUDIO_FORMAT ) );
+		ReplaySensor::SP spKeyboard( new ReplaySensor( "Keyboard", "TextData", "application/json" ) );
+
+		std::vector<std::string> expected;
+		for(int i=0;i<10;++i)
+		{
+			std::string pcm( 3200, (char)i );
+			spMic->Replay( AUDIO_FORMAT, pcm );
+			expected.push_back( pcm );
+
+			TextData text( StringUtil::Format( "hello %d", i ), 0.9f );
+			spKeyboard->Replay( "application/json", ISerializable::SerializeObject( &text ).toStyledString() );
+			expected.push_back( text.GetText() );
+		}
+
+		ISensor::SetRecorder( NULL );
+		recorder.Stop();
+		Test( recorder.GetRecordCount() == expected.size() );
+
+		// replay it as fast as possible, all the data should come back in the same order..
+		SensorManager manager;
+		SessionReplay::SP spReplay( new SessionReplay( SESSION_FILE, 0.0f, 4 ) );
+		Test( spReplay->Start( &manager ) );
+		Test( spReplay->GetRecordCount() == expected.size() );
+
+		SensorManager::SensorList sensors;
+		Test( manager.FindSensorsByDataType( "AudioData", sensors ) );
+		Test( manager.FindSensorsByDataType( "TextData", sensors ) );
+		for(size_t i=0;i<sensors.size();++i)
+			sensors[i]->Subscribe( DELEGATE( TestSessionReplay, OnData, IData *, this ) );
+
+		bool bWait = false;
+		for(int i=0;i<100 && (m_Received.size() < expected.size() || !spReplay->IsFinished());++i)
+			Spin( bWait, 0.1f );
+
+		Test( spReplay->IsFinished() );
+		Test( spReplay->GetReplayedCount() == expected.size() );
+		Test( m_Received == expected );
+
+		for(size_t i=0;i<sensors.size();++i)
+			sensors[i]->Unsubscribe( this );
+		spReplay->Stop();
+		Test( manager.GetSensors().size() == 0 );
+
+		boost::filesystem::remove( SESSION_FILE );
+	}
+
+	void OnData( IData * a_pData )
+	{
+		AudioData * pAudio = DynamicCast<AudioData>( a_pData );
+		if ( pAudio != NULL )
+			m_Received.push_back( pAudio->GetWaveData() );
+		TextData * pText = DynamicCast<TextData>( a_pData );
+		if ( pText != NULL )
+			m_Received.push_back( pText->GetText() );
+	}
+
+	std::vector<std::string>	m_Received;
+};
+
+TestSessionReplay TEST_SESSION_REPLAY;
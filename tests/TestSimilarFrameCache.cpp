@@ -0,0 +1,81 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+#include "utils/UnitTest.h"
+#include "utils/SimilarFrameCache.h"
+
+class TestSimilarFrameCache : public UnitTest
+{
+public:
+	TestSimilarFrameCache() : UnitTest( "TestSimilarFrameCache" )
+	{}
+
+	virtual void RunTest()
+	{
+		const boost::uint64_t HASH = 0x0123456789abcdefULL;
+
+		SimilarFrameCache cache( 2, 4, 60.0 );
+		Test( cache.Find( "camera", HASH, "classifier1", 0.0 ) == NULL );
+
+		// a frame within the distance reuses the result, one too far from it doesn't
+		cache.Add( "camera", HASH, "classifier1", 100.0, Result( "dog" ) );
+		const Json::Value * pResult = cache.Find( "camera", HASH ^ 0xf, "classifier1", 110.0 );
+		Test( pResult != NULL && (*pResult)["class"].asString() == "dog" );
+		Test( cache.Find( "camera", HASH ^ 0x1f, "classifier1", 110.0 ) == NULL );
+
+		// results are kept for each origin
+		Test( cache.Find( "other", HASH, "classifier1", 110.0 ) == NULL );
+		Test( cache.GetCount( "other" ) == 0 );
+
+		// the most recent frame is found first, the oldest is dropped once there are too many
+		cache.Add( "camera", HASH, "classifier1", 120.0, Result( "cat" ) );
+		pResult = cache.Find( "camera", HASH, "classifier1", 130.0 );
+		Test( pResult != NULL && (*pResult)["class"].asString() == "cat" );
+		cache.Add( "camera", ~HASH, "classifier1", 140.0, Result( "person" ) );
+		Test( cache.GetCount( "camera" ) == 2 );
+		pResult = cache.Find( "camera", ~HASH, "classifier1", 150.0 );
+		Test( pResult != NULL && (*pResult)["class"].asString() == "person" );
+
+		// results expire, and are removed once found expired
+		Test( cache.Find( "camera", HASH, "classifier1", 181.0 ) == NULL );
+		Test( cache.GetCount( "camera" ) == 1 );
+		Test( cache.Find( "camera", ~HASH, "classifier1", 200.0 ) != NULL );
+
+		// a new classifier drops the results of the old one
+		Test( cache.Find( "camera", ~HASH, "classifier2", 200.0 ) == NULL );
+		Test( cache.GetCount( "camera" ) == 0 );
+
+		// nothing is kept when no frames are allowed
+		cache.SetMaxFrames( 0 );
+		cache.Add( "camera", HASH, "classifier2", 200.0, Result( "dog" ) );
+		Test( cache.GetCount( "camera" ) == 0 );
+
+		cache.SetMaxFrames( 2 );
+		cache.Add( "camera", HASH, "classifier2", 200.0, Result( "dog" ) );
+		cache.Clear();
+		Test( cache.GetCount( "camera" ) == 0 );
+	}
+
+	Json::Value Result( const std::string & a_Class )
+	{
+		Json::Value result;
+		result["class"] = a_Class;
+		return result;
+	}
+};
+
+TestSimilarFrameCache TEST_SIMILAR_FRAME_CACHE;
@@ -0,0 +1,93 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include "AgentTest.h"
+#include "SelfInstance.h"
+#include "skills/SkillManager.h"
+#include "skills/GestureSkill.h"
+
+class TestSkillCache : public AgentTest
+{
+public:
+	//! Construction
+	TestSkillCache() : AgentTest("TestSkillCache")
+	{}
+
+	virtual void RunTest()
+	{
+		SelfInstance * pInstance = SelfInstance::GetInstance();
+		Test( pInstance != NULL );
+		SkillManager * pSkillManager = pInstance->GetSkillManager();
+		Test( pSkillManager != NULL );
+
+		const std::string SKILL_NAME( "test_skill_cache" );
+
+		// adding a skill caches it once it's saved into the graph
+		ISkill::SP spSkill( new GestureSkill( "wave" ) );
+		spSkill->SetSkillName( SKILL_NAME );
+		Test( pSkillManager->AddSkill( spSkill ) );
+
+		Test( WaitForCache( pSkillManager, SKILL_NAME, 3000 ) );
+		Test( pSkillManager->FindCachedVertex( SKILL_NAME ).get() != NULL );
+
+		// saving the same vertex again leaves the cache alone..
+		pSkillManager->FindCachedVertex( SKILL_NAME )->Save();
+		Test( pSkillManager->FindCachedSkill( SKILL_NAME ) == spSkill );
+
+		// a newer vertex for the same skill, like one merged from a remote graph, removes the cached skill
+		Json::Value props;
+		props["name"] = SKILL_NAME;
+		props["hashId"] = "newer";
+		props["data"] = ISerializable::SerializeObject( spSkill.get() ).toStyledString();
+
+		IGraph::SP spGraph = pInstance->GetKnowledgeGraph();
+		spGraph->SetModel( "world" );
+		IVertex::SP spNewer = spGraph->CreateVertex( "skill", props );
+		Test( spNewer.get() != NULL );
+		Test(! pSkillManager->FindCachedSkill( SKILL_NAME ) );
+
+		// adding the older version again doesn't cache it over the newer vertex..
+		Test( pSkillManager->AddSkill( spSkill ) );
+		WaitForCache( pSkillManager, SKILL_NAME, 500 );
+		Test(! pSkillManager->FindCachedSkill( SKILL_NAME ) );
+
+		// but a new version is saved into the graph and cached
+		ISkill::SP spChanged( new GestureSkill( "bow" ) );
+		spChanged->SetSkillName( SKILL_NAME );
+		Test( pSkillManager->AddSkill( spChanged ) );
+		Test( WaitForCache( pSkillManager, SKILL_NAME, 3000 ) );
+		Test( pSkillManager->FindCachedSkill( SKILL_NAME ) == spChanged );
+		Test( pSkillManager->FindCachedVertex( SKILL_NAME ) != spNewer );
+
+		Test( pSkillManager->DeleteSkill( SKILL_NAME ) );
+	}
+
+	bool WaitForCache( SkillManager * a_pSkillManager, const std::string & a_Name, int a_nTimeout )
+	{
+		for(int i=0;i<a_nTimeout;++i)
+		{
+			ThreadPool::Instance()->ProcessMainThread();
+			boost::this_thread::sleep( boost::posix_time::milliseconds(1) );
+			if ( a_pSkillManager->FindCachedSkill( a_Name ).get() != NULL )
+				return true;
+		}
+		return false;
+	}
+};
+
+TestSkillCache TEST_SKILL_CACHE;
@@ -0,0 +1,213 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+
+#include "utils/UnitTest.h"
+#include "utils/ThreadPool.h"
+#include "utils/TimerPool.h"
+#include "utils/Time.h"
+#include "gestures/SpeechStream.h"
+
+//! Fake TTS service that streams a WAV file in chunks on a timer, like the web-socket TTS.
+class FakeStreamingTTS
+{
+public:
+	//! Types
+	typedef Delegate<std::string *>		StreamCallback;
+
+	FakeStreamingTTS( int a_Rate, int a_Channels, float a_fSeconds, int a_nChunks ) :
+		m_nChunks( a_nChunks ),
+		m_nSent( 0 )
+	{
+		int frames = (int)(a_Rate * a_fSeconds);
+		std::string pcm;
+		for(int i=0;i<frames;++i)
+			for(int c=0;c<a_Channels;++c)
+			{
+				short s = (short)((i % 100) * 100);
+				pcm += (char)(s & 0xff);
+				pcm += (char)((s >> 8) & 0xff);
+			}
+
+		m_Wave = "RIFF";
+		WriteLE( 0xffffffff, 4 );
+		m_Wave += "WAVEfmt ";
+		WriteLE( 16, 4 );
+		WriteLE( 1, 2 );
+		WriteLE( a_Channels, 2 );
+		WriteLE( a_Rate, 4 );
+		WriteLE( a_Rate * a_Channels * 2, 4 );
+		WriteLE( a_Channels * 2, 2 );
+		WriteLE( 16, 2 );
+		m_Wave += "data";
+		WriteLE( 0xffffffff, 4 );
+		m_Wave += pcm;
+	}
+
+	void ToSound( StreamCallback a_Callback )
+	{
+		m_Callback = a_Callback;
+		m_spTimer = TimerPool::Instance()->StartTimer(
+			VOID_DELEGATE( FakeStreamingTTS, OnTimer, this ), 0.1f, true, true );
+	}
+
+	bool IsFinished() const
+	{
+		return m_nSent > m_nChunks;
+	}
+
+private:
+	void WriteLE( unsigned int a_Value, int a_Bytes )
+	{
+		for(int i=0;i<a_Bytes;++i)
+			m_Wave += (char)((a_Value >> (i * 8)) & 0xff);
+	}
+
+	void OnTimer()
+	{
+		if ( m_nSent < m_nChunks )
+		{
+			// split on odd boundaries so partial sample frames are tested as well
+			size_t chunkSize = (m_Wave.size() / m_nChunks) | 1;
+			size_t offset = m_nSent * chunkSize;
+			if ( offset < m_Wave.size() )
+			{
+				std::string chunk( m_Wave.substr( offset, m_nSent == m_nChunks - 1 ? std::string::npos : chunkSize ) );
+				m_Callback( &chunk );
+			}
+		}
+		else if ( m_nSent == m_nChunks )
+		{
+			m_Callback( NULL );
+			m_spTimer.reset();
+		}
+		m_nSent += 1;
+	}
+
+	std::string						m_Wave;
+	int								m_nChunks;
+	int								m_nSent;
+	StreamCallback					m_Callback;
+	TimerPool::ITimer::SP			m_spTimer;
+};
+
+class TestSpeechStream : public UnitTest
+{
+public:
+	TestSpeechStream() : UnitTest( "TestSpeechStream" ),
+		m_BytesReceived( 0 ),
+		m_bDone( false ),
+		m_fFirstAudio( 0.0 )
+	{}
+
+	virtual void RunTest()
+	{
+		ThreadPool pool( 1 );
+		TimerPool timers;
+
+		// 3 seconds of 22khz stereo audio streamed over 2 seconds, played out at 8khz
+		double start = Time().GetEpochTime();
+		FakeStreamingTTS tts( 22050, 2, 3.0f, 20 );
+		SpeechStream::SP spStream( new SpeechStream( 8000, 0.25f, 1.0f,
+			DELEGATE( TestSpeechStream, OnAudio, const std::string &, this ),
+			DELEGATE( TestSpeechStream, OnDone, SpeechStream *, this ) ) );
+		spStream->Start();
+		tts.ToSound( DELEGATE( SpeechStream, OnStreamData, std::string *, spStream ) );
+
+		Spin( m_bDone, 10.0f );
+		Test( m_bDone );
+		Test( tts.IsFinished() );
+		// first audio should be played long before the synthesis has completed
+		Test( m_fFirstAudio > 0.0 && (m_fFirstAudio - start) < 1.0 );
+		Test( spStream->GetFirstAudioLatency() >= 0.0 );
+		Test( m_BytesReceived > (8000 * 2 * 29) / 10 && m_BytesReceived <= 8000 * 2 * 3 + 2 );
+
+		// barge-in, the remaining audio should be dropped and done never invoked
+		m_bDone = false;
+		m_BytesReceived = 0;
+		FakeStreamingTTS tts2( 16000, 1, 5.0f, 10 );
+		spStream.reset( new SpeechStream( 16000, 0.25f, 0.5f,
+			DELEGATE( TestSpeechStream, OnAudio, const std::string &, this ),
+			DELEGATE( TestSpeechStream, OnDone, SpeechStream *, this ) ) );
+		spStream->Start();
+		tts2.ToSound( DELEGATE( SpeechStream, OnStreamData, std::string *, spStream ) );
+
+		bool bWait = false;
+		Spin( bWait, 0.5f );
+		spStream->Cancel();
+		Test( spStream->IsCancelled() );
+		Test( spStream->GetBufferedTime() == 0.0 );
+		Spin( bWait, 1.5f );
+
+		Test(! m_bDone );
+		Test( m_BytesReceived < 16000 * 2 * 2 );
+
+		// audio we can't play still completes the stream, so whoever is waiting on it can move on
+		m_bDone = false;
+		m_BytesReceived = 0;
+		spStream.reset( new SpeechStream( 16000, 0.25f, 0.5f,
+			DELEGATE( TestSpeechStream, OnAudio, const std::string &, this ),
+			DELEGATE( TestSpeechStream, OnDone, SpeechStream *, this ) ) );
+		spStream->Start();
+		spStream->Write( MakeHeader( 16000, 1, 8 ) + std::string( 1600, (char)0x80 ) );
+		Test( m_bDone );
+		Test( spStream->IsFailed() && spStream->IsClosed() );
+		Test( m_BytesReceived == 0 );
+		spStream->Close();
+	}
+
+	static std::string MakeHeader( int a_Rate, int a_Channels, int a_Bits )
+	{
+		std::string header( "RIFF" );
+		WriteLE( header, 0xffffffff, 4 );
+		header += "WAVEfmt ";
+		WriteLE( header, 16, 4 );
+		WriteLE( header, 1, 2 );
+		WriteLE( header, a_Channels, 2 );
+		WriteLE( header, a_Rate, 4 );
+		WriteLE( header, a_Rate * a_Channels * (a_Bits / 8), 4 );
+		WriteLE( header, a_Channels * (a_Bits / 8), 2 );
+		WriteLE( header, a_Bits, 2 );
+		header += "data";
+		WriteLE( header, 0xffffffff, 4 );
+		return header;
+	}
+
+	static void WriteLE( std::string & a_Data, unsigned int a_Value, int a_Bytes )
+	{
+		for(int i=0;i<a_Bytes;++i)
+			a_Data += (char)((a_Value >> (i * 8)) & 0xff);
+	}
+
+	void OnAudio( const std::string & a_Audio )
+	{
+		if ( m_BytesReceived == 0 )
+			m_fFirstAudio = Time().GetEpochTime();
+		m_BytesReceived += a_Audio.size();
+	}
+
+	void OnDone( SpeechStream * a_pStream )
+	{
+		m_bDone = true;
+	}
+
+	size_t		m_BytesReceived;
+	bool		m_bDone;
+	double		m_fFirstAudio;
+};
+
+TestSpeechStream TEST_SPEECH_STREAM;
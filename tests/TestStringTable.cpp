@@ -0,0 +1,63 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+#include "utils/UnitTest.h"
+#include "utils/StringTable.h"
+#include "models/EdgeLabel.h"
+
+class TestStringTable : public UnitTest
+{
+public:
+	TestStringTable() : UnitTest( "TestStringTable" )
+	{}
+
+	virtual void RunTest()
+	{
+		StringTable table;
+		Test( table.GetSize() == 1 );
+
+		// the empty string is always id 0, new strings get the next id
+		StringTable::Id id = 99;
+		Test( table.Find( "", id ) && id == 0 );
+		Test( table.Intern( "" ) == 0 );
+		Test( table.Intern( "knows" ) == 1 );
+		Test( table.Intern( "likes" ) == 2 );
+		Test( table.Intern( "knows" ) == 1 );
+		Test( table.GetSize() == 3 );
+
+		// finding a string doesn't add it
+		Test(! table.Find( "owns", id ) );
+		Test( table.GetSize() == 3 );
+		Test( table.Find( "likes", id ) && id == 2 );
+
+		// references to a string stay valid as more strings are added
+		const std::string & knows = table.GetText( 1 );
+		for(int i=0;i<1000;++i)
+			table.Intern( StringUtil::Format( "label%d", i ) );
+		Test( knows == "knows" );
+		Test( table.GetText( 1002 ) == "label999" );
+		Test( table.GetText( 5000 ) == "" );
+
+		// edge labels use a table of their own, shared by every graph
+		EdgeLabel::Id label = EdgeLabel::Intern( "TestStringTable" );
+		Test( EdgeLabel::Find( "TestStringTable", id ) && id == label );
+		Test( EdgeLabel::GetText( label ) == "TestStringTable" );
+		Test( EdgeLabel::Intern( "" ) == 0 );
+	}
+};
+
+TestStringTable TEST_STRING_TABLE;
@@ -0,0 +1,124 @@
+/**
+* Copyright 2017 IBM Corp. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*/
+
+#include "utils/UnitTest.h"
+#include "sensors/DiskAudioSensor.h"
+
+class TestWaveHeader : public UnitTest
+{
+public:
+	TestWaveHeader() : UnitTest( "TestWaveHeader" )
+	{}
+
+	static void WriteLE( std::string & a_Data, unsigned int a_Value, size_t a_Bytes )
+	{
+		for(size_t i=0;i<a_Bytes;++i)
+			a_Data += (char)((a_Value >> (i * 8)) & 0xff);
+	}
+
+	//! Makes a WAV file with an extra chunk before the fmt chunk, a_nSubFormat is used for WAVE_FORMAT_EXTENSIBLE
+	static std::string MakeWave( int a_nTag, int a_nRate, int a_nChannels, int a_nBits, size_t a_nSamples, int a_nSubFormat = 0 )
+	{
+		std::string fmt;
+		WriteLE( fmt, a_nTag, 2 );
+		WriteLE( fmt, a_nChannels, 2 );
+		WriteLE( fmt, a_nRate, 4 );
+		WriteLE( fmt, a_nRate * a_nChannels * (a_nBits / 8), 4 );
+		WriteLE( fmt, a_nChannels * (a_nBits / 8), 2 );
+		WriteLE( fmt, a_nBits, 2 );
+		if ( a_nTag == DiskAudioSensor::Format::EXTENSIBLE_TAG )
+		{
+			WriteLE( fmt, 22, 2 );
+			WriteLE( fmt, a_nBits, 2 );
+			WriteLE( fmt, 0, 4 );
+			WriteLE( fmt, a_nSubFormat, 2 );
+			fmt.append( 14, '\0' );
+		}
+
+		std::string body( "WAVE" );
+		body += "LIST";
+		WriteLE( body, 3, 4 );
+		body.append( 4, 'x' );			// odd sized chunks are padded
+		body += "fmt ";
+		WriteLE( body, (unsigned int)fmt.size(), 4 );
+		body += fmt;
+		body += "data";
+		WriteLE( body, (unsigned int)a_nSamples, 4 );
+		body.append( a_nSamples, '\0' );
+
+		std::string wave( "RIFF" );
+		WriteLE( wave, (unsigned int)body.size(), 4 );
+		return wave + body;
+	}
+
+	static bool Parse( const std::string & a_Data, DiskAudioSensor::Format & a_Format, size_t & a_Offset, size_t & a_Bytes )
+	{
+		return DiskAudioSensor::ParseWave( a_Data.data(), a_Data.size(), a_Format, a_Offset, a_Bytes );
+	}
+
+	virtual void RunTest()
+	{
+		DiskAudioSensor::Format format;
+		size_t offset = 0, bytes = 0;
+
+		// 16 bit PCM, the samples follow the data chunk header
+		std::string wave( MakeWave( DiskAudioSensor::Format::PCM_TAG, 22050, 2, 16, 400 ) );
+		Test( Parse( wave, format, offset, bytes ) );
+		Test( format.m_Rate == 22050 && format.m_Channels == 2 && format.m_Bits == 16 );
+		Test( offset == wave.size() - 400 && bytes == 400 );
+
+		// a data size past the end of the file is clamped
+		wave.resize( wave.size() - 100 );
+		Test( Parse( wave, format, offset, bytes ) );
+		Test( bytes == 300 );
+
+		// WAVE_FORMAT_EXTENSIBLE is accepted if it's PCM
+		format = DiskAudioSensor::Format();
+		Test( Parse( MakeWave( DiskAudioSensor::Format::EXTENSIBLE_TAG, 16000, 1, 16, 100, DiskAudioSensor::Format::PCM_TAG ), format, offset, bytes ) );
+		Test( format.m_Tag == DiskAudioSensor::Format::PCM_TAG && format.m_Rate == 16000 );
+
+		// float, ADPCM and extensible float are all rejected
+		format = DiskAudioSensor::Format();
+		Test(! Parse( MakeWave( 3, 16000, 1, 32, 100 ), format, offset, bytes ) );
+		Test( format.m_Tag == 3 );
+		format = DiskAudioSensor::Format();
+		Test(! Parse( MakeWave( 2, 16000, 1, 16, 100 ), format, offset, bytes ) );
+		format = DiskAudioSensor::Format();
+		Test(! Parse( MakeWave( DiskAudioSensor::Format::EXTENSIBLE_TAG, 16000, 1, 16, 100, 3 ), format, offset, bytes ) );
+
+		// 24 bit PCM isn't supported
+		format = DiskAudioSensor::Format();
+		Test(! Parse( MakeWave( DiskAudioSensor::Format::PCM_TAG, 16000, 1, 24, 99 ), format, offset, bytes ) );
+
+		// a file without a header is raw PCM in the format it was given
+		format = DiskAudioSensor::Format();
+		format.m_Rate = 16000;
+		format.m_Channels = 1;
+		format.m_Bits = 16;
+		std::string raw( 320, '\0' );
+		Test( Parse( raw, format, offset, bytes ) );
+		Test( offset == 0 && bytes == raw.size() );
+
+		// a header without a data chunk is rejected
+		wave = MakeWave( DiskAudioSensor::Format::PCM_TAG, 16000, 1, 16, 0 );
+		wave.resize( wave.size() - 8 );
+		format = DiskAudioSensor::Format();
+		Test(! Parse( wave, format, offset, bytes ) );
+	}
+};
+
+TestWaveHeader TEST_WAVE_HEADER;